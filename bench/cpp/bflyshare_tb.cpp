@@ -0,0 +1,308 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	bflyshare_tb.cpp
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	A test-bench for the hardware butterfly at eight clocks per
+//		CE, where each pair of FFT stages shares one multiply.  This
+//	tests bflyshare.v, from bench/rtl, which connects two hwbfly.v's to one
+//	mpyshare.v just as fftgen -k 8 connects two adjacent stages.  Random
+//	operands are given to both butterflies on every CE, with CEs eight or
+//	more clocks apart, and every output of each is checked bit for bit
+//	against the butterfly calculated here.
+//
+//	The last line output will either read "SUCCESS" on success, or some
+//	other failure message otherwise.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "Vbflyshare.h"
+#include "twoc.h"
+
+// The parameters of bflyshare.v.  The B butterfly is one bit wider.
+#define	IWIDTH	16
+#define	CWIDTH	20
+#define	OWIDTH	17
+#define	CKPCE	8
+#define	BIWIDTH	(IWIDTH+1)
+#define	BOWIDTH	(OWIDTH+1)
+
+#define	NTESTS	4096
+// The number of results held while waiting for the butterflies
+#define	PIPELEN	64
+
+class	BFLYSHARE_TB {
+public:
+	Vbflyshare	*m_bfly;
+	VerilatedVcdC	*m_trace;
+	unsigned long	m_left_a[PIPELEN], m_right_a[PIPELEN],
+			m_left_b[PIPELEN], m_right_b[PIPELEN];
+	bool		m_aux_a[PIPELEN], m_aux_b[PIPELEN];
+	int		m_addr, m_offset;
+	bool		m_syncd;
+	uint64_t	m_tickcount;
+
+	BFLYSHARE_TB(void) {
+		Verilated::traceEverOn(true);
+		m_trace = NULL;
+		m_bfly = new Vbflyshare;
+		m_addr = 0;
+		m_offset = 0;
+		m_syncd = false;
+		m_tickcount = 0;
+	}
+
+	~BFLYSHARE_TB(void) {
+		closetrace();
+		delete m_bfly;
+	}
+
+	void	opentrace(const char *vcdname) {
+		if (!m_trace) {
+			m_trace = new VerilatedVcdC;
+			m_bfly->trace(m_trace, 99);
+			m_trace->open(vcdname);
+		}
+	}
+
+	void	closetrace(void) {
+		if (m_trace) {
+			m_trace->close();
+			delete	m_trace;
+			m_trace = NULL;
+		}
+	}
+
+	void	tick(void) {
+		m_tickcount++;
+
+		m_bfly->i_clk = 0;
+		m_bfly->eval();
+		if (m_trace) m_trace->dump((uint64_t)(10ul*m_tickcount-2));
+		m_bfly->i_clk = 1;
+		m_bfly->eval();
+		if (m_trace) m_trace->dump((uint64_t)(10ul*m_tickcount));
+		m_bfly->i_clk = 0;
+		m_bfly->eval();
+		if (m_trace) {
+			m_trace->dump((uint64_t)(10ul*m_tickcount+5));
+			m_trace->flush();
+		}
+
+		if ((!m_syncd)&&(m_bfly->o_aux_a))
+			m_offset = m_addr;
+		m_syncd = (m_syncd) || (m_bfly->o_aux_a);
+	}
+
+	// One clock with i_ce, followed by at least CKPCE-1 without
+	void	cetick(void) {
+		int	nidle = CKPCE-1 + (rand() % 3);
+
+		m_bfly->i_ce = 1;
+		tick();
+		m_bfly->i_ce = 0;
+		for(int k=0; k<nidle; k++)
+			tick();
+	}
+
+	void	reset(void) {
+		m_bfly->i_ce      = 0;
+		m_bfly->i_reset   = 1;
+		m_bfly->i_coef_a  = 0;
+		m_bfly->i_left_a  = 0;
+		m_bfly->i_right_a = 0;
+		m_bfly->i_coef_b  = 0;
+		m_bfly->i_left_b  = 0;
+		m_bfly->i_right_b = 0;
+		tick();
+
+		// Fill the butterflies with aux=1 while they are held in
+		// reset.  None of these may come out once reset is released.
+		m_bfly->i_aux_a = 1;
+		m_bfly->i_aux_b = 1;
+		for(int k=0; k<16; k++)
+			cetick();
+		m_bfly->i_reset = 0;
+		m_syncd = false;
+	}
+
+	// The outputs of a butterfly of iw bits in and ow bits out, bit
+	// for bit, just as hwbfly.v calculates them
+	static void	butterfly(const int iw, const int ow,
+			const unsigned long cof, const unsigned long lft,
+			const unsigned long rht,
+			unsigned long &olft, unsigned long &orht) {
+		long	rlft, ilft, rrht, irht, rcof, icof;
+
+		rlft = sbits(lft >> iw, iw);
+		ilft = sbits(lft, iw);
+		rrht = sbits(rht >> iw, iw);
+		irht = sbits(rht, iw);
+		rcof = sbits(cof >> CWIDTH, CWIDTH);
+		icof = sbits(cof, CWIDTH);
+
+		long	sumr, sumi, difr, difi;
+		sumr = rlft + rrht;
+		sumi = ilft + irht;
+		difr = rlft - rrht;
+		difi = ilft - irht;
+
+		// The three products of the Karatsuba form, as mpyshare.v
+		// finds them
+		long	p1, p2, p3, mpyr, mpyi;
+		p1 = difr * rcof;
+		p2 = difi * icof;
+		p3 = (difr + difi) * (rcof + icof);
+
+		mpyr = rndbits(p1-p2, (iw+2)+(CWIDTH+1), ow+4);
+		mpyi = rndbits(p3-p1-p2, (iw+2)+(CWIDTH+1), ow+4);
+
+		long	olr, oli;
+		olr = rndbits(sumr<<(CWIDTH-2), CWIDTH+iw+3, ow+4);
+		oli = rndbits(sumi<<(CWIDTH-2), CWIDTH+iw+3, ow+4);
+
+		olft = (ubits(olr, ow) << ow) | ubits(oli, ow);
+		orht = (ubits(mpyr, ow) << ow) | ubits(mpyi, ow);
+	}
+
+	void	fail(const char *bfly, const char *what, unsigned long exp,
+			unsigned long sut) {
+		printf("TEST %d, BUTTERFLY %s: WRONG %s! (%lx(exp) != %lx(sut))\n",
+			m_addr, bfly, what, exp, sut);
+		printf("FAIL\n");
+		exit(EXIT_FAILURE);
+	}
+
+	void	check(void) {
+		int	k = (m_addr - m_offset) & (PIPELEN-1);
+
+		if (!m_syncd) {
+			if (m_addr > 22) {
+				printf("NO SYNC PULSE!\n");
+				printf("FAIL\n");
+				exit(EXIT_FAILURE);
+			} return;
+		}
+
+		if (m_left_a[k] != m_bfly->o_left_a)
+			fail("A", "O_LEFT", m_left_a[k], m_bfly->o_left_a);
+		if (m_right_a[k] != m_bfly->o_right_a)
+			fail("A", "O_RIGHT", m_right_a[k], m_bfly->o_right_a);
+		if (m_aux_a[k] != (m_bfly->o_aux_a != 0))
+			fail("A", "O_AUX", m_aux_a[k], m_bfly->o_aux_a);
+
+		if (m_left_b[k] != m_bfly->o_left_b)
+			fail("B", "O_LEFT", m_left_b[k], m_bfly->o_left_b);
+		if (m_right_b[k] != m_bfly->o_right_b)
+			fail("B", "O_RIGHT", m_right_b[k], m_bfly->o_right_b);
+		if (m_aux_b[k] != (m_bfly->o_aux_b != 0))
+			fail("B", "O_AUX", m_aux_b[k], m_bfly->o_aux_b);
+	}
+
+	void	test(const unsigned long cofa, const unsigned long lfta,
+			const unsigned long rhta, const bool auxa,
+			const unsigned long cofb, const unsigned long lftb,
+			const unsigned long rhtb, const bool auxb) {
+		int	a = m_addr & (PIPELEN-1);
+
+		m_bfly->i_coef_a  = ubits(cofa, 2*CWIDTH);
+		m_bfly->i_left_a  = ubits(lfta, 2*IWIDTH);
+		m_bfly->i_right_a = ubits(rhta, 2*IWIDTH);
+		m_bfly->i_aux_a   = (auxa) ? 1 : 0;
+		m_bfly->i_coef_b  = ubits(cofb, 2*CWIDTH);
+		m_bfly->i_left_b  = ubits(lftb, 2*BIWIDTH);
+		m_bfly->i_right_b = ubits(rhtb, 2*BIWIDTH);
+		m_bfly->i_aux_b   = (auxb) ? 1 : 0;
+
+		cetick();
+		check();
+
+		butterfly(IWIDTH, OWIDTH, cofa, lfta, rhta,
+				m_left_a[a], m_right_a[a]);
+		m_aux_a[a] = auxa;
+		butterfly(BIWIDTH, BOWIDTH, cofb, lftb, rhtb,
+				m_left_b[a], m_right_b[a]);
+		m_aux_b[a] = auxb;
+
+		m_addr++;
+	}
+};
+
+// A random value of w bits, at either extreme one time in eight
+long	rndval(const int w) {
+	switch(rand() & 7) {
+	case 0:	return -(1l<<(w-1));
+	case 1:	return (1l<<(w-1))-1;
+	default:
+		return sbits(((long)rand() << 16) ^ rand(), w);
+	}
+}
+
+// A random complex value of w bits each
+unsigned long	rndcplx(const int w) {
+	return (ubits(rndval(w), w) << w) | ubits(rndval(w), w);
+}
+
+// A random twiddle factor, of unit magnitude
+unsigned long	rndcoef(void) {
+	double	W = 2.0 * M_PI * rand() / RAND_MAX;
+	long	rv, iv;
+
+	rv = (long)((double)(1l<<(CWIDTH-2))*cos(W)+0.5);
+	iv = (long)((double)(1l<<(CWIDTH-2))*sin(W)+0.5);
+	return (ubits(rv, CWIDTH) << CWIDTH) | ubits(iv, CWIDTH);
+}
+
+int	main(int argc, char **argv, char **envp) {
+	Verilated::commandArgs(argc, argv);
+	BFLYSHARE_TB	*bfly = new BFLYSHARE_TB;
+
+	// bfly->opentrace("bflyshare.vcd");
+
+	bfly->reset();
+
+	// The first aux=1 out of butterfly A marks the delay through both
+	for(int k=0; k<NTESTS; k++)
+		bfly->test(rndcoef(), rndcplx(IWIDTH), rndcplx(IWIDTH),
+				(k == 0)||((rand()&15)==0),
+			rndcoef(), rndcplx(BIWIDTH), rndcplx(BIWIDTH),
+				(k == 0)||((rand()&15)==0));
+
+	delete	bfly;
+
+	printf("SUCCESS!\n");
+	exit(EXIT_SUCCESS);
+}
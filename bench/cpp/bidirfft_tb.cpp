@@ -0,0 +1,257 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	bidirfft_tb.cpp
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	A test-bench for bidirfft.v, the run time selectable forward
+//		or inverse FFT fftgen builds with -b.  Random frames are given
+//	to the core, one sample per i_ce at random intervals, with a random
+//	direction chosen for each frame via i_inverse.  Every frame out is
+//	checked against a double precision DFT of its input, forward or inverse
+//	as requested, and o_inverse is checked against the direction requested
+//	for it.
+//
+//	The last line output will either read "SUCCESS" on success, or some
+//	other failure message otherwise.  This needs to be run from the
+//	directory holding the core, so that the core can find its hex files.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <vector>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "Vbidirfft.h"
+#include "twoc.h"
+#include "dft.h"
+
+#include "bidirsize.h"
+
+#define	IWIDTH	FFT_IWIDTH
+#define	OWIDTH	FFT_OWIDTH
+#define	LGWIDTH	FFT_LGWIDTH
+#define	FFTLEN	(1<<LGWIDTH)
+
+#define	NFRAMES	16
+// The largest RMS error allowed, in output LSBs
+#define	MAXERR	2.0
+
+class	BIDIRFFT_TB {
+public:
+	Vbidirfft	*m_fft;
+	VerilatedVcdC	*m_trace;
+	unsigned long	m_tickcount;
+	// The input to the core, and the direction of each frame
+	std::vector<double>	m_in;
+	std::vector<bool>	m_inverse;
+	double		m_out[2*FFTLEN];
+	int		m_frame, m_bin;
+
+	BIDIRFFT_TB(void) {
+		Verilated::traceEverOn(true);
+		m_fft = new Vbidirfft;
+		m_trace = NULL;
+		m_tickcount = 0l;
+		m_frame = 0;
+		m_bin   = -1;
+	}
+
+	~BIDIRFFT_TB(void) {
+		closetrace();
+		delete m_fft;
+	}
+
+	void	opentrace(const char *vcdname) {
+		if (!m_trace) {
+			m_trace = new VerilatedVcdC;
+			m_fft->trace(m_trace, 99);
+			m_trace->open(vcdname);
+		}
+	}
+
+	void	closetrace(void) {
+		if (m_trace) {
+			m_trace->close();
+			delete	m_trace;
+			m_trace = NULL;
+		}
+	}
+
+	void	tick(void) {
+		m_tickcount++;
+
+		m_fft->i_clk = 0;
+		m_fft->eval();
+		if (m_trace) m_trace->dump((vluint64_t)(10*m_tickcount-2));
+		m_fft->i_clk = 1;
+		m_fft->eval();
+		if (m_trace) m_trace->dump((vluint64_t)(10*m_tickcount));
+		m_fft->i_clk = 0;
+		m_fft->eval();
+		if (m_trace) {
+			m_trace->dump((vluint64_t)(10*m_tickcount+5));
+			m_trace->flush();
+		}
+
+		check();
+	}
+
+	void	reset(void) {
+		m_fft->i_reset = 1;
+		m_fft->i_ce = 0;
+		m_fft->i_inverse = 0;
+		m_fft->i_sample = 0;
+		tick();
+		tick();
+		m_fft->i_reset = 0;
+		tick();
+	}
+
+	void	check(void) {
+		double	ref[2*FFTLEN], err;
+		bool	inv;
+
+		// The core produces one output for every input
+		if (!m_fft->i_ce)
+			return;
+
+		if (m_fft->o_sync) {
+			if ((m_bin >= 0)&&(m_bin != FFTLEN)) {
+				printf("FRAME %d ended after %d bins\n",
+					m_frame, m_bin);
+				printf("FAIL\n");
+				exit(EXIT_FAILURE);
+			}
+			m_bin = 0;
+		} else if ((m_bin < 0)||(m_bin >= FFTLEN))
+			return;
+
+		if (m_inverse.size() <= (unsigned)m_frame) {
+			printf("FRAME %d produced before its input\n", m_frame);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		// o_inverse must follow the frame's direction from one end of
+		// the frame to the other
+		inv = m_inverse[m_frame];
+		if ((m_fft->o_inverse != 0) != inv) {
+			printf("FRAME %d, BIN %d: O_INVERSE = %d, rather than %d\n",
+				m_frame, m_bin, m_fft->o_inverse, (inv) ? 1:0);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		m_out[2*m_bin  ] = sbits(m_fft->o_result >> OWIDTH, OWIDTH);
+		m_out[2*m_bin+1] = sbits(m_fft->o_result, OWIDTH);
+		m_bin++;
+
+		if (m_bin < FFTLEN)
+			return;
+
+		if (m_in.size() < (unsigned)(m_frame+1)*2*FFTLEN) {
+			printf("FRAME %d produced before its input\n", m_frame);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		dft(FFTLEN, &m_in[m_frame*2*FFTLEN], ref, inv);
+		err = dfterr(FFTLEN, ref, m_out);
+		printf("FRAME %3d (%s): RMS error %6.3f\n", m_frame,
+			(inv) ? "inverse" : "forward", err);
+		if (err > MAXERR) {
+			printf("FRAME %d is too far from the %s DFT\n",
+				m_frame, (inv) ? "inverse" : "forward");
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		m_frame++;
+	}
+
+	void	test(long r, long i, bool inv) {
+		m_in.push_back(r);
+		m_in.push_back(i);
+		m_fft->i_ce = 1;
+		m_fft->i_inverse = (inv) ? 1 : 0;
+		m_fft->i_sample = (ubits(r, IWIDTH) << IWIDTH) | ubits(i, IWIDTH);
+		tick();
+		m_fft->i_ce = 0;
+
+		// Samples needn't arrive every clock
+		for(int k = rand() % 3; k > 0; k--)
+			tick();
+	}
+
+	// One random frame, in one direction.  The core only samples
+	// i_inverse with the first sample of the frame, so the rest of the
+	// frame is given random values to show that they are ignored.
+	void	frame(long amp, bool inv) {
+		m_inverse.push_back(inv);
+		for(int k=0; k<FFTLEN; k++) {
+			long	r = (rand() % (2*amp)) - amp,
+				i = (rand() % (2*amp)) - amp;
+
+			test(r, i, (k == 0) ? inv : (rand() & 1));
+		}
+	}
+};
+
+int	main(int argc, char **argv, char **envp) {
+	Verilated::commandArgs(argc, argv);
+	BIDIRFFT_TB	*tb = new BIDIRFFT_TB;
+	long	amp = (1l<<(IWIDTH-2));
+
+	// tb->opentrace("bidirfft.vcd");
+	tb->reset();
+
+	// Start with both directions back to back, each way, then continue
+	// in random directions.  The FFT is a couple of frames behind.
+	tb->frame(amp, false);
+	tb->frame(amp, true);
+	tb->frame(amp, true);
+	tb->frame(amp, false);
+	for(int k=4; k<NFRAMES+4; k++)
+		tb->frame(amp, (rand() & 1) != 0);
+
+	if (tb->m_frame < NFRAMES) {
+		printf("Only %d frames were checked\n", tb->m_frame);
+		printf("FAIL\n");
+		exit(EXIT_FAILURE);
+	}
+
+	delete	tb;
+
+	printf("SUCCESS!\n");
+	exit(EXIT_SUCCESS);
+}
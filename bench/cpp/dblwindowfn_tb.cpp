@@ -0,0 +1,285 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	dblwindowfn_tb.cpp
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	A test-bench for dblwindowfn.v, the window function fftgen
+//		builds with -W for a two sample per clock FFT.  Random samples
+//	are fed in, at random intervals, and every windowed pair out is
+//	checked against the sample times its tap, rounded as the core rounds
+//	it.  The taps themselves, read from the window_*.hex file the core
+//	loads, are checked against a Hann window evaluated in double precision
+//	half a sample off of the usual periodic window, as dblwindowfn.v
+//	requires.
+//
+//	The last line output will either read "SUCCESS" on success, or some
+//	other failure message otherwise.  This needs to be run from the
+//	directory holding the core, so that both it and the core can find
+//	their window_*.hex file.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <vector>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "Vdblwindowfn.h"
+#include "twoc.h"
+
+#include "winsize.h"
+
+// The window is as wide as the FFT's input: samples, taps, and products
+#define	IWIDTH	FFT_IWIDTH
+#define	TWIDTH	FFT_IWIDTH
+#define	OWIDTH	FFT_IWIDTH
+#define	AWIDTH	(IWIDTH+TWIDTH)
+#define	LGWIDTH	FFT_LGWIDTH
+#define	FFTLEN	(1<<LGWIDTH)
+
+#define	NFRAMES	16
+
+class	DBLWINDOW_TB {
+public:
+	Vdblwindowfn	*m_win;
+	VerilatedVcdC	*m_trace;
+	unsigned long	m_tickcount;
+	long		m_tap[FFTLEN/2];
+	std::vector<long>	m_in;
+	int		m_frame, m_pair;
+
+	DBLWINDOW_TB(void) {
+		Verilated::traceEverOn(true);
+		m_win = new Vdblwindowfn;
+		m_trace = NULL;
+		m_tickcount = 0l;
+		m_frame = -1;
+		m_pair = 0;
+	}
+
+	~DBLWINDOW_TB(void) {
+		closetrace();
+		delete m_win;
+	}
+
+	void	opentrace(const char *vcdname) {
+		if (!m_trace) {
+			m_trace = new VerilatedVcdC;
+			m_win->trace(m_trace, 99);
+			m_trace->open(vcdname);
+		}
+	}
+
+	void	closetrace(void) {
+		if (m_trace) {
+			m_trace->close();
+			delete	m_trace;
+			m_trace = NULL;
+		}
+	}
+
+	void	tick(void) {
+		m_tickcount++;
+
+		m_win->i_clk = 0;
+		m_win->eval();
+		if (m_trace) m_trace->dump((vluint64_t)(10*m_tickcount-2));
+		m_win->i_clk = 1;
+		m_win->eval();
+		if (m_trace) m_trace->dump((vluint64_t)(10*m_tickcount));
+		m_win->i_clk = 0;
+		m_win->eval();
+		if (m_trace) {
+			m_trace->dump((vluint64_t)(10*m_tickcount+5));
+			m_trace->flush();
+		}
+
+		check();
+	}
+
+	void	reset(void) {
+		m_win->i_reset = 1;
+		m_win->i_ce = 0;
+		m_win->i_sample = 0;
+		tick();
+		tick();
+		m_win->i_reset = 0;
+		tick();
+	}
+
+	// Read the taps the core loaded, and check them against the window
+	void	load_taps(void) {
+		char	fname[64];
+		FILE	*fp;
+		double	maxv = (double)((1l<<(TWIDTH-1))-1);
+
+		sprintf(fname, "window_%d.hex", FFTLEN);
+		fp = fopen(fname, "r");
+		if (NULL == fp) {
+			fprintf(stderr, "ERR: Could not open %s\n", fname);
+			exit(EXIT_FAILURE);
+		}
+
+		for(int k=0; k<FFTLEN/2; k++) {
+			unsigned	v;
+			double		w;
+
+			if (1 != fscanf(fp, "%x", &v)) {
+				fprintf(stderr, "ERR: %s is too short\n", fname);
+				exit(EXIT_FAILURE);
+			}
+			m_tap[k] = sbits(v, TWIDTH);
+
+			w = 0.5 - 0.5 * cos(2.0 * M_PI * (k+0.5) / FFTLEN);
+			if (fabs(m_tap[k] - maxv * w) > 1.0) {
+				printf("TAP[%d] = %ld, rather than %.1f\n",
+					k, m_tap[k], maxv * w);
+				printf("FAIL\n");
+				exit(EXIT_FAILURE);
+			}
+		} fclose(fp);
+	}
+
+	// Tap k of the full window.  Only the first half is stored, since
+	// w[k] = w[N-1-k]
+	long	tap(int k) {
+		return m_tap[(k < FFTLEN/2) ? k : (FFTLEN-1-k)];
+	}
+
+	long	expected(unsigned long sample, int k) {
+		long	p = m_in[sample] * tap(k);
+
+		return sbits(rndbits(p, AWIDTH, OWIDTH), OWIDTH);
+	}
+
+	void	check(void) {
+		unsigned long	first;
+		long		left, right;
+
+		if (!m_win->o_ce) {
+			if (m_win->o_frame) {
+				printf("O_FRAME set without O_CE\n");
+				printf("FAIL\n");
+				exit(EXIT_FAILURE);
+			}
+			return;
+		}
+
+		if (m_win->o_frame) {
+			if ((m_frame >= 0)&&(m_pair != FFTLEN/2)) {
+				printf("FRAME %d ended after %d pairs\n",
+					m_frame, m_pair);
+				printf("FAIL\n");
+				exit(EXIT_FAILURE);
+			}
+			m_frame++;
+			m_pair = 0;
+		} else if (m_frame < 0) {
+			printf("O_CE set before the first frame\n");
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		} else if (m_pair >= FFTLEN/2) {
+			printf("FRAME %d runs past %d pairs\n", m_frame,
+				FFTLEN/2);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		// Frames overlap by half, so frame f begins at sample f*N/2
+		first = (unsigned long)m_frame * (FFTLEN/2) + 2*m_pair;
+		if (first+1 >= m_in.size()) {
+			printf("FRAME %d, PAIR %d, produced before its samples "
+				"were given\n", m_frame, m_pair);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		left  = sbits(m_win->o_left,  OWIDTH);
+		right = sbits(m_win->o_right, OWIDTH);
+		if ((left != expected(first, 2*m_pair))
+			||(right != expected(first+1, 2*m_pair+1))) {
+			printf("FRAME %d, PAIR %d: (%6ld,%6ld) != (%6ld,%6ld)\n",
+				m_frame, m_pair, left, right,
+				expected(first, 2*m_pair),
+				expected(first+1, 2*m_pair+1));
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		m_pair++;
+	}
+
+	void	test(long sample) {
+		m_in.push_back(sample);
+		m_win->i_ce = 1;
+		m_win->i_sample = ubits(sample, IWIDTH);
+		tick();
+		m_win->i_ce = 0;
+
+		// Samples needn't arrive every clock
+		for(int k = rand() % 3; k > 0; k--)
+			tick();
+	}
+};
+
+int	main(int argc, char **argv, char **envp) {
+	Verilated::commandArgs(argc, argv);
+	DBLWINDOW_TB	*tb = new DBLWINDOW_TB;
+	long	mx = (1l<<(IWIDTH-1))-1;
+
+	// tb->opentrace("dblwindowfn.vcd");
+	tb->load_taps();
+	tb->reset();
+
+	// Start with the extremes, then continue with random data
+	tb->test(mx);
+	tb->test(-mx-1);
+	for(int k=2; k<FFTLEN; k++)
+		tb->test((k&1) ? -mx-1 : mx);
+	for(int k=0; k<NFRAMES*FFTLEN/2; k++)
+		tb->test(sbits(rand(), IWIDTH));
+
+	// Flush the pipeline
+	for(int k=0; k<8; k++)
+		tb->tick();
+
+	if (tb->m_frame < NFRAMES) {
+		printf("Only %d frames were produced\n", tb->m_frame+1);
+		printf("FAIL\n");
+		exit(EXIT_FAILURE);
+	}
+
+	delete	tb;
+
+	printf("SUCCESS!\n");
+	exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,303 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	dct_tb.cpp
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	A test-bench for the streaming DCTs fftgen builds with -X:
+//		dct2.v if DCT_II is defined, dct4.v if DCT_IV is defined, or
+//	mdct.v if MDCT is defined.  Random real samples are given to the core,
+//	one per i_ce at random intervals, and every frame of coefficients out
+//	is checked against the same transform evaluated in double precision
+//	from its definition.  Each MDCT frame is checked against the window
+//	of 2N samples made of its own block and the one before it, so the
+//	first MDCT frame, which has no block before it, is not checked.
+//
+//	The coefficients are only compared once the gain that best matches
+//	the core's has been removed, but this gain must be positive.
+//
+//	The last line output will either read "SUCCESS" on success, or some
+//	other failure message otherwise.  This needs to be run from the
+//	directory holding the core, so that the core can find its hex files.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <vector>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "twoc.h"
+#include "dft.h"
+
+// The header describes the N/2 point FFT within the DCT, whose input has
+// room for the growth of the DCT-IV's pre-twiddle, and the MDCT's fold
+#if	defined(DCT_II)
+#include "Vdct2.h"
+#include "dct2size.h"
+#define	VDCT	Vdct2
+#define	DCTNAME	"DCT-II"
+#define	IWIDTH	FFT_IWIDTH
+#elif	defined(DCT_IV)
+#include "Vdct4.h"
+#include "dct4size.h"
+#define	VDCT	Vdct4
+#define	DCTNAME	"DCT-IV"
+#define	IWIDTH	(FFT_IWIDTH-1)
+#elif	defined(MDCT)
+#include "Vmdct.h"
+#include "mdctsize.h"
+#define	VDCT	Vmdct
+#define	DCTNAME	"MDCT"
+#define	IWIDTH	(FFT_IWIDTH-2)
+#else
+#error "One of DCT_II, DCT_IV, or MDCT must be defined"
+#endif
+
+#define	OWIDTH	(FFT_OWIDTH+1)
+#define	LGWIDTH	(FFT_LGWIDTH+1)
+#define	DCTLEN	(1<<LGWIDTH)
+
+#define	NFRAMES	16
+// The largest RMS error allowed, in output LSBs
+#define	MAXERR	2.0
+
+class	DCT_TB {
+public:
+	VDCT		*m_dct;
+	VerilatedVcdC	*m_trace;
+	unsigned long	m_tickcount;
+	// Every sample given to the core
+	std::vector<double>	m_in;
+	double		m_out[DCTLEN];
+	int		m_frame, m_coef, m_nchecked;
+
+	DCT_TB(void) {
+		Verilated::traceEverOn(true);
+		m_dct = new VDCT;
+		m_trace = NULL;
+		m_tickcount = 0l;
+		m_frame = -1;
+		m_coef  = 0;
+		m_nchecked = 0;
+	}
+
+	~DCT_TB(void) {
+		closetrace();
+		delete m_dct;
+	}
+
+	void	opentrace(const char *vcdname) {
+		if (!m_trace) {
+			m_trace = new VerilatedVcdC;
+			m_dct->trace(m_trace, 99);
+			m_trace->open(vcdname);
+		}
+	}
+
+	void	closetrace(void) {
+		if (m_trace) {
+			m_trace->close();
+			delete	m_trace;
+			m_trace = NULL;
+		}
+	}
+
+	void	tick(void) {
+		m_tickcount++;
+
+		m_dct->i_clk = 0;
+		m_dct->eval();
+		if (m_trace) m_trace->dump((vluint64_t)(10*m_tickcount-2));
+		m_dct->i_clk = 1;
+		m_dct->eval();
+		if (m_trace) m_trace->dump((vluint64_t)(10*m_tickcount));
+		m_dct->i_clk = 0;
+		m_dct->eval();
+		if (m_trace) {
+			m_trace->dump((vluint64_t)(10*m_tickcount+5));
+			m_trace->flush();
+		}
+
+		check();
+	}
+
+	void	reset(void) {
+		m_dct->i_reset = 1;
+		m_dct->i_ce = 0;
+		m_dct->i_sample = 0;
+		tick();
+		tick();
+		m_dct->i_reset = 0;
+		tick();
+	}
+
+	// The transform of frame f, straight from its definition
+	void	reference(int f, double *ref) {
+#ifdef	MDCT
+		const double	*x = &m_in[(f-1)*DCTLEN];
+
+		for(int k=0; k<DCTLEN; k++) {
+			double	acc = 0.0;
+			for(int n=0; n<2*DCTLEN; n++)
+				acc += x[n] * cos(M_PI * (n+0.5+DCTLEN/2)
+						* (k+0.5) / DCTLEN);
+			ref[k] = acc;
+		}
+#else
+		const double	*x = &m_in[f*DCTLEN];
+
+		for(int k=0; k<DCTLEN; k++) {
+			double	acc = 0.0;
+			for(int n=0; n<DCTLEN; n++)
+#ifdef	DCT_II
+				acc += x[n] * cos(M_PI * k * (2*n+1)
+						/ (2.0 * DCTLEN));
+#else
+				acc += x[n] * cos(M_PI * (n+0.5) * (k+0.5)
+						/ DCTLEN);
+#endif
+			ref[k] = acc;
+		}
+#endif
+	}
+
+	void	check(void) {
+		double	ref[DCTLEN], cref[2*DCTLEN], cout[2*DCTLEN],
+			err, gain_r, gain_i;
+
+		// The DCT produces one coefficient for every sample
+		if (!m_dct->i_ce)
+			return;
+
+		if (m_dct->o_sync) {
+			if ((m_frame >= 0)&&(m_coef != DCTLEN)) {
+				printf("FRAME %d ended after %d coefficients\n",
+					m_frame, m_coef);
+				printf("FAIL\n");
+				exit(EXIT_FAILURE);
+			}
+			m_frame++;
+			m_coef = 0;
+		} else if (m_frame < 0)
+			return;
+		else if (m_coef >= DCTLEN) {
+			printf("FRAME %d runs past %d coefficients\n",
+				m_frame, DCTLEN);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		m_out[m_coef++] = sbits(m_dct->o_result, OWIDTH);
+
+		if (m_coef < DCTLEN)
+			return;
+
+		if (m_in.size() < (unsigned)(m_frame+1)*DCTLEN) {
+			printf("FRAME %d produced before its input\n", m_frame);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+#ifdef	MDCT
+		if (m_frame == 0)
+			return;
+#endif
+
+		// Compare as complex values, with zero imaginary parts, so
+		// as to use the DFT's error measure
+		reference(m_frame, ref);
+		for(int k=0; k<DCTLEN; k++) {
+			cref[2*k  ] = ref[k];
+			cref[2*k+1] = 0.0;
+			cout[2*k  ] = m_out[k];
+			cout[2*k+1] = 0.0;
+		}
+
+		err = dfterr(DCTLEN, cref, cout, &gain_r, &gain_i);
+		printf("FRAME %3d: RMS error %6.3f\n", m_frame, err);
+		if (err > MAXERR) {
+			printf("FRAME %d is too far from the %s\n",
+				m_frame, DCTNAME);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		} else if (gain_r <= 0.0) {
+			printf("FRAME %d matches the %s with a gain of %f\n",
+				m_frame, DCTNAME, gain_r);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		m_nchecked++;
+	}
+
+	void	test(long v) {
+		m_in.push_back(v);
+		m_dct->i_ce = 1;
+		m_dct->i_sample = ubits(v, IWIDTH);
+		tick();
+		m_dct->i_ce = 0;
+
+		// Samples needn't arrive every clock
+		for(int k = rand() % 3; k > 0; k--)
+			tick();
+	}
+
+	void	frame(long amp) {
+		for(int k=0; k<DCTLEN; k++)
+			test((rand() % (2*amp)) - amp);
+	}
+};
+
+int	main(int argc, char **argv, char **envp) {
+	Verilated::commandArgs(argc, argv);
+	DCT_TB	*tb = new DCT_TB;
+	long	amp = (1l<<(IWIDTH-2));
+
+	// tb->opentrace("dct.vcd");
+	tb->reset();
+
+	// Each frame is held twice, before and after the FFT, on top of
+	// the FFT's own couple of frames
+	for(int k=0; k<NFRAMES+8; k++)
+		tb->frame(amp);
+
+	if (tb->m_nchecked < NFRAMES) {
+		printf("Only %d frames were checked\n", tb->m_nchecked);
+		printf("FAIL\n");
+		exit(EXIT_FAILURE);
+	}
+
+	delete	tb;
+
+	printf("SUCCESS!\n");
+	exit(EXIT_SUCCESS);
+}
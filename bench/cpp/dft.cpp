@@ -0,0 +1,93 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	dft.cpp
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	A double precision reference DFT, for those test benches
+//		checking a core against the transform it is meant to compute,
+//	together with a measure of how far the core's answer is from it.
+//	The DFT is computed directly, rather than via an FFT, so it doesn't
+//	share any of the shortcuts of the cores being tested--but it is only
+//	suited to the small transforms these test benches use.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+#include <math.h>
+#include "dft.h"
+
+void	dft(const int n, const double *in, double *out, const bool inverse) {
+	double	sgn = (inverse) ? 1.0 : -1.0;
+
+	for(int k=0; k<n; k++) {
+		double	acc_r = 0.0, acc_i = 0.0;
+
+		for(int t=0; t<n; t++) {
+			// Reduce k*t mod n first, to keep the phase accurate
+			double	ph = sgn * 2.0 * M_PI * ((long)k*t % n) / n;
+			double	c = cos(ph), s = sin(ph);
+
+			acc_r += in[2*t] * c - in[2*t+1] * s;
+			acc_i += in[2*t] * s + in[2*t+1] * c;
+		}
+
+		out[2*k  ] = acc_r;
+		out[2*k+1] = acc_i;
+	}
+}
+
+double	dfterr(const int n, const double *ref, const double *got,
+		double *gain_r, double *gain_i) {
+	double	num_r = 0.0, num_i = 0.0, den = 0.0, g_r, g_i, err = 0.0;
+
+	// The least squares gain: sum(got * conj(ref)) / sum(|ref|^2)
+	for(int k=0; k<n; k++) {
+		num_r += got[2*k] * ref[2*k] + got[2*k+1] * ref[2*k+1];
+		num_i += got[2*k+1] * ref[2*k] - got[2*k] * ref[2*k+1];
+		den   += ref[2*k] * ref[2*k] + ref[2*k+1] * ref[2*k+1];
+	}
+
+	if (den > 0.0) {
+		g_r = num_r / den;
+		g_i = num_i / den;
+	} else
+		g_r = g_i = 0.0;
+
+	for(int k=0; k<n; k++) {
+		double	e_r, e_i;
+
+		e_r = got[2*k  ] - (g_r * ref[2*k] - g_i * ref[2*k+1]);
+		e_i = got[2*k+1] - (g_r * ref[2*k+1] + g_i * ref[2*k]);
+		err += e_r * e_r + e_i * e_i;
+	}
+
+	if (gain_r) *gain_r = g_r;
+	if (gain_i) *gain_i = g_i;
+
+	return sqrt(err / (2.0 * n));
+}
@@ -0,0 +1,53 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	dft.h
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	A double precision reference DFT, for those test benches
+//		checking a core against the transform it is meant to compute,
+//	together with a measure of how far the core's answer is from it.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+#ifndef	DFT_H
+#define	DFT_H
+
+// The n point DFT of in[], written to out[].  Both hold n complex values,
+// real part first.  Neither direction is scaled.
+extern	void	dft(const int n, const double *in, double *out,
+			const bool inverse = false);
+
+// The RMS error, per real or imaginary component, between got[] and ref[]
+// once ref[] has been multiplied by the complex gain that best matches
+// got[].  This gain, the scaling applied by the core, is returned in
+// gain_r and gain_i if given.
+extern	double	dfterr(const int n, const double *ref, const double *got,
+			double *gain_r = 0, double *gain_i = 0);
+
+#endif
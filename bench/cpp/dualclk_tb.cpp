@@ -0,0 +1,257 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	dualclk_tb.cpp
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	A test-bench for dualclk.v, the FFT fftgen builds with -w to
+//		run from its own fast clock, and so for the two afifo.v's that
+//	carry samples into and results out of that clock domain.  The two
+//	clocks are run at unrelated rates, i_fclk a little over CKPCE times
+//	as fast as i_sclk, and random frames are given to the core one sample
+//	per i_ce at random intervals of i_sclk.  Every frame out is checked
+//	against a double precision DFT of its input.
+//
+//	The last line output will either read "SUCCESS" on success, or some
+//	other failure message otherwise.  This needs to be run from the
+//	directory holding the core, so that the core can find its hex files.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <vector>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "Vdualclk.h"
+#include "twoc.h"
+#include "dft.h"
+
+#include "dualclksize.h"
+
+#define	IWIDTH	FFT_IWIDTH
+#define	OWIDTH	FFT_OWIDTH
+#define	LGWIDTH	FFT_LGWIDTH
+#define	FFTLEN	(1<<LGWIDTH)
+
+// Half periods of the two clocks, in trace time units.  i_fclk must run
+// at least FFT_CKPCE times as fast as the samples arrive.
+#define	SHALF	(10*FFT_CKPCE+3)
+#define	FHALF	10
+
+#define	NFRAMES	16
+// The largest RMS error allowed, in output LSBs
+#define	MAXERR	2.0
+
+class	DUALCLK_TB {
+public:
+	Vdualclk	*m_fft;
+	VerilatedVcdC	*m_trace;
+	unsigned long	m_time, m_snext, m_fnext;
+	std::vector<double>	m_in;
+	double		m_out[2*FFTLEN];
+	int		m_frame, m_bin;
+
+	DUALCLK_TB(void) {
+		Verilated::traceEverOn(true);
+		m_fft = new Vdualclk;
+		m_trace = NULL;
+		m_time  = 0l;
+		m_snext = SHALF;
+		m_fnext = FHALF;
+		m_frame = 0;
+		m_bin   = -1;
+	}
+
+	~DUALCLK_TB(void) {
+		closetrace();
+		delete m_fft;
+	}
+
+	void	opentrace(const char *vcdname) {
+		if (!m_trace) {
+			m_trace = new VerilatedVcdC;
+			m_fft->trace(m_trace, 99);
+			m_trace->open(vcdname);
+		}
+	}
+
+	void	closetrace(void) {
+		if (m_trace) {
+			m_trace->close();
+			delete	m_trace;
+			m_trace = NULL;
+		}
+	}
+
+	// Advance to the next edge of either clock, or both should they
+	// coincide.  Returns true on a rising edge of i_sclk.
+	bool	edge(void) {
+		bool	srose = false;
+
+		m_time = (m_snext < m_fnext) ? m_snext : m_fnext;
+		if (m_fnext == m_time) {
+			m_fft->i_fclk = !m_fft->i_fclk;
+			m_fnext += FHALF;
+		}
+		if (m_snext == m_time) {
+			m_fft->i_sclk = !m_fft->i_sclk;
+			m_snext += SHALF;
+			srose = (m_fft->i_sclk != 0);
+		}
+
+		m_fft->eval();
+		if (m_trace) {
+			m_trace->dump((vluint64_t)m_time);
+			m_trace->flush();
+		}
+
+		return srose;
+	}
+
+	// Run until just after the next rising edge of i_sclk, letting
+	// i_fclk run as it will in the meantime
+	void	tick(void) {
+		while(!edge())
+			;
+		check();
+	}
+
+	void	reset(void) {
+		m_fft->i_reset = 1;
+		m_fft->i_ce = 0;
+		m_fft->i_sample = 0;
+		tick();
+		tick();
+		m_fft->i_reset = 0;
+		// Give the reset time to leave the i_fclk domain
+		for(int k=0; k<4; k++)
+			tick();
+	}
+
+	void	check(void) {
+		double	ref[2*FFTLEN], err;
+
+		// Results leave one per i_ce, once there are any
+		if (!m_fft->o_valid) {
+			if (m_fft->o_sync) {
+				printf("O_SYNC set without O_VALID\n");
+				printf("FAIL\n");
+				exit(EXIT_FAILURE);
+			}
+			return;
+		}
+
+		if (m_fft->o_sync) {
+			if ((m_bin >= 0)&&(m_bin != FFTLEN)) {
+				printf("FRAME %d ended after %d bins\n",
+					m_frame, m_bin);
+				printf("FAIL\n");
+				exit(EXIT_FAILURE);
+			}
+			m_bin = 0;
+		} else if (m_bin < 0) {
+			printf("O_VALID set before the first frame\n");
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		} else if (m_bin >= FFTLEN) {
+			printf("FRAME %d runs past %d bins\n", m_frame, FFTLEN);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		m_out[2*m_bin  ] = sbits(m_fft->o_result >> OWIDTH, OWIDTH);
+		m_out[2*m_bin+1] = sbits(m_fft->o_result, OWIDTH);
+		m_bin++;
+
+		if (m_bin < FFTLEN)
+			return;
+
+		if (m_in.size() < (unsigned)(m_frame+1)*2*FFTLEN) {
+			printf("FRAME %d produced before its input\n", m_frame);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		dft(FFTLEN, &m_in[m_frame*2*FFTLEN], ref);
+		err = dfterr(FFTLEN, ref, m_out);
+		printf("FRAME %3d: RMS error %6.3f\n", m_frame, err);
+		if (err > MAXERR) {
+			printf("FRAME %d is too far from the DFT\n", m_frame);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		m_frame++;
+	}
+
+	void	test(long r, long i) {
+		m_in.push_back(r);
+		m_in.push_back(i);
+		m_fft->i_ce = 1;
+		m_fft->i_sample = (ubits(r, IWIDTH) << IWIDTH) | ubits(i, IWIDTH);
+		tick();
+		m_fft->i_ce = 0;
+
+		// Samples needn't arrive on every i_sclk
+		for(int k = rand() % 3; k > 0; k--)
+			tick();
+	}
+
+	void	frame(long amp) {
+		for(int k=0; k<FFTLEN; k++)
+			test((rand() % (2*amp)) - amp, (rand() % (2*amp)) - amp);
+	}
+};
+
+int	main(int argc, char **argv, char **envp) {
+	Verilated::commandArgs(argc, argv);
+	DUALCLK_TB	*tb = new DUALCLK_TB;
+	long	amp = (1l<<(IWIDTH-2));
+
+	// tb->opentrace("dualclk.vcd");
+	tb->reset();
+
+	// Results only leave with i_ce, and the FFT holds a couple of frames
+	for(int k=0; k<NFRAMES+4; k++)
+		tb->frame(amp);
+
+	if (tb->m_frame < NFRAMES) {
+		printf("Only %d frames were checked\n", tb->m_frame);
+		printf("FAIL\n");
+		exit(EXIT_FAILURE);
+	}
+
+	delete	tb;
+
+	printf("SUCCESS!\n");
+	exit(EXIT_SUCCESS);
+}
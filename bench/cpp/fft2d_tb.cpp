@@ -0,0 +1,248 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	fft2d_tb.cpp
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	A test-bench for fft2d.v, the two dimensional FFT fftgen
+//		builds with -t, and so for the transpose.v within it.  Random
+//	tiles are given to the core in row major order, one pixel per i_ce
+//	at random intervals.  Every tile out, in column major order, is
+//	checked against a double precision two dimensional DFT of the tile
+//	it came from.
+//
+//	The last line output will either read "SUCCESS" on success, or some
+//	other failure message otherwise.  This needs to be run from the
+//	directory holding the core, so that the core can find its hex files.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <vector>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "Vfft2d.h"
+#include "twoc.h"
+#include "dft.h"
+
+#include "fft2dsize.h"
+
+// The header describes the fftmain used for both the rows and the columns
+// of each square tile
+#define	IWIDTH	FFT_IWIDTH
+#define	OWIDTH	FFT_OWIDTH
+#define	LGWIDTH	FFT_LGWIDTH
+#define	TILEW	(1<<LGWIDTH)
+#define	TILELEN	(TILEW*TILEW)
+
+#define	NFRAMES	16
+// The largest RMS error allowed, in output LSBs
+#define	MAXERR	2.0
+
+class	FFT2D_TB {
+public:
+	Vfft2d		*m_fft;
+	VerilatedVcdC	*m_trace;
+	unsigned long	m_tickcount;
+	// Each tile given to the core, in row major order
+	std::vector<double>	m_in;
+	double		m_out[2*TILELEN];
+	int		m_tile, m_idx;
+
+	FFT2D_TB(void) {
+		Verilated::traceEverOn(true);
+		m_fft = new Vfft2d;
+		m_trace = NULL;
+		m_tickcount = 0l;
+		m_tile = 0;
+		m_idx  = -1;
+	}
+
+	~FFT2D_TB(void) {
+		closetrace();
+		delete m_fft;
+	}
+
+	void	opentrace(const char *vcdname) {
+		if (!m_trace) {
+			m_trace = new VerilatedVcdC;
+			m_fft->trace(m_trace, 99);
+			m_trace->open(vcdname);
+		}
+	}
+
+	void	closetrace(void) {
+		if (m_trace) {
+			m_trace->close();
+			delete	m_trace;
+			m_trace = NULL;
+		}
+	}
+
+	void	tick(void) {
+		m_tickcount++;
+
+		m_fft->i_clk = 0;
+		m_fft->eval();
+		if (m_trace) m_trace->dump((vluint64_t)(10*m_tickcount-2));
+		m_fft->i_clk = 1;
+		m_fft->eval();
+		if (m_trace) m_trace->dump((vluint64_t)(10*m_tickcount));
+		m_fft->i_clk = 0;
+		m_fft->eval();
+		if (m_trace) {
+			m_trace->dump((vluint64_t)(10*m_tickcount+5));
+			m_trace->flush();
+		}
+
+		check();
+	}
+
+	void	reset(void) {
+		m_fft->i_reset = 1;
+		m_fft->i_ce = 0;
+		m_fft->i_sample = 0;
+		tick();
+		tick();
+		m_fft->i_reset = 0;
+		tick();
+	}
+
+	// The two dimensional DFT of one tile: the DFT of each row, followed
+	// by the DFT of each column of the result
+	void	dft2d(const double *tile, double *ref) {
+		double	rows[2*TILELEN], col[2*TILEW], out[2*TILEW];
+
+		for(int r=0; r<TILEW; r++)
+			dft(TILEW, &tile[2*r*TILEW], &rows[2*r*TILEW]);
+		for(int c=0; c<TILEW; c++) {
+			for(int r=0; r<TILEW; r++) {
+				col[2*r  ] = rows[2*(r*TILEW+c)  ];
+				col[2*r+1] = rows[2*(r*TILEW+c)+1];
+			}
+			dft(TILEW, col, out);
+			for(int r=0; r<TILEW; r++) {
+				ref[2*(r*TILEW+c)  ] = out[2*r  ];
+				ref[2*(r*TILEW+c)+1] = out[2*r+1];
+			}
+		}
+	}
+
+	void	check(void) {
+		double	ref[2*TILELEN], err;
+		int	kr, kc;
+
+		// Like fftmain, this produces one output per i_ce
+		if (!m_fft->i_ce)
+			return;
+
+		if (m_fft->o_sync) {
+			if ((m_idx >= 0)&&(m_idx != TILELEN)) {
+				printf("TILE %d ended after %d bins\n",
+					m_tile, m_idx);
+				printf("FAIL\n");
+				exit(EXIT_FAILURE);
+			}
+			m_idx = 0;
+		} else if ((m_idx < 0)||(m_idx >= TILELEN))
+			return;
+
+		// Bin m_idx is Y[kr][kc], with kr in the inner loop
+		kc = m_idx / TILEW;
+		kr = m_idx % TILEW;
+		m_out[2*(kr*TILEW+kc)  ] = sbits(m_fft->o_result >> OWIDTH,
+						OWIDTH);
+		m_out[2*(kr*TILEW+kc)+1] = sbits(m_fft->o_result, OWIDTH);
+		m_idx++;
+
+		if (m_idx < TILELEN)
+			return;
+
+		if (m_in.size() < (unsigned)(m_tile+1)*2*TILELEN) {
+			printf("TILE %d produced before its input\n", m_tile);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		dft2d(&m_in[m_tile*2*TILELEN], ref);
+		err = dfterr(TILELEN, ref, m_out);
+		printf("TILE %3d: RMS error %6.3f\n", m_tile, err);
+		if (err > MAXERR) {
+			printf("TILE %d is too far from the 2D DFT\n", m_tile);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		m_tile++;
+	}
+
+	void	test(long r, long i) {
+		m_in.push_back(r);
+		m_in.push_back(i);
+		m_fft->i_ce = 1;
+		m_fft->i_sample = (ubits(r, IWIDTH) << IWIDTH) | ubits(i, IWIDTH);
+		tick();
+		m_fft->i_ce = 0;
+
+		// Pixels needn't arrive every clock
+		for(int k = rand() % 3; k > 0; k--)
+			tick();
+	}
+};
+
+int	main(int argc, char **argv, char **envp) {
+	Verilated::commandArgs(argc, argv);
+	FFT2D_TB	*tb = new FFT2D_TB;
+	// Keep both FFTs from overflowing on random tiles
+	long	amp = (1l<<(IWIDTH-3));
+
+	// tb->opentrace("fft2d.vcd");
+	tb->reset();
+
+	// The transpose holds a tile, and each FFT a couple of rows more
+	for(int t=0; t<NFRAMES+3; t++) {
+		for(int k=0; k<TILELEN; k++)
+			tb->test((rand() % (2*amp)) - amp,
+				(rand() % (2*amp)) - amp);
+	}
+
+	if (tb->m_tile < NFRAMES) {
+		printf("Only %d tiles were checked\n", tb->m_tile);
+		printf("FAIL\n");
+		exit(EXIT_FAILURE);
+	}
+
+	delete	tb;
+
+	printf("SUCCESS!\n");
+	exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,423 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	fftcosim_tb.cpp
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Runs the Verilated fftmain.v in lockstep with the C++ model
+//		fftgen writes beside it with -M, and compares the output of
+//	every stage, sample by sample, not just the final result.
+//	Every frame is given to the model before it is given to the core, so
+//	that each stage's outputs are known before the core produces them.
+//
+//	The stages are found from the FFTMODEL_TAPS() list within
+//	fftmodel.h, so this works for any size the core is built at.  On a
+//	mismatch, it reports the first stage, frame, and sample where the two
+//	diverge, and which other stages disagreed, before failing.  The last
+//	line output will otherwise read "SUCCESS".
+//
+//	Like fft_tb, this reaches into fftmain for the stage outputs, and so
+//	depends upon the naming conventions of the Verilator used.  Stage
+//	outputs wider than 64 bits, two 32 bit values, aren't supported.
+//
+//	"make cosim" in sw/ builds one core with -M for each rounding method,
+//	beneath rtl/xtra, along with a cosimsize.h describing it.  This is
+//	built once against each, and run from within that core's directory
+//	so that both the core and the model find their hex files.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "Vfftmain.h"
+
+#include "cosimsize.h"
+#include "fftmodel.h"
+
+
+#ifdef	NEW_VERILATOR
+#define	VVAR(A)	fftmain__DOT_ ## A
+#else
+#define	VVAR(A)	v__DOT_ ## A
+#endif
+
+#define	IWIDTH	FFT_IWIDTH
+#define	OWIDTH	FFT_OWIDTH
+#define	LGWIDTH	FFT_LGWIDTH
+#define	FFTLEN	(1<<LGWIDTH)
+
+// Frames in flight, between the model and the core's last output
+#define	NRING	8
+// Frames to run past the first mismatch, to see which stages it reaches
+#define	NDRAIN	2
+
+// The stage outputs, and the final output, counted as stage NSTAGES
+#define	NTAPS	(FFTMODEL::NSTAGES+1)
+
+class	FFTCOSIM_TB {
+public:
+	Vfftmain	*m_fft;
+	FFTMODEL	*m_model;
+	VerilatedVcdC*	m_trace;
+	unsigned long	m_tickcount;
+
+	// The model's outputs for each stage of each frame in flight
+	int64_t		*m_exp_r[NRING], *m_exp_i[NRING];
+	int64_t		m_in_r[FFTLEN], m_in_i[FFTLEN];
+	int		m_iframe, m_iaddr, m_nmodeled;
+
+	// Where each stage's output is, once its first sync has been seen
+	bool		m_syncd[NTAPS];
+	int		m_oframe[NTAPS], m_oaddr[NTAPS];
+
+	// The first mismatch of each stage, if any
+	bool		m_bad[NTAPS];
+	int		m_bad_frame[NTAPS], m_bad_addr[NTAPS];
+	int64_t		m_bad_exp[NTAPS][2], m_bad_got[NTAPS][2];
+	int		m_stop_frame;
+
+	FFTCOSIM_TB(void) {
+		m_fft = new Vfftmain;
+		m_model = new FFTMODEL(".");
+		Verilated::traceEverOn(true);
+		m_trace = NULL;
+		m_tickcount = 0l;
+		for(int k=0; k<NRING; k++) {
+			m_exp_r[k] = new int64_t[NTAPS * FFTLEN];
+			m_exp_i[k] = new int64_t[NTAPS * FFTLEN];
+		}
+	}
+
+	~FFTCOSIM_TB(void) {
+		closetrace();
+		delete m_fft;
+		delete m_model;
+		for(int k=0; k<NRING; k++) {
+			delete[] m_exp_r[k];
+			delete[] m_exp_i[k];
+		}
+	}
+
+	void	opentrace(const char *vcdname) {
+		if (!m_trace) {
+			m_trace = new VerilatedVcdC;
+			m_fft->trace(m_trace, 99);
+			m_trace->open(vcdname);
+		}
+	}
+
+	void	closetrace(void) {
+		if (m_trace) {
+			m_trace->close();
+			delete m_trace;
+			m_trace = NULL;
+		}
+	}
+
+	void	tick(void) {
+		m_tickcount++;
+
+		m_fft->i_clk = 0;
+		m_fft->eval();
+		if (m_trace)
+			m_trace->dump((vluint64_t)(10*m_tickcount-2));
+		m_fft->i_clk = 1;
+		m_fft->eval();
+		if (m_trace)
+			m_trace->dump((vluint64_t)(10*m_tickcount));
+		m_fft->i_clk = 0;
+		m_fft->eval();
+		if (m_trace) {
+			m_trace->dump((vluint64_t)(10*m_tickcount+5));
+			m_trace->flush();
+		}
+	}
+
+	void	cetick(void) {
+		int	ce = m_fft->i_ce, nkce;
+		tick();
+
+		nkce = (rand()&1);
+#ifdef	FFT_CKPCE
+		nkce += FFT_CKPCE;
+#endif
+		if ((ce)&&(nkce>0)) {
+			m_fft->i_ce = 0;
+			for(int kce=1; kce < nkce; kce++)
+				tick();
+		}
+
+		m_fft->i_ce = ce;
+	}
+
+	void	reset(void) {
+		m_fft->i_ce  = 0;
+		m_fft->i_reset = 1;
+		tick();
+		m_fft->i_reset = 0;
+		tick();
+
+		m_iframe = m_iaddr = m_nmodeled = 0;
+		m_stop_frame = -1;
+		for(int k=0; k<NTAPS; k++) {
+			m_syncd[k] = false;
+			m_oframe[k] = m_oaddr[k] = 0;
+			m_bad[k] = false;
+		}
+	}
+
+	//
+	// Pick the next frame, and run it through the model.  Each frame is
+	// scaled down by a random number of bits, so that both small values
+	// and values that overflow the stages are tried.
+	//
+	void	newframe(void) {
+		int	sh = rand() % IWIDTH;
+		int	slot = (m_nmodeled++) % NRING;
+
+		for(int k=0; k<FFTLEN; k++) {
+			m_in_r[k] = FFTMODEL::sext((int64_t)rand() << 1, IWIDTH) >> sh;
+			m_in_i[k] = FFTMODEL::sext((int64_t)rand() << 1, IWIDTH) >> sh;
+		}
+
+		m_model->apply(m_in_r, m_in_i,
+			&m_exp_r[slot][FFTMODEL::NSTAGES * FFTLEN],
+			&m_exp_i[slot][FFTMODEL::NSTAGES * FFTLEN]);
+		for(int k=0; k<FFTMODEL::NSTAGES; k++)
+			for(int p=0; p<FFTLEN; p++) {
+				m_exp_r[slot][k*FFTLEN+p] = m_model->tap_r(k)[p];
+				m_exp_i[slot][k*FFTLEN+p] = m_model->tap_i(k)[p];
+			}
+	}
+
+	unsigned long	insample(int k) {
+		unsigned long	msk = (1ul << IWIDTH)-1;
+
+		return ((m_in_r[k] & msk) << IWIDTH) | (m_in_i[k] & msk);
+	}
+
+	int	owidth(int tap) {
+		return (tap < FFTMODEL::NSTAGES)
+			? FFTMODEL::stages[tap].ow : OWIDTH;
+	}
+
+	//
+	// Compare one sample of stage tap, given as the core packs it, with
+	// the model's.  The first sync of each stage marks the start of the
+	// first frame, and any later sync must fall on the start of a frame.
+	//
+	void	check(int tap, bool sync, int pos, unsigned long vl) {
+		int	ow = owidth(tap), frame, addr, slot;
+		int64_t	got_r, got_i, exp_r, exp_i;
+		bool	misplaced;
+
+		if (sync)
+			m_syncd[tap] = true;
+		if (!m_syncd[tap])
+			return;
+
+		frame = m_oframe[tap];
+		addr  = m_oaddr[tap] + pos;
+		if ((frame >= m_nmodeled)||(frame + NRING < m_nmodeled)) {
+			fprintf(stderr, "ERR: Stage %d is at frame %d, while "
+				"frame %d is going in\n", tap, frame, m_iframe);
+			exit(EXIT_FAILURE);
+		}
+
+		slot  = frame % NRING;
+		got_r = FFTMODEL::sext((int64_t)(vl >> ow), ow);
+		got_i = FFTMODEL::sext((int64_t)vl, ow);
+		exp_r = m_exp_r[slot][tap*FFTLEN + addr];
+		exp_i = m_exp_i[slot][tap*FFTLEN + addr];
+
+		// At two samples per clock, the sync marks the pair
+		misplaced = (sync)&&(m_oaddr[tap] != 0);
+		if ((!m_bad[tap])&&((misplaced)
+				||(got_r != exp_r)||(got_i != exp_i))) {
+			m_bad[tap] = true;
+			m_bad_frame[tap] = frame;
+			m_bad_addr[tap]  = addr;
+			m_bad_exp[tap][0] = exp_r;
+			m_bad_exp[tap][1] = exp_i;
+			m_bad_got[tap][0] = got_r;
+			m_bad_got[tap][1] = got_i;
+			if (misplaced)
+				printf("Stage %d syncs at sample %d\n", tap,
+					m_oaddr[tap]);
+			if (m_stop_frame < 0)
+				m_stop_frame = m_iframe + NDRAIN;
+		}
+	}
+
+	// Step each stage's place by the samples it produced on this CE
+	void	advance(int tap, int nsamples) {
+		if (!m_syncd[tap])
+			return;
+		m_oaddr[tap] += nsamples;
+		if (m_oaddr[tap] >= FFTLEN) {
+			m_oaddr[tap] = 0;
+			m_oframe[tap]++;
+		}
+	}
+
+	//
+	// Check every stage's output on this CE.  Each stage is named by its
+	// size within fftmain.v, and listed by FFTMODEL_TAPS().
+	//
+	void	checkstages(void) {
+#ifdef	DBLCLKFFT
+#define	CHECK_TAP(K, N)	\
+		check(K, m_fft->VVAR(_w_s ## N), 0, m_fft->VVAR(_w_e ## N)); \
+		check(K, m_fft->VVAR(_w_s ## N), 1, m_fft->VVAR(_w_o ## N)); \
+		advance(K, 2);
+
+		FFTMODEL_TAPS(CHECK_TAP)
+		check(NTAPS-1, m_fft->o_sync, 0, m_fft->o_left);
+		check(NTAPS-1, m_fft->o_sync, 1, m_fft->o_right);
+		advance(NTAPS-1, 2);
+#else
+#define	CHECK_TAP(K, N)	\
+		check(K, m_fft->VVAR(_w_s ## N), 0, m_fft->VVAR(_w_d ## N)); \
+		advance(K, 1);
+
+		FFTMODEL_TAPS(CHECK_TAP)
+		check(NTAPS-1, m_fft->o_sync, 0, m_fft->o_result);
+		advance(NTAPS-1, 1);
+#endif
+#undef	CHECK_TAP
+	}
+
+	// Feed one CE's worth of the current frame, then check every stage
+	void	step(void) {
+		if (m_iaddr == 0)
+			newframe();
+
+		m_fft->i_ce    = 1;
+		m_fft->i_reset = 0;
+#ifdef	DBLCLKFFT
+		m_fft->i_left  = insample(m_iaddr++);
+		m_fft->i_right = insample(m_iaddr++);
+#else
+		m_fft->i_sample = insample(m_iaddr++);
+#endif
+		if (m_iaddr >= FFTLEN) {
+			m_iaddr = 0;
+			m_iframe++;
+		}
+
+		cetick();
+		checkstages();
+	}
+
+	// True once a mismatch has had time to reach the stages after it
+	bool	done(void) {
+		return (m_stop_frame >= 0)&&(m_iframe >= m_stop_frame);
+	}
+
+	//
+	// Report the earliest frame to mismatch, and within it the first
+	// stage and the first sample, since any later stage will have
+	// inherited the error
+	//
+	bool	report(void) {
+		int	first = -1;
+
+		for(int k=0; k<NTAPS; k++) {
+			if (!m_bad[k])
+				continue;
+			if ((first < 0)||(m_bad_frame[k] < m_bad_frame[first]))
+				first = k;
+		}
+
+		for(int k=0; k<NTAPS; k++) {
+			if (!m_syncd[k])
+				printf("Stage %d never produced a sync\n", k);
+			else if (m_bad[k])
+				printf("Stage %d: first mismatch in frame %d, "
+					"sample %d\n", k, m_bad_frame[k],
+					m_bad_addr[k]);
+		}
+
+		if (first >= 0) {
+			printf("\nDIVERGED at stage %d%s, frame %d, sample %d:\n"
+				"\tmodel (%ld, %ld), core (%ld, %ld)\n",
+				first, (first == NTAPS-1) ? " (the output)":"",
+				m_bad_frame[first], m_bad_addr[first],
+				(long)m_bad_exp[first][0],
+				(long)m_bad_exp[first][1],
+				(long)m_bad_got[first][0],
+				(long)m_bad_got[first][1]);
+			if (first < FFTMODEL::NSTAGES)
+				printf("\tstage %d is the %d point %s\n",
+					first, FFTMODEL::stages[first].size,
+					(FFTMODEL::stages[first].kind
+						== FFTMODEL::BUTTERFLY)
+					? "butterfly stage"
+					: (FFTMODEL::stages[first].kind
+						== FFTMODEL::QTRSTAGE)
+					? "qtrstage" : "laststage");
+			return false;
+		}
+
+		for(int k=0; k<NTAPS; k++)
+			if (!m_syncd[k])
+				return false;
+		return true;
+	}
+};
+
+int	main(int argc, char **argv, char **envp) {
+	Verilated::commandArgs(argc, argv);
+	FFTCOSIM_TB	*tb = new FFTCOSIM_TB;
+	const	int	NFRAMES = 32;
+
+	if (!tb->m_model->loaded()) {
+		fprintf(stderr, "ERR: Could not load the model\'s twiddle factors\n");
+		exit(EXIT_FAILURE);
+	}
+
+	// tb->opentrace("fftcosim.vcd");
+	tb->reset();
+
+	while((tb->m_iframe < NFRAMES)&&(!tb->done()))
+		tb->step();
+
+	if (!tb->report()) {
+		printf("TEST FAILED\n");
+		delete tb;
+		exit(EXIT_FAILURE);
+	}
+
+	printf("SUCCESS\n");
+	delete tb;
+	exit(EXIT_SUCCESS);
+}
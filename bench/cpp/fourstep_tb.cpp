@@ -0,0 +1,277 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	fourstep_tb.cpp
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	A test-bench for fourstep.v, the four-step FFT fftgen builds
+//		with -F, running against two copies of extmem.v as its
+//	external memory.  Random frames are given to the core, one sample
+//	per i_ce at random intervals.  Every frame out, produced with k1 in
+//	the outer loop and k2 in the inner, is checked against a double
+//	precision DFT of the frame it came from.
+//
+//	The last line output will either read "SUCCESS" on success, or some
+//	other failure message otherwise.  This needs to be run from the
+//	directory holding the core, so that the core can find its hex files.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <vector>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "Vfourstep.h"
+#include "Vextmem.h"
+#include "twoc.h"
+#include "dft.h"
+
+#include "foursize.h"
+
+// The header describes the M point fftmain within fourstep.v.  Both of
+// its pipelines take samples IWIDTH bits wide, and the second produces
+// fourstep.v's own output.
+#define	IWIDTH	FFT_IWIDTH
+#define	OWIDTH	FFT_OWIDTH
+#define	LGHALF	FFT_LGWIDTH
+#define	HALFLEN	(1<<LGHALF)
+#define	FFTLEN	(HALFLEN*HALFLEN)
+
+#define	NFRAMES	16
+// The largest RMS error allowed, in output LSBs
+#define	MAXERR	2.0
+
+class	FOURSTEP_TB {
+public:
+	Vfourstep	*m_four;
+	// The two channels of external memory
+	Vextmem		*m_ma, *m_mb;
+	VerilatedVcdC	*m_trace;
+	unsigned long	m_tickcount;
+	std::vector<double>	m_in;
+	double		m_out[2*FFTLEN];
+	int		m_frame, m_idx;
+
+	FOURSTEP_TB(void) {
+		Verilated::traceEverOn(true);
+		m_four = new Vfourstep;
+		m_ma = new Vextmem;
+		m_mb = new Vextmem;
+		m_trace = NULL;
+		m_tickcount = 0l;
+		m_frame = 0;
+		m_idx   = -1;
+	}
+
+	~FOURSTEP_TB(void) {
+		closetrace();
+		delete m_four;
+		delete m_ma;
+		delete m_mb;
+	}
+
+	void	opentrace(const char *vcdname) {
+		if (!m_trace) {
+			m_trace = new VerilatedVcdC;
+			m_four->trace(m_trace, 99);
+			m_trace->open(vcdname);
+		}
+	}
+
+	void	closetrace(void) {
+		if (m_trace) {
+			m_trace->close();
+			delete	m_trace;
+			m_trace = NULL;
+		}
+	}
+
+	void	eval(void) {
+		m_four->eval();
+		m_ma->eval();
+		m_mb->eval();
+	}
+
+	void	tick(void) {
+		m_tickcount++;
+
+		// Connect the core to its memory.  Every signal between them
+		// is registered, so they need only be copied once a clock.
+		m_ma->i_we    = m_four->o_ma_we;
+		m_ma->i_waddr = m_four->o_ma_waddr;
+		m_ma->i_wdata = m_four->o_ma_wdata;
+		m_ma->i_re    = m_four->o_ma_re;
+		m_ma->i_raddr = m_four->o_ma_raddr;
+		m_four->i_ma_rvalid = m_ma->o_rvalid;
+		m_four->i_ma_rdata  = m_ma->o_rdata;
+
+		m_mb->i_we    = m_four->o_mb_we;
+		m_mb->i_waddr = m_four->o_mb_waddr;
+		m_mb->i_wdata = m_four->o_mb_wdata;
+		m_mb->i_re    = m_four->o_mb_re;
+		m_mb->i_raddr = m_four->o_mb_raddr;
+		m_four->i_mb_rvalid = m_mb->o_rvalid;
+		m_four->i_mb_rdata  = m_mb->o_rdata;
+
+		m_four->i_clk = 0;
+		m_ma->i_clk   = 0;
+		m_mb->i_clk   = 0;
+		eval();
+		if (m_trace) m_trace->dump((vluint64_t)(10*m_tickcount-2));
+		m_four->i_clk = 1;
+		m_ma->i_clk   = 1;
+		m_mb->i_clk   = 1;
+		eval();
+		if (m_trace) m_trace->dump((vluint64_t)(10*m_tickcount));
+		m_four->i_clk = 0;
+		m_ma->i_clk   = 0;
+		m_mb->i_clk   = 0;
+		eval();
+		if (m_trace) {
+			m_trace->dump((vluint64_t)(10*m_tickcount+5));
+			m_trace->flush();
+		}
+
+		check();
+	}
+
+	void	reset(void) {
+		m_four->i_reset = 1;
+		m_four->i_ce = 0;
+		m_four->i_sample = 0;
+		tick();
+		tick();
+		m_four->i_reset = 0;
+		tick();
+	}
+
+	void	check(void) {
+		double	ref[2*FFTLEN], err;
+		int	k1, k2;
+
+		if (!m_four->o_ce) {
+			if (m_four->o_sync) {
+				printf("O_SYNC set without O_CE\n");
+				printf("FAIL\n");
+				exit(EXIT_FAILURE);
+			} return;
+		}
+
+		if (m_four->o_sync) {
+			if ((m_idx >= 0)&&(m_idx != FFTLEN)) {
+				printf("FRAME %d ended after %d outputs\n",
+					m_frame, m_idx);
+				printf("FAIL\n");
+				exit(EXIT_FAILURE);
+			}
+			m_idx = 0;
+		} else if (m_idx < 0) {
+			printf("O_CE set before the first O_SYNC\n");
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		} else if (m_idx >= FFTLEN) {
+			printf("FRAME %d runs past %d outputs\n", m_frame,
+				FFTLEN);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		// Output m_idx is X[k1 + M k2], with k2 the faster of the two
+		k1 = m_idx / HALFLEN;
+		k2 = m_idx % HALFLEN;
+		m_out[2*(k1+HALFLEN*k2)  ] = sbits(m_four->o_result >> OWIDTH,
+						OWIDTH);
+		m_out[2*(k1+HALFLEN*k2)+1] = sbits(m_four->o_result, OWIDTH);
+		m_idx++;
+
+		if (m_idx < FFTLEN)
+			return;
+
+		if (m_in.size() < (unsigned)(m_frame+1)*2*FFTLEN) {
+			printf("FRAME %d produced before its input\n", m_frame);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		dft(FFTLEN, &m_in[m_frame*2*FFTLEN], ref);
+		err = dfterr(FFTLEN, ref, m_out);
+		printf("FRAME %3d: RMS error %6.3f\n", m_frame, err);
+		if (err > MAXERR) {
+			printf("FRAME %d is too far from the DFT\n", m_frame);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		m_frame++;
+	}
+
+	void	test(long r, long i) {
+		m_in.push_back(r);
+		m_in.push_back(i);
+		m_four->i_ce = 1;
+		m_four->i_sample = (ubits(r, IWIDTH) << IWIDTH) | ubits(i, IWIDTH);
+		tick();
+		m_four->i_ce = 0;
+
+		// Samples needn't arrive every clock
+		for(int k = rand() % 3; k > 0; k--)
+			tick();
+	}
+};
+
+int	main(int argc, char **argv, char **envp) {
+	Verilated::commandArgs(argc, argv);
+	FOURSTEP_TB	*tb = new FOURSTEP_TB;
+	// Keep the two pipelines from overflowing on random frames
+	long	amp = (1l<<(IWIDTH-3));
+
+	// tb->opentrace("fourstep.vcd");
+	tb->reset();
+
+	// Each transpose holds a frame, and each pipeline a couple more
+	for(int f=0; f<NFRAMES+4; f++) {
+		for(int k=0; k<FFTLEN; k++)
+			tb->test((rand() % (2*amp)) - amp,
+				(rand() % (2*amp)) - amp);
+	}
+
+	if (tb->m_frame < NFRAMES) {
+		printf("Only %d frames were checked\n", tb->m_frame);
+		printf("FAIL\n");
+		exit(EXIT_FAILURE);
+	}
+
+	delete	tb;
+
+	printf("SUCCESS!\n");
+	exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,286 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	ofdmdemod_tb.cpp
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	A test-bench for ofdmdemod.v, the OFDM demodulator fftgen
+//		builds with -o.  Random symbols, each led by a cyclic prefix
+//	copied from its end, are given to the core one sample per i_ce at
+//	random intervals.  i_sync marks the first symbol, and then marks
+//	others at random.  The subcarriers of every symbol out are checked
+//	against a double precision DFT of the symbol, less its prefix.
+//
+//	Halfway through, the symbol timing is moved by a random number of
+//	samples.  Symbols still within the core are then abandoned, so only
+//	those given after the move are expected from then on.
+//
+//	The last line output will either read "SUCCESS" on success, or some
+//	other failure message otherwise.  This needs to be run from the
+//	directory holding the core, so that the core can find its hex files.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <vector>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "Vofdmdemod.h"
+#include "twoc.h"
+#include "dft.h"
+
+#include "ofdmdemodsize.h"
+
+#define	IWIDTH	FFT_IWIDTH
+#define	OWIDTH	FFT_OWIDTH
+#define	LGWIDTH	FFT_LGWIDTH
+#define	FFTLEN	(1<<LGWIDTH)
+
+// The length of the cyclic prefix, as given to fftgen -o by sw/Makefile
+#define	CPLEN	16
+#define	SYMLEN	(FFTLEN+CPLEN)
+
+#define	NFRAMES	16
+// The largest RMS error allowed, in output LSBs
+#define	MAXERR	2.0
+
+class	OFDMDEMOD_TB {
+public:
+	Vofdmdemod	*m_demod;
+	VerilatedVcdC	*m_trace;
+	unsigned long	m_tickcount;
+	// The N samples following the prefix of every symbol given to the
+	// core
+	std::vector<double>	m_in;
+	double		m_out[2*FFTLEN];
+	// m_sym is the next symbol expected out of the core
+	int		m_sym, m_bin, m_nchecked;
+
+	OFDMDEMOD_TB(void) {
+		Verilated::traceEverOn(true);
+		m_demod = new Vofdmdemod;
+		m_trace = NULL;
+		m_tickcount = 0l;
+		m_sym = 0;
+		m_bin = -1;
+		m_nchecked = 0;
+	}
+
+	~OFDMDEMOD_TB(void) {
+		closetrace();
+		delete m_demod;
+	}
+
+	void	opentrace(const char *vcdname) {
+		if (!m_trace) {
+			m_trace = new VerilatedVcdC;
+			m_demod->trace(m_trace, 99);
+			m_trace->open(vcdname);
+		}
+	}
+
+	void	closetrace(void) {
+		if (m_trace) {
+			m_trace->close();
+			delete	m_trace;
+			m_trace = NULL;
+		}
+	}
+
+	void	tick(void) {
+		m_tickcount++;
+
+		m_demod->i_clk = 0;
+		m_demod->eval();
+		if (m_trace) m_trace->dump((vluint64_t)(10*m_tickcount-2));
+		m_demod->i_clk = 1;
+		m_demod->eval();
+		if (m_trace) m_trace->dump((vluint64_t)(10*m_tickcount));
+		m_demod->i_clk = 0;
+		m_demod->eval();
+		if (m_trace) {
+			m_trace->dump((vluint64_t)(10*m_tickcount+5));
+			m_trace->flush();
+		}
+
+		check();
+	}
+
+	void	reset(void) {
+		m_demod->i_reset = 1;
+		m_demod->i_ce = 0;
+		m_demod->i_sync = 0;
+		m_demod->i_sample = 0;
+		tick();
+		tick();
+		m_demod->i_reset = 0;
+		tick();
+	}
+
+	void	check(void) {
+		double	ref[2*FFTLEN], err;
+
+		// Subcarriers are produced on N of every N+CPLEN i_ce's
+		if (!m_demod->i_ce)
+			return;
+
+		if (!m_demod->o_valid) {
+			if (m_demod->o_sync) {
+				printf("O_SYNC set without O_VALID\n");
+				printf("FAIL\n");
+				exit(EXIT_FAILURE);
+			}
+			return;
+		}
+
+		if (m_demod->o_sync) {
+			if ((m_bin >= 0)&&(m_bin != FFTLEN)) {
+				printf("SYMBOL %d ended after %d bins\n",
+					m_sym, m_bin);
+				printf("FAIL\n");
+				exit(EXIT_FAILURE);
+			}
+			m_bin = 0;
+		} else if (m_bin < 0) {
+			printf("O_VALID set before the first symbol\n");
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		} else if (m_bin >= FFTLEN) {
+			printf("SYMBOL %d runs past %d bins\n", m_sym, FFTLEN);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		m_out[2*m_bin  ] = sbits(m_demod->o_result >> OWIDTH, OWIDTH);
+		m_out[2*m_bin+1] = sbits(m_demod->o_result, OWIDTH);
+		m_bin++;
+
+		if (m_bin < FFTLEN)
+			return;
+
+		if (m_in.size() < (unsigned)(m_sym+1)*2*FFTLEN) {
+			printf("SYMBOL %d produced before its input\n", m_sym);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		dft(FFTLEN, &m_in[m_sym*2*FFTLEN], ref);
+		err = dfterr(FFTLEN, ref, m_out);
+		printf("SYMBOL %3d: RMS error %6.3f\n", m_sym, err);
+		if (err > MAXERR) {
+			printf("SYMBOL %d is too far from the DFT\n", m_sym);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		m_sym++;
+		m_nchecked++;
+	}
+
+	void	test(long r, long i, bool sync) {
+		m_demod->i_ce = 1;
+		m_demod->i_sync = (sync) ? 1 : 0;
+		m_demod->i_sample = (ubits(r, IWIDTH) << IWIDTH) | ubits(i, IWIDTH);
+		tick();
+		m_demod->i_ce = 0;
+		m_demod->i_sync = 0;
+
+		// Samples needn't arrive every clock
+		for(int k = rand() % 3; k > 0; k--)
+			tick();
+	}
+
+	// One random symbol, led by its prefix
+	void	symbol(long amp, bool sync) {
+		long	r[FFTLEN], i[FFTLEN];
+
+		for(int k=0; k<FFTLEN; k++) {
+			r[k] = (rand() % (2*amp)) - amp;
+			i[k] = (rand() % (2*amp)) - amp;
+			m_in.push_back(r[k]);
+			m_in.push_back(i[k]);
+		}
+
+		for(int k=0; k<CPLEN; k++)
+			test(r[FFTLEN-CPLEN+k], i[FFTLEN-CPLEN+k],
+				(sync)&&(k == 0));
+		for(int k=0; k<FFTLEN; k++)
+			test(r[k], i[k], false);
+	}
+
+	// Move the symbol timing by giving nslip junk samples.  Once the
+	// next symbol marks the new timing with i_sync, every symbol given
+	// before it has been abandoned.
+	void	slip(long amp, int nslip) {
+		for(int k=0; k<nslip; k++)
+			test((rand() % (2*amp)) - amp,
+				(rand() % (2*amp)) - amp, false);
+	}
+
+	void	realigned(void) {
+		m_sym = m_in.size() / (2*FFTLEN);
+		m_bin = -1;
+	}
+};
+
+int	main(int argc, char **argv, char **envp) {
+	Verilated::commandArgs(argc, argv);
+	OFDMDEMOD_TB	*tb = new OFDMDEMOD_TB;
+	long	amp = (1l<<(IWIDTH-2));
+
+	// tb->opentrace("ofdmdemod.vcd");
+	tb->reset();
+
+	// Only the first symbol must be marked, but any may be.  The FFT
+	// holds a couple of symbols.
+	tb->symbol(amp, true);
+	for(int k=1; k<NFRAMES/2+4; k++)
+		tb->symbol(amp, (rand() & 1) != 0);
+
+	// Slip the timing by anything short of a whole symbol
+	tb->slip(amp, 1 + (rand() % (SYMLEN-1)));
+	tb->realigned();
+	tb->symbol(amp, true);
+	for(int k=1; k<NFRAMES/2+4; k++)
+		tb->symbol(amp, (rand() & 1) != 0);
+
+	if (tb->m_nchecked < NFRAMES) {
+		printf("Only %d symbols were checked\n", tb->m_nchecked);
+		printf("FAIL\n");
+		exit(EXIT_FAILURE);
+	}
+
+	delete	tb;
+
+	printf("SUCCESS!\n");
+	exit(EXIT_SUCCESS);
+}
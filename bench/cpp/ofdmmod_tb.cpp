@@ -0,0 +1,261 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	ofdmmod_tb.cpp
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	A test-bench for ofdmmod.v, the OFDM modulator fftgen builds
+//		with -i -o, and so for the cpinsert.v within it.  Random
+//	subcarriers are given to the core whenever it is ready for them, on
+//	an i_ce running at random intervals.  Every symbol out is checked in
+//	two parts: its last N samples against a double precision inverse DFT
+//	of its subcarriers, and its first CPLEN samples, the cyclic prefix,
+//	against a copy of its last CPLEN samples.
+//
+//	The last line output will either read "SUCCESS" on success, or some
+//	other failure message otherwise.  This needs to be run from the
+//	directory holding the core, so that the core can find its hex files.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <vector>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "Vofdmmod.h"
+#include "twoc.h"
+#include "dft.h"
+
+#include "ofdmmodsize.h"
+
+#define	IWIDTH	IFFT_IWIDTH
+#define	OWIDTH	IFFT_OWIDTH
+#define	LGWIDTH	IFFT_LGWIDTH
+#define	FFTLEN	(1<<LGWIDTH)
+
+// The length of the cyclic prefix, as given to fftgen -o by sw/Makefile
+#define	CPLEN	16
+#define	SYMLEN	(FFTLEN+CPLEN)
+
+#define	NFRAMES	16
+// The largest RMS error allowed, in output LSBs
+#define	MAXERR	2.0
+
+class	OFDMMOD_TB {
+public:
+	Vofdmmod	*m_mod;
+	VerilatedVcdC	*m_trace;
+	unsigned long	m_tickcount;
+	// The subcarriers given to the core, N per symbol
+	std::vector<double>	m_in;
+	double		m_out[2*SYMLEN];
+	int		m_sym, m_pos, m_nchecked;
+
+	OFDMMOD_TB(void) {
+		Verilated::traceEverOn(true);
+		m_mod = new Vofdmmod;
+		m_trace = NULL;
+		m_tickcount = 0l;
+		m_sym = -1;
+		m_pos = 0;
+		m_nchecked = 0;
+	}
+
+	~OFDMMOD_TB(void) {
+		closetrace();
+		delete m_mod;
+	}
+
+	void	opentrace(const char *vcdname) {
+		if (!m_trace) {
+			m_trace = new VerilatedVcdC;
+			m_mod->trace(m_trace, 99);
+			m_trace->open(vcdname);
+		}
+	}
+
+	void	closetrace(void) {
+		if (m_trace) {
+			m_trace->close();
+			delete	m_trace;
+			m_trace = NULL;
+		}
+	}
+
+	void	tick(void) {
+		m_tickcount++;
+
+		m_mod->i_clk = 0;
+		m_mod->eval();
+		if (m_trace) m_trace->dump((vluint64_t)(10*m_tickcount-2));
+		m_mod->i_clk = 1;
+		m_mod->eval();
+		if (m_trace) m_trace->dump((vluint64_t)(10*m_tickcount));
+		m_mod->i_clk = 0;
+		m_mod->eval();
+		if (m_trace) {
+			m_trace->dump((vluint64_t)(10*m_tickcount+5));
+			m_trace->flush();
+		}
+
+		check();
+	}
+
+	void	reset(void) {
+		m_mod->i_reset = 1;
+		m_mod->i_ce = 0;
+		m_mod->i_sample = 0;
+		tick();
+		tick();
+		m_mod->i_reset = 0;
+		tick();
+	}
+
+	void	check(void) {
+		double	ref[2*FFTLEN], err;
+
+		// The modulator produces one sample on every i_ce, prefix
+		// and all
+		if (!m_mod->i_ce)
+			return;
+
+		if (m_mod->o_sync) {
+			if ((m_sym >= 0)&&(m_pos != SYMLEN)) {
+				printf("SYMBOL %d ended after %d samples\n",
+					m_sym, m_pos);
+				printf("FAIL\n");
+				exit(EXIT_FAILURE);
+			}
+			m_sym++;
+			m_pos = 0;
+		} else if (m_sym < 0)
+			return;
+		else if (m_pos >= SYMLEN) {
+			printf("SYMBOL %d runs past %d samples\n",
+				m_sym, SYMLEN);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		m_out[2*m_pos  ] = sbits(m_mod->o_result >> OWIDTH, OWIDTH);
+		m_out[2*m_pos+1] = sbits(m_mod->o_result, OWIDTH);
+		m_pos++;
+
+		if (m_pos < SYMLEN)
+			return;
+
+		if (m_in.size() < (unsigned)(m_sym+1)*2*FFTLEN) {
+			printf("SYMBOL %d produced before its input\n", m_sym);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		// The prefix is an exact copy of the end of the symbol
+		for(int k=0; k<CPLEN; k++) {
+			if ((m_out[2*k  ] != m_out[2*(FFTLEN+k)  ])
+				||(m_out[2*k+1] != m_out[2*(FFTLEN+k)+1])) {
+				printf("SYMBOL %d: PREFIX[%d] = (%6.0f,%6.0f), "
+					"rather than (%6.0f,%6.0f)\n", m_sym, k,
+					m_out[2*k], m_out[2*k+1],
+					m_out[2*(FFTLEN+k)],
+					m_out[2*(FFTLEN+k)+1]);
+				printf("FAIL\n");
+				exit(EXIT_FAILURE);
+			}
+		}
+
+		dft(FFTLEN, &m_in[m_sym*2*FFTLEN], ref, true);
+		err = dfterr(FFTLEN, ref, &m_out[2*CPLEN]);
+		printf("SYMBOL %3d: RMS error %6.3f\n", m_sym, err);
+		if (err > MAXERR) {
+			printf("SYMBOL %d is too far from the inverse DFT\n",
+				m_sym);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		m_nchecked++;
+	}
+
+	// Step i_ce once, giving the core a subcarrier, followed by a random
+	// number of idle clocks
+	void	step(long r, long i) {
+		m_mod->i_ce = 1;
+		m_mod->i_sample = (ubits(r, IWIDTH) << IWIDTH) | ubits(i, IWIDTH);
+		tick();
+		m_mod->i_ce = 0;
+
+		for(int k = rand() % 3; k > 0; k--)
+			tick();
+	}
+
+	// One symbol of random subcarriers.  i_ce keeps running while the
+	// core isn't ready, as it does while the prefix is produced, and
+	// the samples given then are junk to be ignored.
+	void	symbol(long amp) {
+		for(int k=0; k<FFTLEN; k++) {
+			long	r = (rand() % (2*amp)) - amp,
+				i = (rand() % (2*amp)) - amp;
+
+			while(!m_mod->o_ready)
+				step(rand() % amp, rand() % amp);
+
+			m_in.push_back(r);
+			m_in.push_back(i);
+			step(r, i);
+		}
+	}
+};
+
+int	main(int argc, char **argv, char **envp) {
+	Verilated::commandArgs(argc, argv);
+	OFDMMOD_TB	*tb = new OFDMMOD_TB;
+	long	amp = (1l<<(IWIDTH-2));
+
+	// tb->opentrace("ofdmmod.vcd");
+	tb->reset();
+
+	// The inverse FFT and cpinsert hold a couple of symbols
+	for(int k=0; k<NFRAMES+4; k++)
+		tb->symbol(amp);
+
+	if (tb->m_nchecked < NFRAMES) {
+		printf("Only %d symbols were checked\n", tb->m_nchecked);
+		printf("FAIL\n");
+		exit(EXIT_FAILURE);
+	}
+
+	delete	tb;
+
+	printf("SUCCESS!\n");
+	exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,353 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	polyphase_tb.cpp
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	A test-bench for polyphase.v, the filter bank fftgen builds
+//		with -P, together with the FFT it feeds.  Random samples are
+//	fed into the filter bank, at random intervals, and its outputs are
+//	fed straight into the FFT, just as they would be within a design.
+//	Every output of the filter bank is checked against the sum of the
+//	taps, read from the polyphase_*.hex file the core loads, times the
+//	samples given to it, rounded as the core rounds it.  Every frame out
+//	of the FFT is then checked against a double precision DFT of the
+//	unrounded filter bank outputs.
+//
+//	The last line output will either read "SUCCESS" on success, or some
+//	other failure message otherwise.  This needs to be run from the
+//	directory holding the core, so that both it and the core can find
+//	their hex files.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <vector>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "Vpolyphase.h"
+#include "Vfftmain.h"
+#include "twoc.h"
+#include "dft.h"
+
+#include "pfbsize.h"
+
+// The filter bank keeps the FFT's input width throughout
+#define	IWIDTH	FFT_IWIDTH
+#define	TWIDTH	FFT_IWIDTH
+#define	PWIDTH	FFT_IWIDTH
+#define	AWIDTH	(IWIDTH+TWIDTH)
+#define	OWIDTH	FFT_OWIDTH
+#define	LGWIDTH	FFT_LGWIDTH
+#define	FFTLEN	(1<<LGWIDTH)
+
+// The number of taps per branch, as given to fftgen -P by sw/Makefile
+#define	NTAPS	4
+
+#define	NFRAMES	16
+// The largest RMS error allowed, in FFT output LSBs
+#define	MAXERR	2.0
+
+class	POLYPHASE_TB {
+public:
+	Vpolyphase	*m_pfb;
+	Vfftmain	*m_fft;
+	VerilatedVcdC	*m_trace;
+	unsigned long	m_tickcount;
+	long		m_tap[FFTLEN][NTAPS];
+	std::vector<long>	m_in_r, m_in_i;
+	// The filter bank outputs, at full precision, one frame per FFTLEN
+	std::vector<double>	m_pfb_out;
+	unsigned long	m_npfb;
+	double		m_fft_out[2*FFTLEN];
+	int		m_fft_frame, m_fft_bin;
+
+	POLYPHASE_TB(void) {
+		Verilated::traceEverOn(true);
+		m_pfb = new Vpolyphase;
+		m_fft = new Vfftmain;
+		m_trace = NULL;
+		m_tickcount = 0l;
+		m_npfb = 0;
+		m_fft_frame = 0;
+		m_fft_bin = -1;
+	}
+
+	~POLYPHASE_TB(void) {
+		closetrace();
+		delete m_pfb;
+		delete m_fft;
+	}
+
+	void	opentrace(const char *vcdname) {
+		if (!m_trace) {
+			m_trace = new VerilatedVcdC;
+			m_pfb->trace(m_trace, 99);
+			m_trace->open(vcdname);
+		}
+	}
+
+	void	closetrace(void) {
+		if (m_trace) {
+			m_trace->close();
+			delete	m_trace;
+			m_trace = NULL;
+		}
+	}
+
+	void	tick(void) {
+		m_tickcount++;
+
+		// The filter bank feeds the FFT directly
+		m_fft->i_ce     = m_pfb->o_ce;
+		m_fft->i_sample = m_pfb->o_sample;
+
+		m_pfb->i_clk = 0;
+		m_fft->i_clk = 0;
+		m_pfb->eval();
+		m_fft->eval();
+		if (m_trace) m_trace->dump((vluint64_t)(10*m_tickcount-2));
+		m_pfb->i_clk = 1;
+		m_fft->i_clk = 1;
+		m_pfb->eval();
+		m_fft->eval();
+		if (m_trace) m_trace->dump((vluint64_t)(10*m_tickcount));
+		m_pfb->i_clk = 0;
+		m_fft->i_clk = 0;
+		m_pfb->eval();
+		m_fft->eval();
+		if (m_trace) {
+			m_trace->dump((vluint64_t)(10*m_tickcount+5));
+			m_trace->flush();
+		}
+
+		check_pfb();
+		check_fft();
+	}
+
+	void	reset(void) {
+		m_pfb->i_reset = 1;
+		m_fft->i_reset = 1;
+		m_pfb->i_ce = 0;
+		m_pfb->i_sample = 0;
+		tick();
+		tick();
+		m_pfb->i_reset = 0;
+		m_fft->i_reset = 0;
+		tick();
+	}
+
+	// Read the taps the core loaded.  Line n holds the taps for position
+	// n within each of the last NTAPS FFT lengths, oldest in the MSBs
+	void	load_taps(void) {
+		char	fname[64];
+		FILE	*fp;
+
+		sprintf(fname, "polyphase_%dx%d.hex", FFTLEN, NTAPS);
+		fp = fopen(fname, "r");
+		if (NULL == fp) {
+			fprintf(stderr, "ERR: Could not open %s\n", fname);
+			exit(EXIT_FAILURE);
+		}
+
+		for(int n=0; n<FFTLEN; n++) {
+			unsigned long	v;
+
+			if (1 != fscanf(fp, "%lx", &v)) {
+				fprintf(stderr, "ERR: %s is too short\n", fname);
+				exit(EXIT_FAILURE);
+			}
+
+			for(int p=NTAPS-1; p>=0; p--) {
+				m_tap[n][p] = sbits(v, TWIDTH);
+				v >>= TWIDTH;
+			}
+		} fclose(fp);
+	}
+
+	// The filter bank output as sample s is written, at full precision.
+	// This is the sum, across the last NTAPS FFT lengths, of the samples
+	// at the same position times their taps.
+	void	expected(unsigned long s, long &sum_r, long &sum_i) {
+		unsigned long	frame = s / FFTLEN;
+		int		n = (int)(s % FFTLEN);
+
+		sum_r = sum_i = 0;
+		for(int p=0; p<NTAPS; p++) {
+			unsigned long	k = (frame+1-NTAPS+p) * FFTLEN + n;
+
+			sum_r += m_in_r[k] * m_tap[n][p];
+			sum_i += m_in_i[k] * m_tap[n][p];
+		}
+	}
+
+	void	check_pfb(void) {
+		unsigned long	s;
+		long	sum_r, sum_i, r, i;
+
+		if (!m_pfb->o_ce) {
+			if (m_pfb->o_frame) {
+				printf("O_FRAME set without O_CE\n");
+				printf("FAIL\n");
+				exit(EXIT_FAILURE);
+			}
+			return;
+		}
+
+		// No output is produced until NTAPS FFT lengths have been
+		// given, so output m belongs to input m+(NTAPS-1)*FFTLEN
+		s = m_npfb + (NTAPS-1) * FFTLEN;
+		if (s >= m_in_r.size()) {
+			printf("PFB output %ld produced before its sample\n",
+				m_npfb);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		if ((m_pfb->o_frame != 0) != ((m_npfb % FFTLEN) == 0)) {
+			printf("PFB output %ld: O_FRAME is %s\n", m_npfb,
+				(m_pfb->o_frame) ? "set" : "clear");
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		expected(s, sum_r, sum_i);
+		r = sbits(m_pfb->o_sample >> PWIDTH, PWIDTH);
+		i = sbits(m_pfb->o_sample, PWIDTH);
+		if ((r != sbits(rndbits(sum_r, AWIDTH, PWIDTH), PWIDTH))
+			||(i != sbits(rndbits(sum_i, AWIDTH, PWIDTH), PWIDTH))) {
+			printf("PFB output %ld: (%6ld,%6ld) != (%6ld,%6ld)\n",
+				m_npfb, r, i,
+				sbits(rndbits(sum_r, AWIDTH, PWIDTH), PWIDTH),
+				sbits(rndbits(sum_i, AWIDTH, PWIDTH), PWIDTH));
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		m_pfb_out.push_back(ldexp((double)sum_r, PWIDTH-AWIDTH));
+		m_pfb_out.push_back(ldexp((double)sum_i, PWIDTH-AWIDTH));
+		m_npfb++;
+	}
+
+	void	check_fft(void) {
+		double	ref[2*FFTLEN], err;
+
+		// The FFT produces one output for every input
+		if (!m_fft->i_ce)
+			return;
+
+		if (m_fft->o_sync) {
+			if ((m_fft_bin >= 0)&&(m_fft_bin != FFTLEN)) {
+				printf("FFT frame %d ended after %d bins\n",
+					m_fft_frame, m_fft_bin);
+				printf("FAIL\n");
+				exit(EXIT_FAILURE);
+			}
+			m_fft_bin = 0;
+		} else if (m_fft_bin < 0)
+			return;
+		else if (m_fft_bin >= FFTLEN)
+			// Still waiting on the next sync
+			return;
+
+		m_fft_out[2*m_fft_bin  ] = sbits(m_fft->o_result >> OWIDTH,
+							OWIDTH);
+		m_fft_out[2*m_fft_bin+1] = sbits(m_fft->o_result, OWIDTH);
+		m_fft_bin++;
+
+		if (m_fft_bin < FFTLEN)
+			return;
+
+		// Frame m_fft_frame is complete.  Frames leave the FFT in the
+		// order the filter bank produced them.
+		if (m_pfb_out.size() < (unsigned)(m_fft_frame+1)*2*FFTLEN) {
+			printf("FFT frame %d produced before its input\n",
+				m_fft_frame);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		dft(FFTLEN, &m_pfb_out[m_fft_frame*2*FFTLEN], ref);
+		err = dfterr(FFTLEN, ref, m_fft_out);
+		printf("FRAME %3d: RMS error %6.3f\n", m_fft_frame, err);
+		if (err > MAXERR) {
+			printf("FFT frame %d is too far from the DFT\n",
+				m_fft_frame);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		m_fft_frame++;
+	}
+
+	void	test(long r, long i) {
+		m_in_r.push_back(r);
+		m_in_i.push_back(i);
+		m_pfb->i_ce = 1;
+		m_pfb->i_sample = (ubits(r, IWIDTH) << IWIDTH) | ubits(i, IWIDTH);
+		tick();
+		m_pfb->i_ce = 0;
+
+		// Samples needn't arrive every clock
+		for(int k = rand() % 3; k > 0; k--)
+			tick();
+	}
+};
+
+int	main(int argc, char **argv, char **envp) {
+	Verilated::commandArgs(argc, argv);
+	POLYPHASE_TB	*tb = new POLYPHASE_TB;
+	// Keep the FFT from overflowing on random data
+	long	amp = (1l<<(IWIDTH-2));
+
+	// tb->opentrace("polyphase.vcd");
+	tb->load_taps();
+	tb->reset();
+
+	// A tone, followed by random data
+	for(int k=0; k<NTAPS*FFTLEN; k++)
+		tb->test((long)(amp * cos(2.0 * M_PI * 5.25 * k / FFTLEN)),
+			(long)(amp * sin(2.0 * M_PI * 5.25 * k / FFTLEN)));
+	for(int k=0; k<(NFRAMES+2)*FFTLEN; k++)
+		tb->test((rand() % (2*amp)) - amp, (rand() % (2*amp)) - amp);
+
+	if (tb->m_fft_frame < NFRAMES) {
+		printf("Only %d FFT frames were checked\n", tb->m_fft_frame);
+		printf("FAIL\n");
+		exit(EXIT_FAILURE);
+	}
+
+	delete	tb;
+
+	printf("SUCCESS!\n");
+	exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,237 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	prunebrev_tb.cpp
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	A test-bench for an FFT built with -B, keeping only a range
+//		of its output bins, and so for the prunebrev.v within it.
+//	Random frames are given to the FFT, one sample per i_ce at random
+//	intervals.  Each frame out must hold exactly the NBINS bins kept,
+//	marked by o_valid, with o_sync on the first.  These are checked
+//	against the same bins of a double precision DFT of the frame.
+//
+//	The last line output will either read "SUCCESS" on success, or some
+//	other failure message otherwise.  This needs to be run from the
+//	directory holding the core, so that the FFT can find its hex files.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <vector>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "Vfftmain.h"
+#include "twoc.h"
+#include "dft.h"
+
+#include "prunesize.h"
+
+#define	IWIDTH	FFT_IWIDTH
+#define	OWIDTH	FFT_OWIDTH
+#define	LGWIDTH	FFT_LGWIDTH
+#define	FFTLEN	(1<<LGWIDTH)
+
+// The bins kept, as given to fftgen -B by sw/Makefile
+#define	FIRST	20
+#define	NBINS	12
+
+#define	NFRAMES	16
+// The largest RMS error allowed, in FFT output LSBs
+#define	MAXERR	2.0
+
+class	PRUNEBREV_TB {
+public:
+	Vfftmain	*m_fft;
+	VerilatedVcdC	*m_trace;
+	unsigned long	m_tickcount;
+	std::vector<double>	m_in;
+	double		m_out[2*NBINS];
+	int		m_frame, m_bin;
+
+	PRUNEBREV_TB(void) {
+		Verilated::traceEverOn(true);
+		m_fft = new Vfftmain;
+		m_trace = NULL;
+		m_tickcount = 0l;
+		m_frame = 0;
+		m_bin   = -1;
+	}
+
+	~PRUNEBREV_TB(void) {
+		closetrace();
+		delete m_fft;
+	}
+
+	void	opentrace(const char *vcdname) {
+		if (!m_trace) {
+			m_trace = new VerilatedVcdC;
+			m_fft->trace(m_trace, 99);
+			m_trace->open(vcdname);
+		}
+	}
+
+	void	closetrace(void) {
+		if (m_trace) {
+			m_trace->close();
+			delete	m_trace;
+			m_trace = NULL;
+		}
+	}
+
+	void	tick(void) {
+		m_tickcount++;
+
+		m_fft->i_clk = 0;
+		m_fft->eval();
+		if (m_trace) m_trace->dump((vluint64_t)(10*m_tickcount-2));
+		m_fft->i_clk = 1;
+		m_fft->eval();
+		if (m_trace) m_trace->dump((vluint64_t)(10*m_tickcount));
+		m_fft->i_clk = 0;
+		m_fft->eval();
+		if (m_trace) {
+			m_trace->dump((vluint64_t)(10*m_tickcount+5));
+			m_trace->flush();
+		}
+
+		check();
+	}
+
+	void	reset(void) {
+		m_fft->i_reset = 1;
+		m_fft->i_ce = 0;
+		m_fft->i_sample = 0;
+		tick();
+		tick();
+		m_fft->i_reset = 0;
+		tick();
+	}
+
+	void	check(void) {
+		double	ref[2*FFTLEN], err;
+
+		// Outputs are read on i_ce, as with any FFT
+		if (!m_fft->i_ce)
+			return;
+
+		if (!m_fft->o_valid) {
+			if (m_fft->o_sync) {
+				printf("O_SYNC set without O_VALID\n");
+				printf("FAIL\n");
+				exit(EXIT_FAILURE);
+			} else if ((m_bin > 0)&&(m_bin < NBINS)) {
+				printf("FRAME %d ended after %d bins\n",
+					m_frame, m_bin);
+				printf("FAIL\n");
+				exit(EXIT_FAILURE);
+			} return;
+		}
+
+		if (m_fft->o_sync)
+			m_bin = 0;
+		else if (m_bin < 0) {
+			printf("O_VALID set before the first O_SYNC\n");
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		} else if (m_bin >= NBINS) {
+			printf("FRAME %d runs past %d bins\n", m_frame, NBINS);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		m_out[2*m_bin  ] = sbits(m_fft->o_result >> OWIDTH, OWIDTH);
+		m_out[2*m_bin+1] = sbits(m_fft->o_result, OWIDTH);
+		m_bin++;
+
+		if (m_bin < NBINS)
+			return;
+
+		if (m_in.size() < (unsigned)(m_frame+1)*2*FFTLEN) {
+			printf("FRAME %d produced before its input\n", m_frame);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		dft(FFTLEN, &m_in[m_frame*2*FFTLEN], ref);
+		err = dfterr(NBINS, &ref[2*FIRST], m_out);
+		printf("FRAME %3d: RMS error %6.3f\n", m_frame, err);
+		if (err > MAXERR) {
+			printf("FRAME %d is too far from the DFT\n", m_frame);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		m_frame++;
+	}
+
+	void	test(long r, long i) {
+		m_in.push_back(r);
+		m_in.push_back(i);
+		m_fft->i_ce = 1;
+		m_fft->i_sample = (ubits(r, IWIDTH) << IWIDTH) | ubits(i, IWIDTH);
+		tick();
+		m_fft->i_ce = 0;
+
+		// Samples needn't arrive every clock
+		for(int k = rand() % 3; k > 0; k--)
+			tick();
+	}
+};
+
+int	main(int argc, char **argv, char **envp) {
+	Verilated::commandArgs(argc, argv);
+	PRUNEBREV_TB	*tb = new PRUNEBREV_TB;
+	// Keep the FFT from overflowing on random frames
+	long	amp = (1l<<(IWIDTH-2));
+
+	// tb->opentrace("prunebrev.vcd");
+	tb->reset();
+
+	// The FFT is a couple of frames behind its input
+	for(int f=0; f<NFRAMES+3; f++) {
+		for(int k=0; k<FFTLEN; k++)
+			tb->test((rand() % (2*amp)) - amp,
+				(rand() % (2*amp)) - amp);
+	}
+
+	if (tb->m_frame < NFRAMES) {
+		printf("Only %d frames were checked\n", tb->m_frame);
+		printf("FAIL\n");
+		exit(EXIT_FAILURE);
+	}
+
+	delete	tb;
+
+	printf("SUCCESS!\n");
+	exit(EXIT_SUCCESS);
+}
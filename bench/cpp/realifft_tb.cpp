@@ -0,0 +1,249 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	realifft_tb.cpp
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	A test-bench for realifft.v, the real output inverse FFT
+//		fftgen builds with -r -i, and so for the hermitian.v within it.
+//	Random Hermitian symmetric spectra are given to the core, one bin per
+//	i_ce at random intervals, and every frame of real outputs is checked
+//	against a double precision inverse DFT of the whole spectrum.
+//
+//	The last line output will either read "SUCCESS" on success, or some
+//	other failure message otherwise.  This needs to be run from the
+//	directory holding the core, so that the core can find its hex files.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <vector>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "Vrealifft.h"
+#include "twoc.h"
+#include "dft.h"
+
+#include "rifftsize.h"
+
+// The header describes the N/2 point inverse FFT within realifft.v, whose
+// input is one bit wider than that of realifft.v itself
+#define	IWIDTH	(IFFT_IWIDTH-1)
+#define	OWIDTH	IFFT_OWIDTH
+#define	LGWIDTH	(IFFT_LGWIDTH+1)
+#define	FFTLEN	(1<<LGWIDTH)
+
+#define	NFRAMES	16
+// The largest RMS error allowed, in output LSBs
+#define	MAXERR	2.0
+
+class	REALIFFT_TB {
+public:
+	Vrealifft	*m_ifft;
+	VerilatedVcdC	*m_trace;
+	unsigned long	m_tickcount;
+	// Each full spectrum given to the core, all FFTLEN bins of it
+	std::vector<double>	m_spectrum;
+	double		m_out[2*FFTLEN];
+	int		m_frame, m_pair;
+
+	REALIFFT_TB(void) {
+		Verilated::traceEverOn(true);
+		m_ifft = new Vrealifft;
+		m_trace = NULL;
+		m_tickcount = 0l;
+		m_frame = 0;
+		m_pair  = -1;
+	}
+
+	~REALIFFT_TB(void) {
+		closetrace();
+		delete m_ifft;
+	}
+
+	void	opentrace(const char *vcdname) {
+		if (!m_trace) {
+			m_trace = new VerilatedVcdC;
+			m_ifft->trace(m_trace, 99);
+			m_trace->open(vcdname);
+		}
+	}
+
+	void	closetrace(void) {
+		if (m_trace) {
+			m_trace->close();
+			delete	m_trace;
+			m_trace = NULL;
+		}
+	}
+
+	void	tick(void) {
+		m_tickcount++;
+
+		m_ifft->i_clk = 0;
+		m_ifft->eval();
+		if (m_trace) m_trace->dump((vluint64_t)(10*m_tickcount-2));
+		m_ifft->i_clk = 1;
+		m_ifft->eval();
+		if (m_trace) m_trace->dump((vluint64_t)(10*m_tickcount));
+		m_ifft->i_clk = 0;
+		m_ifft->eval();
+		if (m_trace) {
+			m_trace->dump((vluint64_t)(10*m_tickcount+5));
+			m_trace->flush();
+		}
+
+		check();
+	}
+
+	void	reset(void) {
+		m_ifft->i_reset = 1;
+		m_ifft->i_ce = 0;
+		m_ifft->i_sample = 0;
+		tick();
+		tick();
+		m_ifft->i_reset = 0;
+		tick();
+	}
+
+	void	check(void) {
+		double	ref[2*FFTLEN], err;
+
+		// Like the FFT, this produces one output pair per i_ce
+		if (!m_ifft->i_ce)
+			return;
+
+		if (m_ifft->o_sync) {
+			if ((m_pair >= 0)&&(m_pair != FFTLEN/2)) {
+				printf("FRAME %d ended after %d pairs\n",
+					m_frame, m_pair);
+				printf("FAIL\n");
+				exit(EXIT_FAILURE);
+			}
+			m_pair = 0;
+		} else if ((m_pair < 0)||(m_pair >= FFTLEN/2))
+			return;
+
+		// The outputs are real, x[2m] and x[2m+1]
+		m_out[4*m_pair  ] = sbits(m_ifft->o_even, OWIDTH);
+		m_out[4*m_pair+1] = 0.0;
+		m_out[4*m_pair+2] = sbits(m_ifft->o_odd, OWIDTH);
+		m_out[4*m_pair+3] = 0.0;
+		m_pair++;
+
+		if (m_pair < FFTLEN/2)
+			return;
+
+		if (m_spectrum.size() < (unsigned)(m_frame+1)*2*FFTLEN) {
+			printf("FRAME %d produced before its input\n", m_frame);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		dft(FFTLEN, &m_spectrum[m_frame*2*FFTLEN], ref, true);
+		err = dfterr(FFTLEN, ref, m_out);
+		printf("FRAME %3d: RMS error %6.3f\n", m_frame, err);
+		if (err > MAXERR) {
+			printf("FRAME %d is too far from the inverse DFT\n",
+				m_frame);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		m_frame++;
+	}
+
+	void	test(long r, long i) {
+		m_ifft->i_ce = 1;
+		m_ifft->i_sample = (ubits(r, IWIDTH) << IWIDTH) | ubits(i, IWIDTH);
+		tick();
+		m_ifft->i_ce = 0;
+
+		// Bins needn't arrive every clock
+		for(int k = rand() % 3; k > 0; k--)
+			tick();
+	}
+
+	// One random spectrum.  Only bins 0 through N/2-1 are given to the
+	// core, with bin N/2 in the imaginary part of bin 0, but the inverse
+	// DFT it's checked against needs every bin.
+	void	frame(long amp) {
+		long	r[FFTLEN/2], i[FFTLEN/2];
+		double	spec[2*FFTLEN];
+
+		for(int k=0; k<FFTLEN/2; k++) {
+			r[k] = (rand() % (2*amp)) - amp;
+			i[k] = (rand() % (2*amp)) - amp;
+		}
+
+		spec[0] = r[0];
+		spec[1] = 0.0;
+		spec[FFTLEN  ] = i[0];
+		spec[FFTLEN+1] = 0.0;
+		for(int k=1; k<FFTLEN/2; k++) {
+			spec[2*k  ] = r[k];
+			spec[2*k+1] = i[k];
+			spec[2*(FFTLEN-k)  ] =  r[k];
+			spec[2*(FFTLEN-k)+1] = -i[k];
+		}
+
+		for(int k=0; k<2*FFTLEN; k++)
+			m_spectrum.push_back(spec[k]);
+		for(int k=0; k<FFTLEN/2; k++)
+			test(r[k], i[k]);
+	}
+};
+
+int	main(int argc, char **argv, char **envp) {
+	Verilated::commandArgs(argc, argv);
+	REALIFFT_TB	*tb = new REALIFFT_TB;
+	// Keep the inverse FFT from overflowing on random spectra
+	long	amp = (1l<<(IWIDTH-3));
+
+	// tb->opentrace("realifft.vcd");
+	tb->reset();
+
+	// hermitian.v holds a frame, and the inverse FFT a couple more
+	for(int k=0; k<NFRAMES+4; k++)
+		tb->frame(amp);
+
+	if (tb->m_frame < NFRAMES) {
+		printf("Only %d frames were checked\n", tb->m_frame);
+		printf("FAIL\n");
+		exit(EXIT_FAILURE);
+	}
+
+	delete	tb;
+
+	printf("SUCCESS!\n");
+	exit(EXIT_SUCCESS);
+}
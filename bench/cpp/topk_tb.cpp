@@ -0,0 +1,355 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	topk_tb.cpp
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	A test-bench for topk.v, the back end fftgen builds with -K,
+//		together with the FFT feeding it.  Each frame given to the
+//	FFT holds K tones, of differing strengths and at random bins, plus a
+//	little noise.  The FFT's output is checked against a double precision
+//	DFT of its input, and the bins topk.v finds are checked against the K
+//	strongest bins of that DFT, strongest first.  The power reported for
+//	each of these bins must also match the power in the FFT's output
+//	exactly.
+//
+//	The last line output will either read "SUCCESS" on success, or some
+//	other failure message otherwise.  This needs to be run from the
+//	directory holding the core, so that the FFT can find its hex files.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <vector>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "Vfftmain.h"
+#include "Vtopk.h"
+#include "twoc.h"
+#include "dft.h"
+
+#include "topksize.h"
+
+#define	IWIDTH	FFT_IWIDTH
+#define	OWIDTH	FFT_OWIDTH
+#define	LGWIDTH	FFT_LGWIDTH
+#define	FFTLEN	(1<<LGWIDTH)
+
+// The number of bins found in each frame, as given to fftgen -K by
+// sw/Makefile
+#define	NTOPK	4
+
+#define	NFRAMES	16
+// The largest RMS error allowed, in FFT output LSBs
+#define	MAXERR	2.0
+
+class	TOPK_TB {
+public:
+	Vfftmain	*m_fft;
+	Vtopk		*m_topk;
+	VerilatedVcdC	*m_trace;
+	unsigned long	m_tickcount;
+	// The input to the FFT, and the K strongest bins of each frame,
+	// according to the DFT
+	std::vector<double>	m_in;
+	std::vector<int>	m_expected;
+	// The power in every bin of every frame out of the FFT
+	std::vector<unsigned long>	m_power;
+	double		m_fft_out[2*FFTLEN];
+	int		m_fft_frame, m_fft_bin, m_topk_frame, m_topk_n;
+
+	TOPK_TB(void) {
+		Verilated::traceEverOn(true);
+		m_fft  = new Vfftmain;
+		m_topk = new Vtopk;
+		m_trace = NULL;
+		m_tickcount = 0l;
+		m_fft_frame = 0;
+		m_fft_bin   = -1;
+		m_topk_frame = -1;
+		m_topk_n = NTOPK;
+	}
+
+	~TOPK_TB(void) {
+		closetrace();
+		delete m_fft;
+		delete m_topk;
+	}
+
+	void	opentrace(const char *vcdname) {
+		if (!m_trace) {
+			m_trace = new VerilatedVcdC;
+			m_topk->trace(m_trace, 99);
+			m_trace->open(vcdname);
+		}
+	}
+
+	void	closetrace(void) {
+		if (m_trace) {
+			m_trace->close();
+			delete	m_trace;
+			m_trace = NULL;
+		}
+	}
+
+	void	tick(void) {
+		m_tickcount++;
+
+		// topk.v shares the FFT's i_ce, and takes in the FFT's outputs
+		m_topk->i_ce     = m_fft->i_ce;
+		m_topk->i_sample = m_fft->o_result;
+		m_topk->i_sync   = m_fft->o_sync;
+
+		m_fft->i_clk  = 0;
+		m_topk->i_clk = 0;
+		m_fft->eval();
+		m_topk->eval();
+		if (m_trace) m_trace->dump((vluint64_t)(10*m_tickcount-2));
+		m_fft->i_clk  = 1;
+		m_topk->i_clk = 1;
+		m_fft->eval();
+		m_topk->eval();
+		if (m_trace) m_trace->dump((vluint64_t)(10*m_tickcount));
+		m_fft->i_clk  = 0;
+		m_topk->i_clk = 0;
+		m_fft->eval();
+		m_topk->eval();
+		if (m_trace) {
+			m_trace->dump((vluint64_t)(10*m_tickcount+5));
+			m_trace->flush();
+		}
+
+		check_fft();
+		check_topk();
+	}
+
+	void	reset(void) {
+		m_fft->i_reset  = 1;
+		m_topk->i_reset = 1;
+		m_fft->i_ce = 0;
+		m_fft->i_sample = 0;
+		tick();
+		tick();
+		m_fft->i_reset  = 0;
+		m_topk->i_reset = 0;
+		tick();
+	}
+
+	void	check_fft(void) {
+		double	ref[2*FFTLEN], err;
+
+		// The FFT produces one output for every input
+		if (!m_fft->i_ce)
+			return;
+
+		if (m_fft->o_sync) {
+			if ((m_fft_bin >= 0)&&(m_fft_bin != FFTLEN)) {
+				printf("FFT frame %d ended after %d bins\n",
+					m_fft_frame, m_fft_bin);
+				printf("FAIL\n");
+				exit(EXIT_FAILURE);
+			}
+			m_fft_bin = 0;
+		} else if ((m_fft_bin < 0)||(m_fft_bin >= FFTLEN))
+			return;
+
+		long	r = sbits(m_fft->o_result >> OWIDTH, OWIDTH),
+			i = sbits(m_fft->o_result, OWIDTH);
+		m_fft_out[2*m_fft_bin  ] = r;
+		m_fft_out[2*m_fft_bin+1] = i;
+		m_power.push_back((unsigned long)(r*r + i*i));
+		m_fft_bin++;
+
+		if (m_fft_bin < FFTLEN)
+			return;
+
+		if (m_in.size() < (unsigned)(m_fft_frame+1)*2*FFTLEN) {
+			printf("FFT frame %d produced before its input\n",
+				m_fft_frame);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		dft(FFTLEN, &m_in[m_fft_frame*2*FFTLEN], ref);
+		err = dfterr(FFTLEN, ref, m_fft_out);
+		if (err > MAXERR) {
+			printf("FFT frame %d is too far from the DFT, "
+				"RMS error = %.3f\n", m_fft_frame, err);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		m_fft_frame++;
+	}
+
+	void	check_topk(void) {
+		int		bin, xbin;
+		unsigned long	power, xpower;
+
+		if (!m_topk->o_ce) {
+			if (m_topk->o_sync) {
+				printf("TOPK: O_SYNC set without O_CE\n");
+				printf("FAIL\n");
+				exit(EXIT_FAILURE);
+			}
+			return;
+		}
+
+		if (m_topk->o_sync) {
+			if (m_topk_n != NTOPK) {
+				printf("TOPK frame %d produced %d bins\n",
+					m_topk_frame, m_topk_n);
+				printf("FAIL\n");
+				exit(EXIT_FAILURE);
+			}
+			m_topk_frame++;
+			m_topk_n = 0;
+		} else if (m_topk_n >= NTOPK) {
+			printf("TOPK frame %d produced more than %d bins\n",
+				m_topk_frame, NTOPK);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		// Each list follows the last bin of its frame into topk.v
+		if (m_topk_frame >= m_fft_frame) {
+			printf("TOPK frame %d produced before its FFT frame\n",
+				m_topk_frame);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		bin   = m_topk->o_bin;
+		power = (unsigned long)m_topk->o_power;
+		xbin  = m_expected[m_topk_frame*NTOPK + m_topk_n];
+		xpower= m_power[m_topk_frame*FFTLEN + bin];
+		if ((bin != xbin)||(power != xpower)) {
+			printf("TOPK frame %d, #%d: bin %2d, power %9ld, "
+				"rather than bin %2d\n", m_topk_frame, m_topk_n,
+				bin, power, xbin);
+			if (power != xpower)
+				printf("\tThe FFT produced a power of %ld "
+					"in bin %d\n", xpower, bin);
+			printf("FAIL\n");
+			exit(EXIT_FAILURE);
+		}
+
+		m_topk_n++;
+	}
+
+	// One frame of K tones, at random bins and decreasing strength, plus
+	// a little noise.  The strengths are far enough apart for the order
+	// of the K strongest DFT bins to be unambiguous.
+	void	frame(void) {
+		const	double	amp = (1l<<(IWIDTH-1)) / (3.0 * NTOPK);
+		int	bins[NTOPK];
+		double	in[2*FFTLEN], ref[2*FFTLEN], pwr[FFTLEN];
+
+		for(int j=0; j<NTOPK; j++) {
+			bool	dup;
+			do {
+				bins[j] = rand() % FFTLEN;
+				dup = false;
+				for(int m=0; m<j; m++)
+					dup = (dup)||(bins[m] == bins[j]);
+			} while(dup);
+		}
+
+		for(int k=0; k<FFTLEN; k++) {
+			double	r = (rand() % 33) - 16,
+				i = (rand() % 33) - 16;
+
+			for(int j=0; j<NTOPK; j++) {
+				double	a = amp * (1.0 - 0.15 * j),
+					ph = 2.0 * M_PI * bins[j] * k / FFTLEN;
+				r += a * cos(ph);
+				i += a * sin(ph);
+			}
+
+			in[2*k  ] = (double)(long)r;
+			in[2*k+1] = (double)(long)i;
+		}
+
+		// The K strongest bins of the DFT, strongest first
+		dft(FFTLEN, in, ref);
+		for(int k=0; k<FFTLEN; k++)
+			pwr[k] = ref[2*k]*ref[2*k] + ref[2*k+1]*ref[2*k+1];
+		for(int j=0; j<NTOPK; j++) {
+			int	mx = 0;
+			for(int k=1; k<FFTLEN; k++)
+				if (pwr[k] > pwr[mx])
+					mx = k;
+			m_expected.push_back(mx);
+			pwr[mx] = -1.0;
+		}
+
+		for(int k=0; k<FFTLEN; k++)
+			test((long)in[2*k], (long)in[2*k+1]);
+	}
+
+	void	test(long r, long i) {
+		m_in.push_back(r);
+		m_in.push_back(i);
+		m_fft->i_ce = 1;
+		m_fft->i_sample = (ubits(r, IWIDTH) << IWIDTH) | ubits(i, IWIDTH);
+		tick();
+		m_fft->i_ce = 0;
+
+		// Samples needn't arrive every clock
+		for(int k = rand() % 3; k > 0; k--)
+			tick();
+	}
+};
+
+int	main(int argc, char **argv, char **envp) {
+	Verilated::commandArgs(argc, argv);
+	TOPK_TB	*tb = new TOPK_TB;
+
+	// tb->opentrace("topk.vcd");
+	tb->reset();
+
+	// Each list is produced once the next frame is under way, and the
+	// FFT itself is a couple of frames behind
+	for(int k=0; k<NFRAMES+4; k++)
+		tb->frame();
+
+	if (tb->m_topk_frame+1 < NFRAMES) {
+		printf("Only %d lists were checked\n", tb->m_topk_frame+1);
+		printf("FAIL\n");
+		exit(EXIT_FAILURE);
+	}
+
+	delete	tb;
+
+	printf("SUCCESS!\n");
+	exit(EXIT_SUCCESS);
+}
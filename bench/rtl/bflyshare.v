@@ -0,0 +1,95 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	bflyshare.v
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Two hardware butterflies sharing one multiply, as fftgen
+//		builds adjacent FFT stages with eight or more clocks per CE.
+//	This is only a test bench, for bflyshare_tb.cpp in bench/cpp, so that
+//	both the external multiply path of hwbfly.v and mpyshare.v may be
+//	tested together.  The B butterfly is a bit wider than the A butterfly,
+//	as the later of two FFT stages would be, so that mpyshare must also
+//	sign extend the narrower of its two sets of operands.
+//
+//	hwbfly.v and mpyshare.v come from a core built with -k 8, by
+//	"make bflyshare" in sw/.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+`default_nettype	none
+//
+module	bflyshare(i_clk, i_reset, i_ce,
+		i_coef_a, i_left_a, i_right_a, i_aux_a,
+			o_left_a, o_right_a, o_aux_a,
+		i_coef_b, i_left_b, i_right_b, i_aux_b,
+			o_left_b, o_right_b, o_aux_b);
+	parameter	IWIDTH=16, CWIDTH=20, OWIDTH=17, CKPCE=8;
+	// The B butterfly takes one more bit in, and gives one more out
+	localparam	BIW = IWIDTH+1, BOW = OWIDTH+1;
+	//
+	input	wire			i_clk, i_reset, i_ce;
+	//
+	input	wire	[(2*CWIDTH-1):0]	i_coef_a;
+	input	wire	[(2*IWIDTH-1):0]	i_left_a, i_right_a;
+	input	wire				i_aux_a;
+	output	wire	[(2*OWIDTH-1):0]	o_left_a, o_right_a;
+	output	wire				o_aux_a;
+	//
+	input	wire	[(2*CWIDTH-1):0]	i_coef_b;
+	input	wire	[(2*BIW-1):0]		i_left_b, i_right_b;
+	input	wire				i_aux_b;
+	output	wire	[(2*BOW-1):0]		o_left_b, o_right_b;
+	output	wire				o_aux_b;
+
+	wire	[3*(CWIDTH+1)-1:0]		w_mpy_ac, w_mpy_bc;
+	wire	[3*(IWIDTH+2)-1:0]		w_mpy_ad;
+	wire	[3*(BIW+2)-1:0]			w_mpy_bd;
+	wire	[3*(CWIDTH+IWIDTH+3)-1:0]	w_mpy_ap;
+	wire	[3*(CWIDTH+BIW+3)-1:0]		w_mpy_bp;
+
+	hwbfly	#(.IWIDTH(IWIDTH),.CWIDTH(CWIDTH),.OWIDTH(OWIDTH),
+			.SHIFT(0),.CKPCE(CKPCE))
+		bfly_a(i_clk, i_reset, i_ce, i_coef_a, i_left_a, i_right_a,
+			i_aux_a, o_left_a, o_right_a, o_aux_a,
+			w_mpy_ac, w_mpy_ad, w_mpy_ap);
+
+	hwbfly	#(.IWIDTH(BIW),.CWIDTH(CWIDTH),.OWIDTH(BOW),
+			.SHIFT(0),.CKPCE(CKPCE))
+		bfly_b(i_clk, i_reset, i_ce, i_coef_b, i_left_b, i_right_b,
+			i_aux_b, o_left_b, o_right_b, o_aux_b,
+			w_mpy_bc, w_mpy_bd, w_mpy_bp);
+
+	mpyshare	#(CWIDTH+1, IWIDTH+2, CWIDTH+1, BIW+2)
+		mpy(i_clk, i_reset, i_ce,
+			w_mpy_ac, w_mpy_ad, w_mpy_ap,
+			w_mpy_bc, w_mpy_bd, w_mpy_bp);
+
+endmodule
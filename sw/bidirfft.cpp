@@ -0,0 +1,215 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	bidirfft.cpp
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Generates bidirfft.v, a forward FFT whose direction may be
+//		switched at run time, frame by frame.  Rather than carrying
+//	the direction through every stage, inverse frames are conjugated on
+//	their way into and out of the forward FFT, since
+//
+//	IFFT(x) = conj(FFT(conj(x)))
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+#define _CRT_SECURE_NO_WARNINGS   //  ms vs 2012 doesn't like fopen
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _MSC_VER //  added for ms vs compatibility
+
+#include <io.h>
+#include <direct.h>
+#define _USE_MATH_DEFINES
+#else
+// And for G++/Linux environment
+
+#include <unistd.h>	// Defines the R_OK/W_OK/etc. macros
+#include <sys/stat.h>
+#endif
+
+#include <string.h>
+#include <string>
+#include <math.h>
+#include <ctype.h>
+#include <assert.h>
+
+#include "defaults.h"
+#include "legal.h"
+#include "fftlib.h"
+
+#include "bidirfft.h"
+
+void	build_bidirfft(const char *fname, int lgsize, int iw, int ow,
+		const bool async_reset) {
+	FILE	*fp = fopen(fname, "w");
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return;
+	}
+
+	std::string	resetw("i_reset"), always_reset;
+	if (async_reset) {
+		resetw = std::string("i_areset_n");
+		always_reset = std::string("\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	} else
+		always_reset = std::string("\talways @(posedge i_clk)\n\tif (i_reset)\n");
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\tbidirfft.v\n"
+"//\n"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:\tA %d point FFT whose direction is chosen, frame by frame,\n"
+"//		at run time.  The direction is sampled from i_inverse with\n"
+"//	the first sample of every frame, and held for the rest of it.\n"
+"//	Inverse frames are computed by the forward fftmain within, as\n"
+"//\n"
+"//	IFFT(x) = conj(FFT(conj(x)))\n"
+"//\n"
+"//	so one core, with one set of twiddle factor ROMs, serves both\n"
+"//	directions.  As with ifftmain, the inverse is not scaled by 1/N.\n"
+"//\n"
+"//	A small FIFO carries the direction of each frame in flight from\n"
+"//	the input to the output, where o_inverse reports it alongside\n"
+"//	o_sync.  Since the imaginary parts are negated, the most negative\n"
+"//	value on either side saturates to the most positive one.\n"
+"//\n%s"
+"//\n", prjname, 1<<lgsize, creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+
+	fprintf(fp,
+"module\tbidirfft(i_clk, %s, i_ce, i_inverse, i_sample,\n"
+		"\t\to_result, o_sync, o_inverse);\n"
+	"\tlocalparam\tIW=%d, OW=%d, LGSIZE=%d, LGFIFO=4;\n"
+	"\t//\n"
+	"\tinput\twire\t\t\ti_clk, %s, i_ce, i_inverse;\n"
+	"\tinput\twire\t[(2*IW-1):0]\ti_sample;\n"
+	"\toutput\treg\t[(2*OW-1):0]\to_result;\n"
+	"\toutput\treg\t\t\to_sync, o_inverse;\n"
+"\n"
+	"\t//\n"
+	"\t// Conjugate the input of inverse frames\n"
+	"\t//\n"
+	"\treg\t[(LGSIZE-1):0]\ticnt;\n"
+	"\treg\t\t\tr_ininv;\n"
+	"\twire\t\t\tw_ininv;\n"
+	"\twire\tsigned\t[(IW-1):0]\tx_r, x_i, nx_i;\n"
+	"\twire\t[(2*IW-1):0]\tw_sample;\n"
+"\n"
+	"\tinitial\ticnt = 0;\n"
+	"%s"
+	"\t\ticnt <= 0;\n"
+	"\telse if (i_ce)\n"
+	"\t\ticnt <= icnt + 1'b1;\n"
+"\n"
+	"\tassign\tw_ininv = (icnt == 0) ? i_inverse : r_ininv;\n"
+"\n"
+	"\tinitial\tr_ininv = 1'b0;\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\t\tr_ininv <= w_ininv;\n"
+"\n"
+	"\tassign\tx_r  = i_sample[(2*IW-1):IW];\n"
+	"\tassign\tx_i  = i_sample[(IW-1):0];\n"
+	"\tassign\tnx_i = (x_i == { 1'b1, {(IW-1){1'b0}} })\n"
+	"\t\t\t? { 1'b0, {(IW-1){1'b1}} } : -x_i;\n"
+	"\tassign\tw_sample = (w_ininv) ? { x_r, nx_i } : i_sample;\n"
+"\n"
+	"\t//\n"
+	"\t// The forward FFT\n"
+	"\t//\n"
+	"\twire\t[(2*OW-1):0]\tw_result;\n"
+	"\twire\t\t\tw_sync;\n"
+"\n"
+	"\tfftmain\tfft(i_clk, %s, i_ce, w_sample, w_result, w_sync);\n"
+"\n"
+	"\t//\n"
+	"\t// Carry each frame\'s direction across the FFT\'s latency\n"
+	"\t//\n"
+	"\treg\t\t\tdirmem\t[0:((1<<LGFIFO)-1)];\n"
+	"\treg\t[(LGFIFO-1):0]\twr_addr, rd_addr;\n"
+	"\treg\t\t\tr_outinv;\n"
+	"\twire\t\t\tw_outinv;\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif ((i_ce)&&(icnt == 0))\n"
+	"\t\tdirmem[wr_addr] <= i_inverse;\n"
+"\n"
+	"\tinitial\t{ wr_addr, rd_addr } = 0;\n"
+	"%s"
+	"\t\t{ wr_addr, rd_addr } <= 0;\n"
+	"\telse if (i_ce)\n"
+	"\tbegin\n"
+	"\t\tif (icnt == 0)\n"
+	"\t\t\twr_addr <= wr_addr + 1'b1;\n"
+	"\t\tif (w_sync)\n"
+	"\t\t\trd_addr <= rd_addr + 1'b1;\n"
+	"\tend\n"
+"\n"
+	"\tassign\tw_outinv = (w_sync) ? dirmem[rd_addr] : r_outinv;\n"
+"\n"
+	"\tinitial\tr_outinv = 1'b0;\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\t\tr_outinv <= w_outinv;\n"
+"\n"
+	"\t//\n"
+	"\t// Conjugate the output of inverse frames\n"
+	"\t//\n"
+	"\twire\tsigned\t[(OW-1):0]\ty_r, y_i, ny_i;\n"
+"\n"
+	"\tassign\ty_r  = w_result[(2*OW-1):OW];\n"
+	"\tassign\ty_i  = w_result[(OW-1):0];\n"
+	"\tassign\tny_i = (y_i == { 1'b1, {(OW-1){1'b0}} })\n"
+	"\t\t\t? { 1'b0, {(OW-1){1'b1}} } : -y_i;\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\t\to_result <= (w_outinv) ? { y_r, ny_i } : w_result;\n"
+"\n"
+	"\tinitial\t{ o_sync, o_inverse } = 2'b00;\n"
+	"%s"
+	"\t\t{ o_sync, o_inverse } <= 2'b00;\n"
+	"\telse if (i_ce)\n"
+	"\t\t{ o_sync, o_inverse } <= { w_sync, w_outinv };\n"
+"\n"
+"endmodule\n",
+		resetw.c_str(), iw, ow, lgsize, resetw.c_str(),
+		always_reset.c_str(), resetw.c_str(),
+		always_reset.c_str(), always_reset.c_str());
+
+	fclose(fp);
+}
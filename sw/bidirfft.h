@@ -0,0 +1,44 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	bidirfft.h
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Generates a wrapper around a forward FFT, allowing the
+//		direction of each frame to be chosen at run time.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+#ifndef	BIDIRFFT_H
+#define	BIDIRFFT_H
+
+extern	void	build_bidirfft(const char *fname, int lgsize, int iw, int ow,
+			const bool async_reset = false);
+
+#endif	// BIDIRFFT_H
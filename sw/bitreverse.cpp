@@ -61,7 +61,8 @@
 #include "legal.h"
 #include "bitreverse.h"
 
-void	build_snglbrev(const char *fname, const bool async_reset) {
+void	build_snglbrev(const char *fname, const bool async_reset,
+		const bool mirror, const bool pairs) {
 	FILE	*fp = fopen(fname, "w");
 	if (NULL == fp) {
 		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
@@ -91,19 +92,36 @@ SLASHLINE
 "//	straightforward bitreverse, rather than one written to handle two\n"
 "//	words at once.\n"
 "//\n"
+"%s"
 "//\n%s"
-"//\n", modulename, prjname, creator);
+"//\n", modulename, prjname,
+	(mirror) ? "//	Alongside each bin k, o_mirror produces bin N-k (bin 0 with bin\n"
+		"//	0) from the same memory, as needed to recover the spectrum of\n"
+		"//	a real sequence packed into a complex FFT of half its length,\n"
+		"//	for the DCT-II.  This takes a second read\n"
+		"//	port on brmem.  Block RAMs rarely offer two read ports next\n"
+		"//	to a write port, so expect synthesis to duplicate brmem--as\n"
+		"//	much memory as buffering a second frame would cost.\n"
+		"//\n"
+	: (pairs) ? "//	Rather than in natural order, bins are read out in pairs, k and\n"
+		"//	N-k on alternate clocks: 0, 1, N-1, 2, N-2, ..., N/2-1, N/2+1,\n"
+		"//	and last N/2.  This lets the two real channels sharing one\n"
+		"//	complex FFT be separated, in dualreal.v, from the one read port.\n"
+		"//\n" : "", creator);
 	fprintf(fp, "%s", cpyleft);
 	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
 	fprintf(fp,
-"module	%s(i_clk, %s, i_ce, i_in, o_out, o_sync);\n"
+"module	%s(i_clk, %s, i_ce, i_in, o_out, o_sync%s);\n"
 	"\tparameter\t\t\tLGSIZE=%d, WIDTH=24;\n"
 	"\tinput\twire\t\t\ti_clk, %s, i_ce;\n"
 	"\tinput\twire\t[(2*WIDTH-1):0]\ti_in;\n"
 	"\toutput\treg\t[(2*WIDTH-1):0]\to_out;\n"
 	"\toutput\treg\t\t\to_sync;\n", modulename, resetw.c_str(),
+		(mirror) ? ", o_mirror" : "",
 		TST_DBLREVERSE_LGSIZE,
 		resetw.c_str());
+	if (mirror)
+		fprintf(fp, "\toutput\treg\t[(2*WIDTH-1):0]\to_mirror;\n");
 
 	fprintf(fp,
 "	reg	[(LGSIZE):0]	wraddr;\n"
@@ -111,12 +129,43 @@ SLASHLINE
 "\n"
 "	reg	[(2*WIDTH-1):0]	brmem	[0:((1<<(LGSIZE+1))-1)];\n"
 "\n"
-"	genvar	k;\n"
+"	genvar	k;\n");
+
+	if (pairs)
+		fprintf(fp,
+"	// Read n of each frame is of bin (n+1)/2 for odd n, and of bin\n"
+"	// -n/2 (mod N) for even n\n"
+"	wire	[(LGSIZE-1):0]	rdbin;\n"
+"\n"
+"	assign	rdbin = (wraddr[0]) ? ({ 1'b0, wraddr[(LGSIZE-1):1] } + 1)\n"
+"				: (-{ 1'b0, wraddr[(LGSIZE-1):1] });\n"
+"	generate for(k=0; k<LGSIZE; k=k+1)\n"
+"		assign rdaddr[k] = rdbin[LGSIZE-1-k];\n"
+"	endgenerate\n");
+	else
+		fprintf(fp,
 "	generate for(k=0; k<LGSIZE; k=k+1)\n"
 "		assign rdaddr[k] = wraddr[LGSIZE-1-k];\n"
-"	endgenerate\n"
+"	endgenerate\n");
+
+	fprintf(fp,
 "	assign	rdaddr[LGSIZE] = !wraddr[LGSIZE];\n"
+"\n");
+
+	if (mirror)
+		fprintf(fp,
+"	// Bin N-k sits at the bit reversal of -k\n"
+"	wire	[(LGSIZE-1):0]	negaddr;\n"
+"	wire	[(LGSIZE):0]	mraddr;\n"
 "\n"
+"	assign	negaddr = -wraddr[(LGSIZE-1):0];\n"
+"	generate for(k=0; k<LGSIZE; k=k+1)\n"
+"		assign mraddr[k] = negaddr[LGSIZE-1-k];\n"
+"	endgenerate\n"
+"	assign	mraddr[LGSIZE] = !wraddr[LGSIZE];\n"
+"\n");
+
+	fprintf(fp,
 "	reg	in_reset;\n"
 "\n"
 "	initial	in_reset = 1'b1;\n");
@@ -147,7 +196,16 @@ SLASHLINE
 "	always @(posedge i_clk)\n"
 "		if (i_ce) // If (i_reset) we just output junk ... not a problem\n"
 "			o_out <= brmem[rdaddr]; // w/o a sync pulse\n"
-"\n"
+"\n");
+
+	if (mirror)
+		fprintf(fp,
+"	always @(posedge i_clk)\n"
+"		if (i_ce)\n"
+"			o_mirror <= brmem[mraddr];\n"
+"\n");
+
+	fprintf(fp,
 "	initial	o_sync = 1'b0;\n");
 
 	if (async_reset)
@@ -268,12 +326,33 @@ SLASHLINE
 "\t\t\t\t&&(wraddr[LGSIZE-1:0]\n"
 "\t\t\t\t\t\t<= f_const_addr[LGSIZE-1:0]))\n"
 "\t\t\t`ASSERT(!f_addr_loaded);\n"
+"\n");
+
+		// The read of this address comes at the bit reversal of its
+		// address, or at the place of that bin in the pairs order
+		if (pairs)
+			fprintf(fp,
+"\t\twire\t[LGSIZE:0]\tf_rdpos;\n"
+"\n"
+"\t\tassign\tf_rdpos = (f_reversed_addr[LGSIZE-1:0] == 0) ? 0\n"
+"\t\t\t: ((!f_reversed_addr[LGSIZE-1])\n"
+"\t\t\t\t||(f_reversed_addr[LGSIZE-2:0] == 0))\n"
+"\t\t\t? ({ f_reversed_addr[LGSIZE-1:0], 1'b0 } - 1)\n"
+"\t\t\t: { -f_reversed_addr[LGSIZE-1:0], 1'b0 };\n"
 "\n"
 "\t\talways @(*)\n"
 "\t\tif ((rdaddr[LGSIZE]==f_const_addr[LGSIZE])&&(f_addr_loaded))\n"
+"\t\t\t`ASSERT(wraddr[LGSIZE-1:0] <= f_rdpos+1);\n"
+"\n");
+		else
+			fprintf(fp,
+"\t\talways @(*)\n"
+"\t\tif ((rdaddr[LGSIZE]==f_const_addr[LGSIZE])&&(f_addr_loaded))\n"
 "\t\t\t`ASSERT(wraddr[LGSIZE-1:0]\n"
 "\t\t\t\t\t<= f_reversed_addr[LGSIZE-1:0]+1);\n"
-"\n"
+"\n");
+
+		fprintf(fp,
 "\t\talways @(*)\n"
 "\t\tif (f_addr_loaded)\n"
 "\t\t\t`ASSERT(brmem[f_const_addr] == f_addr_value);\n"
@@ -671,3 +750,217 @@ SLASHLINE
 	fclose(fp);
 	free(modulename);
 }
+
+void	build_prunebrev(const char *fname, const bool async_reset) {
+	FILE	*fp = fopen(fname, "w");
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return;
+	}
+
+	std::string	resetw("i_reset"), always_reset;
+	if (async_reset) {
+		resetw = std::string("i_areset_n");
+		always_reset = std::string("\talways @(posedge i_clk, negedge i_areset_n)\n\t\tif (!i_areset_n)\n");
+	} else
+		always_reset = std::string("\talways @(posedge i_clk)\n\t\tif (i_reset)\n");
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\tprunebrev.v\n"
+"//\n"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:\tThis module bitreverses a pipelined FFT output, much like the\n"
+"//		single clock bitreverse module, save that it only keeps the\n"
+"//	NBINS bins starting at bin FIRST.  Bins outside of this range are\n"
+"//	never written, so its memory need only hold 2^LGMEM bins per frame\n"
+"//	rather than all of them.\n"
+"//\n"
+"//	The bins that are kept are produced in natural order at the start of\n"
+"//	each frame, one per i_ce, with o_valid set.  o_sync is true with bin\n"
+"//	FIRST.  o_valid is clear for the remaining i_ce\'s of the frame.\n"
+"//\n%s"
+"//\n", prjname, creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+	fprintf(fp,
+"module	prunebrev(i_clk, %s, i_ce, i_in, o_out, o_sync, o_valid);\n"
+	"\tparameter\t\t\tLGSIZE=%d, WIDTH=24;\n"
+	"\tparameter\t\t\tFIRST=0, NBINS=4, LGMEM=2;\n"
+	"\tinput\twire\t\t\ti_clk, %s, i_ce;\n"
+	"\tinput\twire\t[(2*WIDTH-1):0]\ti_in;\n"
+	"\toutput\treg\t[(2*WIDTH-1):0]\to_out;\n"
+	"\toutput\treg\t\t\to_sync, o_valid;\n"
+"\n"
+"	reg	[(LGSIZE):0]	wraddr;\n"
+"	wire	[(LGSIZE-1):0]	wrbin, wroff, rdpos;\n"
+"	wire			wr_keep;\n"
+"\n"
+"	reg	[(2*WIDTH-1):0]	brmem	[0:((1<<(LGMEM+1))-1)];\n"
+"\n"
+"	// The FFT produces its bins in bit reversed order\n"
+"	genvar	k;\n"
+"	generate for(k=0; k<LGSIZE; k=k+1)\n"
+"		assign wrbin[k] = wraddr[LGSIZE-1-k];\n"
+"	endgenerate\n"
+"\n"
+"	assign	wroff   = wrbin - FIRST;\n"
+"	assign	wr_keep = (wrbin >= FIRST)&&(wroff < NBINS);\n"
+"	assign	rdpos   = wraddr[(LGSIZE-1):0];\n"
+"\n"
+"	reg	in_reset;\n"
+"\n"
+"	initial	in_reset = 1'b1;\n"
+"%s"
+"			in_reset <= 1'b1;\n"
+"		else if ((i_ce)&&(&wraddr[(LGSIZE-1):0]))\n"
+"			in_reset <= 1'b0;\n"
+"\n"
+"	initial	wraddr = 0;\n"
+"%s"
+"			wraddr <= 0;\n"
+"		else if (i_ce)\n"
+"			wraddr <= wraddr + 1;\n"
+"\n"
+"	always @(posedge i_clk)\n"
+"		if ((i_ce)&&(wr_keep))\n"
+"			brmem[{ wraddr[LGSIZE], wroff[(LGMEM-1):0] }] <= i_in;\n"
+"\n"
+"	always @(posedge i_clk)\n"
+"		if (i_ce)\n"
+"			o_out <= brmem[{ !wraddr[LGSIZE], rdpos[(LGMEM-1):0] }];\n"
+"\n"
+"	initial	o_sync  = 1'b0;\n"
+"	initial	o_valid = 1'b0;\n"
+"%s"
+"		begin\n"
+"			o_sync  <= 1'b0;\n"
+"			o_valid <= 1'b0;\n"
+"		end else if (i_ce)\n"
+"		begin\n"
+"			o_sync  <= (!in_reset)&&(rdpos == 0);\n"
+"			o_valid <= (!in_reset)&&(rdpos < NBINS);\n"
+"		end\n"
+"\n"
+"endmodule\n", resetw.c_str(), TST_DBLREVERSE_LGSIZE, resetw.c_str(),
+		always_reset.c_str(), always_reset.c_str(),
+		always_reset.c_str());
+
+	fclose(fp);
+}
+
+void	build_cpinsert(const char *fname, const bool async_reset) {
+	FILE	*fp = fopen(fname, "w");
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return;
+	}
+
+	std::string	resetw("i_reset"), always_reset;
+	if (async_reset) {
+		resetw = std::string("i_areset_n");
+		always_reset = std::string("\talways @(posedge i_clk, negedge i_areset_n)\n\t\tif (!i_areset_n)\n");
+	} else
+		always_reset = std::string("\talways @(posedge i_clk)\n\t\tif (i_reset)\n");
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\tcpinsert.v\n"
+"//\n"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:\tThis module bitreverses the output of a pipelined inverse\n"
+"//		FFT, much like the single clock bitreverse module, while\n"
+"//	also inserting the cyclic prefix of an OFDM symbol.  Each symbol is\n"
+"//	read out of the same ping-pong memory as N+CPLEN samples, starting\n"
+"//	with its last CPLEN samples, so no separate prefix buffer is needed.\n"
+"//\n"
+"//	The FFT may only run on N of every N+CPLEN i_ce\'s, with i_wr set\n"
+"//	when it does.  i_in and i_sync are its outputs, in bit reversed order.\n"
+"//	A new symbol then completes every N+CPLEN i_ce\'s, just as the last\n"
+"//	one has been read out.  o_sync is true with the first sample of the\n"
+"//	prefix.\n"
+"//\n%s"
+"//\n", prjname, creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+	fprintf(fp,
+"module	cpinsert(i_clk, %s, i_ce, i_wr, i_sync, i_in, o_out, o_sync);\n"
+	"\tparameter\t\t\tLGSIZE=%d, WIDTH=24, CPLEN=2;\n"
+	"\tlocalparam\t[(LGSIZE-1):0]\tCPSTART = (1<<LGSIZE) - CPLEN;\n"
+	"\tinput\twire\t\t\ti_clk, %s, i_ce, i_wr, i_sync;\n"
+	"\tinput\twire\t[(2*WIDTH-1):0]\ti_in;\n"
+	"\toutput\treg\t[(2*WIDTH-1):0]\to_out;\n"
+	"\toutput\treg\t\t\to_sync;\n"
+"\n"
+"	reg	[(LGSIZE):0]	wraddr;\n"
+"	reg	[(LGSIZE-1):0]	rdpos;\n"
+"	wire	[(LGSIZE-1):0]	rdaddr;\n"
+"	reg			rdbank, wr_started, rd_first;\n"
+"	wire			wr_en, wr_last;\n"
+"\n"
+"	reg	[(2*WIDTH-1):0]	brmem	[0:((1<<(LGSIZE+1))-1)];\n"
+"\n"
+"	// The FFT produces its samples in bit reversed order\n"
+"	genvar	k;\n"
+"	generate for(k=0; k<LGSIZE; k=k+1)\n"
+"		assign rdaddr[k] = rdpos[LGSIZE-1-k];\n"
+"	endgenerate\n"
+"\n"
+"	assign	wr_en   = (i_ce)&&(i_wr)&&((wr_started)||(i_sync));\n"
+"	assign	wr_last = (wr_en)&&(&wraddr[(LGSIZE-1):0]);\n"
+"\n"
+"	initial	wr_started = 1'b0;\n"
+"	initial	wraddr = 0;\n"
+"%s"
+"		begin\n"
+"			wr_started <= 1'b0;\n"
+"			wraddr <= 0;\n"
+"		end else if (wr_en)\n"
+"		begin\n"
+"			wr_started <= 1'b1;\n"
+"			wraddr <= wraddr + 1;\n"
+"		end\n"
+"\n"
+"	always @(posedge i_clk)\n"
+"		if (wr_en)\n"
+"			brmem[wraddr] <= i_in;\n"
+"\n"
+"	//\n"
+"	// Once a symbol is complete, read it back starting CPLEN samples\n"
+"	// from its end, wrapping around to its beginning\n"
+"	//\n"
+"	initial	rdbank = 1'b0;\n"
+"	initial	rdpos  = 0;\n"
+"	always @(posedge i_clk)\n"
+"		if (i_ce)\n"
+"		begin\n"
+"			if (wr_last)\n"
+"			begin\n"
+"				rdbank <= wraddr[LGSIZE];\n"
+"				rdpos  <= CPSTART;\n"
+"			end else\n"
+"				rdpos  <= rdpos + 1;\n"
+"		end\n"
+"\n"
+"	always @(posedge i_clk)\n"
+"		if (i_ce) // Junk until the first symbol ... w/o a sync pulse\n"
+"			o_out <= brmem[{ rdbank, rdaddr }];\n"
+"\n"
+"	initial	rd_first = 1'b0;\n"
+"	initial	o_sync   = 1'b0;\n"
+"%s"
+"			{ rd_first, o_sync } <= 2'b00;\n"
+"		else if (i_ce)\n"
+"			{ rd_first, o_sync } <= { wr_last, rd_first };\n"
+"\n"
+"endmodule\n", resetw.c_str(), TST_DBLREVERSE_LGSIZE, resetw.c_str(),
+		always_reset.c_str(), always_reset.c_str());
+
+	fclose(fp);
+}
@@ -38,7 +38,10 @@
 #ifndef	BITREVERSE_H
 #define	BITREVERSE_H
 
-extern	void	build_snglbrev(const char *fname, const bool async_reset = false);
+extern	void	build_snglbrev(const char *fname, const bool async_reset = false,
+			const bool mirror = false, const bool pairs = false);
 extern	void	build_dblreverse(const char *fname, const bool async_reset = false);
+extern	void	build_prunebrev(const char *fname, const bool async_reset = false);
+extern	void	build_cpinsert(const char *fname, const bool async_reset = false);
 
 #endif	// BITREVERSE_H
@@ -72,7 +72,8 @@
 // This stage is called laststage elsewhere.
 //
 void	build_dblstage(const char *fname, ROUND_T rounding,
-			const bool async_reset, const bool dbg) {
+			const bool async_reset, const bool dbg,
+			const bool rndsel) {
 	FILE	*fp = fopen(fname, "w");
 	if (NULL == fp) {
 		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
@@ -80,15 +81,8 @@ void	build_dblstage(const char *fname, ROUND_T rounding,
 		return;
 	}
 
-	const	char	*rnd_string;
-	if (rounding == RND_TRUNCATE)
-		rnd_string = "truncate";
-	else if (rounding == RND_FROMZERO)
-		rnd_string = "roundfromzero";
-	else if (rounding == RND_HALFUP)
-		rnd_string = "roundhalfup";
-	else
-		rnd_string = "convround";
+	const	char	*rnd_parm,
+		*rnd_string = rnd_module(rounding, rndsel, &rnd_parm);
 
 	std::string	resetw("i_reset");
 	if (async_reset)
@@ -162,6 +156,10 @@ SLASHLINE
 	"\n", (dbg)?"_dbg":"", resetw.c_str(), (dbg)?", o_dbg":"",
 	TST_DBLSTAGE_IWIDTH, TST_DBLSTAGE_SHIFT,
 		resetw.c_str());
+	if (rndsel)
+		fprintf(fp,
+	"\t// Which rounder to use on the outputs, as selected by rndselect\n"
+	"\tparameter\t[1:0]\tRNDMODE=%d;\n\n", (int)rounding);
 
 	if (dbg) { fprintf(fp, "\toutput\twire\t[33:0]\t\t\to_dbg;\n"
 		"\tassign\to_dbg = { ((o_sync)&&(i_ce)), i_ce, o_left[(2*OWIDTH-1):(2*OWIDTH-16)],\n"
@@ -231,17 +229,17 @@ SLASHLINE
 		"\t\tend\n"
 "\n");
 	fprintf(fp,
-	"\t%s #(IWIDTH+1,OWIDTH,SHIFT) do_rnd_0r(i_clk, i_ce,\n"
-	"\t\t\t\t\t\t\trnd_in_0r, o_out_0r);\n\n", rnd_string);
+	"\t%s #(IWIDTH+1,OWIDTH,SHIFT%s) do_rnd_0r(i_clk, i_ce,\n"
+	"\t\t\t\t\t\t\trnd_in_0r, o_out_0r);\n\n", rnd_string, rnd_parm);
 	fprintf(fp,
-	"\t%s #(IWIDTH+1,OWIDTH,SHIFT) do_rnd_0i(i_clk, i_ce,\n"
-	"\t\t\t\t\t\t\trnd_in_0i, o_out_0i);\n\n", rnd_string);
+	"\t%s #(IWIDTH+1,OWIDTH,SHIFT%s) do_rnd_0i(i_clk, i_ce,\n"
+	"\t\t\t\t\t\t\trnd_in_0i, o_out_0i);\n\n", rnd_string, rnd_parm);
 	fprintf(fp,
-	"\t%s #(IWIDTH+1,OWIDTH,SHIFT) do_rnd_1r(i_clk, i_ce,\n"
-	"\t\t\t\t\t\t\trnd_in_1r, o_out_1r);\n\n", rnd_string);
+	"\t%s #(IWIDTH+1,OWIDTH,SHIFT%s) do_rnd_1r(i_clk, i_ce,\n"
+	"\t\t\t\t\t\t\trnd_in_1r, o_out_1r);\n\n", rnd_string, rnd_parm);
 	fprintf(fp,
-	"\t%s #(IWIDTH+1,OWIDTH,SHIFT) do_rnd_1i(i_clk, i_ce,\n"
-	"\t\t\t\t\t\t\trnd_in_1i, o_out_1i);\n\n", rnd_string);
+	"\t%s #(IWIDTH+1,OWIDTH,SHIFT%s) do_rnd_1i(i_clk, i_ce,\n"
+	"\t\t\t\t\t\t\trnd_in_1i, o_out_1i);\n\n", rnd_string, rnd_parm);
 
 	fprintf(fp, "\n"
 	"\t// Prior versions of this routine did not include the extra\n"
@@ -272,7 +270,9 @@ SLASHLINE
 void	build_stage(const char *fname,
 		int stage, int nwide, int offset,
 		int nbits, int xtra, int ckpce,
-		const bool async_reset, const bool dbg) {
+		const bool async_reset, const bool dbg,
+		const bool rndsel, const bool extcoef, const bool prune,
+		const bool extmpy) {
 	FILE	*fstage = fopen(fname, "w");
 	int	cbits = nbits + xtra;
 
@@ -327,8 +327,10 @@ SLASHLINE
 		(dbg)?"_dbg":"", prjname, creator);
 	fprintf(fstage, "%s", cpyleft);
 	fprintf(fstage, "//\n//\n`default_nettype\tnone\n//\n");
-	fprintf(fstage, "module\tfftstage%s(i_clk, %s, i_ce, i_sync, i_data, o_data, o_sync%s);\n",
+	fprintf(fstage, "module\tfftstage%s(i_clk, %s, i_ce, i_sync, i_data, o_data, o_sync%s%s%s);\n",
 		(dbg)?"_dbg":"", resetw.c_str(),
+		(extcoef)?", o_caddr, i_coef":"",
+		(extmpy)?", o_mpy_c, o_mpy_d, i_mpy_p":"",
 		(dbg)?", o_dbg":"");
 	// These parameter values are useless at this point--they are to be
 	// replaced by the parameter values in the calling program.  Only
@@ -356,12 +358,31 @@ SLASHLINE
 	fprintf(fstage,
 "\t// The COEFFILE parameter contains the name of the file containing the\n"
 "\t// FFT twiddle factors\n");
+	if (extcoef)
+		fprintf(fstage,
+"\t// (Unused, since the coefficients come from a shared coefrom within\n"
+"\t// the top level.  It remains so the parameter order is unchanged.)\n");
 	if (nwide == 2) {
 		fprintf(fstage, "\tparameter\tCOEFFILE=\"cmem_%c%d.hex\";\n",
 			(offset)?'o':'e', stage*2);
 	} else
 		fprintf(fstage, "\tparameter\tCOEFFILE=\"cmem_%d.hex\";\n",
 			stage);
+	if (rndsel)
+		fprintf(fstage,
+"\t// The rounder used by this stage's butterfly.  This is set per stage\n"
+"\t// by the calling program, so that the wide early stages may (for\n"
+"\t// example) truncate while the later stages use convergent rounding.\n"
+"\t// See rndselect.v for the encoding.\n"
+"\tparameter\t[1:0]	RNDMODE = %d;\n", (int)RND_CONVERGENT);
+	if (prune)
+		fprintf(fstage,
+"\t// Input pruning, for zero padded frames.  When LGKEEP <= LGSPAN,\n"
+"\t// x[n+N/2] is always zero, and so is x[n] for n >= 2^LGKEEP.  Only\n"
+"\t// those first values are then kept, and the butterfly\'s second input\n"
+"\t// is tied to zero.  LGKEEP > LGSPAN keeps the full stage.\n"
+"\tparameter\t	LGKEEP = LGSPAN+1;\n"
+"\tlocalparam\t	LGMEM = (LGKEEP > LGSPAN) ? LGSPAN : LGKEEP;\n");
 
 	fprintf(fstage,"\n"
 "`ifdef	VERILATOR\n"
@@ -374,8 +395,23 @@ SLASHLINE
 "\tinput	wire				i_clk, %s, i_ce, i_sync;\n"
 "\tinput	wire	[(2*IWIDTH-1):0]	i_data;\n"
 "\toutput	reg	[(2*OWIDTH-1):0]	o_data;\n"
-"\toutput	reg				o_sync;\n"
-"\n", resetw.c_str());
+"\toutput	reg				o_sync;\n", resetw.c_str());
+	if (extcoef)
+		fprintf(fstage,
+"\t// The twiddle factors are read from a ROM shared with another stage.\n"
+"\t// The coefficient at index o_caddr must be returned on i_coef, one\n"
+"\t// i_ce later.\n"
+"\toutput	wire	[(LGSPAN-1):0]		o_caddr;\n"
+"\tinput	wire	[(2*CWIDTH-1):0]	i_coef;\n");
+	if (extmpy)
+		fprintf(fstage,
+"\t// The hardware butterfly's multiply is shared with another stage,\n"
+"\t// within an mpyshare in the top level.  These are unused when\n"
+"\t// OPT_HWMPY is clear.\n"
+"\toutput	wire	[3*(CWIDTH+1)-1:0]	o_mpy_c;\n"
+"\toutput	wire	[3*(IWIDTH+2)-1:0]	o_mpy_d;\n"
+"\tinput	wire	[3*(CWIDTH+IWIDTH+3)-1:0] i_mpy_p;\n");
+	fprintf(fstage, "\n");
 	if (dbg) { fprintf(fstage, "\toutput\twire\t[33:0]\t\t\to_dbg;\n"
 		"\tassign\to_dbg = { ((o_sync)&&(i_ce)), i_ce, o_data[(2*OWIDTH-1):(2*OWIDTH-16)],\n"
 			"\t\t\t\t\to_data[(OWIDTH-1):(OWIDTH-16)] };\n"
@@ -387,13 +423,16 @@ SLASHLINE
 	"\t// 	ob_*	to reference the outputs from the butterfly\n"
 	"\treg	wait_for_sync;\n"
 	"\treg	[(2*IWIDTH-1):0]	ib_a, ib_b;\n"
-	"\treg	[(2*CWIDTH-1):0]	ib_c;\n"
+	"\t%s	[(2*CWIDTH-1):0]	ib_c;\n"
 	"\treg	ib_sync;\n"
 "\n"
 	"\treg	b_started;\n"
 	"\twire	ob_sync;\n"
-	"\twire	[(2*OWIDTH-1):0]\tob_a, ob_b;\n");
-	fprintf(fstage,
+	"\twire	[(2*OWIDTH-1):0]\tob_a, ob_b;\n",
+		(extcoef) ? "wire" : "reg");
+
+	if (!extcoef) {
+		fprintf(fstage,
 "\n"
 "\t// cmem is defined as an array of real and complex values,\n"
 "\t// where the top CWIDTH bits are the real value and the bottom\n"
@@ -404,26 +443,27 @@ SLASHLINE
 "\t//\n"
 "\treg	[(2*CWIDTH-1):0]	cmem [0:((1<<LGSPAN)-1)];\n");
 
-	if (formal_property_flag)
-		fprintf(fstage, 
-			"`ifdef	FORMAL\n"
-			"// Let the formal tool pick the coefficients\n"
-			"`else\n");
-	fprintf(fstage, "\tinitial\t$readmemh(COEFFILE,cmem);\n\n");
-	if (formal_property_flag)
-		fprintf(fstage, "`endif\n\n");
+		if (formal_property_flag)
+			fprintf(fstage, 
+				"`ifdef	FORMAL\n"
+				"// Let the formal tool pick the coefficients\n"
+				"`else\n");
+		fprintf(fstage, "\tinitial\t$readmemh(COEFFILE,cmem);\n\n");
+		if (formal_property_flag)
+			fprintf(fstage, "`endif\n\n");
+	}
 
 	// gen_coeff_file(coredir, fname, stage, cbits, nwide, offset, inv);
 
 	fprintf(fstage,
 "\treg	[(LGSPAN):0]		iaddr;\n"
-"\treg	[(2*IWIDTH-1):0]	imem	[0:((1<<LGSPAN)-1)];\n"
+"\treg	[(2*IWIDTH-1):0]	imem	[0:((1<<%s)-1)];\n"
 "\n"
 "\treg	[LGSPAN:0]		oaddr;\n"
 "\treg	[(2*OWIDTH-1):0]	omem	[0:((1<<LGSPAN)-1)];\n"
 "\n"
 "\tinitial wait_for_sync = 1\'b1;\n"
-"\tinitial iaddr = 0;\n");
+"\tinitial iaddr = 0;\n", (prune) ? "LGMEM" : "LGSPAN");
 	if (async_reset)
 		fprintf(fstage, "\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
 	else
@@ -440,11 +480,26 @@ SLASHLINE
 		"\t\t//\n"
 		"\t\tiaddr <= iaddr + { {(LGSPAN){1\'b0}}, 1\'b1 };\n"
 		"\t\twait_for_sync <= 1\'b0;\n"
-	"\tend\n"
+	"\tend\n");
+	if (prune)
+		fprintf(fstage,
+	"\talways @(posedge i_clk) // Need to make certain here that we don\'t read\n"
+	"\tif ((i_ce)&&(!iaddr[LGSPAN]) // and write the same address on\n"
+			"\t\t&&((iaddr[(LGSPAN-1):0] >> LGMEM) == 0)) // the same clk\n"
+		"\t\timem[iaddr[(LGMEM-1):0]] <= i_data;\n"
+	"\n");
+	else
+		fprintf(fstage,
 	"\talways @(posedge i_clk) // Need to make certain here that we don\'t read\n"
 	"\tif ((i_ce)&&(!iaddr[LGSPAN])) // and write the same address on\n"
 		"\t\timem[iaddr[(LGSPAN-1):0]] <= i_data; // the same clk\n"
 	"\n");
+	if (extcoef)
+		fprintf(fstage,
+"\t// The coefficient address is the same as the input memory address,\n"
+"\t// and the coefficient comes back in time to be used with ib_a\n"
+"\tassign\to_caddr = iaddr[(LGSPAN-1):0];\n"
+"\tassign\tib_c    = i_coef;\n\n");
 
 	fprintf(fstage,
 	"\t//\n"
@@ -471,13 +526,25 @@ SLASHLINE
 	"\t// butterfly inputs\n"
 	"\talways\t@(posedge i_clk)\n"
 	"\tif (i_ce)\n"
-	"\tbegin\n"
+	"\tbegin\n");
+	if (prune)
+		fprintf(fstage,
+		"\t\t// One input from memory, or zero past what was kept, ...\n"
+		"\t\tib_a <= ((iaddr[(LGSPAN-1):0] >> LGMEM) == 0)\n"
+			"\t\t\t? imem[iaddr[(LGMEM-1):0]] : 0;\n"
+		"\t\t// One input clocked in from the top, unless it\'s zero\n"
+		"\t\tib_b <= (LGKEEP > LGSPAN) ? i_data : 0;\n");
+	else
+		fprintf(fstage,
 		"\t\t// One input from memory, ...\n"
 		"\t\tib_a <= imem[iaddr[(LGSPAN-1):0]];\n"
 		"\t\t// One input clocked in from the top\n"
-		"\t\tib_b <= i_data;\n"
+		"\t\tib_b <= i_data;\n");
+	if (!extcoef)
+		fprintf(fstage,
 		"\t\t// and the coefficient or twiddle factor\n"
-		"\t\tib_c <= cmem[iaddr[(LGSPAN-1):0]];\n"
+		"\t\tib_c <= cmem[iaddr[(LGSPAN-1):0]];\n");
+	fprintf(fstage,
 	"\tend\n\n");
 
 	fprintf(fstage,
@@ -517,23 +584,29 @@ SLASHLINE
 "\tgenerate if (OPT_HWMPY)\n"
 "\tbegin : HWBFLY\n"
 "\t\thwbfly #(.IWIDTH(IWIDTH),.CWIDTH(CWIDTH),.OWIDTH(OWIDTH),\n"
-			"\t\t\t\t.CKPCE(CKPCE), .SHIFT(BFLYSHIFT))\n"
+			"\t\t\t\t.CKPCE(CKPCE), .SHIFT(BFLYSHIFT)%s)\n"
 		"\t\t\tbfly(i_clk, %s, i_ce, (idle)?0:ib_c,\n"
 			"\t\t\t\t(idle || (!i_ce)) ? 0:ib_a,\n"
 			"\t\t\t\t(idle || (!i_ce)) ? 0:ib_b,\n"
 			"\t\t\t\t(ib_sync)&&(i_ce),\n"
-			"\t\t\t\tob_a, ob_b, ob_sync);\n"
+			"\t\t\t\tob_a, ob_b, ob_sync%s);\n"
 "\tend else begin : FWBFLY\n"
 "\t\tbutterfly #(.IWIDTH(IWIDTH),.CWIDTH(CWIDTH),.OWIDTH(OWIDTH),\n"
-		"\t\t\t\t.CKPCE(CKPCE),.SHIFT(BFLYSHIFT))\n"
+		"\t\t\t\t.CKPCE(CKPCE),.SHIFT(BFLYSHIFT)%s)\n"
 	"\t\t\tbfly(i_clk, %s, i_ce,\n"
 			"\t\t\t\t\t(idle||(!i_ce))?0:ib_c,\n"
 			"\t\t\t\t\t(idle||(!i_ce))?0:ib_a,\n"
 			"\t\t\t\t\t(idle||(!i_ce))?0:ib_b,\n"
 			"\t\t\t\t\t(ib_sync&&i_ce),\n"
 			"\t\t\t\t\tob_a, ob_b, ob_sync);\n"
+"%s"
 "\tend endgenerate\n",
-			resetw.c_str(), resetw.c_str());
+			(rndsel) ? ", .RNDMODE(RNDMODE)" : "",
+			resetw.c_str(),
+			(extmpy) ? ",\n\t\t\t\to_mpy_c, o_mpy_d, i_mpy_p" : "",
+			(rndsel) ? ",.RNDMODE(RNDMODE)" : "",
+			resetw.c_str(),
+			(extmpy) ? "\n\t\tassign\to_mpy_c = 0;\n\t\tassign\to_mpy_d = 0;\n\n" : "");
 
 	if (formal_property_flag)
 		fprintf(fstage, "`endif\n\n");
@@ -678,8 +751,11 @@ SLASHLINE
 	"\tif ((i_ce)&&(!wait_for_sync)&&(f_last_addr == { 1'b1, f_addr[LGSPAN-1:0]}))\n"
 	"\tbegin\n"
 		"\t\tassert(ib_a == f_left);\n"
-		"\t\tassert(ib_b == f_right);\n"
-		"\t\tassert(ib_c == cmem[f_addr[LGSPAN-1:0]]);\n"
+		"\t\tassert(ib_b == f_right);\n");
+	if (!extcoef)
+		fprintf(fstage,
+		"\t\tassert(ib_c == cmem[f_addr[LGSPAN-1:0]]);\n");
+	fprintf(fstage,
 	"\tend\n\n");
 
 	fprintf(fstage,
@@ -785,3 +861,69 @@ SLASHLINE
 
 	fprintf(fstage, "endmodule\n");
 }
+
+//
+// Builds a dual-port twiddle factor ROM, so that one table of coefficients
+// may be shared between two FFT stages.
+//
+void	build_coefrom(const char *fname) {
+	FILE	*fp = fopen(fname, "w");
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return;
+	}
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\tcoefrom.v\n"
+"//\n"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:\tHolds the twiddle factors for one or two FFT stages, with a\n"
+"//		read port for each.  Since each stage's coefficient table\n"
+"//	is every other entry of the table for the stage before it, two\n"
+"//	stages can share a single table if the smaller one reads it with a\n"
+"//	stride of two.  The address shift is left to the caller.\n"
+"//\n"
+"//	Both reads complete on the clock following the address, so long as\n"
+"//	i_ce is true, matching the coefficient memory within fftstage.\n"
+"//\n%s"
+"//\n", prjname, creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+
+	fprintf(fp,
+"module\tcoefrom(i_clk, i_ce, i_addr_a, o_coef_a, i_addr_b, o_coef_b);\n"
+	"\tparameter\tCWIDTH=20, LGSIZE=8;\n"
+	"\tparameter\tCOEFFILE=\"cmem_512.hex\";\n"
+	"\tinput\twire\t\t\ti_clk, i_ce;\n"
+	"\tinput\twire\t[(LGSIZE-1):0]\ti_addr_a, i_addr_b;\n"
+	"\toutput\treg\t[(2*CWIDTH-1):0]\to_coef_a, o_coef_b;\n"
+"\n"
+	"\treg	[(2*CWIDTH-1):0]	cmem [0:((1<<LGSIZE)-1)];\n"
+"\n");
+
+	if (formal_property_flag)
+		fprintf(fp,
+			"`ifdef	FORMAL\n"
+			"// Let the formal tool pick the coefficients\n"
+			"`else\n");
+	fprintf(fp, "\tinitial\t$readmemh(COEFFILE,cmem);\n\n");
+	if (formal_property_flag)
+		fprintf(fp, "`endif\n\n");
+
+	fprintf(fp,
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+		"\t\to_coef_a <= cmem[i_addr_a];\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+		"\t\to_coef_b <= cmem[i_addr_b];\n"
+"\n"
+"endmodule\n");
+
+	fclose(fp);
+}
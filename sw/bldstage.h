@@ -41,12 +41,19 @@
 #include "rounding.h"
 
 extern	void	build_dblstage(const char *fname, ROUND_T rounding,
-		const bool async_reset = false, const bool dbg = false);
+		const bool async_reset = false, const bool dbg = false,
+		const bool rndsel = false);
 
 extern	void	build_stage(const char *fname,
 		int stage, int nwide, int offset,
 		int nbits, int xtra, int ckpce,
 		const bool async_reset = false,
-		const bool dbg=false);
+		const bool dbg=false,
+		const bool rndsel=false,
+		const bool extcoef=false,
+		const bool prune=false,
+		const bool extmpy=false);
+
+extern	void	build_coefrom(const char *fname);
 
 #endif	// BLDSTAGE_H
@@ -90,22 +90,15 @@ int lstat(const char *filename, struct stat *buf) { return 1; };
 #include "butterfly.h"
 
 void	build_butterfly(const char *fname, int xtracbits, ROUND_T rounding,
-			int	ckpce, const bool async_reset) {
+			int	ckpce, const bool async_reset, const bool rndsel) {
 	FILE	*fp = fopen(fname, "w");
 	if (NULL == fp) {
 		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
 		perror("O/S Err was:");
 		return;
 	}
-	const	char	*rnd_string;
-	if (rounding == RND_TRUNCATE)
-		rnd_string = "truncate";
-	else if (rounding == RND_FROMZERO)
-		rnd_string = "roundfromzero";
-	else if (rounding == RND_HALFUP)
-		rnd_string = "roundhalfup";
-	else
-		rnd_string = "convround";
+	const	char	*rnd_parm,
+		*rnd_string = rnd_module(rounding, rndsel, &rnd_parm);
 
 	//if (ckpce >= 3)
 		//ckpce = 3;
@@ -213,6 +206,10 @@ SLASHLINE
 	fprintf(fp, "OWIDTH=IWIDTH+1;\n");
 #endif
 	fprintf(fp, "\tparameter\tSHIFT=0;\n");
+	if (rndsel)
+		fprintf(fp,
+	"\t// Which rounder to use on the outputs, as selected by rndselect\n"
+	"\tparameter\t[1:0]\tRNDMODE=%d;\n", (int)rounding);
 
 	fprintf(fp,
 	"\t// The number of clocks per each i_ce.  The actual number can be\n"
@@ -255,7 +252,11 @@ SLASHLINE
 			"\t\t\t: (MPYDELAY >  4) ? 3\n"
 			"\t\t\t: 2;\n"
 	"\tlocalparam	AUXLEN=(LCLDELAY+3);\n"
-	"\tlocalparam	MPYREMAINDER = MPYDELAY - CKPCE*(MPYDELAY/CKPCE);\n"
+	"\t//\n"
+	"\t// Beyond three clocks per CE, the multiply still only steps three\n"
+	"\t// times per CE, and the extra clocks are idle.\n"
+	"\tlocalparam	MPYPCE = (CKPCE > 3) ? 3 : CKPCE;\n"
+	"\tlocalparam	MPYREMAINDER = MPYDELAY - MPYPCE*(MPYDELAY/MPYPCE);\n"
 "\n\n");
 
 
@@ -626,7 +627,7 @@ SLASHLINE
 	///	Three clock per CE, so CE, no-ce, no-ce*, CE
 	///
 	fprintf(fp,
-"\tend else if (CKPCE <= 3)\n\tbegin : CKPCE_THREE\n");
+"\tend else begin : CKPCE_THREE\n");
 
 	fprintf(fp,
 	"\t\t// Coefficient multiply inputs\n"
@@ -905,19 +906,19 @@ SLASHLINE
 	"\tassign	left_si = { {(2){fifo_i[(IWIDTH+CWIDTH)]}}, fifo_i };\n\n");
 
 	fprintf(fp,
-	"\t%s #(CWIDTH+IWIDTH+3,OWIDTH,SHIFT+4) do_rnd_left_r(i_clk, i_ce,\n"
+	"\t%s #(CWIDTH+IWIDTH+3,OWIDTH,SHIFT+4%s) do_rnd_left_r(i_clk, i_ce,\n"
 	"\t\t\t\tleft_sr, rnd_left_r);\n\n",
-		rnd_string);
+		rnd_string, rnd_parm);
 	fprintf(fp,
-	"\t%s #(CWIDTH+IWIDTH+3,OWIDTH,SHIFT+4) do_rnd_left_i(i_clk, i_ce,\n"
+	"\t%s #(CWIDTH+IWIDTH+3,OWIDTH,SHIFT+4%s) do_rnd_left_i(i_clk, i_ce,\n"
 	"\t\t\t\tleft_si, rnd_left_i);\n\n",
-		rnd_string);
+		rnd_string, rnd_parm);
 	fprintf(fp,
-	"\t%s #(CWIDTH+IWIDTH+3,OWIDTH,SHIFT+4) do_rnd_right_r(i_clk, i_ce,\n"
-	"\t\t\t\tmpy_r, rnd_right_r);\n\n", rnd_string);
+	"\t%s #(CWIDTH+IWIDTH+3,OWIDTH,SHIFT+4%s) do_rnd_right_r(i_clk, i_ce,\n"
+	"\t\t\t\tmpy_r, rnd_right_r);\n\n", rnd_string, rnd_parm);
 	fprintf(fp,
-	"\t%s #(CWIDTH+IWIDTH+3,OWIDTH,SHIFT+4) do_rnd_right_i(i_clk, i_ce,\n"
-	"\t\t\t\tmpy_i, rnd_right_i);\n\n", rnd_string);
+	"\t%s #(CWIDTH+IWIDTH+3,OWIDTH,SHIFT+4%s) do_rnd_right_i(i_clk, i_ce,\n"
+	"\t\t\t\tmpy_i, rnd_right_i);\n\n", rnd_string, rnd_parm);
 	fprintf(fp,
 	"\talways @(posedge i_clk)\n"
 	"\tif (i_ce)\n"
@@ -1056,7 +1057,7 @@ SLASHLINE
 			"\t\t\t\t&&(!$past(i_ce,3))&&(!$past(i_ce,4)))\n"
 			"\t\t\tassume(i_ce);\n"
 "\n"
-	"\tend else if (CKPCE == 3)\n"
+	"\tend else if (CKPCE >= 3)\n"
 	"\tbegin : F_CKPCE_THREE\n"
 "\n"
 		"\t\t// Primary i_ce assumption: Following any i_ce cycle,\n"
@@ -1274,7 +1275,8 @@ SLASHLINE
 }
 
 void	build_hwbfly(const char *fname, int xtracbits, ROUND_T rounding,
-		int ckpce, const bool async_reset) {
+		int ckpce, const bool async_reset, const bool rndsel,
+		const bool extmpy) {
 	FILE	*fp = fopen(fname, "w");
 	if (NULL == fp) {
 		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
@@ -1282,15 +1284,8 @@ void	build_hwbfly(const char *fname, int xtracbits, ROUND_T rounding,
 		return;
 	}
 
-	const	char	*rnd_string;
-	if (rounding == RND_TRUNCATE)
-		rnd_string = "truncate";
-	else if (rounding == RND_FROMZERO)
-		rnd_string = "roundfromzero";
-	else if (rounding == RND_HALFUP)
-		rnd_string = "roundhalfup";
-	else
-		rnd_string = "convround";
+	const	char	*rnd_parm,
+		*rnd_string = rnd_module(rounding, rndsel, &rnd_parm);
 
 	std::string	resetw("i_reset");
 	if (async_reset)
@@ -1337,7 +1332,7 @@ SLASHLINE
 	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
 	fprintf(fp,
 "module	hwbfly(i_clk, %s, i_ce, i_coef, i_left, i_right, i_aux,\n"
-		"\t\to_left, o_right, o_aux);\n"
+		"\t\to_left, o_right, o_aux%s);\n"
 	"\t// Public changeable parameters ...\n"
 	"\t//	- IWIDTH, number of bits in each component of the input\n"
 	"\t//	- CWIDTH, number of bits in each component of the twiddle factor\n"
@@ -1345,9 +1340,15 @@ SLASHLINE
 	"\tparameter IWIDTH=16,CWIDTH=IWIDTH+%d,OWIDTH=IWIDTH+1;\n"
 	"\t// Drop an additional bit on the output?\n"
 	"\tparameter\t\tSHIFT=0;\n"
-	"\t// The number of clocks per clock enable, 1, 2, or 3.\n"
-	"\tparameter\t[1:0]\tCKPCE=%d;\n\t//\n", resetw.c_str(), xtracbits,
-		ckpce);
+	"\t// The number of clocks per clock enable.  Three or more use a\n"
+	"\t// single multiply, idle for any clocks past the third.\n"
+	"\tparameter\t\tCKPCE=%d;\n\t//\n", resetw.c_str(),
+		(extmpy) ? ", o_mpy_c, o_mpy_d, i_mpy_p" : "",
+		xtracbits, ckpce);
+	if (rndsel)
+		fprintf(fp,
+	"\t// Which rounder to use on the outputs, as selected by rndselect\n"
+	"\tparameter\t[1:0]\tRNDMODE=%d;\n\t//\n", (int)rounding);
 
 	fprintf(fp,
 	"\tinput\twire\ti_clk, %s, i_ce;\n"
@@ -1357,6 +1358,14 @@ SLASHLINE
 	"\toutput\twire\t[(2*OWIDTH-1):0]\to_left, o_right;\n"
 	"\toutput\treg\to_aux;\n\n"
 "\n", resetw.c_str());
+	if (extmpy)
+		fprintf(fp,
+	"\t// Operands to, and products from, a multiply shared with another\n"
+	"\t// stage.  Each holds three values, with the first in the top bits.\n"
+	"\toutput\twire\t[3*(CWIDTH+1)-1:0]\to_mpy_c;\n"
+	"\toutput\twire\t[3*(IWIDTH+2)-1:0]\to_mpy_d;\n"
+	"\tinput\twire\t[3*(CWIDTH+IWIDTH+3)-1:0]\ti_mpy_p;\n"
+"\n");
 
 	fprintf(fp,
 	"\treg\t[(2*IWIDTH-1):0]	r_left, r_right;\n"
@@ -1445,313 +1454,359 @@ SLASHLINE
 //	fprintf(fp,
 //"\tend else if (CKPCI == 2'b01)\n\tbegin\n");
 
-	///////////////////////////////////////////
-	///
-	///	One clock per CE, so CE, CE, CE, CE, CE is possible
-	///
-	fprintf(fp,
-"\tgenerate if (CKPCE <= 1)\n\tbegin : CKPCE_ONE\n");
-
-	fprintf(fp,
-	"\t\t// Coefficient multiply inputs\n"
-	"\t\treg\tsigned	[(CWIDTH-1):0]	p1c_in, p2c_in;\n"
-	"\t\t// Data multiply inputs\n"
-	"\t\treg\tsigned	[(IWIDTH):0]	p1d_in, p2d_in;\n"
-	"\t\t// Product 3, coefficient input\n"
-	"\t\treg\tsigned	[(CWIDTH):0]	p3c_in;\n"
-	"\t\t// Product 3, data input\n"
-	"\t\treg\tsigned	[(IWIDTH+1):0]	p3d_in;\n"
-"\n");
-	fprintf(fp,
-	"\t\treg\tsigned	[((IWIDTH+1)+(CWIDTH)-1):0]	rp_one, rp_two;\n"
-	"\t\treg\tsigned	[((IWIDTH+2)+(CWIDTH+1)-1):0]	rp_three;\n"
+	if (extmpy) {
+		///////////////////////////////////////////
+		///
+		///	The multiply is outside, shared with another stage
+		///
+		fprintf(fp,
+	"\t// The three products are found by a multiply outside of this\n"
+	"\t// butterfly, shared with another stage (see mpyshare.v).  Each\n"
+	"\t// set of operands is held on o_mpy_c and o_mpy_d from one i_ce\n"
+	"\t// to the next, and its products must be returned on i_mpy_p\n"
+	"\t// before that next i_ce.\n"
+	"\treg\t\t[3*(CWIDTH+1)-1:0]\tmpy_pipe_c;\n"
+	"\treg\t\t[3*(IWIDTH+2)-1:0]\tmpy_pipe_d;\n"
+	"\treg\tsigned\t[((IWIDTH+1)+(CWIDTH)-1):0]\trp_one, rp_two;\n"
+	"\treg\tsigned\t[((IWIDTH+2)+(CWIDTH+1)-1):0]\trp_three;\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+		"\t\tmpy_pipe_c[3*(CWIDTH+1)-1:(CWIDTH+1)] <= {\n"
+			"\t\t\tir_coef_r[CWIDTH-1], ir_coef_r,\n"
+			"\t\t\tir_coef_i[CWIDTH-1], ir_coef_i };\n"
+		"\t\tmpy_pipe_c[CWIDTH:0] <= ir_coef_i + ir_coef_r;\n"
+		"\t\tmpy_pipe_d[3*(IWIDTH+2)-1:(IWIDTH+2)] <= {\n"
+			"\t\t\tr_dif_r[IWIDTH], r_dif_r,\n"
+			"\t\t\tr_dif_i[IWIDTH], r_dif_i };\n"
+		"\t\tmpy_pipe_d[(IWIDTH+2)-1:0] <= r_dif_r + r_dif_i;\n"
+	"\tend\n"
+"\n"
+	"\tassign\to_mpy_c = mpy_pipe_c;\n"
+	"\tassign\to_mpy_d = mpy_pipe_d;\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+		"\t\trp_one   <= i_mpy_p[(2*(CWIDTH+IWIDTH+3)+(CWIDTH+IWIDTH)):(2*(CWIDTH+IWIDTH+3))];\n"
+		"\t\trp_two   <= i_mpy_p[((CWIDTH+IWIDTH+3)+(CWIDTH+IWIDTH)):(CWIDTH+IWIDTH+3)];\n"
+		"\t\trp_three <= i_mpy_p[(CWIDTH+IWIDTH+3)-1:0];\n"
+	"\tend\n"
+"\n"
+	"\tassign\tp_one   = rp_one;\n"
+	"\tassign\tp_two   = rp_two;\n"
+	"\tassign\tp_three = rp_three;\n"
 "\n");
+	} else {
+		///////////////////////////////////////////
+		///
+		///	One clock per CE, so CE, CE, CE, CE, CE is possible
+		///
+		fprintf(fp,
+	"\tgenerate if (CKPCE <= 1)\n\tbegin : CKPCE_ONE\n");
 
-	fprintf(fp,
-	"\t\talways @(posedge i_clk)\n"
-	"\t\tif (i_ce)\n"
-	"\t\tbegin\n"
-		"\t\t\t// Second clock, pipeline = 1\n"
-		"\t\t\tp1c_in <= ir_coef_r;\n"
-		"\t\t\tp2c_in <= ir_coef_i;\n"
-		"\t\t\tp1d_in <= r_dif_r;\n"
-		"\t\t\tp2d_in <= r_dif_i;\n"
-		"\t\t\tp3c_in <= ir_coef_i + ir_coef_r;\n"
-		"\t\t\tp3d_in <= r_dif_r + r_dif_i;\n"
-	"\t\tend\n\n");
+		fprintf(fp,
+		"\t\t// Coefficient multiply inputs\n"
+		"\t\treg\tsigned	[(CWIDTH-1):0]	p1c_in, p2c_in;\n"
+		"\t\t// Data multiply inputs\n"
+		"\t\treg\tsigned	[(IWIDTH):0]	p1d_in, p2d_in;\n"
+		"\t\t// Product 3, coefficient input\n"
+		"\t\treg\tsigned	[(CWIDTH):0]	p3c_in;\n"
+		"\t\t// Product 3, data input\n"
+		"\t\treg\tsigned	[(IWIDTH+1):0]	p3d_in;\n"
+	"\n");
+		fprintf(fp,
+		"\t\treg\tsigned	[((IWIDTH+1)+(CWIDTH)-1):0]	rp_one, rp_two;\n"
+		"\t\treg\tsigned	[((IWIDTH+2)+(CWIDTH+1)-1):0]	rp_three;\n"
+	"\n");
 
-	if (formal_property_flag)
 		fprintf(fp,
-"`ifndef	FORMAL\n");
+		"\t\talways @(posedge i_clk)\n"
+		"\t\tif (i_ce)\n"
+		"\t\tbegin\n"
+			"\t\t\t// Second clock, pipeline = 1\n"
+			"\t\t\tp1c_in <= ir_coef_r;\n"
+			"\t\t\tp2c_in <= ir_coef_i;\n"
+			"\t\t\tp1d_in <= r_dif_r;\n"
+			"\t\t\tp2d_in <= r_dif_i;\n"
+			"\t\t\tp3c_in <= ir_coef_i + ir_coef_r;\n"
+			"\t\t\tp3d_in <= r_dif_r + r_dif_i;\n"
+		"\t\tend\n\n");
+
+		if (formal_property_flag)
+			fprintf(fp,
+	"`ifndef	FORMAL\n");
 
-	fprintf(fp,
-	"\t\talways @(posedge i_clk)\n"
-	"\t\tif (i_ce)\n"
-	"\t\tbegin\n"
-		"\t\t\t// Third clock, pipeline = 3\n"
-		"\t\t\t//   As desired, each of these lines infers a DSP48\n"
-		"\t\t\trp_one   <= p1c_in * p1d_in;\n"
-		"\t\t\trp_two   <= p2c_in * p2d_in;\n"
-		"\t\t\trp_three <= p3c_in * p3d_in;\n"
-	"\t\tend\n");
-
-	if (formal_property_flag)
 		fprintf(fp,
-"`else\n"
-		"\t\twire	signed	[((IWIDTH+1)+(CWIDTH)-1):0]	pre_rp_one, pre_rp_two;\n"
-		"\t\twire	signed	[((IWIDTH+2)+(CWIDTH+1)-1):0]	pre_rp_three;\n"
-"\n"
-		"\t\tabs_mpy #(CWIDTH,IWIDTH+1,1'b1)\n"
-		"\t\t	onei(p1c_in, p1d_in, pre_rp_one);\n"
-		"\t\tabs_mpy #(CWIDTH,IWIDTH+1,1'b1)\n"
-		"\t\t	twoi(p2c_in, p2d_in, pre_rp_two);\n"
-		"\t\tabs_mpy #(CWIDTH+1,IWIDTH+2,1'b1)\n"
-		"\t\t	threei(p3c_in, p3d_in, pre_rp_three);\n"
-"\n"
 		"\t\talways @(posedge i_clk)\n"
 		"\t\tif (i_ce)\n"
 		"\t\tbegin\n"
-		"\t\t	rp_one   = pre_rp_one;\n"
-		"\t\t	rp_two   = pre_rp_two;\n"
-		"\t\t	rp_three = pre_rp_three;\n"
-		"\t\tend\n"
-"`endif // FORMAL\n");
+			"\t\t\t// Third clock, pipeline = 3\n"
+			"\t\t\t//   As desired, each of these lines infers a DSP48\n"
+			"\t\t\trp_one   <= p1c_in * p1d_in;\n"
+			"\t\t\trp_two   <= p2c_in * p2d_in;\n"
+			"\t\t\trp_three <= p3c_in * p3d_in;\n"
+		"\t\tend\n");
+
+		if (formal_property_flag)
+			fprintf(fp,
+	"`else\n"
+			"\t\twire	signed	[((IWIDTH+1)+(CWIDTH)-1):0]	pre_rp_one, pre_rp_two;\n"
+			"\t\twire	signed	[((IWIDTH+2)+(CWIDTH+1)-1):0]	pre_rp_three;\n"
+	"\n"
+			"\t\tabs_mpy #(CWIDTH,IWIDTH+1,1'b1)\n"
+			"\t\t	onei(p1c_in, p1d_in, pre_rp_one);\n"
+			"\t\tabs_mpy #(CWIDTH,IWIDTH+1,1'b1)\n"
+			"\t\t	twoi(p2c_in, p2d_in, pre_rp_two);\n"
+			"\t\tabs_mpy #(CWIDTH+1,IWIDTH+2,1'b1)\n"
+			"\t\t	threei(p3c_in, p3d_in, pre_rp_three);\n"
+	"\n"
+			"\t\talways @(posedge i_clk)\n"
+			"\t\tif (i_ce)\n"
+			"\t\tbegin\n"
+			"\t\t	rp_one   = pre_rp_one;\n"
+			"\t\t	rp_two   = pre_rp_two;\n"
+			"\t\t	rp_three = pre_rp_three;\n"
+			"\t\tend\n"
+	"`endif // FORMAL\n");
+
+		fprintf(fp,"\n"
+		"\t\tassign\tp_one   = rp_one;\n"
+		"\t\tassign\tp_two   = rp_two;\n"
+		"\t\tassign\tp_three = rp_three;\n"
+	"\n");
 
-	fprintf(fp,"\n"
-	"\t\tassign\tp_one   = rp_one;\n"
-	"\t\tassign\tp_two   = rp_two;\n"
-	"\t\tassign\tp_three = rp_three;\n"
-"\n");
+		///////////////////////////////////////////
+		///
+		///	Two clocks per CE, so CE, no-ce, CE, no-ce, etc
+		///
+		fprintf(fp,
+		"\tend else if (CKPCE <= 2)\n"
+		"\tbegin : CKPCE_TWO\n"
+			"\t\t// Coefficient multiply inputs\n"
+			"\t\treg		[2*(CWIDTH)-1:0]	mpy_pipe_c;\n"
+			"\t\t// Data multiply inputs\n"
+			"\t\treg		[2*(IWIDTH+1)-1:0]	mpy_pipe_d;\n"
+			"\t\twire	signed	[(CWIDTH-1):0]	mpy_pipe_vc;\n"
+			"\t\twire	signed	[(IWIDTH):0]	mpy_pipe_vd;\n"
+			"\t\t//\n"
+			"\t\treg	signed	[(CWIDTH+1)-1:0]	mpy_cof_sum;\n"
+			"\t\treg	signed	[(IWIDTH+2)-1:0]	mpy_dif_sum;\n"
+	"\n"
+			"\t\tassign	mpy_pipe_vc =  mpy_pipe_c[2*(CWIDTH)-1:CWIDTH];\n"
+			"\t\tassign	mpy_pipe_vd =  mpy_pipe_d[2*(IWIDTH+1)-1:IWIDTH+1];\n"
+	"\n"
+			"\t\treg			mpy_pipe_v;\n"
+			"\t\treg			ce_phase;\n"
+	"\n"
+			"\t\treg	signed	[(CWIDTH+IWIDTH+1)-1:0]	mpy_pipe_out;\n"
+			"\t\treg	signed [IWIDTH+CWIDTH+3-1:0]	longmpy;\n"
+	"\n"
+	"\n"
+			"\t\tinitial	ce_phase = 1'b1;\n"
+			"\t\talways @(posedge i_clk)\n"
+			"\t\tif (i_reset)\n"
+				"\t\t\tce_phase <= 1'b1;\n"
+			"\t\telse if (i_ce)\n"
+				"\t\t\tce_phase <= 1'b0;\n"
+			"\t\telse\n"
+				"\t\t\tce_phase <= 1'b1;\n"
+	"\n"
+			"\t\talways @(*)\n"
+				"\t\t\tmpy_pipe_v = (i_ce)||(!ce_phase);\n"
+	"\n"
+			"\t\talways @(posedge i_clk)\n"
+			"\t\tif (!ce_phase)\n"
+			"\t\tbegin\n"
+				"\t\t\t// Pre-clock\n"
+				"\t\t\tmpy_pipe_c[2*CWIDTH-1:0] <=\n"
+					"\t\t\t\t\t{ ir_coef_r, ir_coef_i };\n"
+				"\t\t\tmpy_pipe_d[2*(IWIDTH+1)-1:0] <=\n"
+					"\t\t\t\t\t{ r_dif_r, r_dif_i };\n"
+	"\n"
+				"\t\t\tmpy_cof_sum  <= ir_coef_i + ir_coef_r;\n"
+				"\t\t\tmpy_dif_sum <= r_dif_r + r_dif_i;\n"
+	"\n"
+			"\t\tend else if (i_ce)\n"
+			"\t\tbegin\n"
+				"\t\t\t// First clock\n"
+				"\t\t\tmpy_pipe_c[2*(CWIDTH)-1:0] <= {\n"
+					"\t\t\t\tmpy_pipe_c[(CWIDTH)-1:0], {(CWIDTH){1'b0}} };\n"
+				"\t\t\tmpy_pipe_d[2*(IWIDTH+1)-1:0] <= {\n"
+					"\t\t\t\tmpy_pipe_d[(IWIDTH+1)-1:0], {(IWIDTH+1){1'b0}} };\n"
+			"\t\tend\n\n");
+
+		if (formal_property_flag)
+			fprintf(fp, "`ifndef	FORMAL\n");
 
-	///////////////////////////////////////////
-	///
-	///	Two clocks per CE, so CE, no-ce, CE, no-ce, etc
-	///
-	fprintf(fp,
-	"\tend else if (CKPCE <= 2)\n"
-	"\tbegin : CKPCE_TWO\n"
+		fprintf(fp,
+			"\t\talways @(posedge i_clk)\n"
+			"\t\tif (i_ce) // First clock\n"
+				"\t\t\tlongmpy <= mpy_cof_sum * mpy_dif_sum;\n"
+	"\n"
+			"\t\talways @(posedge i_clk)\n"
+			"\t\tif (mpy_pipe_v)\n"
+				"\t\t\tmpy_pipe_out <= mpy_pipe_vc * mpy_pipe_vd;\n");
+
+		if (formal_property_flag)
+			fprintf(fp, "`else\n"
+			"\t\twire	signed [IWIDTH+CWIDTH+3-1:0]	pre_longmpy;\n"
+			"\t\twire	signed	[(CWIDTH+IWIDTH+1)-1:0]	pre_mpy_pipe_out;\n"
+	"\n"
+			"\t\tabs_mpy	#(CWIDTH+1,IWIDTH+2,1)\n"
+			"\t\t	longmpyi(mpy_cof_sum, mpy_dif_sum, pre_longmpy);\n"
+	"\n"
+			"\t\talways @(posedge i_clk)\n"
+			"\t\tif (i_ce)\n"
+			"\t\t	longmpy <= pre_longmpy;\n"
+	"\n"
+	"\n"
+			"\t\tabs_mpy #(CWIDTH,IWIDTH+1,1)\n"
+			"\t\t	mpy_pipe_outi(mpy_pipe_vc, mpy_pipe_vd, pre_mpy_pipe_out);\n"
+	"\n"
+			"\t\talways @(posedge i_clk)\n"
+			"\t\tif (mpy_pipe_v)\n"
+			"\t\t	mpy_pipe_out <= pre_mpy_pipe_out;\n"
+	"`endif\n");
+
+		fprintf(fp,"\n"
+			"\t\treg\tsigned\t[((IWIDTH+1)+(CWIDTH)-1):0]	rp_one,\n"
+					"\t\t\t\t\t\t\trp2_one, rp_two;\n"
+			"\t\treg\tsigned\t[((IWIDTH+2)+(CWIDTH+1)-1):0]	rp_three;\n"
+	"\n"
+			"\t\talways @(posedge i_clk)\n"
+			"\t\tif (!ce_phase) // 1.5 clock\n"
+				"\t\t\trp_one <= mpy_pipe_out;\n"
+			"\t\talways @(posedge i_clk)\n"
+			"\t\tif (i_ce) // two clocks\n"
+				"\t\t\trp_two <= mpy_pipe_out;\n"
+			"\t\talways @(posedge i_clk)\n"
+			"\t\tif (i_ce) // Second clock\n"
+				"\t\t\trp_three<= longmpy;\n"
+			"\t\talways @(posedge i_clk)\n"
+			"\t\tif (i_ce)\n"
+				"\t\t\trp2_one<= rp_one;\n"
+	"\n"
+			"\t\tassign	p_one  = rp2_one;\n"
+			"\t\tassign	p_two  = rp_two;\n"
+			"\t\tassign	p_three= rp_three;\n"
+	"\n");
+
+		/////////////////////////
+		///
+		///	Three clock per CE, so CE, no-ce, no-ce*, CE
+		///
+		fprintf(fp,
+	"\tend else begin : CKPCE_THREE\n");
+
+		fprintf(fp,
 		"\t\t// Coefficient multiply inputs\n"
-		"\t\treg		[2*(CWIDTH)-1:0]	mpy_pipe_c;\n"
+		"\t\treg\t\t[3*(CWIDTH+1)-1:0]\tmpy_pipe_c;\n"
 		"\t\t// Data multiply inputs\n"
-		"\t\treg		[2*(IWIDTH+1)-1:0]	mpy_pipe_d;\n"
-		"\t\twire	signed	[(CWIDTH-1):0]	mpy_pipe_vc;\n"
-		"\t\twire	signed	[(IWIDTH):0]	mpy_pipe_vd;\n"
-		"\t\t//\n"
-		"\t\treg	signed	[(CWIDTH+1)-1:0]	mpy_cof_sum;\n"
-		"\t\treg	signed	[(IWIDTH+2)-1:0]	mpy_dif_sum;\n"
-"\n"
-		"\t\tassign	mpy_pipe_vc =  mpy_pipe_c[2*(CWIDTH)-1:CWIDTH];\n"
-		"\t\tassign	mpy_pipe_vd =  mpy_pipe_d[2*(IWIDTH+1)-1:IWIDTH+1];\n"
-"\n"
-		"\t\treg			mpy_pipe_v;\n"
-		"\t\treg			ce_phase;\n"
-"\n"
-		"\t\treg	signed	[(CWIDTH+IWIDTH+1)-1:0]	mpy_pipe_out;\n"
-		"\t\treg	signed [IWIDTH+CWIDTH+3-1:0]	longmpy;\n"
-"\n"
-"\n"
-		"\t\tinitial	ce_phase = 1'b1;\n"
+		"\t\treg\t\t[3*(IWIDTH+2)-1:0]\tmpy_pipe_d;\n"
+		"\t\twire\tsigned	[(CWIDTH):0]	mpy_pipe_vc;\n"
+		"\t\twire\tsigned	[(IWIDTH+1):0]	mpy_pipe_vd;\n"
+		"\n"
+		"\t\tassign\tmpy_pipe_vc =  mpy_pipe_c[3*(CWIDTH+1)-1:2*(CWIDTH+1)];\n"
+		"\t\tassign\tmpy_pipe_vd =  mpy_pipe_d[3*(IWIDTH+2)-1:2*(IWIDTH+2)];\n"
+		"\n"
+		"\t\treg\t\t\tmpy_pipe_v;\n"
+		"\t\treg\t\t[2:0]\tce_phase;\n"
+		"\n"
+		"\t\treg\tsigned	[  (CWIDTH+IWIDTH+3)-1:0]	mpy_pipe_out;\n"
+	"\n");
+		fprintf(fp,
+		"\t\tinitial\tce_phase = 3'b011;\n"
 		"\t\talways @(posedge i_clk)\n"
 		"\t\tif (i_reset)\n"
-			"\t\t\tce_phase <= 1'b1;\n"
+			"\t\t\tce_phase <= 3'b011;\n"
 		"\t\telse if (i_ce)\n"
-			"\t\t\tce_phase <= 1'b0;\n"
-		"\t\telse\n"
-			"\t\t\tce_phase <= 1'b1;\n"
-"\n"
+			"\t\t\tce_phase <= 3'b000;\n"
+		"\t\telse if (ce_phase != 3'b011)\n"
+			"\t\t\tce_phase <= ce_phase + 1'b1;\n"
+	"\n"
 		"\t\talways @(*)\n"
-			"\t\t\tmpy_pipe_v = (i_ce)||(!ce_phase);\n"
-"\n"
+			"\t\t\tmpy_pipe_v = (i_ce)||(ce_phase < 3'b010);\n"
+	"\n");
+
+		fprintf(fp,
 		"\t\talways @(posedge i_clk)\n"
-		"\t\tif (!ce_phase)\n"
-		"\t\tbegin\n"
-			"\t\t\t// Pre-clock\n"
-			"\t\t\tmpy_pipe_c[2*CWIDTH-1:0] <=\n"
-				"\t\t\t\t\t{ ir_coef_r, ir_coef_i };\n"
-			"\t\t\tmpy_pipe_d[2*(IWIDTH+1)-1:0] <=\n"
-				"\t\t\t\t\t{ r_dif_r, r_dif_i };\n"
-"\n"
-			"\t\t\tmpy_cof_sum  <= ir_coef_i + ir_coef_r;\n"
-			"\t\t\tmpy_dif_sum <= r_dif_r + r_dif_i;\n"
-"\n"
-		"\t\tend else if (i_ce)\n"
-		"\t\tbegin\n"
-			"\t\t\t// First clock\n"
-			"\t\t\tmpy_pipe_c[2*(CWIDTH)-1:0] <= {\n"
-				"\t\t\t\tmpy_pipe_c[(CWIDTH)-1:0], {(CWIDTH){1'b0}} };\n"
-			"\t\t\tmpy_pipe_d[2*(IWIDTH+1)-1:0] <= {\n"
-				"\t\t\t\tmpy_pipe_d[(IWIDTH+1)-1:0], {(IWIDTH+1){1'b0}} };\n"
-		"\t\tend\n\n");
+			"\t\t\tif (ce_phase == 3\'b000)\n"
+			"\t\t\tbegin\n"
+				"\t\t\t\t// Second clock\n"
+				"\t\t\t\tmpy_pipe_c[3*(CWIDTH+1)-1:(CWIDTH+1)] <= {\n"
+				"\t\t\t\t\tir_coef_r[CWIDTH-1], ir_coef_r,\n"
+				"\t\t\t\t\tir_coef_i[CWIDTH-1], ir_coef_i };\n"
+				"\t\t\t\tmpy_pipe_c[CWIDTH:0] <= ir_coef_i + ir_coef_r;\n"
+				"\t\t\t\tmpy_pipe_d[3*(IWIDTH+2)-1:(IWIDTH+2)] <= {\n"
+				"\t\t\t\t\tr_dif_r[IWIDTH], r_dif_r,\n"
+				"\t\t\t\t\tr_dif_i[IWIDTH], r_dif_i };\n"
+				"\t\t\t\tmpy_pipe_d[(IWIDTH+2)-1:0] <= r_dif_r + r_dif_i;\n"
+	"\n"
+			"\t\t\tend else if (mpy_pipe_v)\n"
+			"\t\t\tbegin\n"
+				"\t\t\t\tmpy_pipe_c[3*(CWIDTH+1)-1:0] <= {\n"
+				"\t\t\t\t\tmpy_pipe_c[2*(CWIDTH+1)-1:0], {(CWIDTH+1){1\'b0}} };\n"
+				"\t\t\t\tmpy_pipe_d[3*(IWIDTH+2)-1:0] <= {\n"
+				"\t\t\t\t\tmpy_pipe_d[2*(IWIDTH+2)-1:0], {(IWIDTH+2){1\'b0}} };\n"
+			"\t\t\tend\n\n");
 
-	if (formal_property_flag)
-		fprintf(fp, "`ifndef	FORMAL\n");
+		if (formal_property_flag)
+			fprintf(fp, "`ifndef\tFORMAL\n");
 
-	fprintf(fp,
-		"\t\talways @(posedge i_clk)\n"
-		"\t\tif (i_ce) // First clock\n"
-			"\t\t\tlongmpy <= mpy_cof_sum * mpy_dif_sum;\n"
-"\n"
+		fprintf(fp,
 		"\t\talways @(posedge i_clk)\n"
-		"\t\tif (mpy_pipe_v)\n"
-			"\t\t\tmpy_pipe_out <= mpy_pipe_vc * mpy_pipe_vd;\n");
+		"\t\t\tif (mpy_pipe_v)\n"
+				"\t\t\t\tmpy_pipe_out <= mpy_pipe_vc * mpy_pipe_vd;\n"
+	"\n");
 
-	if (formal_property_flag)
-		fprintf(fp, "`else\n"
-		"\t\twire	signed [IWIDTH+CWIDTH+3-1:0]	pre_longmpy;\n"
-		"\t\twire	signed	[(CWIDTH+IWIDTH+1)-1:0]	pre_mpy_pipe_out;\n"
-"\n"
-		"\t\tabs_mpy	#(CWIDTH+1,IWIDTH+2,1)\n"
-		"\t\t	longmpyi(mpy_cof_sum, mpy_dif_sum, pre_longmpy);\n"
-"\n"
-		"\t\talways @(posedge i_clk)\n"
-		"\t\tif (i_ce)\n"
-		"\t\t	longmpy <= pre_longmpy;\n"
-"\n"
-"\n"
-		"\t\tabs_mpy #(CWIDTH,IWIDTH+1,1)\n"
-		"\t\t	mpy_pipe_outi(mpy_pipe_vc, mpy_pipe_vd, pre_mpy_pipe_out);\n"
-"\n"
-		"\t\talways @(posedge i_clk)\n"
-		"\t\tif (mpy_pipe_v)\n"
-		"\t\t	mpy_pipe_out <= pre_mpy_pipe_out;\n"
-"`endif\n");
+		if (formal_property_flag)
+			fprintf(fp,
+	"`else\t// FORMAL\n"
+			"\t\twire	signed	[  (CWIDTH+IWIDTH+3)-1:0] pre_mpy_pipe_out;\n"
+	"\n"
+			"\t\tabs_mpy #(CWIDTH+1,IWIDTH+2,1)\n"
+			"\t\t	mpy_pipe_outi(mpy_pipe_vc, mpy_pipe_vd, pre_mpy_pipe_out);\n"
+			"\t\talways @(posedge i_clk)\n"
+			"\t\t	if (mpy_pipe_v)\n"
+			"\t\t		mpy_pipe_out <= pre_mpy_pipe_out;\n"
+	"`endif\t// FORMAL\n\n");
 
-	fprintf(fp,"\n"
-		"\t\treg\tsigned\t[((IWIDTH+1)+(CWIDTH)-1):0]	rp_one,\n"
-				"\t\t\t\t\t\t\trp2_one, rp_two;\n"
-		"\t\treg\tsigned\t[((IWIDTH+2)+(CWIDTH+1)-1):0]	rp_three;\n"
-"\n"
+
+		fprintf(fp,
+		"\t\treg\tsigned\t[((IWIDTH+1)+(CWIDTH)-1):0]\trp_one, rp_two,\n"
+						"\t\t\t\t\t\trp2_one, rp2_two;\n"
+		"\t\treg\tsigned\t[((IWIDTH+2)+(CWIDTH+1)-1):0]\trp_three, rp2_three;\n"
+
+	"\n");
+
+		fprintf(fp,
 		"\t\talways @(posedge i_clk)\n"
-		"\t\tif (!ce_phase) // 1.5 clock\n"
-			"\t\t\trp_one <= mpy_pipe_out;\n"
+		"\t\tif(i_ce)\n"
+			"\t\t\trp_one <= mpy_pipe_out[(CWIDTH+IWIDTH):0];\n"
 		"\t\talways @(posedge i_clk)\n"
-		"\t\tif (i_ce) // two clocks\n"
-			"\t\t\trp_two <= mpy_pipe_out;\n"
+		"\t\tif(ce_phase == 3'b000)\n"
+			"\t\t\trp_two <= mpy_pipe_out[(CWIDTH+IWIDTH):0];\n"
 		"\t\talways @(posedge i_clk)\n"
-		"\t\tif (i_ce) // Second clock\n"
-			"\t\t\trp_three<= longmpy;\n"
+		"\t\tif(ce_phase == 3'b001)\n"
+			"\t\t\trp_three <= mpy_pipe_out;\n"
 		"\t\talways @(posedge i_clk)\n"
 		"\t\tif (i_ce)\n"
+		"\t\tbegin\n"
 			"\t\t\trp2_one<= rp_one;\n"
-"\n"
-		"\t\tassign	p_one  = rp2_one;\n"
-		"\t\tassign	p_two  = rp_two;\n"
-		"\t\tassign	p_three= rp_three;\n"
-"\n");
-
-	/////////////////////////
-	///
-	///	Three clock per CE, so CE, no-ce, no-ce*, CE
-	///
-	fprintf(fp,
-"\tend else if (CKPCE <= 2'b11)\n\tbegin : CKPCE_THREE\n");
-
-	fprintf(fp,
-	"\t\t// Coefficient multiply inputs\n"
-	"\t\treg\t\t[3*(CWIDTH+1)-1:0]\tmpy_pipe_c;\n"
-	"\t\t// Data multiply inputs\n"
-	"\t\treg\t\t[3*(IWIDTH+2)-1:0]\tmpy_pipe_d;\n"
-	"\t\twire\tsigned	[(CWIDTH):0]	mpy_pipe_vc;\n"
-	"\t\twire\tsigned	[(IWIDTH+1):0]	mpy_pipe_vd;\n"
-	"\n"
-	"\t\tassign\tmpy_pipe_vc =  mpy_pipe_c[3*(CWIDTH+1)-1:2*(CWIDTH+1)];\n"
-	"\t\tassign\tmpy_pipe_vd =  mpy_pipe_d[3*(IWIDTH+2)-1:2*(IWIDTH+2)];\n"
-	"\n"
-	"\t\treg\t\t\tmpy_pipe_v;\n"
-	"\t\treg\t\t[2:0]\tce_phase;\n"
-	"\n"
-	"\t\treg\tsigned	[  (CWIDTH+IWIDTH+3)-1:0]	mpy_pipe_out;\n"
-"\n");
-	fprintf(fp,
-	"\t\tinitial\tce_phase = 3'b011;\n"
-	"\t\talways @(posedge i_clk)\n"
-	"\t\tif (i_reset)\n"
-		"\t\t\tce_phase <= 3'b011;\n"
-	"\t\telse if (i_ce)\n"
-		"\t\t\tce_phase <= 3'b000;\n"
-	"\t\telse if (ce_phase != 3'b011)\n"
-		"\t\t\tce_phase <= ce_phase + 1'b1;\n"
-"\n"
-	"\t\talways @(*)\n"
-		"\t\t\tmpy_pipe_v = (i_ce)||(ce_phase < 3'b010);\n"
-"\n");
-
-	fprintf(fp,
-	"\t\talways @(posedge i_clk)\n"
-		"\t\t\tif (ce_phase == 3\'b000)\n"
-		"\t\t\tbegin\n"
-			"\t\t\t\t// Second clock\n"
-			"\t\t\t\tmpy_pipe_c[3*(CWIDTH+1)-1:(CWIDTH+1)] <= {\n"
-			"\t\t\t\t\tir_coef_r[CWIDTH-1], ir_coef_r,\n"
-			"\t\t\t\t\tir_coef_i[CWIDTH-1], ir_coef_i };\n"
-			"\t\t\t\tmpy_pipe_c[CWIDTH:0] <= ir_coef_i + ir_coef_r;\n"
-			"\t\t\t\tmpy_pipe_d[3*(IWIDTH+2)-1:(IWIDTH+2)] <= {\n"
-			"\t\t\t\t\tr_dif_r[IWIDTH], r_dif_r,\n"
-			"\t\t\t\t\tr_dif_i[IWIDTH], r_dif_i };\n"
-			"\t\t\t\tmpy_pipe_d[(IWIDTH+2)-1:0] <= r_dif_r + r_dif_i;\n"
-"\n"
-		"\t\t\tend else if (mpy_pipe_v)\n"
-		"\t\t\tbegin\n"
-			"\t\t\t\tmpy_pipe_c[3*(CWIDTH+1)-1:0] <= {\n"
-			"\t\t\t\t\tmpy_pipe_c[2*(CWIDTH+1)-1:0], {(CWIDTH+1){1\'b0}} };\n"
-			"\t\t\t\tmpy_pipe_d[3*(IWIDTH+2)-1:0] <= {\n"
-			"\t\t\t\t\tmpy_pipe_d[2*(IWIDTH+2)-1:0], {(IWIDTH+2){1\'b0}} };\n"
-		"\t\t\tend\n\n");
-
-	if (formal_property_flag)
-		fprintf(fp, "`ifndef\tFORMAL\n");
-
-	fprintf(fp,
-	"\t\talways @(posedge i_clk)\n"
-	"\t\t\tif (mpy_pipe_v)\n"
-			"\t\t\t\tmpy_pipe_out <= mpy_pipe_vc * mpy_pipe_vd;\n"
-"\n");
-
-	if (formal_property_flag)
+			"\t\t\trp2_two<= rp_two;\n"
+			"\t\t\trp2_three<= rp_three;\n"
+		"\t\tend\n");
 		fprintf(fp,
-"`else\t// FORMAL\n"
-		"\t\twire	signed	[  (CWIDTH+IWIDTH+3)-1:0] pre_mpy_pipe_out;\n"
-"\n"
-		"\t\tabs_mpy #(CWIDTH+1,IWIDTH+2,1)\n"
-		"\t\t	mpy_pipe_outi(mpy_pipe_vc, mpy_pipe_vd, pre_mpy_pipe_out);\n"
-		"\t\talways @(posedge i_clk)\n"
-		"\t\t	if (mpy_pipe_v)\n"
-		"\t\t		mpy_pipe_out <= pre_mpy_pipe_out;\n"
-"`endif\t// FORMAL\n\n");
-
-
-	fprintf(fp,
-	"\t\treg\tsigned\t[((IWIDTH+1)+(CWIDTH)-1):0]\trp_one, rp_two,\n"
-					"\t\t\t\t\t\trp2_one, rp2_two;\n"
-	"\t\treg\tsigned\t[((IWIDTH+2)+(CWIDTH+1)-1):0]\trp_three, rp2_three;\n"
-
-"\n");
-
-	fprintf(fp,
-	"\t\talways @(posedge i_clk)\n"
-	"\t\tif(i_ce)\n"
-		"\t\t\trp_one <= mpy_pipe_out[(CWIDTH+IWIDTH):0];\n"
-	"\t\talways @(posedge i_clk)\n"
-	"\t\tif(ce_phase == 3'b000)\n"
-		"\t\t\trp_two <= mpy_pipe_out[(CWIDTH+IWIDTH):0];\n"
-	"\t\talways @(posedge i_clk)\n"
-	"\t\tif(ce_phase == 3'b001)\n"
-		"\t\t\trp_three <= mpy_pipe_out;\n"
-	"\t\talways @(posedge i_clk)\n"
-	"\t\tif (i_ce)\n"
-	"\t\tbegin\n"
-		"\t\t\trp2_one<= rp_one;\n"
-		"\t\t\trp2_two<= rp_two;\n"
-		"\t\t\trp2_three<= rp_three;\n"
-	"\t\tend\n");
-	fprintf(fp,
-	"\t\tassign	p_one\t= rp2_one;\n"
-	"\t\tassign	p_two\t= rp2_two;\n"
-	"\t\tassign\tp_three\t= rp2_three;\n"
-"\n");
+		"\t\tassign	p_one\t= rp2_one;\n"
+		"\t\tassign	p_two\t= rp2_two;\n"
+		"\t\tassign\tp_three\t= rp2_three;\n"
+	"\n");
 
-	fprintf(fp,
-"\tend endgenerate\n");
+		fprintf(fp,
+	"\tend endgenerate\n");
+	}
 
 	fprintf(fp,
 	"\twire\tsigned	[((IWIDTH+2)+(CWIDTH+1)-1):0]	w_one, w_two;\n"
@@ -1817,19 +1872,19 @@ SLASHLINE
 	"\t// Round the results\n"
 	"\twire\tsigned\t[(OWIDTH-1):0]\trnd_left_r, rnd_left_i, rnd_right_r, rnd_right_i;\n\n");
 	fprintf(fp,
-	"\t%s #(CWIDTH+IWIDTH+1,OWIDTH,SHIFT+2) do_rnd_left_r(i_clk, i_ce,\n"
+	"\t%s #(CWIDTH+IWIDTH+1,OWIDTH,SHIFT+2%s) do_rnd_left_r(i_clk, i_ce,\n"
 	"\t\t\t\tleft_sr, rnd_left_r);\n\n",
-		rnd_string);
+		rnd_string, rnd_parm);
 	fprintf(fp,
-	"\t%s #(CWIDTH+IWIDTH+1,OWIDTH,SHIFT+2) do_rnd_left_i(i_clk, i_ce,\n"
+	"\t%s #(CWIDTH+IWIDTH+1,OWIDTH,SHIFT+2%s) do_rnd_left_i(i_clk, i_ce,\n"
 	"\t\t\t\tleft_si, rnd_left_i);\n\n",
-		rnd_string);
+		rnd_string, rnd_parm);
 	fprintf(fp,
-	"\t%s #(CWIDTH+IWIDTH+3,OWIDTH,SHIFT+4) do_rnd_right_r(i_clk, i_ce,\n"
-	"\t\t\t\tmpy_r, rnd_right_r);\n\n", rnd_string);
+	"\t%s #(CWIDTH+IWIDTH+3,OWIDTH,SHIFT+4%s) do_rnd_right_r(i_clk, i_ce,\n"
+	"\t\t\t\tmpy_r, rnd_right_r);\n\n", rnd_string, rnd_parm);
 	fprintf(fp,
-	"\t%s #(CWIDTH+IWIDTH+3,OWIDTH,SHIFT+4) do_rnd_right_i(i_clk, i_ce,\n"
-	"\t\t\t\tmpy_i, rnd_right_i);\n\n", rnd_string);
+	"\t%s #(CWIDTH+IWIDTH+3,OWIDTH,SHIFT+4%s) do_rnd_right_i(i_clk, i_ce,\n"
+	"\t\t\t\tmpy_i, rnd_right_i);\n\n", rnd_string, rnd_parm);
 
 
 	fprintf(fp,
@@ -1902,7 +1957,7 @@ SLASHLINE
 		"\t\tassert property (@(posedge i_clk)\n"
 		"\t\t	i_ce |=> !i_ce);\n"
 	"\n"
-	"\tend else if (CKPCE == 3)\n"
+	"\tend else if (CKPCE >= 3)\n"
 	"\tbegin : F_CKPCE_THREE\n"
 "\n"
 		"\t\tassert property (@(posedge i_clk)\n"
@@ -1929,7 +1984,7 @@ SLASHLINE
 		"\t\t	if ($past(i_ce))\n"
 		"\t\t		assume(!i_ce);\n"
 	"\n"
-	"\tend else if (CKPCE == 3)\n"
+	"\tend else if (CKPCE >= 3)\n"
 	"\tbegin : F_CKPCE_THREE\n"
 "\n"
 		"\t\talways @(posedge i_clk)\n"
@@ -2094,3 +2149,117 @@ SLASHLINE
 
 	fclose(fp);
 }
+
+void	build_mpyshare(const char *fname, const bool async_reset) {
+	FILE	*fp = fopen(fname, "w");
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return;
+	}
+
+	std::string	resetw("i_reset"), always_reset;
+	if (async_reset) {
+		resetw = std::string("i_areset_n");
+		always_reset = std::string("\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	} else
+		always_reset = std::string("\talways @(posedge i_clk)\n\tif (i_reset)\n");
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\tmpyshare.v\n"
+"//\n"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:\tOne hardware multiply, shared by the butterflies of two\n"
+"//		adjacent FFT stages.  Each hwbfly needs three products per\n"
+"//	i_ce.  Given eight or more clocks per i_ce, one multiply can find all\n"
+"//	six of them: the A butterfly\'s on the first three clocks following\n"
+"//	i_ce, and the B butterfly\'s on the next three.\n"
+"//\n"
+"//	The operands of each butterfly, i_ac and i_ad or i_bc and i_bd,\n"
+"//	must be held from one i_ce to the next.  Each holds three values,\n"
+"//	the first in its top bits.  Their products are returned on o_ap and\n"
+"//	o_bp before that next i_ce.  The operands are registered on the way\n"
+"//	into the multiply, and the products on the way out, so the last\n"
+"//	of them is ready seven clocks after i_ce.\n"
+"//\n"
+"//	Should a stage have no partner, its B inputs may be tied to zero.\n"
+"//\n%s"
+"//\n", prjname, creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+
+	fprintf(fp,
+"module\tmpyshare(i_clk, %s, i_ce, i_ac, i_ad, o_ap, i_bc, i_bd, o_bp);\n"
+	"\t// The widths of each butterfly\'s coefficient (C) and data (D)\n"
+	"\t// operands\n"
+	"\tparameter\tACW=21, ADW=18, BCW=21, BDW=18;\n"
+	"\tlocalparam\tCW = (ACW > BCW) ? ACW : BCW,\n"
+			"\t\t\tDW = (ADW > BDW) ? ADW : BDW,\n"
+			"\t\t\tAPW = ACW+ADW, BPW = BCW+BDW;\n"
+	"\t//\n"
+	"\tinput\twire\t\t\ti_clk, %s, i_ce;\n"
+	"\tinput\twire\t[3*ACW-1:0]\ti_ac;\n"
+	"\tinput\twire\t[3*ADW-1:0]\ti_ad;\n"
+	"\toutput\treg\t[3*APW-1:0]\to_ap;\n"
+	"\tinput\twire\t[3*BCW-1:0]\ti_bc;\n"
+	"\tinput\twire\t[3*BDW-1:0]\ti_bd;\n"
+	"\toutput\treg\t[3*BPW-1:0]\to_bp;\n"
+"\n"
+	"\treg\t\t[2:0]\t\tphase;\n"
+	"\twire\tsigned\t[ACW-1:0]\tac0, ac1, ac2;\n"
+	"\twire\tsigned\t[ADW-1:0]\tad0, ad1, ad2;\n"
+	"\twire\tsigned\t[BCW-1:0]\tbc0, bc1, bc2;\n"
+	"\twire\tsigned\t[BDW-1:0]\tbd0, bd1, bd2;\n"
+	"\treg\tsigned\t[CW-1:0]\tmpy_c;\n"
+	"\treg\tsigned\t[DW-1:0]\tmpy_d;\n"
+	"\twire\tsigned\t[CW+DW-1:0]\tproduct;\n"
+"\n"
+	"\t// Count the clocks since the last i_ce, stopping at seven\n"
+	"\tinitial\tphase = 3\'b111;\n"
+	"%s"
+	"\t\tphase <= 3\'b111;\n"
+	"\telse if (i_ce)\n"
+	"\t\tphase <= 3\'b000;\n"
+	"\telse if (phase != 3\'b111)\n"
+	"\t\tphase <= phase + 1\'b1;\n"
+"\n"
+	"\tassign\t{ ac0, ac1, ac2 } = i_ac;\n"
+	"\tassign\t{ ad0, ad1, ad2 } = i_ad;\n"
+	"\tassign\t{ bc0, bc1, bc2 } = i_bc;\n"
+	"\tassign\t{ bd0, bd1, bd2 } = i_bd;\n"
+"\n"
+	"\t// Pick this clock\'s operands, sign extending them to the wider of\n"
+	"\t// the two butterflies\n"
+	"\talways @(posedge i_clk)\n"
+	"\tcase(phase)\n"
+	"\t3\'d0: begin mpy_c <= ac0; mpy_d <= ad0; end\n"
+	"\t3\'d1: begin mpy_c <= ac1; mpy_d <= ad1; end\n"
+	"\t3\'d2: begin mpy_c <= ac2; mpy_d <= ad2; end\n"
+	"\t3\'d3: begin mpy_c <= bc0; mpy_d <= bd0; end\n"
+	"\t3\'d4: begin mpy_c <= bc1; mpy_d <= bd1; end\n"
+	"\t3\'d5: begin mpy_c <= bc2; mpy_d <= bd2; end\n"
+	"\tdefault: begin end\n"
+	"\tendcase\n"
+"\n"
+	"\tassign\tproduct = mpy_c * mpy_d;\n"
+"\n"
+	"\t// Each product fits within the width of its own operands\n"
+	"\talways @(posedge i_clk)\n"
+	"\tcase(phase)\n"
+	"\t3\'d1: o_ap[(3*APW-1):(2*APW)] <= product[(APW-1):0];\n"
+	"\t3\'d2: o_ap[(2*APW-1):APW]     <= product[(APW-1):0];\n"
+	"\t3\'d3: o_ap[(APW-1):0]         <= product[(APW-1):0];\n"
+	"\t3\'d4: o_bp[(3*BPW-1):(2*BPW)] <= product[(BPW-1):0];\n"
+	"\t3\'d5: o_bp[(2*BPW-1):BPW]     <= product[(BPW-1):0];\n"
+	"\t3\'d6: o_bp[(BPW-1):0]         <= product[(BPW-1):0];\n"
+	"\tdefault: begin end\n"
+	"\tendcase\n"
+"\n"
+"endmodule\n",
+		resetw.c_str(), resetw.c_str(), always_reset.c_str());
+
+	fclose(fp);
+}
@@ -40,9 +40,14 @@
 
 extern	void	build_butterfly(const char *fname, int xtracbits,
 			ROUND_T rounding, int ckpce = 1,
-			const bool async_reset = false);
+			const bool async_reset = false,
+			const bool rndsel = false);
 
 extern	void	build_hwbfly(const char *fname, int xtracbits, ROUND_T rounding,
-		int ckpce = 3, const bool async_reset= false);
+		int ckpce = 3, const bool async_reset= false,
+		const bool rndsel = false, const bool extmpy = false);
+
+extern	void	build_mpyshare(const char *fname,
+			const bool async_reset = false);
 
 #endif
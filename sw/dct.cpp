@@ -0,0 +1,781 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	dct.cpp
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Generates streaming DCT cores around an N/2 point complex FFT,
+//		along with the twiddle tables they need.  Each core takes
+//	N real samples per frame, one per i_ce, and produces N real
+//	coefficients per frame in natural order.
+//
+//	DCT-IV:	The FFT is given (x[2n] + j x[N-1-2n]) exp(-j pi(4n+1)/4N).
+//		Each of its bins, times exp(-j pi k/N), holds X[2k] in its
+//		real part, and -X[N-1-2k] in its imaginary part.
+//
+//	MDCT:	Each block of N new samples is folded with the prior block
+//		into N values, whose DCT-IV is the MDCT of the 2N sample
+//		window spanning both blocks.
+//
+//	DCT-II:	The samples are reordered as even samples followed by the
+//		odd ones in reverse, and pairs of these packed into one
+//		complex value.  The spectrum of this real sequence is then
+//		recovered from bins k and N/2-k of the FFT, as in dualreal.v,
+//		and rotated by exp(-j pi k/2N) to produce X[k] and X[N-k].
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+#define _CRT_SECURE_NO_WARNINGS   //  ms vs 2012 doesn't like fopen
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _MSC_VER //  added for ms vs compatibility
+
+#include <io.h>
+#include <direct.h>
+#define _USE_MATH_DEFINES
+#else
+// And for G++/Linux environment
+
+#include <unistd.h>	// Defines the R_OK/W_OK/etc. macros
+#include <sys/stat.h>
+#endif
+
+#include <string.h>
+#include <string>
+#include <math.h>
+#include <ctype.h>
+#include <assert.h>
+
+#include "defaults.h"
+#include "legal.h"
+#include "fftlib.h"
+
+#include "dct.h"
+
+bool	parse_dct(const char *str, DCT_T &dct) {
+	if ((strcasecmp(str, "dct2")==0)||(strcasecmp(str, "dct-ii")==0))
+		dct = DCT_II;
+	else if ((strcasecmp(str, "dct4")==0)||(strcasecmp(str, "dct-iv")==0))
+		dct = DCT_IV;
+	else if (strcasecmp(str, "mdct")==0)
+		dct = DCT_MDCT;
+	else
+		return false;
+	return true;
+}
+
+const char *dct_name(DCT_T dct) {
+	switch(dct) {
+	case DCT_II:	return "dct2";
+	case DCT_IV:	return "dct4";
+	case DCT_MDCT:	return "mdct";
+	default:	return "none";
+	}
+}
+
+std::string	gen_dct_fname(const char *coredir, const char *tbl,
+			int lgsize) {
+	std::string	result;
+	char	*memfile;
+
+	memfile = new char[strlen(coredir)+strlen(tbl)+64];
+	if (coredir[0] == '\0')
+		sprintf(memfile, "%s_%d.hex", tbl, 1<<lgsize);
+	else
+		sprintf(memfile, "%s/%s_%d.hex", coredir, tbl, 1<<lgsize);
+	result = std::string(memfile);
+	delete[] memfile;
+	return result;
+}
+
+//
+// Writes one twiddle, exp(j phase[k]), per line, in the same format as the
+// FFT's own coefficient files
+//
+static	void	gen_phase_table(const char *fname, const double *phase,
+			int nentries, int cbits) {
+	FILE	*fp = fopen(fname, "w");
+	double	radius = (double)(1ll<<(cbits-2));
+
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return;
+	}
+
+	for(int k=0; k<nentries; k++) {
+		long long ic, is, vl;
+
+		ic = (long long)llround(radius * cos(phase[k]));
+		is = (long long)llround(radius * sin(phase[k]));
+		vl = (ic & (~(-1ll << (cbits))));
+		vl <<= (cbits);
+		vl |= (is & (~(-1ll << (cbits))));
+		fprintf(fp, "%0*llx\n", ((cbits*2+3)/4), vl);
+	}
+
+	fclose(fp);
+}
+
+void	gen_dct_twiddles(const char *coredir, DCT_T dct, int lgsize,
+		int cbits) {
+	std::string	fname;
+	int		npts = 1<<lgsize, nhalf = npts/2;
+	double		*phase = new double[npts], *phb = new double[npts];
+
+	assert(2*cbits < 64);
+
+	if (dct == DCT_II) {
+		//
+		// Entry 2k+s produces X[k] (s=0) or X[N-k] (s=1), as the
+		// real part of A[k] W^k + B[k] W^5k, where W = exp(-j pi/2N).
+		// Multiplying both by j makes that the negative imaginary
+		// part instead.  X[N/2] comes from k = 0, using W^(N/2).
+		//
+		for(int k=0; k<nhalf; k++) {
+			double	w = -M_PI / (2.0 * npts);
+
+			phase[2*k]   = w * k;
+			phb[2*k]     = w * 5 * k;
+			if (k == 0) {
+				phase[1] = w * nhalf;
+				phb[1]   = w * 5 * nhalf;
+			} else {
+				phase[2*k+1] = w * k     + M_PI/2.0;
+				phb[2*k+1]   = w * 5 * k + M_PI/2.0;
+			}
+		}
+
+		fname = gen_dct_fname(coredir, "dct2twa", lgsize);
+		gen_phase_table(fname.c_str(), phase, npts, cbits);
+		fname = gen_dct_fname(coredir, "dct2twb", lgsize);
+		gen_phase_table(fname.c_str(), phb, npts, cbits);
+	} else {
+		for(int n=0; n<nhalf; n++)
+			phase[n] = -M_PI * (4*n+1) / (4.0 * npts);
+		fname = gen_dct_fname(coredir, "dctpre", lgsize);
+		gen_phase_table(fname.c_str(), phase, nhalf, cbits);
+
+		// Entry 2k+s produces X[2k] (s=0) or X[N-1-2k] (s=1)
+		for(int k=0; k<nhalf; k++) {
+			phase[2*k]   = -M_PI * k / (double)npts;
+			phase[2*k+1] = -M_PI * k / (double)npts + M_PI/2.0;
+		}
+		fname = gen_dct_fname(coredir, "dct4tw", lgsize);
+		gen_phase_table(fname.c_str(), phase, npts, cbits);
+	}
+
+	delete[] phase;
+	delete[] phb;
+}
+
+void	build_dct(const char *fname, DCT_T dct, int lgsize, int iw, int fiw,
+		int ow, int cw, ROUND_T rounding, const bool async_reset) {
+	FILE	*fp = fopen(fname, "w");
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return;
+	}
+
+	assert(dct != DCT_NONE);
+	assert(lgsize >= 4);
+
+	std::string	resetw("i_reset"), always_reset;
+	if (async_reset) {
+		resetw = std::string("i_areset_n");
+		always_reset = std::string("\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	} else
+		always_reset = std::string("\talways @(posedge i_clk)\n\tif (i_reset)\n");
+
+	const	char	*rnd_string = rnd_module(rounding),
+			*name = dct_name(dct);
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\t%s.v\n"
+"//\n"
+"// Project:\t%s\n"
+"//\n", name, prjname);
+
+	if (dct == DCT_II)
+		fprintf(fp,
+"// Purpose:\tA streaming %d point DCT-II,\n"
+"//\n"
+"//	X[k] = SUM x[n] cos(pi k (2n+1) / 2N),\n"
+"//\n"
+"//		using a %d point FFT.  The samples are reordered, as\n"
+"//	v[n] = x[2n] and v[N-1-n] = x[2n+1], and packed two to a complex\n"
+"//	value.  The spectrum V[k] of v[n] is then separated from the FFT\'s\n"
+"//	bins k and N/2-k, and rotated by exp(-j pi k/2N) to produce X[k] in\n"
+"//	its real part and -X[N-k] in its imaginary part.\n"
+"//\n", 1<<lgsize, 1<<(lgsize-1));
+	else if (dct == DCT_IV)
+		fprintf(fp,
+"// Purpose:\tA streaming %d point DCT-IV,\n"
+"//\n"
+"//	X[k] = SUM x[n] cos(pi (n+1/2) (k+1/2) / N),\n"
+"//\n"
+"//		using a %d point FFT.  The FFT is given\n"
+"//	(x[2n] + j x[N-1-2n]) exp(-j pi (4n+1)/4N), and each of its bins\n"
+"//	rotated by exp(-j pi k/N) to produce X[2k] in its real part and\n"
+"//	-X[N-1-2k] in its imaginary part.\n"
+"//\n", 1<<lgsize, 1<<(lgsize-1));
+	else
+		fprintf(fp,
+"// Purpose:\tA streaming MDCT, producing %d coefficients from each\n"
+"//		window of %d samples,\n"
+"//\n"
+"//	X[k] = SUM x[n] cos(pi (n+1/2+N/2) (k+1/2) / N),\n"
+"//\n"
+"//	with windows overlapping by half.  Each block of N new samples is\n"
+"//	folded with the block before it into N values, whose DCT-IV is the\n"
+"//	MDCT of both blocks.  The DCT-IV uses a %d point FFT.  Any window\n"
+"//	function must be applied to the samples before they arrive.\n"
+"//\n", 1<<lgsize, 2<<lgsize, 1<<(lgsize-1));
+
+	fprintf(fp,
+"//	Samples arrive one per i_ce, and the coefficients of each frame are\n"
+"//	produced in natural order, one per i_ce, with o_sync set alongside\n"
+"//	X[0].\n"
+"//\n%s"
+"//\n", creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+
+	fprintf(fp,
+"module\t%s(i_clk, %s, i_ce, i_sample, o_result, o_sync);\n"
+	"\tlocalparam\tIW=%d, FIW=%d, OW=%d, CW=%d, LGSIZE=%d;\n"
+	"\tlocalparam\tUW=%s, XW=OW+1;\n",
+		name, resetw.c_str(), iw, fiw, ow, cw, lgsize,
+		(dct == DCT_MDCT) ? "IW+1" : "IW");
+	if (dct == DCT_II)
+		fprintf(fp,
+	"\tparameter\tTWAFILE=\"dct2twa_%d.hex\";\n"
+	"\tparameter\tTWBFILE=\"dct2twb_%d.hex\";\n",
+			1<<lgsize, 1<<lgsize);
+	else
+		fprintf(fp,
+	"\tparameter\tPREFILE=\"dctpre_%d.hex\";\n"
+	"\tparameter\tTWAFILE=\"dct4tw_%d.hex\";\n",
+			1<<lgsize, 1<<lgsize);
+	fprintf(fp,
+	"\t//\n"
+	"\tinput\twire\t\t\ti_clk, %s, i_ce;\n"
+	"\tinput\twire\tsigned\t[(IW-1):0]\ti_sample;\n"
+	"\toutput\treg\tsigned\t[(XW-1):0]\to_result;\n"
+	"\toutput\treg\t\t\to_sync;\n"
+"\n", resetw.c_str());
+
+	//
+	// Input frames
+	//
+	fprintf(fp,
+	"\t//\n"
+	"\t// Capture each frame\n"
+	"\t//\n"
+	"\treg\t[LGSIZE:0]\twraddr;\n"
+	"\twire\t\t\tw_frame, w_fbank;\n"
+"\n"
+	"\tinitial\twraddr = 0;\n"
+	"%s"
+	"\t\twraddr <= 0;\n"
+	"\telse if (i_ce)\n"
+	"\t\twraddr <= wraddr + 1\'b1;\n"
+"\n", always_reset.c_str());
+
+	if (dct == DCT_MDCT) {
+		fprintf(fp,
+	"\t// Each block is folded as it arrives.  Sample N/2+j is paired\n"
+	"\t// with sample N/2-1-j from the first half of the block.  Minus\n"
+	"\t// their sum is value j of this frame, and their difference is\n"
+	"\t// value N-1-j of the next frame.\n"
+	"\treg\tsigned\t[(IW-1):0]\thmem\t[0:((1<<(LGSIZE-1))-1)];\n"
+	"\treg\tsigned\t[(UW-1):0]\tdmem\t[0:((1<<(LGSIZE-1))-1)];\n"
+	"\treg\tsigned\t[(UW-1):0]\tlomem\t[0:((1<<LGSIZE)-1)];\n"
+	"\treg\tsigned\t[(UW-1):0]\thimem\t[0:((1<<LGSIZE)-1)];\n"
+	"\treg\tsigned\t[(IW-1):0]\tfd_h, fd_x;\n"
+	"\treg\tsigned\t[(UW-1):0]\tfd_d;\n"
+	"\treg\t[(LGSIZE-2):0]\tfd_j;\n"
+	"\treg\t\t\tfd_bank, fd_valid;\n"
+	"\twire\t[(LGSIZE-2):0]\tw_j;\n"
+	"\twire\tsigned\t[UW:0]\t\tw_nsum;\n"
+	"\twire\tsigned\t[(UW-1):0]\tw_diff;\n"
+"\n"
+	"\tassign\tw_j = wraddr[(LGSIZE-2):0];\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif ((i_ce)&&(!wraddr[LGSIZE-1]))\n"
+	"\t\thmem[w_j] <= i_sample;\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+	"\t\tfd_h <= hmem[~w_j];\n"
+	"\t\tfd_d <= dmem[~w_j];\n"
+	"\t\tfd_x <= i_sample;\n"
+	"\t\tfd_j <= w_j;\n"
+	"\t\tfd_bank <= wraddr[LGSIZE];\n"
+	"\tend\n"
+"\n"
+	"\tinitial\tfd_valid = 1\'b0;\n"
+	"%s"
+	"\t\tfd_valid <= 1\'b0;\n"
+	"\telse if (i_ce)\n"
+	"\t\tfd_valid <= wraddr[LGSIZE-1];\n"
+"\n"
+	"\t// Only minus the sum of two most negative values can overflow\n"
+	"\tassign\tw_nsum = - fd_h - fd_x;\n"
+	"\tassign\tw_diff = fd_h - fd_x;\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif ((i_ce)&&(fd_valid))\n"
+	"\tbegin\n"
+	"\t\tlomem[{ fd_bank, fd_j }] <= (w_nsum[UW:(UW-1)] == 2\'b01)\n"
+	"\t\t\t\t? { 1\'b0, {(UW-1){1\'b1}} } : w_nsum[(UW-1):0];\n"
+	"\t\thimem[{ fd_bank, ~fd_j }] <= fd_d;\n"
+	"\t\tdmem[~fd_j] <= w_diff;\n"
+	"\tend\n"
+"\n"
+	"\tassign\tw_frame = (i_ce)&&(fd_valid)&&(&fd_j);\n"
+	"\tassign\tw_fbank = fd_bank;\n"
+"\n", always_reset.c_str());
+	} else {
+		fprintf(fp,
+	"\treg\tsigned\t[(IW-1):0]\txmem\t[0:((1<<(LGSIZE+1))-1)];\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\t\txmem[wraddr] <= i_sample;\n"
+"\n"
+	"\tassign\tw_frame = (i_ce)&&(&wraddr[(LGSIZE-1):0]);\n"
+	"\tassign\tw_fbank = wraddr[LGSIZE];\n"
+"\n");
+	}
+
+	//
+	// Feed the FFT
+	//
+	fprintf(fp,
+	"\t//\n"
+	"\t// Read each completed frame back out as N/2 complex values,\n"
+	"\t// their real parts on even i_ce\'s and imaginary parts on odd\n"
+	"\t//\n"
+	"\treg\t\t\tfeeding, rdbank, rd_valid, rd_slot;\n"
+	"\treg\t[(LGSIZE-1):0]\trdcnt;\n"
+	"%s"
+	"\twire\t[(LGSIZE-1):0]\trdaddr;\n"
+	"\treg\tsigned\t[(UW-1):0]\trd_data;\n"
+"\n"
+	"\tinitial\tfeeding = 1\'b0;\n"
+	"%s"
+	"\t\tfeeding <= 1\'b0;\n"
+	"\telse if (w_frame)\n"
+	"\t\tfeeding <= 1\'b1;\n"
+"\n"
+	"\tinitial\trdbank = 1\'b0;\n"
+	"\tinitial\trdcnt  = 0;\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (w_frame)\n"
+	"\tbegin\n"
+	"\t\trdbank <= w_fbank;\n"
+	"\t\trdcnt  <= 0;\n"
+	"\tend else if (i_ce)\n"
+	"\t\trdcnt  <= rdcnt + 1\'b1;\n"
+"\n", (dct == DCT_II) ? "" : "\treg\t[(LGSIZE-2):0]\trd_n;\n",
+		always_reset.c_str());
+
+	if (dct == DCT_II)
+		fprintf(fp,
+	"\t// v[2m] and v[2m+1], where v[n] = x[2n] and v[N-1-n] = x[2n+1]\n"
+	"\tassign\trdaddr = (rdcnt[LGSIZE-1]) ? ~{ rdcnt[(LGSIZE-2):0], 1\'b0 }\n"
+	"\t\t\t\t: { rdcnt[(LGSIZE-2):0], 1\'b0 };\n"
+"\n");
+	else
+		fprintf(fp,
+	"\t// u[2n] and u[N-1-2n]\n"
+	"\tassign\trdaddr = (rdcnt[0]) ? ~{ rdcnt[(LGSIZE-1):1], 1\'b0 }\n"
+	"\t\t\t\t: { rdcnt[(LGSIZE-1):1], 1\'b0 };\n"
+"\n");
+
+	fprintf(fp,
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n");
+	if (dct == DCT_MDCT)
+		fprintf(fp,
+	"\t\tif (rdaddr[LGSIZE-1])\n"
+	"\t\t\trd_data <= himem[{ rdbank, rdaddr[(LGSIZE-2):0] }];\n"
+	"\t\telse\n"
+	"\t\t\trd_data <= lomem[{ rdbank, rdaddr[(LGSIZE-2):0] }];\n");
+	else
+		fprintf(fp,
+	"\t\trd_data <= xmem[{ rdbank, rdaddr }];\n");
+	fprintf(fp,
+	"\t\trd_slot <= rdcnt[0];\n");
+	if (dct != DCT_II)
+		fprintf(fp,
+	"\t\trd_n    <= rdcnt[(LGSIZE-1):1];\n");
+	fprintf(fp,
+	"\tend\n"
+"\n"
+	"\tinitial\trd_valid = 1\'b0;\n"
+	"%s"
+	"\t\trd_valid <= 1\'b0;\n"
+	"\telse if (i_ce)\n"
+	"\t\trd_valid <= feeding;\n"
+"\n"
+	"\treg\tsigned\t[(UW-1):0]\tc_r, c_i;\n"
+	"\treg\t\t\tc_valid;\n"
+	"\twire\t\t\tw_fftce;\n"
+	"\twire\t[(2*FIW-1):0]\tw_fftin;\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+	"\t\tif (!rd_slot)\n"
+	"\t\t\tc_r <= rd_data;\n"
+	"\t\telse\n"
+	"\t\t\tc_i <= rd_data;\n"
+	"\tend\n"
+"\n"
+	"\tinitial\tc_valid = 1\'b0;\n"
+	"%s"
+	"\t\tc_valid <= 1\'b0;\n"
+	"\telse if (i_ce)\n"
+	"\t\tc_valid <= (rd_valid)&&(rd_slot);\n"
+"\n", always_reset.c_str(), always_reset.c_str());
+
+	if (dct == DCT_II) {
+		fprintf(fp,
+	"\tassign\tw_fftce = (i_ce)&&(c_valid);\n"
+	"\tassign\tw_fftin = { c_r, c_i };\n"
+"\n");
+	} else {
+		fprintf(fp,
+	"\t//\n"
+	"\t// The pre-twiddle, exp(-j pi (4n+1)/4N)\n"
+	"\t//\n"
+	"\treg\t[(2*CW-1):0]\tpremem\t[0:((1<<(LGSIZE-1))-1)];\n"
+	"\treg\t[(2*CW-1):0]\tc_tw;\n"
+	"\twire\tsigned\t[(CW-1):0]\tpre_r, pre_i;\n"
+	"\treg\tsigned\t[(UW+CW-1):0]\tp_rr, p_ii, p_ri, p_ir;\n"
+	"\treg\tsigned\t[(UW+CW):0]\tv_r, v_i;\n"
+	"\twire\tsigned\t[(FIW-1):0]\tfv_r, fv_i;\n"
+	"\treg\t\t\tp_valid, v_valid, fv_valid;\n"
+"\n"
+	"\tinitial\t$readmemh(PREFILE, premem);\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\t\tc_tw <= premem[rd_n];\n"
+"\n"
+	"\tassign\tpre_r = c_tw[(2*CW-1):CW];\n"
+	"\tassign\tpre_i = c_tw[(CW-1):0];\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+	"\t\tp_rr <= c_r * pre_r;\n"
+	"\t\tp_ii <= c_i * pre_i;\n"
+	"\t\tp_ri <= c_r * pre_i;\n"
+	"\t\tp_ir <= c_i * pre_r;\n"
+"\n"
+	"\t\tv_r <= p_rr - p_ii;\n"
+	"\t\tv_i <= p_ri + p_ir;\n"
+	"\tend\n"
+"\n"
+	"\t// The twiddles carry a gain of 2^(CW-2)\n"
+	"\t%s #(UW+CW+1,FIW,2) rnd_vr(i_clk, i_ce, v_r, fv_r);\n"
+	"\t%s #(UW+CW+1,FIW,2) rnd_vi(i_clk, i_ce, v_i, fv_i);\n"
+"\n"
+	"\tinitial\t{ p_valid, v_valid, fv_valid } = 3\'b000;\n"
+	"%s"
+	"\t\t{ p_valid, v_valid, fv_valid } <= 3\'b000;\n"
+	"\telse if (i_ce)\n"
+	"\t\t{ p_valid, v_valid, fv_valid } <= { c_valid, p_valid, v_valid };\n"
+"\n"
+	"\tassign\tw_fftce = (i_ce)&&(fv_valid);\n"
+	"\tassign\tw_fftin = { fv_r, fv_i };\n"
+"\n", rnd_string, rnd_string, always_reset.c_str());
+	}
+
+	//
+	// The FFT
+	//
+	fprintf(fp,
+	"\t//\n"
+	"\t// The FFT, stepped on every other i_ce\n"
+	"\t//\n"
+	"\twire\t[(2*OW-1):0]\tw_result;\n"
+	"%s"
+	"\twire\t\t\tw_sync;\n"
+"\n"
+	"\tfftmain\tfft(i_clk, %s, w_fftce, w_fftin, w_result, w_sync%s);\n"
+"\n",
+		(dct == DCT_II) ? "\twire\t[(2*OW-1):0]\tw_mirror;\n" : "",
+		resetw.c_str(),
+		(dct == DCT_II) ? ", w_mirror" : "");
+
+	//
+	// Post-twiddles
+	//
+	fprintf(fp,
+	"\t//\n"
+	"\t// Each bin produces two outputs, one on each of the two i_ce\'s\n"
+	"\t// that follow it\n"
+	"\t//\n"
+	"\treg\t\t\tr_step, out_started;\n"
+	"\treg\t[(LGSIZE-2):0]\tkcnt, q_k;\n"
+	"\treg\t\t\tq_slot, q_valid;\n"
+	"\twire\t[(LGSIZE-1):0]\tw_oaddr;\n"
+"\n"
+	"\tinitial\t{ r_step, out_started } = 2\'b00;\n"
+	"%s"
+	"\t\t{ r_step, out_started } <= 2\'b00;\n"
+	"\telse if (i_ce)\n"
+	"\tbegin\n"
+	"\t\tr_step <= w_fftce;\n"
+	"\t\tif ((r_step)&&(w_sync))\n"
+	"\t\t\tout_started <= 1\'b1;\n"
+	"\tend\n"
+"\n"
+	"\tinitial\tkcnt = 0;\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif ((i_ce)&&(r_step))\n"
+	"\t\tkcnt <= (w_sync) ? 1 : (kcnt + 1\'b1);\n"
+"\n", always_reset.c_str());
+
+	if (dct == DCT_II)
+		fprintf(fp,
+	"\twire\tsigned\t[(OW-1):0]\ty_r, y_i, m_r, m_i;\n"
+	"\treg\tsigned\t[OW:0]\t\tq_ar, q_ai, q_br, q_bi;\n"
+"\n"
+	"\tassign\ty_r = w_result[(2*OW-1):OW];\n"
+	"\tassign\ty_i = w_result[(OW-1):0];\n"
+	"\tassign\tm_r = w_mirror[(2*OW-1):OW];\n"
+	"\tassign\tm_i = w_mirror[(OW-1):0];\n"
+"\n");
+	else
+		fprintf(fp,
+	"\treg\t[(2*OW-1):0]\tq_a;\n"
+"\n");
+
+	fprintf(fp,
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+	"\t\tif (r_step)\n"
+	"\t\tbegin\n"
+	"\t\t\tq_k    <= (w_sync) ? 0 : kcnt;\n"
+	"\t\t\tq_slot <= 1\'b0;\n");
+	if (dct == DCT_II)
+		fprintf(fp,
+	"\t\t\t// 2A = Y[k] + conj(Y[N/2-k]), 2B = (Y[k] - conj(Y[N/2-k])) / j\n"
+	"\t\t\tq_ar <= y_r + m_r;\n"
+	"\t\t\tq_ai <= y_i - m_i;\n"
+	"\t\t\tq_br <= y_i + m_i;\n"
+	"\t\t\tq_bi <= m_r - y_r;\n");
+	else
+		fprintf(fp,
+	"\t\t\tq_a <= w_result;\n");
+	fprintf(fp,
+	"\t\tend else\n"
+	"\t\t\tq_slot <= 1\'b1;\n"
+	"\tend\n"
+"\n"
+	"\tinitial\tq_valid = 1\'b0;\n"
+	"%s"
+	"\t\tq_valid <= 1\'b0;\n"
+	"\telse if (i_ce)\n"
+	"\t\tq_valid <= (r_step) ? ((out_started)||(w_sync))\n"
+	"\t\t\t\t: ((q_valid)&&(!q_slot));\n"
+"\n", always_reset.c_str());
+
+	if (dct == DCT_II)
+		fprintf(fp,
+	"\t// X[k], then X[N-k], or X[N/2] following X[0]\n"
+	"\tassign\tw_oaddr = (!q_slot) ? { 1\'b0, q_k }\n"
+	"\t\t\t: (q_k == 0) ? { 1\'b1, {(LGSIZE-1){1\'b0}} }\n"
+	"\t\t\t: (-{ 1\'b0, q_k });\n"
+"\n");
+	else
+		fprintf(fp,
+	"\t// X[2k], then X[N-1-2k]\n"
+	"\tassign\tw_oaddr = (q_slot) ? ~{ q_k, 1\'b0 } : { q_k, 1\'b0 };\n"
+"\n");
+
+	fprintf(fp,
+	"\treg\t[(2*CW-1):0]\ttwamem\t[0:((1<<LGSIZE)-1)];\n"
+	"\treg\t[(2*CW-1):0]\tt_twa;\n"
+	"\twire\tsigned\t[(CW-1):0]\ttwa_r, twa_i;\n");
+	if (dct == DCT_II)
+		fprintf(fp,
+	"\treg\t[(2*CW-1):0]\ttwbmem\t[0:((1<<LGSIZE)-1)];\n"
+	"\treg\t[(2*CW-1):0]\tt_twb;\n"
+	"\twire\tsigned\t[(CW-1):0]\ttwb_r, twb_i;\n"
+	"\treg\tsigned\t[OW:0]\t\tt_ar, t_ai, t_br, t_bi;\n"
+	"\treg\tsigned\t[(OW+CW):0]\tm_ar, m_ai, m_br, m_bi;\n"
+	"\treg\tsigned\t[(OW+CW+2):0]\ts_sum;\n");
+	else
+		fprintf(fp,
+	"\treg\tsigned\t[(OW-1):0]\tt_ar, t_ai;\n"
+	"\treg\tsigned\t[(OW+CW-1):0]\tm_ar, m_ai;\n"
+	"\treg\tsigned\t[(OW+CW):0]\ts_sum;\n");
+	fprintf(fp,
+	"\twire\tsigned\t[(XW-1):0]\tx_val;\n"
+	"\treg\t[(LGSIZE-1):0]\tt_addr, m_addr, s_addr, x_addr;\n"
+	"\treg\t\t\tt_valid, m_valid, s_valid, x_valid;\n"
+	"\treg\t\t\tt_last, m_last, s_last, x_last;\n"
+"\n"
+	"\tinitial\t$readmemh(TWAFILE, twamem);\n");
+	if (dct == DCT_II)
+		fprintf(fp,
+	"\tinitial\t$readmemh(TWBFILE, twbmem);\n");
+	fprintf(fp,
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+	"\t\tt_twa  <= twamem[{ q_k, q_slot }];\n");
+	if (dct == DCT_II)
+		fprintf(fp,
+	"\t\tt_twb  <= twbmem[{ q_k, q_slot }];\n"
+	"\t\t{ t_ar, t_ai, t_br, t_bi } <= { q_ar, q_ai, q_br, q_bi };\n");
+	else
+		fprintf(fp,
+	"\t\t{ t_ar, t_ai } <= q_a;\n");
+	fprintf(fp,
+	"\t\tt_addr <= w_oaddr;\n"
+	"\t\tt_last <= (q_slot)&&(&q_k);\n"
+	"\tend\n"
+"\n"
+	"\tassign\ttwa_r = t_twa[(2*CW-1):CW];\n"
+	"\tassign\ttwa_i = t_twa[(CW-1):0];\n");
+	if (dct == DCT_II)
+		fprintf(fp,
+	"\tassign\ttwb_r = t_twb[(2*CW-1):CW];\n"
+	"\tassign\ttwb_i = t_twb[(CW-1):0];\n");
+	fprintf(fp,
+"\n"
+	"\t// Only the real part of each product is needed\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+	"\t\tm_ar <= t_ar * twa_r;\n"
+	"\t\tm_ai <= t_ai * twa_i;\n");
+	if (dct == DCT_II)
+		fprintf(fp,
+	"\t\tm_br <= t_br * twb_r;\n"
+	"\t\tm_bi <= t_bi * twb_i;\n"
+"\n"
+	"\t\ts_sum <= (m_ar - m_ai) + (m_br - m_bi);\n");
+	else
+		fprintf(fp,
+"\n"
+	"\t\ts_sum <= m_ar - m_ai;\n");
+	fprintf(fp,
+"\n"
+	"\t\t{ m_addr, s_addr, x_addr } <= { t_addr, m_addr, s_addr };\n"
+	"\t\t{ m_last, s_last, x_last } <= { t_last, m_last, s_last };\n"
+	"\tend\n"
+"\n"
+	"\tinitial\t{ t_valid, m_valid, s_valid, x_valid } = 4\'b0000;\n"
+	"%s"
+	"\t\t{ t_valid, m_valid, s_valid, x_valid } <= 4\'b0000;\n"
+	"\telse if (i_ce)\n"
+	"\t\t{ t_valid, m_valid, s_valid, x_valid }\n"
+	"\t\t\t\t<= { q_valid, t_valid, m_valid, s_valid };\n"
+"\n", always_reset.c_str());
+
+	if (dct == DCT_II)
+		fprintf(fp,
+	"\t// The twiddles carry a gain of 2^(CW-2), and the sum is 2X\n"
+	"\t%s #(OW+CW+3,XW,3) rnd_x(i_clk, i_ce, s_sum, x_val);\n"
+"\n", rnd_string);
+	else
+		fprintf(fp,
+	"\t// The twiddles carry a gain of 2^(CW-2)\n"
+	"\t%s #(OW+CW+1,XW,2) rnd_x(i_clk, i_ce, s_sum, x_val);\n"
+"\n", rnd_string);
+
+	//
+	// Return to natural order
+	//
+	fprintf(fp,
+	"\t//\n"
+	"\t// Return the coefficients to their natural order\n"
+	"\t//\n"
+	"\treg\tsigned\t[(XW-1):0]\tomem\t[0:((1<<(LGSIZE+1))-1)];\n"
+	"\treg\t\t\tobank, ordbank, o_first;\n"
+	"\treg\t[(LGSIZE-1):0]\tordpos;\n"
+	"\twire\t\t\tw_olast;\n"
+"\n"
+	"\tassign\tw_olast = (i_ce)&&(x_valid)&&(x_last);\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif ((i_ce)&&(x_valid))\n"
+	"\t\tomem[{ obank, x_addr }] <= x_val;\n"
+"\n"
+	"\tinitial\tobank = 1\'b0;\n"
+	"%s"
+	"\t\tobank <= 1\'b0;\n"
+	"\telse if (w_olast)\n"
+	"\t\tobank <= !obank;\n"
+"\n"
+	"\tinitial\tordbank = 1\'b0;\n"
+	"\tinitial\tordpos  = 0;\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+	"\t\tif (w_olast)\n"
+	"\t\tbegin\n"
+	"\t\t\tordbank <= obank;\n"
+	"\t\t\tordpos  <= 0;\n"
+	"\t\tend else\n"
+	"\t\t\tordpos  <= ordpos + 1\'b1;\n"
+	"\tend\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce) // Junk until the first frame ... w/o a sync pulse\n"
+	"\t\to_result <= omem[{ ordbank, ordpos }];\n"
+"\n"
+	"\tinitial\t{ o_first, o_sync } = 2\'b00;\n"
+	"%s"
+	"\t\t{ o_first, o_sync } <= 2\'b00;\n"
+	"\telse if (i_ce)\n"
+	"\t\t{ o_first, o_sync } <= { w_olast, o_first };\n"
+"\n"
+"endmodule\n", always_reset.c_str(), always_reset.c_str());
+
+	fclose(fp);
+}
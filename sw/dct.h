@@ -0,0 +1,57 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	dct.h
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Generates streaming DCT-II, DCT-IV, and MDCT cores, each built
+//		around an N/2 point complex FFT with pre- and post-twiddles.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+#ifndef	DCT_H
+#define	DCT_H
+
+#include "rounding.h"
+
+typedef	enum {
+	DCT_NONE=0, DCT_II, DCT_IV, DCT_MDCT
+} DCT_T;
+
+extern	bool	parse_dct(const char *str, DCT_T &dct);
+extern	const char *dct_name(DCT_T dct);
+extern	std::string	gen_dct_fname(const char *coredir, const char *tbl,
+			int lgsize);
+extern	void	gen_dct_twiddles(const char *coredir, DCT_T dct, int lgsize,
+			int cbits);
+extern	void	build_dct(const char *fname, DCT_T dct, int lgsize, int iw,
+			int fiw, int ow, int cw, ROUND_T rounding,
+			const bool async_reset = false);
+
+#endif	// DCT_H
@@ -0,0 +1,549 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	dualclk.cpp
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Generates dualclk.v, which runs an FFT built for several clocks
+//		per sample (-k) from a fast FFT clock, while its samples come
+//	and go on a slower sample clock.  Samples cross between the two
+//	through afifo.v, a gray coded asynchronous FIFO.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+#define _CRT_SECURE_NO_WARNINGS   //  ms vs 2012 doesn't like fopen
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _MSC_VER //  added for ms vs compatibility
+
+#include <io.h>
+#include <direct.h>
+#define _USE_MATH_DEFINES
+#else
+// And for G++/Linux environment
+
+#include <unistd.h>	// Defines the R_OK/W_OK/etc. macros
+#include <sys/stat.h>
+#endif
+
+#include <string.h>
+#include <string>
+#include <math.h>
+#include <ctype.h>
+#include <assert.h>
+
+#include "defaults.h"
+#include "legal.h"
+#include "fftlib.h"
+
+#include "dualclk.h"
+
+void	build_afifo(const char *fname, const bool async_reset) {
+	FILE	*fp = fopen(fname, "w");
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return;
+	}
+
+	std::string	wresetw("i_wreset"), rresetw("i_rreset"),
+			wreset, rreset;
+	if (async_reset) {
+		wresetw = std::string("i_wreset_n");
+		rresetw = std::string("i_rreset_n");
+		wreset = std::string("\talways @(posedge i_wclk, negedge i_wreset_n)\n\tif (!i_wreset_n)\n");
+		rreset = std::string("\talways @(posedge i_rclk, negedge i_rreset_n)\n\tif (!i_rreset_n)\n");
+	} else {
+		wreset = std::string("\talways @(posedge i_wclk)\n\tif (i_wreset)\n");
+		rreset = std::string("\talways @(posedge i_rclk)\n\tif (i_rreset)\n");
+	}
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\tafifo.v\n"
+"//\n"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:\tAn asynchronous FIFO, crossing WIDTH bit words from the i_wclk\n"
+"//		domain to the i_rclk domain.  Each side keeps its own binary\n"
+"//	pointer, and passes a gray coded copy of it through two flip-flops\n"
+"//	into the other domain, so that only one bit of it may be changing\n"
+"//	as it is captured.  Each side has its own reset, synchronous to its\n"
+"//	own clock.\n"
+"//\n"
+"//	o_rdata is the word at the head of the FIFO, valid whenever\n"
+"//	o_rempty is clear.  i_rd removes it.\n"
+"//\n%s"
+"//\n", prjname, creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+
+	fprintf(fp,
+"module\tafifo(i_wclk, %s, i_wr, i_wdata, o_wfull,\n"
+		"\t\ti_rclk, %s, i_rd, o_rdata, o_rempty);\n"
+	"\tparameter\tLGFIFO=4, WIDTH=32;\n"
+	"\t//\n"
+	"\tinput\twire\t\t\ti_wclk, %s, i_wr;\n"
+	"\tinput\twire\t[(WIDTH-1):0]\ti_wdata;\n"
+	"\toutput\treg\t\t\to_wfull;\n"
+	"\tinput\twire\t\t\ti_rclk, %s, i_rd;\n"
+	"\toutput\twire\t[(WIDTH-1):0]\to_rdata;\n"
+	"\toutput\treg\t\t\to_rempty;\n"
+"\n"
+	"\treg\t[(WIDTH-1):0]\tmem\t[0:((1<<LGFIFO)-1)];\n"
+"\n"
+	"\t//\n"
+	"\t// Write side\n"
+	"\t//\n"
+	"\treg\t[LGFIFO:0]\twbin, wgray, wq1_rgray, wq2_rgray;\n"
+	"\twire\t[LGFIFO:0]\twbin_next, wgray_next;\n"
+"\n"
+	"\tassign\twbin_next  = wbin + { {(LGFIFO){1\'b0}}, ((i_wr)&&(!o_wfull)) };\n"
+	"\tassign\twgray_next = (wbin_next >> 1) ^ wbin_next;\n"
+"\n"
+	"\tinitial\t{ wbin, wgray, o_wfull } = 0;\n"
+	"%s"
+	"\t\t{ wbin, wgray, o_wfull } <= 0;\n"
+	"\telse begin\n"
+	"\t\twbin  <= wbin_next;\n"
+	"\t\twgray <= wgray_next;\n"
+	"\t\t// Full when the pointers differ only in their top bit, or\n"
+	"\t\t// the top two bits of their gray codes\n"
+	"\t\to_wfull <= (wgray_next == { ~wq2_rgray[LGFIFO:(LGFIFO-1)],\n"
+	"\t\t\t\t\twq2_rgray[(LGFIFO-2):0] });\n"
+	"\tend\n"
+"\n"
+	"\tinitial\t{ wq2_rgray, wq1_rgray } = 0;\n"
+	"%s"
+	"\t\t{ wq2_rgray, wq1_rgray } <= 0;\n"
+	"\telse\n"
+	"\t\t{ wq2_rgray, wq1_rgray } <= { wq1_rgray, rgray };\n"
+"\n"
+	"\talways @(posedge i_wclk)\n"
+	"\tif ((i_wr)&&(!o_wfull))\n"
+	"\t\tmem[wbin[(LGFIFO-1):0]] <= i_wdata;\n"
+"\n"
+	"\t//\n"
+	"\t// Read side\n"
+	"\t//\n"
+	"\treg\t[LGFIFO:0]\trbin, rgray, rq1_wgray, rq2_wgray;\n"
+	"\twire\t[LGFIFO:0]\trbin_next, rgray_next;\n"
+"\n"
+	"\tassign\trbin_next  = rbin + { {(LGFIFO){1\'b0}}, ((i_rd)&&(!o_rempty)) };\n"
+	"\tassign\trgray_next = (rbin_next >> 1) ^ rbin_next;\n"
+"\n"
+	"\tinitial\t{ rbin, rgray } = 0;\n"
+	"\tinitial\to_rempty = 1\'b1;\n"
+	"%s"
+	"\tbegin\n"
+	"\t\t{ rbin, rgray } <= 0;\n"
+	"\t\to_rempty <= 1\'b1;\n"
+	"\tend else begin\n"
+	"\t\trbin  <= rbin_next;\n"
+	"\t\trgray <= rgray_next;\n"
+	"\t\to_rempty <= (rgray_next == rq2_wgray);\n"
+	"\tend\n"
+"\n"
+	"\tinitial\t{ rq2_wgray, rq1_wgray } = 0;\n"
+	"%s"
+	"\t\t{ rq2_wgray, rq1_wgray } <= 0;\n"
+	"\telse\n"
+	"\t\t{ rq2_wgray, rq1_wgray } <= { rq1_wgray, wgray };\n"
+"\n"
+	"\tassign\to_rdata = mem[rbin[(LGFIFO-1):0]];\n"
+"\n",
+		wresetw.c_str(), rresetw.c_str(),
+		wresetw.c_str(), rresetw.c_str(),
+		wreset.c_str(), wreset.c_str(),
+		rreset.c_str(), rreset.c_str());
+
+	if (formal_property_flag) {
+		// Each reset, as a condition true while it is asserted
+		const char	*wactive = (async_reset) ? "(!i_wreset_n)" : "i_wreset",
+				*ractive = (async_reset) ? "(!i_rreset_n)" : "i_rreset";
+
+		fprintf(fp,
+"`ifdef\tFORMAL\n"
+"`ifdef\tAFIFO\n"
+"`define\tASSUME\tassume\n"
+"`define\tASSERT\tassert\n"
+"`else\n"
+"`define\tASSUME\tassert\n"
+"`define\tASSERT\tassume\n"
+"`endif\n"
+"\n"
+	"\treg\tf_past_valid_gbl;\n"
+	"\tinitial\tf_past_valid_gbl = 1'b0;\n"
+	"\talways @($global_clock)\n"
+		"\t\tf_past_valid_gbl <= 1'b1;\n"
+"\n"
+	"\t//\n"
+	"\t// Each input changes only with its own clock.  Both sides start in\n"
+	"\t// reset, and neither is ever reset again.\n"
+	"\t//\n"
+	"\talways @($global_clock)\n"
+	"\tif ((f_past_valid_gbl)&&(!$rose(i_wclk)))\n"
+	"\tbegin\n"
+		"\t\t`ASSUME($stable(%s));\n"
+		"\t\t`ASSUME($stable(i_wr));\n"
+		"\t\t`ASSUME($stable(i_wdata));\n"
+	"\tend\n"
+"\n"
+	"\talways @($global_clock)\n"
+	"\tif ((f_past_valid_gbl)&&(!$rose(i_rclk)))\n"
+	"\tbegin\n"
+		"\t\t`ASSUME($stable(%s));\n"
+		"\t\t`ASSUME($stable(i_rd));\n"
+	"\tend\n"
+"\n"
+	"\tinitial\t`ASSUME(%s);\n"
+	"\tinitial\t`ASSUME(%s);\n"
+"\n"
+	"\talways @($global_clock)\n"
+	"\tif (f_past_valid_gbl)\n"
+	"\tbegin\n"
+		"\t\tif (!$past(%s))\n"
+			"\t\t\t`ASSUME(!%s);\n"
+		"\t\tif (!$past(%s))\n"
+			"\t\t\t`ASSUME(!%s);\n"
+	"\tend\n"
+"\n"
+	"\talways @(*)\n"
+	"\tif (%s)\n"
+		"\t\t`ASSERT({ wbin, wgray, wq1_rgray, wq2_rgray, o_wfull } == 0);\n"
+"\n"
+	"\talways @(*)\n"
+	"\tif (%s)\n"
+		"\t\t`ASSERT(({ rbin, rgray, rq1_wgray, rq2_wgray } == 0)&&(o_rempty));\n"
+"\n",
+		wresetw.c_str(), rresetw.c_str(), wactive, ractive,
+		wactive, wactive, ractive, ractive, wactive, ractive);
+
+		fprintf(fp,
+	"\t//\n"
+	"\t// Only one bit of a gray coded pointer may change at a time, so that\n"
+	"\t// the other side captures either its old value or its new one\n"
+	"\t//\n"
+	"\talways @(*)\n"
+	"\tbegin\n"
+		"\t\t`ASSERT(wgray == ((wbin >> 1) ^ wbin));\n"
+		"\t\t`ASSERT(rgray == ((rbin >> 1) ^ rbin));\n"
+	"\tend\n"
+"\n"
+	"\talways @($global_clock)\n"
+	"\tif (f_past_valid_gbl)\n"
+	"\tbegin\n"
+		"\t\t`ASSERT($onehot0(wgray ^ $past(wgray)));\n"
+		"\t\t`ASSERT($onehot0(rgray ^ $past(rgray)));\n"
+	"\tend\n"
+"\n"
+	"\t//\n"
+	"\t// Each side's copy of the other's pointer, in binary.  Each is an\n"
+	"\t// old value of that pointer, and the copy past the second flip-flop\n"
+	"\t// is older still.  The distances below are all taken modulo the size\n"
+	"\t// of the pointers.\n"
+	"\t//\n"
+	"\tgenvar\tk;\n"
+	"\twire\t[LGFIFO:0]\tf_wq1_rbin, f_wq2_rbin, f_rq1_wbin, f_rq2_wbin;\n"
+	"\twire\t[LGFIFO:0]\tf_fill, f_wfill, f_wlag1, f_wlag2,\n"
+	"\t\t\t\tf_rlag1, f_rlag2;\n"
+"\n"
+	"\tgenerate for(k=0; k<=LGFIFO; k=k+1)\n"
+	"\tbegin : F_GRAY2BIN\n"
+		"\t\tassign\tf_wq1_rbin[k] = ^wq1_rgray[LGFIFO:k];\n"
+		"\t\tassign\tf_wq2_rbin[k] = ^wq2_rgray[LGFIFO:k];\n"
+		"\t\tassign\tf_rq1_wbin[k] = ^rq1_wgray[LGFIFO:k];\n"
+		"\t\tassign\tf_rq2_wbin[k] = ^rq2_wgray[LGFIFO:k];\n"
+	"\tend endgenerate\n"
+"\n"
+	"\t// The number of words in the FIFO, and as far as the write side knows\n"
+	"\tassign\tf_fill  = wbin - rbin;\n"
+	"\tassign\tf_wfill = wbin - f_wq2_rbin;\n"
+	"\t// How far each copy lags behind the pointer it was copied from\n"
+	"\tassign\tf_wlag1 = rbin - f_wq1_rbin;\n"
+	"\tassign\tf_wlag2 = rbin - f_wq2_rbin;\n"
+	"\tassign\tf_rlag1 = wbin - f_rq1_wbin;\n"
+	"\tassign\tf_rlag2 = wbin - f_rq2_wbin;\n"
+"\n"
+	"\talways @(*)\n"
+	"\tbegin\n"
+		"\t\t// The write side never overfills the FIFO, even though\n"
+		"\t\t// it only knows of an old read pointer\n"
+		"\t\t`ASSERT(f_fill <= (1<<LGFIFO));\n"
+		"\t\t`ASSERT(f_wfill <= (1<<LGFIFO));\n"
+		"\t\t`ASSERT(f_wlag2 <= f_wfill);\n"
+		"\t\t`ASSERT(f_wlag1 <= f_wlag2);\n"
+		"\t\t//\n"
+		"\t\t// The read side never passes the write pointer it knows of,\n"
+		"\t\t// nor can that pointer pass the real one\n"
+		"\t\t`ASSERT(f_rlag2 <= f_fill);\n"
+		"\t\t`ASSERT(f_rlag1 <= f_rlag2);\n"
+		"\t\t//\n"
+		"\t\t// Full and empty may be set early, but never late\n"
+		"\t\tif (f_wfill == (1<<LGFIFO))\n"
+			"\t\t\t`ASSERT(o_wfull);\n"
+		"\t\tif (f_rq2_wbin == rbin)\n"
+			"\t\t\t`ASSERT(o_rempty);\n"
+		"\t\tif (!o_rempty)\n"
+			"\t\t\t`ASSERT(f_fill != 0);\n"
+	"\tend\n"
+"\n");
+
+		fprintf(fp,
+	"\t//\n"
+	"\t// Any word written must be read back unchanged\n"
+	"\t//\n"
+	"\t(* anyconst *)\treg\t[LGFIFO:0]\tf_const_addr;\n"
+	"\t(* anyconst *)\treg\t[(WIDTH-1):0]\tf_const_data;\n"
+	"\treg\t\t\tf_const_written;\n"
+	"\twire\t[LGFIFO:0]\tf_const_dist;\n"
+	"\twire\t\t\tf_const_inuse;\n"
+"\n"
+	"\tinitial\tf_const_written = 1'b0;\n"
+	"%s"
+		"\t\tf_const_written <= 1'b0;\n"
+	"\telse if ((i_wr)&&(!o_wfull)&&(wbin == f_const_addr))\n"
+		"\t\tf_const_written <= (i_wdata == f_const_data);\n"
+"\n"
+	"\t// The word is in the FIFO until the read pointer passes it\n"
+	"\tassign\tf_const_dist  = f_const_addr - rbin;\n"
+	"\tassign\tf_const_inuse = (f_const_dist < f_fill);\n"
+"\n"
+	"\talways @(*)\n"
+	"\tif ((f_const_written)&&(f_const_inuse))\n"
+	"\tbegin\n"
+		"\t\t`ASSERT(mem[f_const_addr[(LGFIFO-1):0]] == f_const_data);\n"
+		"\t\tif (f_const_dist == 0)\n"
+			"\t\t\t`ASSERT(o_rdata == f_const_data);\n"
+	"\tend\n"
+"\n"
+"`ifdef\tAFIFO\n"
+	"\talways @(*)\n"
+	"\tbegin\n"
+		"\t\tcover(o_wfull);\n"
+		"\t\tcover((f_const_written)&&(f_const_inuse)\n"
+			"\t\t\t\t&&(f_const_dist == 0)&&(!o_rempty));\n"
+		"\t\t// Emptied again, after having passed through the whole FIFO\n"
+		"\t\tcover((rbin[LGFIFO])&&(f_fill == 0)&&(o_rempty));\n"
+	"\tend\n"
+"`endif\t// AFIFO\n"
+"`endif\t// FORMAL\n", wreset.c_str());
+	}
+
+	fprintf(fp, "endmodule\n");
+
+	fclose(fp);
+}
+
+void	build_dualclk(const char *fname, int lgsize, int iw, int ow,
+		int ckpce, const bool async_reset) {
+	FILE	*fp = fopen(fname, "w");
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return;
+	}
+
+	assert(ckpce >= 2);
+
+	std::string	resetw("i_reset"), freset("f_reset"),
+			sreset, freset_always;
+	if (async_reset) {
+		resetw = std::string("i_areset_n");
+		freset = std::string("f_areset_n");
+		sreset = std::string("\talways @(posedge i_sclk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+		freset_always = std::string("\talways @(posedge i_fclk, negedge f_areset_n)\n\tif (!f_areset_n)\n");
+	} else {
+		sreset = std::string("\talways @(posedge i_sclk)\n\tif (i_reset)\n");
+		freset_always = std::string("\talways @(posedge i_fclk)\n\tif (f_reset)\n");
+	}
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\tdualclk.v\n"
+"//\n"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:\tRuns a %d point FFT, built for %d clocks per sample, from a\n"
+"//		fast FFT clock, i_fclk, while its samples arrive and its\n"
+"//	results leave on a slower sample clock, i_sclk.  Since the FFT has\n"
+"//	%d clocks for every sample, each of its stages needs fewer hardware\n"
+"//	multiplies than an FFT running at one sample per clock.\n"
+"//\n"
+"//	i_fclk must run at least %d times as fast as samples arrive.  The\n"
+"//	FFT is given a new sample no more often than every %d i_fclk\'s.\n"
+"//\n"
+"//	Samples arrive with i_ce, and results leave with o_valid, both on\n"
+"//	i_sclk.  o_sync marks the first bin of each frame.  %s is\n"
+"//	synchronous to i_sclk%s.\n"
+"//\n%s"
+"//\n", prjname, 1<<lgsize, ckpce, ckpce, ckpce, ckpce,
+		resetw.c_str(),
+		(async_reset) ? ", and is released synchronously into the\n//\tFFT\'s clock domain" : ", and is passed into the FFT\'s\n//\tclock domain through two flip-flops",
+		creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+
+	fprintf(fp,
+"module\tdualclk(i_sclk, i_fclk, %s, i_ce, i_sample,\n"
+		"\t\to_result, o_sync, o_valid);\n"
+	"\tlocalparam\tIW=%d, OW=%d, CKPCE=%d, LGFIFO=4;\n"
+	"\t//\n"
+	"\tinput\twire\t\t\ti_sclk, i_fclk, %s, i_ce;\n"
+	"\tinput\twire\t[(2*IW-1):0]\ti_sample;\n"
+	"\toutput\treg\t[(2*OW-1):0]\to_result;\n"
+	"\toutput\treg\t\t\to_sync, o_valid;\n"
+"\n",
+		resetw.c_str(), iw, ow, ckpce, resetw.c_str());
+
+	if (async_reset)
+		fprintf(fp,
+	"\t//\n"
+	"\t// Release the reset synchronously to i_fclk\n"
+	"\t//\n"
+	"\treg\t[1:0]\t\tf_rstpipe;\n"
+	"\twire\t\t\tf_areset_n;\n"
+"\n"
+	"\tinitial\tf_rstpipe = 2\'b00;\n"
+	"\talways @(posedge i_fclk, negedge i_areset_n)\n"
+	"\tif (!i_areset_n)\n"
+	"\t\tf_rstpipe <= 2\'b00;\n"
+	"\telse\n"
+	"\t\tf_rstpipe <= { f_rstpipe[0], 1\'b1 };\n"
+"\n"
+	"\tassign\tf_areset_n = f_rstpipe[1];\n"
+"\n");
+	else
+		fprintf(fp,
+	"\t//\n"
+	"\t// Bring the reset into the i_fclk domain.  i_fclk is the faster\n"
+	"\t// clock, so it cannot miss an i_reset lasting one i_sclk.\n"
+	"\t//\n"
+	"\treg\t[1:0]\t\tf_rstpipe;\n"
+	"\twire\t\t\tf_reset;\n"
+"\n"
+	"\tinitial\tf_rstpipe = 2\'b11;\n"
+	"\talways @(posedge i_fclk)\n"
+	"\t\tf_rstpipe <= { f_rstpipe[0], i_reset };\n"
+"\n"
+	"\tassign\tf_reset = f_rstpipe[1];\n"
+"\n");
+
+	fprintf(fp,
+	"\t//\n"
+	"\t// Samples into the FFT\'s clock domain\n"
+	"\t//\n"
+	"\twire\t[(2*IW-1):0]\tf_sample;\n"
+	"\twire\t\t\tf_empty, w_unused_full;\n"
+	"\treg\t[(2*IW-1):0]\tr_sample;\n"
+	"\treg\t\t\tf_ce;\n"
+	"\treg\t[%d:0]\t\tf_wait;\n"
+	"\twire\t\t\tf_rd;\n"
+"\n"
+	"\tafifo #(LGFIFO, 2*IW)\n"
+	"\t\tinfifo(i_sclk, %s, i_ce, i_sample, w_unused_full,\n"
+	"\t\t\ti_fclk, %s, f_rd, f_sample, f_empty);\n"
+"\n"
+	"\t// Take a new sample no more often than every CKPCE clocks\n"
+	"\tassign\tf_rd = (!f_empty)&&(f_wait == 0);\n"
+"\n"
+	"\tinitial\tf_wait = 0;\n"
+	"\tinitial\tf_ce   = 1\'b0;\n"
+	"%s"
+	"\tbegin\n"
+	"\t\tf_wait <= 0;\n"
+	"\t\tf_ce   <= 1\'b0;\n"
+	"\tend else begin\n"
+	"\t\tf_ce <= f_rd;\n"
+	"\t\tif (f_rd)\n"
+	"\t\t\tf_wait <= CKPCE-1;\n"
+	"\t\telse if (f_wait != 0)\n"
+	"\t\t\tf_wait <= f_wait - 1\'b1;\n"
+	"\tend\n"
+"\n"
+	"\talways @(posedge i_fclk)\n"
+	"\tif (f_rd)\n"
+	"\t\tr_sample <= f_sample;\n"
+"\n"
+	"\t//\n"
+	"\t// The FFT\n"
+	"\t//\n"
+	"\twire\t[(2*OW-1):0]\tf_result;\n"
+	"\twire\t\t\tf_sync;\n"
+	"\treg\t\t\tf_started;\n"
+"\n"
+	"\tfftmain\tfft(i_fclk, %s, f_ce, r_sample, f_result, f_sync);\n"
+"\n"
+	"\t// Skip the junk before the first frame\n"
+	"\tinitial\tf_started = 1\'b0;\n"
+	"%s"
+	"\t\tf_started <= 1\'b0;\n"
+	"\telse if ((f_ce)&&(f_sync))\n"
+	"\t\tf_started <= 1\'b1;\n"
+"\n"
+	"\t//\n"
+	"\t// Results back into the sample clock domain.  Each is captured\n"
+	"\t// on the i_ce following the one that produced it.\n"
+	"\t//\n"
+	"\twire\t[(2*OW):0]\ts_result;\n"
+	"\twire\t\t\ts_empty, w_unused_ofull;\n"
+"\n"
+	"\tafifo #(LGFIFO, 2*OW+1)\n"
+	"\t\toutfifo(i_fclk, %s, (f_ce)&&((f_started)||(f_sync)),\n"
+	"\t\t\t\t{ f_sync, f_result }, w_unused_ofull,\n"
+	"\t\t\ti_sclk, %s, i_ce, s_result, s_empty);\n"
+"\n"
+	"\talways @(posedge i_sclk)\n"
+	"\tif (i_ce)\n"
+	"\t\to_result <= s_result[(2*OW-1):0];\n"
+"\n"
+	"\tinitial\t{ o_sync, o_valid } = 2\'b00;\n"
+	"%s"
+	"\t\t{ o_sync, o_valid } <= 2\'b00;\n"
+	"\telse if (i_ce)\n"
+	"\t\t{ o_sync, o_valid } <= { (!s_empty)&&(s_result[2*OW]),\n"
+	"\t\t\t\t\t\t(!s_empty) };\n"
+	"\telse\n"
+	"\t\t{ o_sync, o_valid } <= 2\'b00;\n"
+"\n"
+"endmodule\n",
+		lgval(ckpce)-1,
+		resetw.c_str(), freset.c_str(),
+		freset_always.c_str(),
+		freset.c_str(),
+		freset_always.c_str(),
+		freset.c_str(), resetw.c_str(),
+		sreset.c_str());
+
+	fclose(fp);
+}
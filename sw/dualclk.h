@@ -0,0 +1,46 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	dualclk.h
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Generates a wrapper running the FFT from a faster clock than
+//		its samples, along with the asynchronous FIFOs crossing
+//	between the two clock domains.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+#ifndef	DUALCLK_H
+#define	DUALCLK_H
+
+extern	void	build_afifo(const char *fname, const bool async_reset = false);
+extern	void	build_dualclk(const char *fname, int lgsize, int iw, int ow,
+			int ckpce, const bool async_reset = false);
+
+#endif	// DUALCLK_H
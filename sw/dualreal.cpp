@@ -0,0 +1,215 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	dualreal.cpp
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Generates dualreal.v, which separates the spectra of two real
+//		channels sharing one complex FFT.  If the FFT's input is
+//	a[n] + j b[n], with a[n] and b[n] both real, then its output Y[k]
+//	holds both spectra, since
+//
+//	A[k] = (Y[k] + conj(Y[N-k])) / 2
+//	B[k] = (Y[k] - conj(Y[N-k])) / 2j
+//
+//	Bin N-k comes from a second read port of the FFT's bit reversal
+//	memory, so no other frame buffer is required.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+#define _CRT_SECURE_NO_WARNINGS   //  ms vs 2012 doesn't like fopen
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _MSC_VER //  added for ms vs compatibility
+
+#include <io.h>
+#include <direct.h>
+#define _USE_MATH_DEFINES
+#else
+// And for G++/Linux environment
+
+#include <unistd.h>	// Defines the R_OK/W_OK/etc. macros
+#include <sys/stat.h>
+#endif
+
+#include <string.h>
+#include <string>
+#include <math.h>
+#include <ctype.h>
+#include <assert.h>
+
+#include "defaults.h"
+#include "legal.h"
+#include "fftlib.h"
+
+#include "dualreal.h"
+
+void	build_dualreal(const char *fname, int lgsize, int iw,
+		ROUND_T rounding, const bool async_reset) {
+	FILE	*fp = fopen(fname, "w");
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return;
+	}
+
+	std::string	resetw("i_reset"), always_reset;
+	if (async_reset) {
+		resetw = std::string("i_areset_n");
+		always_reset = std::string("\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	} else
+		always_reset = std::string("\talways @(posedge i_clk)\n\tif (i_reset)\n");
+
+	const	char	*rnd_string = rnd_module(rounding);
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\tdualreal.v\n"
+"//\n"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:\tSeparates the spectra of two real channels, a[n] and b[n],\n"
+"//		fed to a %d point FFT as a[n] + j b[n].  The FFT, built with -u,\n"
+"//	produces its bins in pairs, k and N-k on alternate i_ce\'s:\n"
+"//	Y[0], Y[1], Y[N-1], Y[2], Y[N-2], ..., Y[N/2-1], Y[N/2+1], and last\n"
+"//	Y[N/2].  Holding the first of each pair until the second arrives,\n"
+"//\n"
+"//	A[k] = (Y[k] + conj(Y[N-k])) / 2\n"
+"//	B[k] = (Y[k] - conj(Y[N-k])) / 2j\n"
+"//\n"
+"//	Bins zero and N/2 are their own mirrors, so A is the real part of\n"
+"//	each and B the imaginary part.  Bins 0 through N/2 of both spectra are\n"
+"//	produced, in natural order, on N/2+1 of the N i_ce\'s of each frame,\n"
+"//	with o_valid set.  As with any real signal, bins N/2+1 through N-1 of\n"
+"//	each spectrum are the conjugates of bins N/2-1 through 1.\n"
+"//\n"
+"//	Connect i_ce, i_sync, and i_result to the FFT\'s i_ce, o_sync, and\n"
+"//	o_result.  o_a, o_b, o_sync, and o_valid only change on i_ce.\n"
+"//	o_sync is true with bin zero.\n"
+"//\n%s"
+"//\n", prjname, 1<<lgsize, creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+
+	fprintf(fp,
+"module\tdualreal(i_clk, %s, i_ce, i_sync, i_result,\n"
+		"\t\to_a, o_b, o_sync, o_valid);\n"
+	"\tparameter\tIW=%d, LGSIZE=%d;\n"
+	"\t//\n"
+	"\tinput\twire\t\t\ti_clk, %s, i_ce, i_sync;\n"
+	"\tinput\twire\t[(2*IW-1):0]\ti_result;\n"
+	"\toutput\twire\t[(2*IW-1):0]\to_a, o_b;\n"
+	"\toutput\treg\t\t\to_sync, o_valid;\n"
+"\n"
+	"\treg\t[(LGSIZE-1):0]\t\tpos;\n"
+	"\twire\t[(LGSIZE-1):0]\t\tw_pos;\n"
+	"\treg\t\t\t\trunning;\n"
+	"\treg\t[(2*IW-1):0]\t\tr_first;\n"
+	"\twire\t[(2*IW-1):0]\t\tw_first;\n"
+	"\twire\tsigned\t[(IW-1):0]\ty_r, y_i, m_r, m_i;\n"
+	"\treg\tsigned\t[IW:0]\t\ta_r, a_i, b_r, b_i;\n"
+	"\twire\tsigned\t[(IW-1):0]\tra_r, ra_i, rb_r, rb_i;\n"
+	"\treg\t\t\t\tr_sync, r_valid;\n"
+"\n"
+	"\t//\n"
+	"\t// Where i_result falls within the frame\n"
+	"\t//\n"
+	"\tassign\tw_pos = (i_sync) ? 0 : pos;\n"
+"\n"
+	"\tinitial\tpos = 0;\n"
+	"\tinitial\trunning = 1\'b0;\n"
+	"%s"
+	"\tbegin\n"
+	"\t\tpos <= 0;\n"
+	"\t\trunning <= 1\'b0;\n"
+	"\tend else if (i_ce)\n"
+	"\tbegin\n"
+	"\t\tpos <= w_pos + 1;\n"
+	"\t\tif (i_sync)\n"
+	"\t\t\trunning <= 1\'b1;\n"
+	"\tend\n"
+"\n"
+	"\t// Bin k, the first of each pair, waits for bin N-k\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\t\tr_first <= i_result;\n"
+"\n"
+	"\t// Bins zero and N/2 are paired with themselves\n"
+	"\tassign\tw_first = ((w_pos == 0)||(&w_pos)) ? i_result : r_first;\n"
+"\n"
+	"\tassign\ty_r = w_first[(2*IW-1):IW];\n"
+	"\tassign\ty_i = w_first[(IW-1):0];\n"
+	"\tassign\tm_r = i_result[(2*IW-1):IW];\n"
+	"\tassign\tm_i = i_result[(IW-1):0];\n"
+"\n"
+	"\t//\n"
+	"\t// Y[k] + conj(Y[N-k]), and (Y[k] - conj(Y[N-k])) / j\n"
+	"\t//\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+	"\t\ta_r <= y_r + m_r;\n"
+	"\t\ta_i <= y_i - m_i;\n"
+	"\t\tb_r <= y_i + m_i;\n"
+	"\t\tb_i <= m_r - y_r;\n"
+	"\tend\n"
+"\n"
+	"\t// The sums are a bit wider than Y.  Dropping their bottom bit\n"
+	"\t// divides by two, and returns them to the width of Y.\n"
+	"\t%s #(IW+1,IW,0) rnd_ar(i_clk, i_ce, a_r, ra_r);\n"
+	"\t%s #(IW+1,IW,0) rnd_ai(i_clk, i_ce, a_i, ra_i);\n"
+	"\t%s #(IW+1,IW,0) rnd_br(i_clk, i_ce, b_r, rb_r);\n"
+	"\t%s #(IW+1,IW,0) rnd_bi(i_clk, i_ce, b_i, rb_i);\n"
+"\n"
+	"\t// A bin is complete on the second of each pair, and on N/2\n"
+	"\tinitial\t{ r_sync, o_sync, r_valid, o_valid } = 4\'b0000;\n"
+	"%s"
+	"\t\t{ r_sync, o_sync, r_valid, o_valid } <= 4\'b0000;\n"
+	"\telse if (i_ce)\n"
+	"\tbegin\n"
+	"\t\t{ r_sync, o_sync } <= { i_sync, r_sync };\n"
+	"\t\tr_valid <= ((running)||(i_sync))\n"
+	"\t\t\t\t&&((!w_pos[0])||(&w_pos));\n"
+	"\t\to_valid <= r_valid;\n"
+	"\tend\n"
+"\n"
+	"\tassign\to_a = { ra_r, ra_i };\n"
+	"\tassign\to_b = { rb_r, rb_i };\n"
+"\n"
+"endmodule\n",
+		resetw.c_str(), iw, lgsize, resetw.c_str(),
+		always_reset.c_str(),
+		rnd_string, rnd_string, rnd_string, rnd_string,
+		always_reset.c_str());
+
+	fclose(fp);
+}
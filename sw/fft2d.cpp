@@ -0,0 +1,317 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	fft2d.cpp
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Generates fft2d.v, a streaming two dimensional FFT of an N x N
+//		tile, taking one pixel per clock in row major order.  A row
+//	fftmain transforms each row, transpose.v turns the corner, and a
+//	column fftmain transforms each column.  A second transpose may be
+//	added to return the bins to row major order.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+#define _CRT_SECURE_NO_WARNINGS   //  ms vs 2012 doesn't like fopen
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _MSC_VER //  added for ms vs compatibility
+
+#include <io.h>
+#include <direct.h>
+#define _USE_MATH_DEFINES
+#else
+// And for G++/Linux environment
+
+#include <unistd.h>	// Defines the R_OK/W_OK/etc. macros
+#include <sys/stat.h>
+#endif
+
+#include <string.h>
+#include <string>
+#include <math.h>
+#include <ctype.h>
+#include <assert.h>
+
+#include "defaults.h"
+#include "legal.h"
+#include "fftlib.h"
+
+#include "fft2d.h"
+
+void	build_transpose(const char *fname, const bool async_reset) {
+	FILE	*fp = fopen(fname, "w");
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return;
+	}
+
+	std::string	resetw("i_reset"), always_reset;
+	if (async_reset) {
+		resetw = std::string("i_areset_n");
+		always_reset = std::string("\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	} else
+		always_reset = std::string("\talways @(posedge i_clk)\n\tif (i_reset)\n");
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\ttranspose.v\n"
+"//\n"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:\tTurns the corner on a stream of 2^LGHALF x 2^LGHALF tiles.\n"
+"//		Each tile is written in order into one half of a ping-pong\n"
+"//	memory, while the last tile is read from the other half by columns.\n"
+"//	Since one write and one read take place on every i_ce, each to its\n"
+"//	own half, the stream never stalls.\n"
+"//\n"
+"//	i_valid marks i_data as the next word of a tile.  It must stay set\n"
+"//	on every i_ce once it is first set.  o_valid is set once the first\n"
+"//	tile has been written, and o_sync marks the first word of each tile.\n"
+"//\n%s"
+"//\n", prjname, creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+
+	fprintf(fp,
+"module\ttranspose(i_clk, %s, i_ce, i_valid, i_data,\n"
+		"\t\to_valid, o_data, o_sync);\n"
+	"\tparameter\tLGHALF=4, WIDTH=32;\n"
+	"\tlocalparam\tLGSIZE=2*LGHALF;\n"
+	"\t//\n"
+	"\tinput\twire\t\t\ti_clk, %s, i_ce, i_valid;\n"
+	"\tinput\twire\t[(WIDTH-1):0]\ti_data;\n"
+	"\toutput\treg\t\t\to_valid;\n"
+	"\toutput\treg\t[(WIDTH-1):0]\to_data;\n"
+	"\toutput\treg\t\t\to_sync;\n"
+"\n"
+	"\treg\t[(WIDTH-1):0]\ttmem\t[0:((1<<(LGSIZE+1))-1)];\n"
+	"\treg\t[LGSIZE:0]\twcnt;\n"
+	"\treg\t\t\trunning;\n"
+"\n"
+	"\tinitial\twcnt = 0;\n"
+	"%s"
+	"\t\twcnt <= 0;\n"
+	"\telse if ((i_ce)&&(i_valid))\n"
+	"\t\twcnt <= wcnt + 1'b1;\n"
+"\n"
+	"\tinitial\trunning = 1'b0;\n"
+	"%s"
+	"\t\trunning <= 1'b0;\n"
+	"\telse if ((i_ce)&&(i_valid)&&(&wcnt[(LGSIZE-1):0]))\n"
+	"\t\trunning <= 1'b1;\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif ((i_ce)&&(i_valid))\n"
+	"\t\ttmem[wcnt] <= i_data;\n"
+"\n"
+	"\t// Reading by columns swaps the two halves of the address\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif ((i_ce)&&(i_valid))\n"
+	"\t\to_data <= tmem[{ !wcnt[LGSIZE], wcnt[(LGHALF-1):0],\n"
+	"\t\t\t\t\twcnt[(LGSIZE-1):LGHALF] }];\n"
+"\n"
+	"\tinitial\t{ o_valid, o_sync } = 2'b00;\n"
+	"%s"
+	"\t\t{ o_valid, o_sync } <= 2'b00;\n"
+	"\telse if ((i_ce)&&(i_valid))\n"
+	"\tbegin\n"
+	"\t\to_valid <= running;\n"
+	"\t\to_sync  <= (running)&&(wcnt[(LGSIZE-1):0] == 0);\n"
+	"\tend\n"
+"\n"
+"endmodule\n",
+		resetw.c_str(), resetw.c_str(),
+		always_reset.c_str(), always_reset.c_str(),
+		always_reset.c_str());
+
+	fclose(fp);
+}
+
+void	build_fft2d(const char *fname, int lgsize, int iw, int ow,
+		bool inv, ROUND_T rounding, bool reorder,
+		const bool async_reset) {
+	FILE	*fp = fopen(fname, "w");
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return;
+	}
+
+	std::string	resetw("i_reset"), always_reset;
+	if (async_reset) {
+		resetw = std::string("i_areset_n");
+		always_reset = std::string("\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	} else
+		always_reset = std::string("\talways @(posedge i_clk)\n\tif (i_reset)\n");
+
+	const	char	*rnd_string = rnd_module(rounding);
+
+	const char	*fftname = (inv) ? "ifftmain" : "fftmain";
+
+	assert(ow >= iw);
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\tfft2d.v\n"
+"//\n"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:\tA streaming %d x %d two dimensional %sFFT.  Pixels enter in\n"
+"//		row major order, one per i_ce, with the first pixel after a\n"
+"//	reset starting the first tile.  Each row is transformed by one\n"
+"//	%s, the tile is turned by transpose.v, and each column is then\n"
+"//	transformed by a second %s.\n"
+"//\n"
+"//	Both FFTs take %d bit inputs, so the row FFT\'s outputs are rounded\n"
+"//	back to this width, dropping the %d bits they grew by, before the\n"
+"//	corner turn.\n"
+"//\n"
+"//	%s"
+"//\n"
+"//	As with fftmain, o_result is valid from the first o_sync onward,\n"
+"//	and changes following each i_ce.\n"
+"//\n%s"
+"//\n", prjname, 1<<lgsize, 1<<lgsize, (inv)?"inverse ":"",
+		fftname, fftname, iw, ow-iw,
+		(reorder)
+		? "A second transpose returns the bins to row major order, so that\n"
+		  "//	o_result steps through Y[kr][kc] with kc in the inner loop.\n"
+		: "The bins are produced in column major order, so that o_result\n"
+		  "//	steps through Y[kr][kc] with kr in the inner loop.\n",
+		creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+
+	fprintf(fp,
+"module\tfft2d(i_clk, %s, i_ce, i_sample, o_result, o_sync);\n"
+	"\tlocalparam\tIW=%d, OW=%d, LGHALF=%d;\n"
+	"\t//\n"
+	"\tinput\twire\t\t\ti_clk, %s, i_ce;\n"
+	"\tinput\twire\t[(2*IW-1):0]\ti_sample;\n"
+	"\toutput\twire\t[(2*OW-1):0]\to_result;\n"
+	"\toutput\twire\t\t\to_sync;\n"
+"\n"
+	"\t//\n"
+	"\t// Transform each row\n"
+	"\t//\n"
+	"\twire\t[(2*OW-1):0]\tw_row;\n"
+	"\twire\t\t\tw_rowsync;\n"
+	"\treg\t\t\trow_started, row_valid;\n"
+	"\twire\tsigned\t[(IW-1):0]\tz_r, z_i;\n"
+"\n"
+	"\t%s\trowfft(i_clk, %s, i_ce, i_sample, w_row, w_rowsync);\n"
+"\n"
+	"\tinitial\t{ row_started, row_valid } = 2'b00;\n"
+	"%s"
+	"\t\t{ row_started, row_valid } <= 2'b00;\n"
+	"\telse if (i_ce)\n"
+	"\tbegin\n"
+	"\t\tif (w_rowsync)\n"
+	"\t\t\trow_started <= 1'b1;\n"
+	"\t\trow_valid <= (row_started)||(w_rowsync);\n"
+	"\tend\n"
+"\n"
+	"\t// Return to the input width for the column FFT\n"
+	"\t%s #(OW,IW,0) rnd_r(i_clk, i_ce, w_row[(2*OW-1):OW], z_r);\n"
+	"\t%s #(OW,IW,0) rnd_i(i_clk, i_ce, w_row[(OW-1):0], z_i);\n"
+"\n"
+	"\t//\n"
+	"\t// Turn the corner, and transform each column\n"
+	"\t//\n"
+	"\twire\t\t\tw_colvalid;\n"
+	"\twire\t[(2*IW-1):0]\tw_coldata;\n"
+	"\twire\t[(2*OW-1):0]\tw_col;\n"
+	"\twire\t\t\tw_colsync;\n"
+	"\t// verilator lint_off UNUSED\n"
+	"\twire\t\t\tw_unused_sync;\n"
+	"\t// verilator lint_on  UNUSED\n"
+"\n"
+	"\ttranspose #(LGHALF, 2*IW)\n"
+	"\t\trowturn(i_clk, %s, i_ce, row_valid, { z_r, z_i },\n"
+	"\t\t\tw_colvalid, w_coldata, w_unused_sync);\n"
+"\n"
+	"\t%s\tcolfft(i_clk, %s, (i_ce)&&(w_colvalid), w_coldata,\n"
+	"\t\t\tw_col, w_colsync);\n"
+"\n",
+		resetw.c_str(), iw, ow, lgsize, resetw.c_str(),
+		fftname, resetw.c_str(), always_reset.c_str(),
+		rnd_string, rnd_string,
+		resetw.c_str(), fftname, resetw.c_str());
+
+	if (reorder) {
+		fprintf(fp,
+	"\t//\n"
+	"\t// Turn the corner again, returning to row major order\n"
+	"\t//\n"
+	"\treg\t\t\tcol_started;\n"
+	"\t// verilator lint_off UNUSED\n"
+	"\twire\t\t\tw_unused_valid;\n"
+	"\t// verilator lint_on  UNUSED\n"
+"\n"
+	"\tinitial\tcol_started = 1'b0;\n"
+	"%s"
+	"\t\tcol_started <= 1'b0;\n"
+	"\telse if ((i_ce)&&(w_colvalid)&&(w_colsync))\n"
+	"\t\tcol_started <= 1'b1;\n"
+"\n"
+	"\ttranspose #(LGHALF, 2*OW)\n"
+	"\t\tcolturn(i_clk, %s, (i_ce)&&(w_colvalid),\n"
+	"\t\t\t(col_started)||(w_colsync), w_col,\n"
+	"\t\t\tw_unused_valid, o_result, o_sync);\n"
+"\n",
+			always_reset.c_str(), resetw.c_str());
+	} else {
+		fprintf(fp,
+	"\t//\n"
+	"\t// Each column FFT produces one column of the result.  kcnt counts\n"
+	"\t// them, so that o_sync only marks the first of each tile.\n"
+	"\t//\n"
+	"\treg\t[(LGHALF-1):0]\tkcnt;\n"
+"\n"
+	"\tinitial\tkcnt = 0;\n"
+	"%s"
+	"\t\tkcnt <= 0;\n"
+	"\telse if ((i_ce)&&(w_colvalid)&&(w_colsync))\n"
+	"\t\tkcnt <= kcnt + 1'b1;\n"
+"\n"
+	"\tassign\to_result = w_col;\n"
+	"\tassign\to_sync   = (w_colsync)&&(kcnt == 0);\n"
+"\n",
+			always_reset.c_str());
+	}
+
+	fprintf(fp, "endmodule\n");
+	fclose(fp);
+}
@@ -78,6 +78,7 @@ int lstat(const char *filename, struct stat *buf) { return 1; };
 #endif
 
 #define	mkdir(A,B)	_mkdir(A)
+#define	strcasecmp	_stricmp
 
 #define access _access
 
@@ -102,23 +103,30 @@ int lstat(const char *filename, struct stat *buf) { return 1; };
 #include "bitreverse.h"
 #include "softmpy.h"
 #include "butterfly.h"
-
-void	build_dblquarters(const char *fname, ROUND_T rounding, const bool async_reset=false, const bool dbg=false) {
+#include "windowfn.h"
+#include "polyphase.h"
+#include "psdaccum.h"
+#include "topk.h"
+#include "realifft.h"
+#include "dualreal.h"
+#include "bidirfft.h"
+#include "ofdm.h"
+#include "dct.h"
+#include "fourstep.h"
+#include "fft2d.h"
+#include "dualclk.h"
+#include "zeropad.h"
+#include "fftmodel.h"
+
+void	build_dblquarters(const char *fname, ROUND_T rounding, const bool async_reset=false, const bool dbg=false, const bool rndsel=false) {
 	FILE	*fp = fopen(fname, "w");
 	if (NULL == fp) {
 		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
 		perror("O/S Err was:");
 		return;
 	}
-	const	char	*rnd_string;
-	if (rounding == RND_TRUNCATE)
-		rnd_string = "truncate";
-	else if (rounding == RND_FROMZERO)
-		rnd_string = "roundfromzero";
-	else if (rounding == RND_HALFUP)
-		rnd_string = "roundhalfup";
-	else
-		rnd_string = "convround";
+	const	char	*rnd_parm,
+		*rnd_string = rnd_module(rounding, rndsel, &rnd_parm);
 
 
 	fprintf(fp,
@@ -158,6 +166,10 @@ SLASHLINE
 	resetw.c_str(),
 	(dbg)?", o_dbg":"", TST_QTRSTAGE_IWIDTH,
 	TST_QTRSTAGE_LGWIDTH, resetw.c_str());
+	if (rndsel)
+		fprintf(fp,
+	"\t// Which rounder to use on the outputs, as selected by rndselect\n"
+	"\tparameter\t[1:0]\tRNDMODE=%d;\n", (int)rounding);
 	if (dbg) { fprintf(fp, "\toutput\twire\t[33:0]\t\t\to_dbg;\n"
 		"\tassign\to_dbg = { ((o_sync)&&(i_ce)), i_ce, o_data[(2*OWIDTH-1):(2*OWIDTH-16)],\n"
 			"\t\t\t\t\to_data[(OWIDTH-1):(OWIDTH-16)] };\n"
@@ -192,17 +204,17 @@ SLASHLINE
 	fprintf(fp,
 	"\t\t\t\t\tn_rnd_diff_r, n_rnd_diff_i;\n");
 	fprintf(fp,
-	"\t%s #(IWIDTH+1,OWIDTH,SHIFT)\tdo_rnd_sum_r(i_clk, i_ce,\n"
-	"\t\t\t\tsum_r, rnd_sum_r);\n\n", rnd_string);
+	"\t%s #(IWIDTH+1,OWIDTH,SHIFT%s)\tdo_rnd_sum_r(i_clk, i_ce,\n"
+	"\t\t\t\tsum_r, rnd_sum_r);\n\n", rnd_string, rnd_parm);
 	fprintf(fp,
-	"\t%s #(IWIDTH+1,OWIDTH,SHIFT)\tdo_rnd_sum_i(i_clk, i_ce,\n"
-	"\t\t\t\tsum_i, rnd_sum_i);\n\n", rnd_string);
+	"\t%s #(IWIDTH+1,OWIDTH,SHIFT%s)\tdo_rnd_sum_i(i_clk, i_ce,\n"
+	"\t\t\t\tsum_i, rnd_sum_i);\n\n", rnd_string, rnd_parm);
 	fprintf(fp,
-	"\t%s #(IWIDTH+1,OWIDTH,SHIFT)\tdo_rnd_diff_r(i_clk, i_ce,\n"
-	"\t\t\t\tdiff_r, rnd_diff_r);\n\n", rnd_string);
+	"\t%s #(IWIDTH+1,OWIDTH,SHIFT%s)\tdo_rnd_diff_r(i_clk, i_ce,\n"
+	"\t\t\t\tdiff_r, rnd_diff_r);\n\n", rnd_string, rnd_parm);
 	fprintf(fp,
-	"\t%s #(IWIDTH+1,OWIDTH,SHIFT)\tdo_rnd_diff_i(i_clk, i_ce,\n"
-	"\t\t\t\tdiff_i, rnd_diff_i);\n\n", rnd_string);
+	"\t%s #(IWIDTH+1,OWIDTH,SHIFT%s)\tdo_rnd_diff_i(i_clk, i_ce,\n"
+	"\t\t\t\tdiff_i, rnd_diff_i);\n\n", rnd_string, rnd_parm);
 	fprintf(fp, "\tassign n_rnd_diff_r = - rnd_diff_r;\n"
 		"\tassign n_rnd_diff_i = - rnd_diff_i;\n");
 /*
@@ -327,22 +339,15 @@ SLASHLINE
 	fprintf(fp, "endmodule\n");
 }
 
-void	build_snglquarters(const char *fname, ROUND_T rounding, const bool async_reset=false, const bool dbg=false) {
+void	build_snglquarters(const char *fname, ROUND_T rounding, const bool async_reset=false, const bool dbg=false, const bool rndsel=false) {
 	FILE	*fp = fopen(fname, "w");
 	if (NULL == fp) {
 		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
 		perror("O/S Err was:");
 		return;
 	}
-	const	char	*rnd_string;
-	if (rounding == RND_TRUNCATE)
-		rnd_string = "truncate";
-	else if (rounding == RND_FROMZERO)
-		rnd_string = "roundfromzero";
-	else if (rounding == RND_HALFUP)
-		rnd_string = "roundhalfup";
-	else
-		rnd_string = "convround";
+	const	char	*rnd_parm,
+		*rnd_string = rnd_module(rounding, rndsel, &rnd_parm);
 
 
 	fprintf(fp,
@@ -409,6 +414,10 @@ SLASHLINE
 		"\t\n", (dbg)?"_dbg":"", resetw.c_str(),
 		(dbg)?", o_dbg":"", TST_QTRSTAGE_IWIDTH,
 		TST_QTRSTAGE_LGWIDTH, resetw.c_str());
+	if (rndsel)
+		fprintf(fp,
+	"\t// Which rounder to use on the outputs, as selected by rndselect\n"
+	"\tparameter\t[1:0]\tRNDMODE=%d;\n", (int)rounding);
 	if (dbg) { fprintf(fp, "\toutput\twire\t[33:0]\t\t\to_dbg;\n"
 		"\tassign\to_dbg = { ((o_sync)&&(i_ce)), i_ce, o_data[(2*OWIDTH-1):(2*OWIDTH-16)],\n"
 			"\t\t\t\t\to_data[(OWIDTH-1):(OWIDTH-16)] };\n"
@@ -447,17 +456,17 @@ SLASHLINE
 	fprintf(fp,
 	"\twire\tsigned\t[(OWIDTH-1):0]\trnd_sum_r, rnd_sum_i,\n"
 	"\t\t\trnd_diff_r, rnd_diff_i, n_rnd_diff_r, n_rnd_diff_i;\n"
-	"\t%s #(IWIDTH+1,OWIDTH,SHIFT)\tdo_rnd_sum_r(i_clk, i_ce,\n"
-	"\t\t\t\tsum_r, rnd_sum_r);\n\n", rnd_string);
+	"\t%s #(IWIDTH+1,OWIDTH,SHIFT%s)\tdo_rnd_sum_r(i_clk, i_ce,\n"
+	"\t\t\t\tsum_r, rnd_sum_r);\n\n", rnd_string, rnd_parm);
 	fprintf(fp,
-	"\t%s #(IWIDTH+1,OWIDTH,SHIFT)\tdo_rnd_sum_i(i_clk, i_ce,\n"
-	"\t\t\t\tsum_i, rnd_sum_i);\n\n", rnd_string);
+	"\t%s #(IWIDTH+1,OWIDTH,SHIFT%s)\tdo_rnd_sum_i(i_clk, i_ce,\n"
+	"\t\t\t\tsum_i, rnd_sum_i);\n\n", rnd_string, rnd_parm);
 	fprintf(fp,
-	"\t%s #(IWIDTH+1,OWIDTH,SHIFT)\tdo_rnd_diff_r(i_clk, i_ce,\n"
-	"\t\t\t\tdiff_r, rnd_diff_r);\n\n", rnd_string);
+	"\t%s #(IWIDTH+1,OWIDTH,SHIFT%s)\tdo_rnd_diff_r(i_clk, i_ce,\n"
+	"\t\t\t\tdiff_r, rnd_diff_r);\n\n", rnd_string, rnd_parm);
 	fprintf(fp,
-	"\t%s #(IWIDTH+1,OWIDTH,SHIFT)\tdo_rnd_diff_i(i_clk, i_ce,\n"
-	"\t\t\t\tdiff_i, rnd_diff_i);\n\n", rnd_string);
+	"\t%s #(IWIDTH+1,OWIDTH,SHIFT%s)\tdo_rnd_diff_i(i_clk, i_ce,\n"
+	"\t\t\t\tdiff_i, rnd_diff_i);\n\n", rnd_string, rnd_parm);
 	fprintf(fp, "\tassign n_rnd_diff_r = - rnd_diff_r;\n"
 		"\tassign n_rnd_diff_i = - rnd_diff_i;\n");
 	fprintf(fp,
@@ -732,13 +741,16 @@ SLASHLINE
 }
 
 
-void	build_sngllast(const char *fname, const bool async_reset = false) {
+void	build_sngllast(const char *fname, ROUND_T rounding,
+		const bool async_reset = false, const bool rndsel = false) {
 	FILE	*fp = fopen(fname, "w");
 	if (NULL == fp) {
 		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
 		perror("O/S Err was:");
 		return;
 	}
+	const	char	*rnd_parm,
+		*rnd_string = rnd_module(rounding, rndsel, &rnd_parm);
 
 	std::string	resetw("i_reset");
 	if (async_reset)
@@ -768,6 +780,10 @@ SLASHLINE
 "	output	wire	[(2*OWIDTH-1):0]	o_val;\n"
 "	output	reg				o_sync;\n\n",
 		resetw.c_str(), resetw.c_str());
+	if (rndsel)
+		fprintf(fp,
+	"\t// Which rounder to use on the outputs, as selected by rndselect\n"
+	"\tparameter\t[1:0]\tRNDMODE=%d;\n\n", (int)rounding);
 
 	fprintf(fp,
 "	reg	signed	[(IWIDTH-1):0]	m_r, m_i;\n"
@@ -859,12 +875,14 @@ SLASHLINE
 "\n"
 "	// Now that we have our results, let's round them and report them\n"
 "	wire	signed	[(OWIDTH-1):0]	o_r, o_i;\n"
-"\n"
-"	convround #(IWIDTH+1,OWIDTH,SHIFT) do_rnd_r(i_clk, i_ce, rnd_r, o_r);\n"
-"	convround #(IWIDTH+1,OWIDTH,SHIFT) do_rnd_i(i_clk, i_ce, rnd_i, o_i);\n"
+"\n");
+
+	fprintf(fp,
+"	%s #(IWIDTH+1,OWIDTH,SHIFT%s) do_rnd_r(i_clk, i_ce, rnd_r, o_r);\n"
+"	%s #(IWIDTH+1,OWIDTH,SHIFT%s) do_rnd_i(i_clk, i_ce, rnd_i, o_i);\n"
 "\n"
 "	assign	o_val  = { o_r, o_i };\n"
-"\n");
+"\n", rnd_string, rnd_parm, rnd_string, rnd_parm);
 
 
 	if (formal_property_flag) {
@@ -957,6 +975,183 @@ SLASHLINE
 	fclose(fp);
 }
 
+//
+// Rounding may be chosen separately for each stage, via a comma separated
+// list of rounding names given to -R.  The first name applies to the first
+// (largest) stage, the second to the next, and so on.  Should the list be
+// shorter than the number of stages, the last rounder given applies to all
+// of the remaining stages.
+//
+#define	MAXRNDSTAGES	64
+bool	parse_rounding(const char *str, ROUND_T &rounding) {
+	if ((strcasecmp(str, "t")==0)||(strcasecmp(str, "trunc")==0)
+			||(strcasecmp(str, "truncate")==0))
+		rounding = RND_TRUNCATE;
+	else if ((strcasecmp(str, "f")==0)||(strcasecmp(str, "fromzero")==0)
+			||(strcasecmp(str, "roundfromzero")==0))
+		rounding = RND_FROMZERO;
+	else if ((strcasecmp(str, "h")==0)||(strcasecmp(str, "halfup")==0)
+			||(strcasecmp(str, "roundhalfup")==0))
+		rounding = RND_HALFUP;
+	else if ((strcasecmp(str, "c")==0)||(strcasecmp(str, "conv")==0)
+			||(strcasecmp(str, "convergent")==0)
+			||(strcasecmp(str, "convround")==0))
+		rounding = RND_CONVERGENT;
+	else
+		return false;
+	return true;
+}
+
+int	parse_rounding_list(const char *str, ROUND_T *rndlist) {
+	char	*dup = strdup(str), *tok;
+	int	nrnd = 0;
+
+	for(tok = strtok(dup, ", "); tok; tok = strtok(NULL, ", ")) {
+		if (nrnd >= MAXRNDSTAGES) {
+			fprintf(stderr, "ERR: Too many rounding stages given\n");
+			exit(EXIT_FAILURE);
+		} else if (!parse_rounding(tok, rndlist[nrnd])) {
+			fprintf(stderr, "ERR: Unknown rounding method, %s\n", tok);
+			fprintf(stderr, "Valid methods are truncate, fromzero, halfup, and convergent\n");
+			exit(EXIT_FAILURE);
+		} nrnd++;
+	}
+
+	free(dup);
+	return nrnd;
+}
+
+std::string	rnd_stage_param(bool rndsel, ROUND_T rounding) {
+	char	buf[16];
+
+	if (!rndsel)
+		return std::string("");
+	sprintf(buf, ",%d", (int)rounding);
+	return std::string(buf);
+}
+
+//
+// With -z, every fftstage takes an LGKEEP parameter following its rounding
+// mode.  A stage whose span is at least the number of nonzero inputs only
+// ever sees zeros in the second half of each span, and keeps only the first
+// 2^LGKEEP values of the first.
+//
+std::string	prune_param(int nonzero, int lgspan) {
+	char	buf[16];
+	int	lgkeep;
+
+	if (nonzero <= 0)
+		return std::string("");
+	for(lgkeep=0; (1<<lgkeep) < nonzero; lgkeep++)
+		;
+	if (lgkeep > lgspan)
+		lgkeep = lgspan+1;
+	sprintf(buf, ",%d", lgkeep);
+	return std::string(buf);
+}
+
+//
+// With -T, the twiddle factors of each pair of fftstages come from one
+// dual-port coefrom in the top level, rather than one ROM per stage.  The
+// smaller stage of a pair reads every other entry of the larger stage's
+// table.  Should there be an odd number of stages, the last has a coefrom
+// all to itself.
+//
+// In the two samples per clock mode, the even and odd halves of each stage
+// share a coefrom instead.  It holds the stage's full table, interleaving
+// the even half's coefficients with the odd half's.
+//
+void	emit_coefrom(FILE *vmain, int size, int cbits, const char *cmem,
+		bool paired) {
+	int	lgspan = lgval(size)-1;
+
+	if (paired) {
+		fprintf(vmain, "\t// Twiddle factors for the %d and %d point stages, shared in one ROM\n", size, size/2);
+		fprintf(vmain, "\twire\t[%d:0]\tw_ca%d;\n", lgspan-1, size);
+		fprintf(vmain, "\twire\t[%d:0]\tw_ca%d;\n", lgspan-2, size/2);
+		fprintf(vmain, "\twire\t[%d:0]\tw_c%d, w_c%d;\n",
+			2*cbits-1, size, size/2);
+		fprintf(vmain, "\tcoefrom\t#(%d,%d,\"%s\")\n\t\tcrom_%d(i_clk, i_ce, w_ca%d, w_c%d,\n\t\t\t{ w_ca%d, 1\'b0 }, w_c%d);\n",
+			cbits, lgspan, cmem, size, size, size, size/2, size/2);
+	} else {
+		fprintf(vmain, "\t// Twiddle factors for the %d point stage\n", size);
+		fprintf(vmain, "\twire\t[%d:0]\tw_ca%d;\n", lgspan-1, size);
+		fprintf(vmain, "\twire\t[%d:0]\tw_c%d;\n", 2*cbits-1, size);
+		fprintf(vmain, "\t// verilator lint_off UNUSED\n\twire\t[%d:0]\tw_cx%d;\n\t// verilator lint_on  UNUSED\n", 2*cbits-1, size);
+		fprintf(vmain, "\tcoefrom\t#(%d,%d,\"%s\")\n\t\tcrom_%d(i_clk, i_ce, w_ca%d, w_c%d,\n\t\t\tw_ca%d, w_cx%d);\n",
+			cbits, lgspan, cmem, size, size, size, size, size);
+	}
+}
+
+void	emit_dblcoefrom(FILE *vmain, int size, int cbits, const char *cmem) {
+	int	lgspan = lgval(size)-2;
+
+	fprintf(vmain, "\t// Twiddle factors for both halves of the %d point stage\n", size);
+	fprintf(vmain, "\twire\t[%d:0]\tw_cae%d, w_cao%d;\n", lgspan-1, size, size);
+	fprintf(vmain, "\twire\t[%d:0]\tw_ce%d, w_co%d;\n", 2*cbits-1, size, size);
+	fprintf(vmain, "\tcoefrom\t#(%d,%d,\"%s\")\n\t\tcrom_%d(i_clk, i_ce, { w_cae%d, 1\'b0 }, w_ce%d,\n\t\t\t{ w_cao%d, 1\'b1 }, w_co%d);\n",
+		cbits, lgspan+1, cmem, size, size, size, size, size);
+}
+
+std::string	coef_ports(bool share_coef, int size, const char *half = "") {
+	char	buf[64];
+
+	if (!share_coef)
+		return std::string("");
+	sprintf(buf, ", w_ca%s%d, w_c%s%d", half, size, half, size);
+	return std::string(buf);
+}
+
+//
+// Given eight or more clocks per sample, the hardware butterflies of each
+// pair of multiply stages share a single multiply, held in an mpyshare in
+// the top level.  The butterfly of the larger stage uses the multiply on
+// the first three clocks following each i_ce, and that of the smaller stage
+// on the next three.  Should there be an odd number of multiply stages, the
+// last has an mpyshare all to itself.
+//
+// Every fftstage then has the ports for an external multiply.  Those
+// stages not using hardware multiplies simply ignore them.
+//
+void	emit_mpywires(FILE *vmain, int size, int iw, int cw, bool mpystage) {
+	if (!mpystage)
+		fprintf(vmain, "\t// verilator lint_off UNUSED\n");
+	fprintf(vmain, "\twire\t[%d:0]\tw_mc%d;\n", 3*(cw+1)-1, size);
+	fprintf(vmain, "\twire\t[%d:0]\tw_md%d;\n", 3*(iw+2)-1, size);
+	if (!mpystage)
+		fprintf(vmain, "\t// verilator lint_on  UNUSED\n");
+	fprintf(vmain, "\twire\t[%d:0]\tw_mp%d;\n", 3*(cw+iw+3)-1, size);
+	if (!mpystage)
+		fprintf(vmain, "\tassign\tw_mp%d = 0;\n", size);
+}
+
+void	emit_mpyshare(FILE *vmain, const char *resetw,
+		int asize, int aiw, int acw, int bsize, int biw, int bcw) {
+	if (bsize > 0) {
+		fprintf(vmain, "\t// One multiply, shared by the %d and %d point stages\n", asize, bsize);
+		fprintf(vmain, "\tmpyshare\t#(%d,%d,%d,%d)\n\t\tmpy_%d(i_clk, %s, i_ce,\n",
+			acw+1, aiw+2, bcw+1, biw+2, asize, resetw);
+		fprintf(vmain, "\t\t\tw_mc%d, w_md%d, w_mp%d,\n\t\t\tw_mc%d, w_md%d, w_mp%d);\n",
+			asize, asize, asize, bsize, bsize, bsize);
+	} else {
+		fprintf(vmain, "\t// A multiply for the %d point stage alone\n", asize);
+		fprintf(vmain, "\t// verilator lint_off UNUSED\n\twire\t[%d:0]\tw_mpx%d;\n\t// verilator lint_on  UNUSED\n", 3*(acw+aiw+3)-1, asize);
+		fprintf(vmain, "\tmpyshare\t#(%d,%d,%d,%d)\n\t\tmpy_%d(i_clk, %s, i_ce,\n",
+			acw+1, aiw+2, acw+1, aiw+2, asize, resetw);
+		fprintf(vmain, "\t\t\tw_mc%d, w_md%d, w_mp%d,\n\t\t\t0, 0, w_mpx%d);\n",
+			asize, asize, asize, asize);
+	}
+}
+
+std::string	mpy_ports(bool share_mpy, int size) {
+	char	buf[64];
+
+	if (!share_mpy)
+		return std::string("");
+	sprintf(buf, ", w_mc%d, w_md%d, w_mp%d", size, size, size);
+	return std::string(buf);
+}
+
 void	usage(void) {
 	fprintf(stderr,
 "USAGE:\tfftgen [-f <size>] [-d dir] [-c cbits] [-n nbits] [-m mxbits] [-s]\n"
@@ -965,35 +1160,100 @@ void	usage(void) {
 "\t\t(for a real FFT) at one clock per two real input samples.\n"
 "\t-a <hdrname>  Create a header of information describing the built-in\n"
 "\t\tparameters, useful for module-level testing with Verilator\n"
+"\t-b\tBuild bidirfft.v, wrapping a forward FFT whose direction is\n"
+"\t\tchosen for each frame by an i_inverse input.  Inverse frames are\n"
+"\t\tconjugated into and out of the one FFT, so both directions\n"
+"\t\tshare its twiddle factor ROMs.  Requires -1.\n"
+"\t-B <first>,<nbins>  Keep only the nbins output bins starting at\n"
+"\t\tbin first.  The bit reversal memory then holds only these bins,\n"
+"\t\twhich fftmain produces in natural order at the start of each\n"
+"\t\tframe, marked by a new o_valid output.  Requires -1.\n"
 "\t-c <cbits>\tCauses all internal complex coefficients to be\n"
 "\t\tlonger than the corresponding data bits, to help avoid\n"
 "\t\tcoefficient truncation errors.  The default is %d bits longer\n"
 "\t\tthan the data bits.\n"
+"\t-C\tTrim the coefficients of each stage by the noise they add to\n"
+"\t\tthe output.  By default, each stage\'s coefficients grow with\n"
+"\t\tits data width.  -C lets the twiddles of all stages together\n"
+"\t\tadd up to twice the noise they would at those widths, taking\n"
+"\t\tbits from the stages whose twiddles add the least noise.  No\n"
+"\t\tstage is ever given wider coefficients than its default.\n"
 "\t-d <dir>  Places all of the generated verilog files into <dir>.\n"
 "\t\tThe default is a subdirectory of the current directory\n"
 "\t\tnamed %s.\n"
 "\t-f <size>  Sets the size of the FFT as the number of complex\n"
 "\t\tsamples input to the transform.  (No default value, this is\n"
 "\t\ta required parameter.)\n"
+"\t-F\tBuild fourstep.v, a four-step FFT of -f <size> points, for sizes\n"
+"\t\tfar too large for a single pipeline.  The size must be a power of\n"
+"\t\tfour.  Two sqrt(size) point fftmain pipelines are built, with a\n"
+"\t\ttwiddle multiply between them, and the data is transposed\n"
+"\t\tthrough two channels of external memory.  extmem.v models this\n"
+"\t\tmemory for simulation.  Requires -1.\n"
 "\t-i\tAn inverse FFT, meaning that the coefficients are\n"
 "\t\tgiven by e^{ j 2 pi k/N n }.  The default is a forward FFT, with\n"
 "\t\tcoefficients given by e^{ -j 2 pi k/N n }.\n"
+"\t-I <nfrm>[,<width>]  Build psdaccum.v, a back end integrating the\n"
+"\t\tpower, |X|^2, in each FFT bin across nfrm frames.  The sums are\n"
+"\t\treduced to their top <width> bits, if given.  With nfrm of 1,\n"
+"\t\tthe power of each bin is produced as it is found.  This works on\n"
+"\t\tthe FFT's output in either order, so it may be used with -s.\n"
 "\t-k #\tSets # clocks per sample, used to minimize multiplies.  Also\n"
-"\t\tsets one sample in per i_ce clock (opt -1)\n"
+"\t\tsets one sample in per i_ce clock (opt -1).  Each hardware\n"
+"\t\tbutterfly uses three multiplies at one clock per sample, two at\n"
+"\t\ttwo, and one at three or more.  At eight or more, each pair of\n"
+"\t\tstages shares a single multiply, so -p counts two stages each.\n"
+"\t-K <k>\tBuild topk.v, a back end producing only the k bins of greatest\n"
+"\t\tpower within each frame, strongest first, together with their\n"
+"\t\tbin numbers.  As with -I, this may be used with -s.\n"
 "\t-m <mxbits>\tSets the maximum bit width that the FFT should ever\n"
 "\t\tproduce.  Internal values greater than this value will be\n"
 "\t\ttruncated to this value.  (The default value grows the input\n"
 "\t\tsize by one bit for every two FFT stages.)\n"
+"\t-M\tWrite fftmodel.h and fftmodel.cpp (ifftmodel.* for -i), a C++\n"
+"\t\tmodel of the fftmain just built, intended to be bit exact but\n"
+"\t\tnot yet checked against the Verilog.  The model uses the\n"
+"\t\tsame widths, rounding, and twiddle factor files as each stage of\n"
+"\t\tthe Verilog, and produces its outputs in the same order.\n"
+"\t\tfftmodel_t.h holds the same model, specialized at compile time\n"
+"\t\tand with the twiddle factors built in.\n"
 "\t-n <nbits>\tSets the bitwidth for values coming into the (i)FFT.\n"
 "\t\tThe default is %d bits input for each component of the two\n"
 "\t\tcomplex values into the FFT.\n"
+"\t-o <cplen>\tBuild an OFDM modulator, ofdmmod.v, if -i is given, or\n"
+"\t\ta demodulator, ofdmdemod.v, otherwise, for symbols led by a\n"
+"\t\tcyclic prefix of cplen samples.  The modulator inserts the prefix\n"
+"\t\tfrom the FFT\'s own bit reversal memory.  The demodulator drops it,\n"
+"\t\taligning to the symbol timing given by an i_sync input.  Requires\n"
+"\t\t-1.\n"
+"\t-O <ovsamp>\tOversample the polyphase filter bank outputs by this\n"
+"\t\tfactor, either 1 (critically sampled, the default) or 2.\n"
 "\t-p <nmpy>  Sets the number of hardware multiplies (DSPs) to use, versus\n"
 "\t\tshift-add emulation.  The default is not to use any hardware\n"
 "\t\tmultipliers.\n"
+"\t-P <taps>\tBuild a polyphase filter bank front end, polyphase.v,\n"
+"\t\twith this many taps per branch, together with its prototype\n"
+"\t\tfilter taps in polyphase_<size>x<taps>.hex.  The prototype is a\n"
+"\t\twindowed sinc, using the -W window (Hann by default).  The bank\n"
+"\t\tfeeds a single sample per clock FFT directly, giving far better\n"
+"\t\tisolation between bins than a window alone.\n"
+"\t-q\tQuantize the coefficients for minimum error, rather than\n"
+"\t\trounding each independently.  This chooses the scale, just\n"
+"\t\tbelow unity, at which the rounded coefficients of each stage\n"
+"\t\tfall closest to the unit circle.  The resulting gain error is\n"
+"\t\tharmless, while the lower coefficient error raises the SFDR.\n"
+"\t-R <rnd>[,<rnd>...]  Sets the rounding method used by each stage,\n"
+"\t\tbeginning with the first (largest) stage.  Methods are truncate,\n"
+"\t\tfromzero, halfup, and convergent (the default).  The last method\n"
+"\t\tlisted applies to all remaining stages, so -R t,t,t,c will\n"
+"\t\ttruncate in the first three stages and use convergent rounding\n"
+"\t\tthereafter.\n"
 "\t-r\tBuild a real-FFT at four input points per sample, rather than a\n"
-"\t\tcomplex FFT.  (Default is a Complex FFT.)\n"
-"\t\tThis option is a place-holder.  The real-FFT has not (yet) been\n"
-"\t\timplemented.\n"
+"\t\tcomplex FFT.  (Default is a Complex FFT.)  Only the inverse,\n"
+"\t\t-r -i, has been implemented.  This builds realifft.v, taking\n"
+"\t\tthe N/2 bins of a Hermitian spectrum (with bin N/2 in the\n"
+"\t\timaginary part of bin 0) one per clock, and producing two real\n"
+"\t\toutputs per clock from an N/2 point complex inverse FFT.\n"
 "\t-s\tSkip the final bit reversal stage.  This is useful in\n"
 "\t\talgorithms that need to apply a filter without needing to do\n"
 "\t\tbin shifting, as these algorithms can, with this option, just\n"
@@ -1002,9 +1262,53 @@ void	usage(void) {
 "\t\ta decimation in time inverse to do this, which this program does\n"
 "\t\tnot yet provide.)\n"
 "\t-S\tInclude the final bit reversal stage (default).\n"
+"\t-t <rows>x<cols>[,r]  Build fft2d.v, a streaming two dimensional\n"
+"\t\tFFT of image tiles, taking one pixel per clock in row major\n"
+"\t\torder.  Rows are transformed by one fftmain, the corner is turned\n"
+"\t\tby transpose.v, and columns are transformed by a second fftmain.\n"
+"\t\tThe bins come out in column major order, unless ,r is given to\n"
+"\t\tadd a second transpose back to row major order.  Tiles must be\n"
+"\t\tsquare, and this replaces -f.  Requires -1.\n"
+"\t-T\tShare twiddle factor ROMs.  Each pair of FFT stages reads its\n"
+"\t\tcoefficients from a single dual-port ROM, since the smaller\n"
+"\t\tstage's table is every other entry of the larger's.  Both\n"
+"\t\tstages of a pair use the wider of their two coefficient widths.\n"
+"\t\tWith -2, the even and odd halves of each stage share one ROM.\n"
+"\t-u\tUse one complex FFT for two real channels, a[n] + j b[n].\n"
+"\t\tThe bit reversal reads bins k and N-k on alternate clocks,\n"
+"\t\tthrough its one read port, and dualreal.v is built to separate\n"
+"\t\tthe two channels\' spectra, bins 0 through N/2, from these.\n"
+"\t\tRequires -1, and may not be used with -s.\n"
+"\t-w\tBuild dualclk.v, running the FFT from its own clock, i_fclk,\n"
+"\t\tfaster than the clock its samples arrive and leave on, i_sclk.\n"
+"\t\tSamples cross between the two through asynchronous FIFOs,\n"
+"\t\tafifo.v.  The FFT is built for -k clocks per sample, two if not\n"
+"\t\tgiven, so that it needs fewer multiplies per stage.  i_fclk must\n"
+"\t\trun at least -k times as fast as the samples.  Requires -1.\n"
+"\t-W <window>\tWrite the taps of a window function, one of rect,\n"
+"\t\thann, hamming, or blackman, to window_<size>.hex.  For a -1 FFT\n"
+"\t\tthese are the usual periodic window, for rtl/windowfn.v.  For a\n"
+"\t\t-2 FFT, dblwindowfn.v is built as well.  This applies the\n"
+"\t\twindow to one real sample per clock, producing frames with 50%%\n"
+"\t\toverlap at the two samples per clock the FFT expects.  Its\n"
+"\t\twindow is taken half a sample later, so that it is symmetric\n"
+"\t\tand only half of its taps need be kept.\n"
 "\t-x <xtrabits>\tUse this many extra bits internally, before any final\n"
 "\t\trounding or truncation of the answer to the final number of\n"
-"\t\tbits.  The default is to use %d extra bits internally.\n",
+"\t\tbits.  The default is to use %d extra bits internally.\n"
+"\t-X <dct>\tBuild a streaming DCT around an N/2 point FFT, where -f\n"
+"\t\tgives N.  <dct> is one of dct2, dct4, or mdct.  dct2.v and\n"
+"\t\tdct4.v take N real samples per frame, and produce their N\n"
+"\t\tcoefficients.  mdct.v produces N coefficients from each window\n"
+"\t\tof 2N samples, hopping N samples at a time.  Requires -1.\n"
+"\t-z <m>\tPrune the FFT for zero padded frames, where only the first m\n"
+"\t\tsamples of each frame may be nonzero.  i_ce still marks every\n"
+"\t\tsample of the frame, but i_sample is ignored past the first m.\n"
+"\t\tEach stage spanning m or more samples then stores only the\n"
+"\t\tnonzero ones, and its butterfly\'s second input is tied to zero.\n"
+"\t\tzeropad.v is also built, taking only the m nonzero samples of\n"
+"\t\teach frame and giving the FFT the N-m zeros itself, one per\n"
+"\t\tclock.  Requires -1, and 2 <= m <= N/2.\n",
 /*
 "\t-0\tA forward FFT (default), meaning that the coefficients are\n"
 "\t\tgiven by e^{-j 2 pi k/N n }.\n"
@@ -1026,11 +1330,37 @@ int main(int argc, char **argv) {
 		verbose_flag = false,
 		single_clock = true,
 		real_fft = false,
-		async_reset = false;
+		async_reset = false,
+		noise_cbits = false,
+		opt_coef = false,
+		share_coef = false,
+		share_mpy = false,
+		dual_real = false,
+		four_step = false,
+		tile_reorder = false,
+		bidir = false,
+		dual_clock = false,
+		sw_model = false,
+		mirror = false;
+	WINDOW_T	window = WIN_NONE;
+	int	pfbtaps = 0, pfbovsamp = 1;
+	int	psdavg = 0, psdbits = 0, topk = 0;
+	int	realsize = 0, realbits = 0;
+	int	nonzero = 0, binfirst = 0, binlen = 0;
+	int	lgbigsize = 0, tilerows = 0, tilecols = 0;
+	int	cplen = 0, dctbits = 0;
+	DCT_T	dct = DCT_NONE;
 	FILE	*vmain;
 	std::string	coredir = DEF_COREDIR, cmdline = "", hdrname = "";
 	ROUND_T	rounding = RND_CONVERGENT;
 	// ROUND_T	rounding = RND_HALFUP;
+	ROUND_T	rndlist[MAXRNDSTAGES], stage_rnd[MAXRNDSTAGES];
+	int	nrnd = 0;
+	unsigned	rndmask = 0;
+	// The stages of fftmain, as built, for the C++ model
+	MDLSTAGE	mdlstage[MAXRNDSTAGES];
+	int	nmdl = 0;
+	bool	rndsel = false;
 
 	bool	dbg = false;
 	int	dbgstage = 128;
@@ -1046,15 +1376,17 @@ int main(int argc, char **argv) {
 	}
 
 	{ int c;
-	while((c = getopt(argc, argv, "12Aa:c:d:D:f:hik:m:n:p:rsSx:v")) != -1) {
+	while((c = getopt(argc, argv, "12Aa:bB:Cc:d:D:f:FhiI:k:K:m:Mn:o:O:p:P:qrR:sSt:TuvwW:x:X:z:")) != -1) {
 		switch(c) {
 		case '1':	single_clock = true;  break;
 		case '2':	single_clock = false; break;
 		case 'A':	async_reset  = true;  break;
 		case 'a':	hdrname = strdup(optarg);	break;
+		case 'C':	noise_cbits = true;		break;
 		case 'c':	xtracbits = atoi(optarg);	break;
 		case 'd':	coredir = std::string(optarg);	break;
 		case 'D':	dbgstage = atoi(optarg);	break;
+		case 'F':	four_step = true;		break;
 		case 'f':	fftsize = atoi(optarg);	
 				{ int sln = strlen(optarg);
 				if (!isdigit(optarg[sln-1])){
@@ -1075,16 +1407,66 @@ int main(int argc, char **argv) {
 				}} break;
 		case 'h':	usage(); exit(EXIT_SUCCESS);	break;
 		case 'i':	inverse = true;			break;
+		case 'b':	bidir = true;			break;
+		case 'B':	{ char *ptr;
+				binfirst = strtol(optarg, &ptr, 0);
+				if (*ptr == ',')
+					binlen = strtol(ptr+1, &ptr, 0);
+				if ((*ptr != '\0')||(binfirst < 0)||(binlen < 2)) {
+					fprintf(stderr, "ERR: Unrecognized bin range, %s\n", optarg);
+					exit(EXIT_FAILURE);
+				}} break;
+		case 'I':	{ char *ptr;
+				psdavg = strtol(optarg, &ptr, 0);
+				if (*ptr == ',')
+					psdbits = strtol(ptr+1, &ptr, 0);
+				if ((*ptr != '\0')||(psdavg < 1)) {
+					fprintf(stderr, "ERR: Unrecognized integration, %s\n", optarg);
+					exit(EXIT_FAILURE);
+				}} break;
 		case 'k':	ckpce = atoi(optarg);
 				single_clock = true;
 				break;
+		case 'K':	topk = atoi(optarg);		break;
 		case 'm':	maxbitsout = atoi(optarg);	break;
+		case 'M':	sw_model = true;		break;
 		case 'n':	nbitsin = atoi(optarg);		break;
+		case 'o':	cplen = atoi(optarg);		break;
+		case 'O':	pfbovsamp = atoi(optarg);	break;
 		case 'p':	nummpy = atoi(optarg);		break;
+		case 'P':	pfbtaps = atoi(optarg);		break;
+		case 'q':	opt_coef = true;		break;
 		case 'r':	real_fft = true;		break;
+		case 'R':	nrnd = parse_rounding_list(optarg, rndlist);
+				break;
 		case 'S':	bitreverse = true;		break;
+		case 't':	{ char *ptr;
+				tilerows = strtol(optarg, &ptr, 0);
+				if ((*ptr == 'x')||(*ptr == 'X'))
+					tilecols = strtol(ptr+1, &ptr, 0);
+				if ((ptr[0] == ',')&&(ptr[1] == 'r')) {
+					tile_reorder = true;
+					ptr += 2;
+				}
+				if ((*ptr != '\0')||(tilerows < 1)||(tilecols < 1)) {
+					fprintf(stderr, "ERR: Unrecognized tile size, %s\n", optarg);
+					exit(EXIT_FAILURE);
+				}} break;
+		case 'T':	share_coef = true;		break;
 		case 's':	bitreverse = false;		break;
+		case 'u':	dual_real = true;		break;
+		case 'w':	dual_clock = true;		break;
+		case 'W':	if (!parse_window(optarg, window)) {
+					fprintf(stderr, "ERR: Unknown window, %s\n", optarg);
+					fprintf(stderr, "Valid windows are rect, hann, hamming, and blackman\n");
+					exit(EXIT_FAILURE);
+				} break;
 		case 'x':	xtrapbits = atoi(optarg);	break;
+		case 'X':	if (!parse_dct(optarg, dct)) {
+				fprintf(stderr, "ERR: Unknown transform, %s\n", optarg);
+				exit(EXIT_FAILURE);
+				} break;
+		case 'z':	nonzero = atoi(optarg);		break;
 		case 'v':	verbose_flag = true;		break;
 		// case 'z':	variable_size = true;		break;
 		default:
@@ -1107,6 +1489,36 @@ int main(int argc, char **argv) {
 			printf("  that accepts two inputs per clock\n");
 		if (async_reset)
 			printf("  using a negative logic ASYNC reset\n");
+		if (window != WIN_NONE)
+			printf("  with %s window taps%s\n",
+				window_name(window),
+				(single_clock) ? "" : ", applied by dblwindowfn.v");
+		if (psdavg > 0)
+			printf("  followed by the integration of %d frames of power\n",
+				psdavg);
+		if (topk > 0)
+			printf("  followed by a search for the %d strongest bins\n",
+				topk);
+		if (dual_real)
+			printf("  shared by two real channels, separated by dualreal.v\n");
+		if ((cplen > 0)&&(inverse))
+			printf("  modulating OFDM symbols with a %d sample cyclic prefix\n", cplen);
+		else if (cplen > 0)
+			printf("  demodulating OFDM symbols with a %d sample cyclic prefix\n", cplen);
+		if (bidir)
+			printf("  switched to an inverse FFT at run time, by bidirfft.v\n");
+		if (dual_clock)
+			printf("  clocked faster than its samples, within dualclk.v\n");
+		if (nonzero > 0)
+			printf("  pruned for %d nonzero samples a frame, zero filled by zeropad.v\n",
+				nonzero);
+		if (binlen > 0)
+			printf("  producing only bins %d through %d\n",
+				binfirst, binfirst+binlen-1);
+		if (pfbtaps > 0)
+			printf("  fed by a %d tap per branch, %s polyphase filter bank\n",
+				pfbtaps, (pfbovsamp > 1) ? "2x oversampled"
+					: "critically sampled");
 
 		printf("The core will be placed into the %s/ directory\n", coredir.c_str());
 
@@ -1119,8 +1531,121 @@ int main(int argc, char **argv) {
 	}
 
 	if (real_fft) {
-		printf("The real FFT option is not implemented yet, but still on\nmy to do list.  Please try again later.\n");
-		exit(EXIT_FAILURE);
+		if (!inverse) {
+			printf("The real FFT option is not implemented yet, but still on\nmy to do list.  Please try again later.\n");
+			exit(EXIT_FAILURE);
+		} else if (!single_clock) {
+			fprintf(stderr, "ERR: The real inverse FFT requires a single sample per clock FFT\n");
+			exit(EXIT_FAILURE);
+		} else if (fftsize < 8) {
+			fprintf(stderr, "ERR: The real inverse FFT requires 8 points or more\n");
+			exit(EXIT_FAILURE);
+		} else if ((window != WIN_NONE)||(pfbtaps != 0)
+				||(psdavg != 0)||(topk != 0)) {
+			fprintf(stderr, "ERR: The real inverse FFT cannot be combined with -W, -P, -I, or -K\n");
+			exit(EXIT_FAILURE);
+		}
+
+		// The N real outputs come from an N/2 point complex inverse
+		// FFT, whose inputs are one bit wider than the spectrum
+		realsize = fftsize;
+		realbits = nbitsin;
+		fftsize /= 2;
+		nbitsin += 1;
+
+		if (verbose_flag)
+			printf("  as hermitian.v followed by a %d point complex inverse FFT\n",
+				fftsize);
+	}
+
+	if (dct != DCT_NONE) {
+		if ((!single_clock)||(!bitreverse)) {
+			fprintf(stderr, "ERR: The DCT requires a single sample per clock FFT, with its bit reversal\n");
+			exit(EXIT_FAILURE);
+		} else if (inverse) {
+			fprintf(stderr, "ERR: Only the forward DCT has been implemented\n");
+			exit(EXIT_FAILURE);
+		} else if ((real_fft)||(dual_real)||(window != WIN_NONE)
+				||(pfbtaps != 0)||(psdavg != 0)||(topk != 0)
+				||(nonzero != 0)||(binlen != 0)||(four_step)
+				||(tilerows != 0)||(bidir)||(cplen != 0)) {
+			fprintf(stderr, "ERR: The DCT cannot be combined with -r, -u, -W, -P, -I, -K, -z, -B, -F, -t, -b, or -o\n");
+			exit(EXIT_FAILURE);
+		} else if ((fftsize < 16)||(fftsize & (fftsize-1))) {
+			fprintf(stderr, "ERR: The DCT size must be a power of two, 16 or more\n");
+			exit(EXIT_FAILURE);
+		}
+
+		// The N point DCT uses an N/2 point FFT.  The DCT-IV's
+		// pre-twiddle adds a bit to its input, and the MDCT's fold
+		// adds another.
+		dctbits = nbitsin;
+		fftsize /= 2;
+		if (dct == DCT_IV)
+			nbitsin += 1;
+		else if (dct == DCT_MDCT)
+			nbitsin += 2;
+		mirror = (dct == DCT_II);
+
+		if (verbose_flag)
+			printf("  as a %d point %s, from a %d point complex FFT\n",
+				fftsize*2, dct_name(dct), fftsize);
+	}
+
+	if (tilerows > 0) {
+		if ((!single_clock)||(!bitreverse)) {
+			fprintf(stderr, "ERR: The 2D FFT requires a single sample per clock FFT, with its bit reversal\n");
+			exit(EXIT_FAILURE);
+		} else if ((four_step)||(real_fft)||(dual_real)
+				||(window != WIN_NONE)||(pfbtaps != 0)
+				||(psdavg != 0)||(topk != 0)
+				||(nonzero != 0)||(binlen != 0)) {
+			fprintf(stderr, "ERR: The 2D FFT cannot be combined with -F, -r, -u, -W, -P, -I, -K, -z, or -B\n");
+			exit(EXIT_FAILURE);
+		} else if (tilerows != tilecols) {
+			fprintf(stderr, "ERR: The 2D FFT only supports square tiles\n");
+			exit(EXIT_FAILURE);
+		} else if ((tilecols < 8)||(tilecols & (tilecols-1))) {
+			fprintf(stderr, "ERR: The 2D FFT tile size must be a power of two, 8 or more\n");
+			exit(EXIT_FAILURE);
+		} else if ((fftsize > 0)&&(fftsize != tilecols)) {
+			fprintf(stderr, "ERR: The FFT size, -f %d, doesn\'t match the %dx%d tile\n",
+				fftsize, tilerows, tilecols);
+			exit(EXIT_FAILURE);
+		}
+
+		// Rows and columns share one fftmain
+		fftsize = tilecols;
+
+		if (verbose_flag)
+			printf("  for a %dx%d two dimensional FFT, in %s major order\n",
+				tilerows, tilecols,
+				(tile_reorder) ? "row" : "column");
+	}
+
+	if (four_step) {
+		for(lgbigsize=1; (1<<lgbigsize) < fftsize; lgbigsize++)
+			;
+		if ((!single_clock)||(!bitreverse)) {
+			fprintf(stderr, "ERR: The four-step FFT requires a single sample per clock FFT, with its bit reversal\n");
+			exit(EXIT_FAILURE);
+		} else if ((real_fft)||(dual_real)||(window != WIN_NONE)
+				||(pfbtaps != 0)||(psdavg != 0)||(topk != 0)
+				||(nonzero != 0)||(binlen != 0)) {
+			fprintf(stderr, "ERR: The four-step FFT cannot be combined with -r, -u, -W, -P, -I, -K, -z, or -B\n");
+			exit(EXIT_FAILURE);
+		} else if ((fftsize != (1<<lgbigsize))||(lgbigsize & 1)
+				||(lgbigsize < 6)) {
+			fprintf(stderr, "ERR: The four-step FFT size must be a power of four, 64 or more\n");
+			exit(EXIT_FAILURE);
+		}
+
+		// Each step is a sqrt(N) point FFT
+		fftsize = 1<<(lgbigsize/2);
+
+		if (verbose_flag)
+			printf("  as a %d point four-step FFT, using two %d point FFTs\n",
+				1<<lgbigsize, fftsize);
 	}
 
 	if (ckpce < 1)
@@ -1136,6 +1661,131 @@ int main(int argc, char **argv) {
 			;
 	}
 
+	if ((window != WIN_NONE)&&(!single_clock)&&(fftsize < 8)) {
+		fprintf(stderr, "ERR: The two sample per clock window requires an FFT of 8 points or more\n");
+		exit(EXIT_FAILURE);
+	}
+
+	if (pfbtaps != 0) {
+		if (!single_clock) {
+			fprintf(stderr, "ERR: The polyphase filter bank requires a single sample per clock FFT\n");
+			exit(EXIT_FAILURE);
+		} else if (pfbtaps < 2) {
+			fprintf(stderr, "ERR: A polyphase filter bank needs at least two taps per branch\n");
+			exit(EXIT_FAILURE);
+		} else if ((pfbovsamp != 1)&&(pfbovsamp != 2)) {
+			fprintf(stderr, "ERR: The polyphase filter bank may only be oversampled by 1 or 2\n");
+			exit(EXIT_FAILURE);
+		} else if ((pfbovsamp > 1)&&(fftsize < 4)) {
+			fprintf(stderr, "ERR: An oversampled polyphase filter bank requires an FFT of 4 points or more\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	if ((psdavg > 0)&&(fftsize < ((single_clock) ? 2 : 4))) {
+		fprintf(stderr, "ERR: Power integration requires at least two samples per frame\n");
+		exit(EXIT_FAILURE);
+	}
+
+	if ((topk != 0)&&((topk < 0)
+			||(topk > ((single_clock) ? fftsize : fftsize/2)))) {
+		fprintf(stderr, "ERR: The peak search can only keep from 1 to %d bins\n",
+			(single_clock) ? fftsize : fftsize/2);
+		exit(EXIT_FAILURE);
+	}
+
+	if (dual_real) {
+		if ((!single_clock)||(!bitreverse)) {
+			fprintf(stderr, "ERR: Two real channels require a single sample per clock FFT, with its bit reversal\n");
+			exit(EXIT_FAILURE);
+		} else if ((real_fft)||(psdavg != 0)||(topk != 0)) {
+			fprintf(stderr, "ERR: Two real channels cannot be combined with -r, -I, or -K\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	if (nonzero != 0) {
+		if (!single_clock) {
+			fprintf(stderr, "ERR: Input pruning requires a single sample per clock FFT\n");
+			exit(EXIT_FAILURE);
+		} else if ((real_fft)||(pfbtaps != 0)) {
+			fprintf(stderr, "ERR: Input pruning cannot be combined with -r or -P\n");
+			exit(EXIT_FAILURE);
+		} else if ((fftsize < 8)||(nonzero < 2)||(nonzero > fftsize/2)) {
+			fprintf(stderr, "ERR: Input pruning requires an FFT of 8 points or more, and\n"
+				"\tfrom 2 to N/2 nonzero samples\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	if (binlen > 0) {
+		if ((!single_clock)||(!bitreverse)) {
+			fprintf(stderr, "ERR: Output pruning requires a single sample per clock FFT, with its bit reversal\n");
+			exit(EXIT_FAILURE);
+		} else if ((dual_real)||(real_fft)||(psdavg != 0)||(topk != 0)) {
+			fprintf(stderr, "ERR: Output pruning cannot be combined with -u, -r, -I, or -K\n");
+			exit(EXIT_FAILURE);
+		} else if ((fftsize < 8)||(binfirst+binlen > fftsize)) {
+			fprintf(stderr, "ERR: Output pruning requires an FFT of 8 points or more, and\n"
+				"\ta bin range within it\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	if (cplen != 0) {
+		if ((!single_clock)||(!bitreverse)) {
+			fprintf(stderr, "ERR: OFDM requires a single sample per clock FFT, with its bit reversal\n");
+			exit(EXIT_FAILURE);
+		} else if ((real_fft)||(dual_real)||(pfbtaps != 0)
+				||(psdavg != 0)||(topk != 0)||(binlen != 0)
+				||(nonzero != 0)||(four_step)||(tilerows != 0)
+				||(bidir)) {
+			fprintf(stderr, "ERR: OFDM cannot be combined with -r, -u, -P, -I, -K, -B, -z, -F, -t, or -b\n");
+			exit(EXIT_FAILURE);
+		} else if ((fftsize < 8)||(cplen < 2)||(cplen >= fftsize)) {
+			fprintf(stderr, "ERR: OFDM requires an FFT of 8 points or more, and\n"
+				"\ta cyclic prefix from 2 to N-1 samples long\n");
+			exit(EXIT_FAILURE);
+		}
+
+		// The modulator's prefix is inserted by its own bit reversal
+		if (inverse)
+			bitreverse = false;
+	}
+
+	if (bidir) {
+		if (!single_clock) {
+			fprintf(stderr, "ERR: A run time direction requires a single sample per clock FFT\n");
+			exit(EXIT_FAILURE);
+		} else if (inverse) {
+			fprintf(stderr, "ERR: A run time direction already includes the inverse, drop -i\n");
+			exit(EXIT_FAILURE);
+		} else if ((real_fft)||(dual_real)||(pfbtaps != 0)
+				||(psdavg != 0)||(topk != 0)||(binlen != 0)
+				||(four_step)||(tilerows != 0)) {
+			fprintf(stderr, "ERR: A run time direction cannot be combined with -r, -u, -P, -I, -K, -B, -F, or -t\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	if (dual_clock) {
+		if (!single_clock) {
+			fprintf(stderr, "ERR: Two clock domains require a single sample per clock FFT\n");
+			exit(EXIT_FAILURE);
+		} else if ((real_fft)||(dual_real)||(pfbtaps != 0)
+				||(psdavg != 0)||(topk != 0)||(binlen != 0)
+				||(four_step)||(tilerows != 0)||(bidir)
+				||(cplen != 0)||(dct != DCT_NONE)) {
+			fprintf(stderr, "ERR: Two clock domains cannot be combined with -r, -u, -P, -I, -K, -B, -F, -t, -b, -o, or -X\n");
+			exit(EXIT_FAILURE);
+		}
+
+		// The point of the faster clock is to share each multiply
+		// across more than one clock
+		if (ckpce < 2)
+			ckpce = 2;
+	}
+
 	if ((fftsize <= 0)||(nbitsin < 1)||(nbitsin>48)) {
 		printf("INVALID PARAMETERS!!!!\n");
 		exit(EXIT_FAILURE);
@@ -1184,17 +1834,79 @@ int main(int argc, char **argv) {
 	} if ((maxbitsout > 0)&&(nbitsout > maxbitsout))
 		nbitsout = maxbitsout;
 
+	// The twiddle factor width of each stage, indexed by its log size.
+	// By default, these grow with the data through the FFT.  -C then
+	// trims them by the noise each stage adds.
+	int	dflt_cbits[32], stage_cbits[32];
+	{
+		int	nbits = nbitsin+1+xtrapbits, dropbit = 0;
+
+		for(int k=0; k<32; k++)
+			dflt_cbits[k] = nbitsin+xtracbits;
+		if ((maxbitsout > 0)&&(nbits > maxbitsout))
+			nbits = maxbitsout;
+		for(int k=lgsize-1; k>=3; k--) {
+			int	obits = nbits+((dropbit)?0:1);
+
+			if ((maxbitsout > 0)&&(obits > maxbitsout))
+				obits = maxbitsout;
+			dflt_cbits[k] = nbits+xtracbits+xtrapbits;
+			dropbit ^= 1;
+			nbits = obits;
+		}
+
+		if (noise_cbits)
+			coef_bits(lgsize, dflt_cbits, stage_cbits);
+		else for(int k=0; k<32; k++)
+			stage_cbits[k] = dflt_cbits[k];
+	}
+
 	if (verbose_flag) {
 		printf("Output samples will be %d bits wide\n", nbitsout);
 		printf("This %sFFT will take %d-bit samples in, and produce %d samples out\n", (inverse)?"i":"", nbitsin, nbitsout);
 		if (maxbitsout > 0)
 			printf("  Internally, it will allow items to accumulate to %d bits\n", maxbitsout);
-		printf("  Twiddle-factors of %d bits will be used\n",
-			nbitsin+xtracbits);
+		if (noise_cbits) {
+			printf("  Twiddle-factors will be sized by stage:");
+			for(int k=lgsize; k>=3; k--)
+				printf(" %d:%d", 1<<k, stage_cbits[k]);
+			printf("\n  rather than the default of:");
+			for(int k=lgsize; k>=3; k--)
+				printf(" %d:%d", 1<<k, dflt_cbits[k]);
+			printf("\n");
+		} else
+			printf("  Twiddle-factors of %d bits will be used\n",
+				nbitsin+xtracbits);
 		if (!bitreverse)
 		printf("  The output will be left in bit-reversed order\n");
 	}
 
+	// Assign a rounding method to every stage
+	for(int k=0; k<lgsize; k++) {
+		if (nrnd <= 0)
+			stage_rnd[k] = rounding;
+		else if (k < nrnd)
+			stage_rnd[k] = rndlist[k];
+		else
+			stage_rnd[k] = rndlist[nrnd-1];
+		rndmask |= (1u << (int)stage_rnd[k]);
+	} if (nrnd > lgsize)
+		fprintf(stderr, "WARNING: Only %d of the %d rounding methods given will be used\n", lgsize, nrnd);
+	rounding = stage_rnd[0];
+	// If more than one rounder is in use, every stage will need to
+	// select its own
+	rndsel = ((rndmask & (rndmask-1)) != 0);
+
+	if ((verbose_flag)&&(rndsel)) {
+		printf("  Each stage will use its own rounding method:\n");
+		for(int k=0; k<lgsize; k++)
+			printf("    Stage %2d (%6d pts): %s\n", k, fftsize>>k,
+				(stage_rnd[k] == RND_TRUNCATE) ? "truncate"
+				: (stage_rnd[k] == RND_FROMZERO) ? "round from zero"
+				: (stage_rnd[k] == RND_HALFUP) ? "round half up"
+				: "convergent rounding");
+	}
+
 	// Figure out how many multiply stages to use, and how many to skip
 	if (!single_clock) {
 		nmpypstage = 6;
@@ -1206,6 +1918,11 @@ int main(int argc, char **argv) {
 		nmpypstage = 1;
 
 	mpy_stages = nummpy / nmpypstage;
+	// With eight clocks per sample, each multiply serves two stages
+	if ((single_clock)&&(ckpce >= 8)&&(nummpy > 0)) {
+		share_mpy = true;
+		mpy_stages = 2*nummpy;
+	}
 	if (mpy_stages > lgval(fftsize)-2)
 		mpy_stages = lgval(fftsize)-2;
 
@@ -1389,6 +2106,33 @@ SLASHLINE
 "//	o_sync\tA one bit output indicating the first sample of the FFT frame.\n"
 "//	\t\tIt also indicates the first valid sample out of the FFT\n"
 "//	\t\ton the first frame.\n", nbitsin, nbitsin, nbitsout, nbitsout*2);
+		if (dual_real)
+			fprintf(vmain,
+"//	Order\tBins are produced in pairs, k and N-k, for separating the\n"
+"//	\t\tspectra of two real channels in dualreal.v: 0, 1, N-1, 2,\n"
+"//	\t\tN-2, ..., N/2-1, N/2+1, and last N/2.  o_sync is still\n"
+"//	\t\ttrue with bin zero.\n");
+		else if (mirror)
+			fprintf(vmain,
+"//	o_mirror\tBin N-k of the same frame, produced alongside bin k\n"
+"//	\t\tof o_result, for recovering the spectrum of the real sequence\n"
+"//	\t\tpacked into i_sample by %s.v.  Read from a second port\n"
+"//	\t\ton the bit reversal memory, which synthesis is likely to\n"
+"//	\t\tduplicate.\n", dct_name(dct));
+		if (nonzero > 0)
+			fprintf(vmain,
+"//	Pruning\tThis FFT has been pruned for zero padded frames.  Only the\n"
+"//	\t\tfirst %d values of i_sample in each frame are used, the rest\n"
+"//	\t\tare taken to be zero.  i_ce must still mark every sample.\n"
+"//	\t\tzeropad.v wraps this FFT, and marks the zeros itself, so\n"
+"//	\t\tthat only the first %d samples need be given.\n",
+				nonzero, nonzero);
+		if (binlen > 0)
+			fprintf(vmain,
+"//	o_valid\tTrue when o_result holds one of the %d bins kept, bins %d\n"
+"//	\t\tthrough %d.  These come in natural order at the start of each\n"
+"//	\t\tframe, with o_sync set alongside bin %d.\n",
+				binlen, binfirst, binfirst+binlen-1, binfirst);
 	} else {
 		fprintf(vmain,
 "//	i_ce\tA clock enable line.  If this line is set, this module\n"
@@ -1439,8 +2183,9 @@ SLASHLINE
 	fprintf(vmain, "module %sfftmain(i_clk, %s, i_ce,\n",
 		(inverse)?"i":"", resetw.c_str());
 	if (single_clock) {
-		fprintf(vmain, "\t\ti_sample, o_result, o_sync%s);\n",
-			(dbg)?", o_dbg":"");
+		fprintf(vmain, "\t\ti_sample, o_result, o_sync%s%s%s);\n",
+			(mirror)?", o_mirror":"",
+			(binlen > 0)?", o_valid":"", (dbg)?", o_dbg":"");
 	} else {
 		fprintf(vmain, "\t\ti_left, i_right,\n");
 		fprintf(vmain, "\t\to_left, o_right, o_sync%s);\n",
@@ -1460,6 +2205,10 @@ SLASHLINE
 	if (single_clock) {
 	fprintf(vmain, "\tinput\twire\t[(2*IWIDTH-1):0]\ti_sample;\n");
 	fprintf(vmain, "\toutput\treg\t[(2*OWIDTH-1):0]\to_result;\n");
+	if (mirror)
+		fprintf(vmain, "\toutput\treg\t[(2*OWIDTH-1):0]\to_mirror;\n");
+	if (binlen > 0)
+		fprintf(vmain, "\toutput\treg\t\t\t\to_valid;\n");
 	} else {
 	fprintf(vmain, "\tinput\twire\t[(2*IWIDTH-1):0]\ti_left, i_right;\n");
 	fprintf(vmain, "\toutput\treg\t[(2*OWIDTH-1):0]\to_left, o_right;\n");
@@ -1491,15 +2240,26 @@ SLASHLINE
 			fprintf(vmain, "\t\t\tbr_start <= 1\'b1;\n");
 		}
 		fprintf(vmain, "\n\n");
-		fprintf(vmain, "\tlaststage\t#(IWIDTH)\tstage_2(i_clk, %s, i_ce,\n", resetw.c_str());
+		fprintf(vmain, "\tlaststage\t#(IWIDTH%s)\tstage_2(i_clk, %s, i_ce,\n",
+			(rndsel) ? (std::string(",IWIDTH+1,0")
+				+ rnd_stage_param(rndsel, stage_rnd[0])).c_str()
+				: "",
+			resetw.c_str());
 		fprintf(vmain, "\t\t\t(%s%s), i_left, i_right, br_left, br_right);\n",
 			(async_reset)?"":"!", resetw.c_str());
 		fprintf(vmain, "\n\n");
+		mdl_stage(mdlstage[nmdl++], MDL_LASTSTAGE, 2, nbitsin, 0,
+			nbitsin+1, 0, stage_rnd[0]);
 	} else {
 		int	nbits = nbitsin, dropbit=0;
 		int	obits = nbits+1+xtrapbits;
 		std::string	cmem;
 		FILE	*cmemfp;
+		// With shared twiddle ROMs, is this stage the second of a pair?
+		bool	rom_follower = false;
+		int	rom_cbits = 0;
+		// With shared multiplies, the stage waiting for a partner
+		int	mpy_lead = 0, mpy_leadiw = 0, mpy_leadcw = 0;
 
 		if ((maxbitsout > 0)&&(obits > maxbitsout))
 			obits = maxbitsout;
@@ -1507,6 +2267,7 @@ SLASHLINE
 		// Always do a first stage
 		{
 			bool	mpystage;
+			int	cbits = stage_cbits[lgsize];
 
 			// Last two stages are always non-multiply stages
 			// since the multiplies can be done by adds
@@ -1518,50 +2279,103 @@ SLASHLINE
 			fprintf(vmain, "\twire\t\tw_s%d;\n", fftsize);
 			if (single_clock) {
 				fprintf(vmain, "\twire\t[%d:0]\tw_d%d;\n", 2*(obits+xtrapbits)-1, fftsize);
+				if ((share_coef)&&(fftsize/2 >= 8)) {
+					// Size the ROM for both stages
+					int	ncbits = stage_cbits[lgsize-1];
+					if (ncbits > cbits)
+						cbits = ncbits;
+					rom_follower = true;
+					rom_cbits = cbits;
+				}
 				cmem = gen_coeff_fname(coredir.c_str(), fftsize, 1, 0, inverse);
 				cmemfp = gen_coeff_open(cmem.c_str());
-				gen_coeffs(cmemfp, fftsize,  nbitsin+xtracbits, 1, 0, inverse);
+				gen_coeffs(cmemfp, fftsize,  cbits, 1, 0, inverse, opt_coef);
 				cmem = gen_coeff_fname(EMPTYSTR, fftsize, 1, 0, inverse);
-				fprintf(vmain, "\tfftstage%s\t#(IWIDTH,IWIDTH+%d,%d,%d,0,\n\t\t\t%d, %d, \"%s\")\n\t\tstage_%d(i_clk, %s, i_ce,\n",
+				if (share_coef)
+					emit_coefrom(vmain, fftsize, cbits,
+						cmem.c_str(), rom_follower);
+				if (share_mpy)
+					emit_mpywires(vmain, fftsize, nbitsin,
+						cbits, mpystage);
+				fprintf(vmain, "\tfftstage%s\t#(IWIDTH,IWIDTH+%d,%d,%d,0,\n\t\t\t%d, %d, \"%s\"%s%s)\n\t\tstage_%d(i_clk, %s, i_ce,\n",
 					((dbg)&&(dbgstage == fftsize))?"_dbg":"",
-					xtracbits, obits+xtrapbits,
+					cbits-nbitsin, obits+xtrapbits,
 					lgtmp-1, (mpystage)?1:0,
 					ckpce, cmem.c_str(),
+					rnd_stage_param(rndsel, stage_rnd[lgsize-lgtmp]).c_str(),
+					prune_param(nonzero, lgtmp-1).c_str(),
 					fftsize, resetw.c_str());
-				fprintf(vmain, "\t\t\t(%s%s), i_sample, w_d%d, w_s%d%s);\n",
+				fprintf(vmain, "\t\t\t(%s%s), i_sample, w_d%d, w_s%d%s%s%s);\n",
 					(async_reset)?"":"!", resetw.c_str(),
 					fftsize, fftsize,
+					coef_ports(share_coef, fftsize).c_str(),
+					mpy_ports(share_mpy, fftsize).c_str(),
 					((dbg)&&(dbgstage == fftsize))
 						? ", o_dbg":"");
+				mdl_stage(mdlstage[nmdl++], MDL_BUTTERFLY, fftsize,
+					nbitsin, cbits, obits+xtrapbits, 0,
+					stage_rnd[lgsize-lgtmp], cmem);
+				if ((share_mpy)&&(mpystage)) {
+					if (fftsize/2 >= 8) {
+						// Wait for the next stage
+						mpy_lead   = fftsize;
+						mpy_leadiw = nbitsin;
+						mpy_leadcw = cbits;
+					} else
+						emit_mpyshare(vmain, resetw.c_str(),
+							fftsize, nbitsin, cbits,
+							0, 0, 0);
+				}
 			} else {
 				fprintf(vmain, "\t// verilator lint_off UNUSED\n\twire\t\tw_os%d;\n\t// verilator lint_on  UNUSED\n", fftsize);
 				fprintf(vmain, "\twire\t[%d:0]\tw_e%d, w_o%d;\n", 2*(obits+xtrapbits)-1, fftsize, fftsize);
-				cmem = gen_coeff_fname(coredir.c_str(), fftsize, 2, 0, inverse);
-				cmemfp = gen_coeff_open(cmem.c_str());
-				gen_coeffs(cmemfp, fftsize,  nbitsin+xtracbits, 2, 0, inverse);
-				cmem = gen_coeff_fname(EMPTYSTR, fftsize, 2, 0, inverse);
-				fprintf(vmain, "\tfftstage%s\t#(IWIDTH,IWIDTH+%d,%d,%d,0,\n\t\t\t%d, %d, \"%s\")\n\t\tstage_e%d(i_clk, %s, i_ce,\n",
+				if (share_coef) {
+					cmem = gen_coeff_fname(coredir.c_str(), fftsize, 1, 0, inverse);
+					cmemfp = gen_coeff_open(cmem.c_str());
+					gen_coeffs(cmemfp, fftsize,  cbits, 1, 0, inverse, opt_coef);
+					cmem = gen_coeff_fname(EMPTYSTR, fftsize, 1, 0, inverse);
+					emit_dblcoefrom(vmain, fftsize, cbits,
+						cmem.c_str());
+				} else {
+					cmem = gen_coeff_fname(coredir.c_str(), fftsize, 2, 0, inverse);
+					cmemfp = gen_coeff_open(cmem.c_str());
+					gen_coeffs(cmemfp, fftsize,  cbits, 2, 0, inverse, opt_coef);
+					cmem = gen_coeff_fname(EMPTYSTR, fftsize, 2, 0, inverse);
+				}
+				fprintf(vmain, "\tfftstage%s\t#(IWIDTH,IWIDTH+%d,%d,%d,0,\n\t\t\t%d, %d, \"%s\"%s)\n\t\tstage_e%d(i_clk, %s, i_ce,\n",
 					((dbg)&&(dbgstage == fftsize))?"_dbg":"",
-					xtracbits, obits+xtrapbits,
+					cbits-nbitsin, obits+xtrapbits,
 					lgtmp-2, (mpystage)?1:0,
 					ckpce, cmem.c_str(),
+					rnd_stage_param(rndsel, stage_rnd[lgsize-lgtmp]).c_str(),
 					fftsize, resetw.c_str());
-				fprintf(vmain, "\t\t\t(%s%s), i_left, w_e%d, w_s%d%s);\n",
+				fprintf(vmain, "\t\t\t(%s%s), i_left, w_e%d, w_s%d%s%s);\n",
 					(async_reset)?"":"!", resetw.c_str(),
 					fftsize, fftsize,
+					coef_ports(share_coef, fftsize, "e").c_str(),
 					((dbg)&&(dbgstage == fftsize))?", o_dbg":"");
-				cmem = gen_coeff_fname(coredir.c_str(), fftsize, 2, 1, inverse);
-				cmemfp = gen_coeff_open(cmem.c_str());
-				gen_coeffs(cmemfp, fftsize,  nbitsin+xtracbits, 2, 1, inverse);
-				cmem = gen_coeff_fname(EMPTYSTR, fftsize, 2, 1, inverse);
-				fprintf(vmain, "\tfftstage\t#(IWIDTH,IWIDTH+%d,%d,%d,0,\n\t\t\t%d, %d, \"%s\")\n\t\tstage_o%d(i_clk, %s, i_ce,\n",
-					xtracbits, obits+xtrapbits,
+				mdl_stage(mdlstage[nmdl], MDL_BUTTERFLY, fftsize,
+					nbitsin, cbits, obits+xtrapbits, 0,
+					stage_rnd[lgsize-lgtmp], cmem);
+				if (!share_coef) {
+					cmem = gen_coeff_fname(coredir.c_str(), fftsize, 2, 1, inverse);
+					cmemfp = gen_coeff_open(cmem.c_str());
+					gen_coeffs(cmemfp, fftsize,  cbits, 2, 1, inverse, opt_coef);
+					cmem = gen_coeff_fname(EMPTYSTR, fftsize, 2, 1, inverse);
+				}
+				fprintf(vmain, "\tfftstage\t#(IWIDTH,IWIDTH+%d,%d,%d,0,\n\t\t\t%d, %d, \"%s\"%s)\n\t\tstage_o%d(i_clk, %s, i_ce,\n",
+					cbits-nbitsin, obits+xtrapbits,
 					lgtmp-2, (mpystage)?1:0,
 					ckpce, cmem.c_str(),
+					rnd_stage_param(rndsel, stage_rnd[lgsize-lgtmp]).c_str(),
 					fftsize, resetw.c_str());
-				fprintf(vmain, "\t\t\t(%s%s), i_right, w_o%d, w_os%d);\n",
+				fprintf(vmain, "\t\t\t(%s%s), i_right, w_o%d, w_os%d%s);\n",
 					(async_reset)?"":"!",resetw.c_str(),
-					fftsize, fftsize);
+					fftsize, fftsize,
+					coef_ports(share_coef, fftsize, "o").c_str());
+				if (!share_coef)
+					mdlstage[nmdl].ocmem = cmem;
+				nmdl++;
 			}
 
 			std::string	fname;
@@ -1575,21 +2389,23 @@ SLASHLINE
 				dbgname += "_dbg";
 				dbgname += ".v";
 				if (single_clock)
-					build_stage(fname.c_str(), fftsize, 1, 0, nbits, xtracbits, ckpce, async_reset, true);
+					build_stage(fname.c_str(), fftsize, 1, 0, nbits, xtracbits, ckpce, async_reset, true, rndsel, share_coef, (nonzero > 0), share_mpy);
 				else
-					build_stage(fname.c_str(), fftsize, 2, 1, nbits, xtracbits, ckpce, async_reset, true);
+					build_stage(fname.c_str(), fftsize, 2, 1, nbits, xtracbits, ckpce, async_reset, true, rndsel, share_coef);
 			}
 
 			fname += ".v";
 			if (single_clock) {
 				build_stage(fname.c_str(), fftsize, 1, 0,
 					nbits, xtracbits, ckpce, async_reset,
-					false);
+					false, rndsel, share_coef, (nonzero > 0),
+					share_mpy);
 			} else {
 				// All stages use the same Verilog, so we only
 				// need to build one
 				build_stage(fname.c_str(), fftsize, 2, 1,
-					nbits, xtracbits, ckpce, async_reset, false);
+					nbits, xtracbits, ckpce, async_reset, false,
+					rndsel, share_coef);
 			}
 		}
 
@@ -1605,6 +2421,8 @@ SLASHLINE
 
 			{
 				bool		mpystage;
+				int		cstride = 1;
+				int		cbits = stage_cbits[lgtmp];
 
 				mpystage = ((lgtmp-2) <= mpy_stages);
 
@@ -1616,68 +2434,144 @@ SLASHLINE
 					fprintf(vmain,"\twire\t[%d:0]\tw_d%d;\n",
 						2*(obits+xtrapbits)-1,
 						tmp_size);
-					cmem = gen_coeff_fname(coredir.c_str(), tmp_size, 1, 0, inverse);
-					cmemfp = gen_coeff_open(cmem.c_str());
-					gen_coeffs(cmemfp, tmp_size,
-						nbits+xtracbits+xtrapbits, 1, 0, inverse);
-					cmem = gen_coeff_fname(EMPTYSTR, tmp_size, 1, 0, inverse);
-					fprintf(vmain, "\tfftstage%s\t#(%d,%d,%d,%d,%d,\n\t\t\t%d, %d, \"%s\")\n\t\tstage_%d(i_clk, %s, i_ce,\n",
+					if (rom_follower) {
+						// Our coefficients come from
+						// the last stage's ROM
+						cbits = rom_cbits;
+						cstride = 2;
+						rom_follower = false;
+					} else {
+						if ((share_coef)&&(tmp_size/2 >= 8)) {
+							int	ncbits = stage_cbits[lgtmp-1];
+							if (ncbits > cbits)
+								cbits = ncbits;
+							rom_follower = true;
+							rom_cbits = cbits;
+						}
+						cmem = gen_coeff_fname(coredir.c_str(), tmp_size, 1, 0, inverse);
+						cmemfp = gen_coeff_open(cmem.c_str());
+						gen_coeffs(cmemfp, tmp_size,
+							cbits, 1, 0, inverse, opt_coef);
+						cmem = gen_coeff_fname(EMPTYSTR, tmp_size, 1, 0, inverse);
+						if (share_coef)
+							emit_coefrom(vmain, tmp_size,
+								cbits, cmem.c_str(),
+								rom_follower);
+					}
+					if (share_mpy)
+						emit_mpywires(vmain, tmp_size,
+							nbits+xtrapbits, cbits,
+							mpystage);
+					fprintf(vmain, "\tfftstage%s\t#(%d,%d,%d,%d,%d,\n\t\t\t%d, %d, \"%s\"%s%s)\n\t\tstage_%d(i_clk, %s, i_ce,\n",
 						((dbg)&&(dbgstage==tmp_size))?"_dbg":"",
 						nbits+xtrapbits,
-						nbits+xtracbits+xtrapbits,
+						cbits,
 						obits+xtrapbits,
 						lgtmp-1, (dropbit)?0:0, (mpystage)?1:0,
 						ckpce,
-						cmem.c_str(), tmp_size,
+						cmem.c_str(),
+						rnd_stage_param(rndsel, stage_rnd[lgsize-lgtmp]).c_str(),
+						prune_param(nonzero, lgtmp-1).c_str(),
+						tmp_size,
 						resetw.c_str());
-					fprintf(vmain, "\t\t\tw_s%d, w_d%d, w_d%d, w_s%d%s);\n",
+					fprintf(vmain, "\t\t\tw_s%d, w_d%d, w_d%d, w_s%d%s%s%s);\n",
 						tmp_size<<1, tmp_size<<1,
 						tmp_size, tmp_size,
+						coef_ports(share_coef, tmp_size).c_str(),
+						mpy_ports(share_mpy, tmp_size).c_str(),
 						((dbg)&&(dbgstage == tmp_size))
 							?", o_dbg":"");
+					mdl_stage(mdlstage[nmdl++], MDL_BUTTERFLY,
+						tmp_size, nbits+xtrapbits, cbits,
+						obits+xtrapbits, 0,
+						stage_rnd[lgsize-lgtmp], cmem, cstride);
+					if ((share_mpy)&&(mpystage)) {
+						if (mpy_lead > 0) {
+							emit_mpyshare(vmain,
+								resetw.c_str(),
+								mpy_lead, mpy_leadiw,
+								mpy_leadcw, tmp_size,
+								nbits+xtrapbits, cbits);
+							mpy_lead = 0;
+						} else if (tmp_size/2 >= 8) {
+							mpy_lead   = tmp_size;
+							mpy_leadiw = nbits+xtrapbits;
+							mpy_leadcw = cbits;
+						} else
+							emit_mpyshare(vmain,
+								resetw.c_str(),
+								tmp_size,
+								nbits+xtrapbits, cbits,
+								0, 0, 0);
+					}
 				} else {
 					fprintf(vmain, "\t// verilator lint_off UNUSED\n\twire\t\tw_os%d;\n\t// verilator lint_on  UNUSED\n",
 						tmp_size);
 					fprintf(vmain,"\twire\t[%d:0]\tw_e%d, w_o%d;\n",
 						2*(obits+xtrapbits)-1,
 						tmp_size, tmp_size);
-					cmem = gen_coeff_fname(coredir.c_str(), tmp_size, 2, 0, inverse);
-					cmemfp = gen_coeff_open(cmem.c_str());
-					gen_coeffs(cmemfp, tmp_size,
-						nbits+xtracbits+xtrapbits, 2, 0, inverse);
-					cmem = gen_coeff_fname(EMPTYSTR, tmp_size, 2, 0, inverse);
-					fprintf(vmain, "\tfftstage%s\t#(%d,%d,%d,%d,%d,\n\t\t\t%d, %d, \"%s\")\n\t\tstage_e%d(i_clk, %s, i_ce,\n",
+					if (share_coef) {
+						cmem = gen_coeff_fname(coredir.c_str(), tmp_size, 1, 0, inverse);
+						cmemfp = gen_coeff_open(cmem.c_str());
+						gen_coeffs(cmemfp, tmp_size,
+							cbits, 1, 0, inverse, opt_coef);
+						cmem = gen_coeff_fname(EMPTYSTR, tmp_size, 1, 0, inverse);
+						emit_dblcoefrom(vmain, tmp_size,
+							cbits, cmem.c_str());
+					} else {
+						cmem = gen_coeff_fname(coredir.c_str(), tmp_size, 2, 0, inverse);
+						cmemfp = gen_coeff_open(cmem.c_str());
+						gen_coeffs(cmemfp, tmp_size,
+							cbits, 2, 0, inverse, opt_coef);
+						cmem = gen_coeff_fname(EMPTYSTR, tmp_size, 2, 0, inverse);
+					}
+					fprintf(vmain, "\tfftstage%s\t#(%d,%d,%d,%d,%d,\n\t\t\t%d, %d, \"%s\"%s)\n\t\tstage_e%d(i_clk, %s, i_ce,\n",
 						((dbg)&&(dbgstage==tmp_size))?"_dbg":"",
 						nbits+xtrapbits,
-						nbits+xtracbits+xtrapbits,
+						cbits,
 						obits+xtrapbits,
 						lgtmp-2, (dropbit)?0:0, (mpystage)?1:0,
 						ckpce,
-						cmem.c_str(), tmp_size,
+						cmem.c_str(),
+						rnd_stage_param(rndsel, stage_rnd[lgsize-lgtmp]).c_str(),
+						tmp_size,
 						resetw.c_str());
-					fprintf(vmain, "\t\t\tw_s%d, w_e%d, w_e%d, w_s%d%s);\n",
+					fprintf(vmain, "\t\t\tw_s%d, w_e%d, w_e%d, w_s%d%s%s);\n",
 						tmp_size<<1, tmp_size<<1,
 						tmp_size, tmp_size,
+						coef_ports(share_coef, tmp_size, "e").c_str(),
 						((dbg)&&(dbgstage == tmp_size))
 							?", o_dbg":"");
-					cmem = gen_coeff_fname(coredir.c_str(),
-						tmp_size, 2, 1, inverse);
-					cmemfp = gen_coeff_open(cmem.c_str());
-					gen_coeffs(cmemfp, tmp_size,
-						nbits+xtracbits+xtrapbits,
-						2, 1, inverse);
-					cmem = gen_coeff_fname(EMPTYSTR,
-						tmp_size, 2, 1, inverse);
-					fprintf(vmain, "\tfftstage\t#(%d,%d,%d,%d,%d,\n\t\t\t%d, %d, \"%s\")\n\t\tstage_o%d(i_clk, %s, i_ce,\n",
+					mdl_stage(mdlstage[nmdl], MDL_BUTTERFLY,
+						tmp_size, nbits+xtrapbits, cbits,
+						obits+xtrapbits, 0,
+						stage_rnd[lgsize-lgtmp], cmem);
+					if (!share_coef) {
+						cmem = gen_coeff_fname(coredir.c_str(),
+							tmp_size, 2, 1, inverse);
+						cmemfp = gen_coeff_open(cmem.c_str());
+						gen_coeffs(cmemfp, tmp_size,
+							cbits,
+							2, 1, inverse, opt_coef);
+						cmem = gen_coeff_fname(EMPTYSTR,
+							tmp_size, 2, 1, inverse);
+					}
+					fprintf(vmain, "\tfftstage\t#(%d,%d,%d,%d,%d,\n\t\t\t%d, %d, \"%s\"%s)\n\t\tstage_o%d(i_clk, %s, i_ce,\n",
 						nbits+xtrapbits,
-						nbits+xtracbits+xtrapbits,
+						cbits,
 						obits+xtrapbits,
 						lgtmp-2, (dropbit)?0:0, (mpystage)?1:0,
-						ckpce, cmem.c_str(), tmp_size,
+						ckpce, cmem.c_str(),
+						rnd_stage_param(rndsel, stage_rnd[lgsize-lgtmp]).c_str(),
+						tmp_size,
 						resetw.c_str());
-					fprintf(vmain, "\t\t\tw_s%d, w_o%d, w_o%d, w_os%d);\n",
+					fprintf(vmain, "\t\t\tw_s%d, w_o%d, w_o%d, w_os%d%s);\n",
 						tmp_size<<1, tmp_size<<1,
-						tmp_size, tmp_size);
+						tmp_size, tmp_size,
+						coef_ports(share_coef, tmp_size, "o").c_str());
+					if (!share_coef)
+						mdlstage[nmdl].ocmem = cmem;
+					nmdl++;
 				}
 				fprintf(vmain, "\n");
 			}
@@ -1698,28 +2592,34 @@ SLASHLINE
 			if (single_clock) {
 				fprintf(vmain, "\twire\t[%d:0]\tw_d4;\n",
 					2*(obits+xtrapbits)-1);
-				fprintf(vmain, "\tqtrstage%s\t#(%d,%d,%d,%d,%d)\tstage_4(i_clk, %s, i_ce,\n",
+				fprintf(vmain, "\tqtrstage%s\t#(%d,%d,%d,%d,%d%s)\tstage_4(i_clk, %s, i_ce,\n",
 					((dbg)&&(dbgstage==4))?"_dbg":"",
 					nbits+xtrapbits, obits+xtrapbits, lgsize,
 					(inverse)?1:0, (dropbit)?0:0,
+					rnd_stage_param(rndsel, stage_rnd[lgsize-lgtmp]).c_str(),
 					resetw.c_str());
 				fprintf(vmain, "\t\t\t\t\t\tw_s8, w_d8, w_d4, w_s4%s);\n",
 					((dbg)&&(dbgstage==4))?", o_dbg":"");
 			} else {
 				fprintf(vmain, "\t// verilator lint_off UNUSED\n\twire\t\tw_os4;\n\t// verilator lint_on  UNUSED\n");
 				fprintf(vmain, "\twire\t[%d:0]\tw_e4, w_o4;\n", 2*(obits+xtrapbits)-1);
-				fprintf(vmain, "\tqtrstage%s\t#(%d,%d,%d,0,%d,%d)\tstage_e4(i_clk, %s, i_ce,\n",
+				fprintf(vmain, "\tqtrstage%s\t#(%d,%d,%d,0,%d,%d%s)\tstage_e4(i_clk, %s, i_ce,\n",
 					((dbg)&&(dbgstage==4))?"_dbg":"",
 					nbits+xtrapbits, obits+xtrapbits, lgsize,
 					(inverse)?1:0, (dropbit)?0:0,
+					rnd_stage_param(rndsel, stage_rnd[lgsize-lgtmp]).c_str(),
 					resetw.c_str());
 				fprintf(vmain, "\t\t\t\t\t\tw_s8, w_e8, w_e4, w_s4%s);\n",
 					((dbg)&&(dbgstage==4))?", o_dbg":"");
-				fprintf(vmain, "\tqtrstage\t#(%d,%d,%d,1,%d,%d)\tstage_o4(i_clk, %s, i_ce,\n",
+				fprintf(vmain, "\tqtrstage\t#(%d,%d,%d,1,%d,%d%s)\tstage_o4(i_clk, %s, i_ce,\n",
 					nbits+xtrapbits, obits+xtrapbits, lgsize, (inverse)?1:0, (dropbit)?0:0,
+					rnd_stage_param(rndsel, stage_rnd[lgsize-lgtmp]).c_str(),
 					resetw.c_str());
 				fprintf(vmain, "\t\t\t\t\t\tw_s8, w_o8, w_o4, w_os4);\n");
 			}
+			mdl_stage(mdlstage[nmdl++], MDL_QTRSTAGE, 4,
+				nbits+xtrapbits, 0, obits+xtrapbits, 0,
+				stage_rnd[lgsize-lgtmp]);
 			dropbit ^= 1;
 			nbits = obits;
 			tmp_size >>= 1; lgtmp--;
@@ -1745,16 +2645,21 @@ SLASHLINE
 			*/
 
 			if (single_clock) {
-				fprintf(vmain, "\tlaststage\t#(%d,%d,%d)\tstage_2(i_clk, %s, i_ce,\n",
+				fprintf(vmain, "\tlaststage\t#(%d,%d,%d%s)\tstage_2(i_clk, %s, i_ce,\n",
 					nbits+xtrapbits, obits,(dropbit)?0:1,
+					rnd_stage_param(rndsel, stage_rnd[lgsize-lgtmp]).c_str(),
 					resetw.c_str());
 				fprintf(vmain, "\t\t\t\t\tw_s4, w_d4, w_d2, w_s2);\n");
 			} else {
-				fprintf(vmain, "\tlaststage\t#(%d,%d,%d)\tstage_2(i_clk, %s, i_ce,\n",
+				fprintf(vmain, "\tlaststage\t#(%d,%d,%d%s)\tstage_2(i_clk, %s, i_ce,\n",
 					nbits+xtrapbits, obits,(dropbit)?0:1,
+					rnd_stage_param(rndsel, stage_rnd[lgsize-lgtmp]).c_str(),
 					resetw.c_str());
 				fprintf(vmain, "\t\t\t\t\tw_s4, w_e4, w_o4, w_e2, w_o2, w_s2);\n");
 			}
+			mdl_stage(mdlstage[nmdl++], MDL_LASTSTAGE, 2,
+				nbits+xtrapbits, 0, obits, (dropbit)?0:1,
+				stage_rnd[lgsize-lgtmp]);
 
 			fprintf(vmain, "\n\n");
 			nbits = obits;
@@ -1793,9 +2698,24 @@ SLASHLINE
 	if (bitreverse) {
 		if (single_clock) {
 			fprintf(vmain, "\twire\t[(2*OWIDTH-1):0]\tbr_o_result;\n");
-			fprintf(vmain, "\tbitreverse\t#(%d,%d)\n\t\trevstage(i_clk, %s,\n", lgsize, nbitsout, resetw.c_str());
+			if (mirror)
+				fprintf(vmain, "\twire\t[(2*OWIDTH-1):0]\tbr_o_mirror;\n");
+			if (binlen > 0) {
+				int	lgmem;
+
+				for(lgmem=1; (1<<lgmem) < binlen; lgmem++)
+					;
+				fprintf(vmain, "\twire\t\t\tbr_valid;\n");
+				fprintf(vmain, "\tprunebrev\t#(%d,%d,%d,%d,%d)\n\t\trevstage(i_clk, %s,\n", lgsize, nbitsout, binfirst, binlen, lgmem, resetw.c_str());
+			} else
+				fprintf(vmain, "\tbitreverse\t#(%d,%d)\n\t\trevstage(i_clk, %s,\n", lgsize, nbitsout, resetw.c_str());
 			fprintf(vmain, "\t\t\t(i_ce & br_start), br_sample,\n");
-			fprintf(vmain, "\t\t\tbr_o_result, br_sync);\n");
+			if (binlen > 0) {
+				fprintf(vmain, "\t\t\tbr_o_result, br_sync, br_valid);\n");
+			} else if (mirror) {
+				fprintf(vmain, "\t\t\tbr_o_result, br_sync, br_o_mirror);\n");
+			} else
+				fprintf(vmain, "\t\t\tbr_o_result, br_sync);\n");
 		} else {
 			fprintf(vmain, "\twire\t[(2*OWIDTH-1):0]\tbr_o_left, br_o_right;\n");
 			fprintf(vmain, "\tbitreverse\t#(%d,%d)\n\t\trevstage(i_clk, %s,\n", lgsize, nbitsout, resetw.c_str());
@@ -1830,7 +2750,28 @@ SLASHLINE
 "\n"
 "\talways @(posedge i_clk)\n"
 "\t\tif (i_ce)\n");
-	if (single_clock) {
+	if (mirror) {
+		fprintf(vmain,
+"\t\tbegin\n"
+"\t\t\to_result  <= br_o_result;\n"
+"\t\t\to_mirror  <= br_o_mirror;\n"
+"\t\tend\n");
+	} else if (binlen > 0) {
+		fprintf(vmain, "\t\t\to_result  <= br_o_result;\n");
+		fprintf(vmain,
+"\n"
+"\tinitial\to_valid = 1\'b0;\n");
+		if (async_reset)
+			fprintf(vmain,
+"\talways @(posedge i_clk, negedge i_areset_n)\n\t\tif (!i_areset_n)\n");
+		else
+			fprintf(vmain,
+"\talways @(posedge i_clk)\n\t\tif (i_reset)\n");
+		fprintf(vmain,
+"\t\t\to_valid <= 1\'b0;\n"
+"\t\telse if (i_ce)\n"
+"\t\t\to_valid <= br_valid;\n");
+	} else if (single_clock) {
 		fprintf(vmain, "\t\t\to_result  <= br_o_result;\n");
 	} else {
 		fprintf(vmain,
@@ -1851,11 +2792,146 @@ SLASHLINE
 
 		fname = coredir + "/butterfly.v";
 		build_butterfly(fname.c_str(), xtracbits, rounding,
-			ckpce, async_reset);
+			ckpce, async_reset, rndsel);
 
 		fname = coredir + "/hwbfly.v";
 		build_hwbfly(fname.c_str(), xtracbits, rounding,
-			ckpce, async_reset);
+			ckpce, async_reset, rndsel, share_mpy);
+
+		if (share_mpy) {
+			fname = coredir + "/mpyshare.v";
+			build_mpyshare(fname.c_str(), async_reset);
+		}
+
+		if (share_coef) {
+			fname = coredir + "/coefrom.v";
+			build_coefrom(fname.c_str());
+		}
+
+		if (window != WIN_NONE) {
+			// The window taps are as wide as the FFT's input
+			fname = gen_window_fname(coredir.c_str(), fftsize);
+			gen_window_taps(fname.c_str(), window, lgsize, nbitsin,
+				!single_clock);
+			if (!single_clock) {
+				fname = coredir + "/dblwindowfn.v";
+				build_dblwindow(fname.c_str(), lgsize,
+					nbitsin, nbitsin, nbitsin,
+					async_reset);
+			}
+		}
+
+		if (pfbtaps > 0) {
+			// Like the window, the filter bank keeps the FFT's
+			// input width
+			fname = gen_pfb_fname(coredir.c_str(), fftsize, pfbtaps);
+			gen_pfb_taps(fname.c_str(),
+				(window != WIN_NONE) ? window : WIN_HANN,
+				lgsize, pfbtaps, nbitsin);
+			fname = coredir + "/polyphase.v";
+			build_polyphase(fname.c_str(), lgsize, pfbtaps,
+				pfbovsamp, nbitsin, nbitsin, nbitsin,
+				async_reset);
+		}
+
+		if (psdavg > 0) {
+			fname = coredir + "/psdaccum.v";
+			build_psdaccum(fname.c_str(), lgsize, nbitsout, psdavg,
+				(psdbits > 0) ? psdbits
+					: psd_width(nbitsout, psdavg),
+				single_clock, !bitreverse, async_reset);
+		}
+
+		if (topk > 0) {
+			fname = coredir + "/topk.v";
+			build_topk(fname.c_str(), lgsize, nbitsout, topk,
+				single_clock, !bitreverse, async_reset);
+		}
+
+		if (dual_real) {
+			fname = coredir + "/dualreal.v";
+			build_dualreal(fname.c_str(), lgsize, nbitsout,
+				rounding, async_reset);
+		}
+
+		if (dct != DCT_NONE) {
+			gen_dct_twiddles(coredir.c_str(), dct, lgsize+1,
+				nbitsin+xtracbits);
+
+			fname = coredir + "/" + dct_name(dct) + ".v";
+			build_dct(fname.c_str(), dct, lgsize+1, dctbits, nbitsin,
+				nbitsout, nbitsin+xtracbits, rounding,
+				async_reset);
+		}
+
+		if ((cplen > 0)&&(inverse)) {
+			fname = coredir + "/cpinsert.v";
+			build_cpinsert(fname.c_str(), async_reset);
+
+			fname = coredir + "/ofdmmod.v";
+			build_ofdmmod(fname.c_str(), lgsize, cplen, nbitsin,
+				nbitsout, async_reset);
+		} else if (cplen > 0) {
+			fname = coredir + "/ofdmdemod.v";
+			build_ofdmdemod(fname.c_str(), lgsize, cplen, nbitsin,
+				nbitsout, async_reset);
+		}
+
+		if (bidir) {
+			fname = coredir + "/bidirfft.v";
+			build_bidirfft(fname.c_str(), lgsize, nbitsin, nbitsout,
+				async_reset);
+		}
+
+		if (nonzero > 0) {
+			fname = coredir + "/zeropad.v";
+			build_zeropad(fname.c_str(), lgsize, nonzero, nbitsin,
+				nbitsout, inverse, async_reset);
+		}
+
+		if (dual_clock) {
+			fname = coredir + "/afifo.v";
+			build_afifo(fname.c_str(), async_reset);
+
+			fname = coredir + "/dualclk.v";
+			build_dualclk(fname.c_str(), lgsize, nbitsin, nbitsout,
+				ckpce, async_reset);
+		}
+
+		if (four_step) {
+			gen_fourstep_twiddles(coredir.c_str(), lgbigsize,
+				nbitsin+xtracbits, inverse);
+
+			fname = coredir + "/fourstep.v";
+			build_fourstep(fname.c_str(), lgbigsize, nbitsin,
+				nbitsout, nbitsin+xtracbits, inverse,
+				rounding, async_reset);
+
+			fname = coredir + "/extmem.v";
+			build_extmem(fname.c_str());
+		}
+
+		if (tilerows > 0) {
+			fname = coredir + "/transpose.v";
+			build_transpose(fname.c_str(), async_reset);
+
+			fname = coredir + "/fft2d.v";
+			build_fft2d(fname.c_str(), lgsize, nbitsin, nbitsout,
+				inverse, rounding, tile_reorder, async_reset);
+		}
+
+		if (real_fft) {
+			gen_coeff_file(coredir.c_str(), EMPTYSTR, realsize,
+				realbits+xtracbits, 1, 0, true, opt_coef);
+
+			fname = coredir + "/hermitian.v";
+			build_hermitian(fname.c_str(), lgsize+1, realbits,
+				realbits+xtracbits, rounding, async_reset);
+
+			fname = coredir + "/realifft.v";
+			build_realifft(fname.c_str(), lgsize+1, realbits,
+				nbitsout, async_reset);
+		}
 
 		{
 			// To make debugging easier, we build both of these
@@ -1871,55 +2947,94 @@ SLASHLINE
 		if ((dbg)&&(dbgstage == 4)) {
 			fname = coredir + "/qtrstage_dbg.v";
 			if (single_clock)
-				build_snglquarters(fname.c_str(), rounding,
-					async_reset, true);
+				build_snglquarters(fname.c_str(),
+					stage_rnd[lgsize-2], async_reset, true,
+					rndsel);
 			else
-				build_dblquarters(fname.c_str(), rounding,
-					async_reset, true);
+				build_dblquarters(fname.c_str(),
+					stage_rnd[lgsize-2], async_reset, true,
+					rndsel);
 		}
 		fname = coredir + "/qtrstage.v";
 		if (single_clock)
-			build_snglquarters(fname.c_str(), rounding,
-					async_reset, false);
+			build_snglquarters(fname.c_str(),
+					stage_rnd[lgsize-2], async_reset,
+					false, rndsel);
 		else
-			build_dblquarters(fname.c_str(), rounding,
-					async_reset, false);
+			build_dblquarters(fname.c_str(),
+					stage_rnd[lgsize-2], async_reset,
+					false, rndsel);
 
 
 		if (single_clock) {
 			fname = coredir + "/laststage.v";
-			build_sngllast(fname.c_str(), async_reset);
+			build_sngllast(fname.c_str(), stage_rnd[lgsize-1],
+				async_reset, rndsel);
 		} else {
 			if ((dbg)&&(dbgstage == 2))
 				fname = coredir + "/laststage_dbg.v";
 			else
 				fname = coredir + "/laststage.v";
-			build_dblstage(fname.c_str(), rounding,
-				async_reset, (dbg)&&(dbgstage==2));
+			build_dblstage(fname.c_str(), stage_rnd[lgsize-1],
+				async_reset, (dbg)&&(dbgstage==2), rndsel);
 		}
 
-		if (bitreverse) {
+		if ((bitreverse)&&(binlen > 0)) {
+			fname = coredir + "/prunebrev.v";
+			build_prunebrev(fname.c_str(), async_reset);
+		} else if (bitreverse) {
 			fname = coredir + "/bitreverse.v";
 			if (single_clock)
-				build_snglbrev(fname.c_str(), async_reset);
+				build_snglbrev(fname.c_str(), async_reset,
+					mirror, dual_real);
 			else
 				build_dblreverse(fname.c_str(), async_reset);
 		}
 
-		const	char	*rnd_string = "";
-		switch(rounding) {
-			case RND_TRUNCATE:	rnd_string = "/truncate.v"; break;
-			case RND_FROMZERO:	rnd_string = "/roundfromzero.v"; break;
-			case RND_HALFUP:	rnd_string = "/roundhalfup.v"; break;
-			default:
-				rnd_string = "/convround.v"; break;
-		} fname = coredir + rnd_string;
-		switch(rounding) {
-			case RND_TRUNCATE: build_truncator(fname.c_str()); break;
-			case RND_FROMZERO: build_roundfromzero(fname.c_str()); break;
-			case RND_HALFUP: build_roundhalfup(fname.c_str()); break;
-			default:
-				build_convround(fname.c_str()); break;
+		// Build every rounder used by any stage
+		for(int k=0; k<4; k++) {
+			ROUND_T	rnd = (ROUND_T)k;
+			const	char	*rnd_string = "";
+
+			if (0 == (rndmask & (1u<<k)))
+				continue;
+
+			switch(rnd) {
+				case RND_TRUNCATE:	rnd_string = "/truncate.v"; break;
+				case RND_FROMZERO:	rnd_string = "/roundfromzero.v"; break;
+				case RND_HALFUP:	rnd_string = "/roundhalfup.v"; break;
+				default:
+					rnd_string = "/convround.v"; break;
+			} fname = coredir + rnd_string;
+			switch(rnd) {
+				case RND_TRUNCATE: build_truncator(fname.c_str()); break;
+				case RND_FROMZERO: build_roundfromzero(fname.c_str()); break;
+				case RND_HALFUP: build_roundhalfup(fname.c_str()); break;
+				default:
+					build_convround(fname.c_str()); break;
+			}
+		}
+
+		if (rndsel) {
+			fname = coredir + "/rndselect.v";
+			build_rndselect(fname.c_str(), rndmask);
+		}
+
+		if (sw_model) {
+			// Pruned stages take everything past the first
+			// 2^LGKEEP inputs to be zero
+			int	nkeep = fftsize;
+
+			if ((single_clock)&&(nonzero > 0)) {
+				for(nkeep=1; nkeep < nonzero; nkeep <<= 1)
+					;
+				if (nkeep > fftsize)
+					nkeep = fftsize;
+			}
+
+			build_fftmodel(coredir.c_str(), lgsize, nbitsin,
+				nbitsout, inverse, bitreverse, dual_real,
+				nkeep, nmdl, mdlstage);
 		}
 
 	}
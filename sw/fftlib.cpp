@@ -112,8 +112,115 @@ int	lgdelay(int nbits, int xtra) {
 	return lgval(bflydelay(nbits, xtra)+3);
 }
 
+void	coef_bits(int lgsize, const int *dflt, int *cbits) {
+	//
+	// Trim the twiddle widths of an FFT of 2^lgsize points.  dflt[k] is
+	// the width the 2^k point stage gets by default, growing with the
+	// data as it passes through the FFT.  cbits[k] is set to the width
+	// it gets instead, which is never wider.
+	//
+	// A cbits coefficient has a step size of 2^-(cbits-2), and so adds a
+	// relative noise power of 2 step^2/12 to every sample multiplied by
+	// a non-trivial coefficient.  The remaining stages scale signal and
+	// noise alike, so this ratio is unchanged at the output no matter
+	// which stage it came from.  Coefficients of one and -j are exact,
+	// so only (stage/2-2) of every stage outputs, frac, see this noise.
+	// In units of the first stage's step, stage k adds
+	//
+	//	noise[k] = 2 frac[k] 4^(dflt[lgsize]-cbits[k])
+	//
+	// The later stages' default widths grow with their data, not their
+	// noise, so their twiddles add far less noise than the first's.  The
+	// total may grow to twice what it is at the default widths.  Bits are
+	// taken one at a time from whichever stage adds the least noise by
+	// losing one, for as long as the total stays within that budget.
+	//
+	double	frac[32], noise[32], total = 0.0, budget;
+
+	for(int k=0; k<32; k++)
+		cbits[k] = dflt[k];
+	if ((lgsize < 3)||(lgsize >= 32))
+		return;
+
+	for(int k=3; k<=lgsize; k++) {
+		frac[k] = ((1<<k)/2 - 2) / (double)(1<<k);
+		noise[k] = 2.0 * frac[k] * pow(4.0, dflt[lgsize]-cbits[k]);
+		total += noise[k];
+	}
+	budget = 2.0 * total;
+
+	while(true) {
+		int	best = -1;
+
+		// On a tie, take the bit from the larger stage and its ROM
+		for(int k=lgsize; k>=3; k--)
+			if ((cbits[k] > 2)&&((best < 0)||(noise[k] < noise[best])))
+				best = k;
+		if ((best < 0)||(total + 3.0 * noise[best] > budget))
+			break;
+		total += 3.0 * noise[best];
+		noise[best] *= 4.0;
+		cbits[best]--;
+	}
+}
+
+static	double	coef_radius(int stage, int cbits, bool inv) {
+	//
+	// Coefficients rounded independently to the nearest integer pair
+	// each miss the unit circle by a different amount.  Those errors
+	// are what set the spurious free dynamic range of the transform.
+	// A common gain error, however, costs nothing--it just scales the
+	// output.  Hence, search the radii within 1/64th of 2^(cbits-2)
+	// for the one whose rounded coefficients lie closest to a circle
+	// of that radius.  This costs at most 0.14dB of gain per stage.
+	// (Radii greater than 2^(cbits-2) are avoided, lest the stage grow
+	// beyond what its bit widths allow.)
+	//
+	int	ncoeffs = stage/2, nsteps;
+	double	*c, *s, one = (double)(1ll<<(cbits-2)), best_r = one,
+		best_err = -1.0;
+
+	// Limit the search to something reasonable for large FFTs
+	nsteps = (1<<26) / ((ncoeffs > 0) ? ncoeffs : 1);
+	if (nsteps > 1024)
+		nsteps = 1024;
+	else if (nsteps < 64)
+		nsteps = 64;
+
+	c = new double[ncoeffs];
+	s = new double[ncoeffs];
+	for(int k=0; k<ncoeffs; k++) {
+		double	W = ((inv)?1:-1)*2.0*M_PI*k/(double)(stage);
+
+		c[k] = cos(W); s[k] = sin(W);
+	}
+
+	for(int step=0; step<=nsteps; step++) {
+		double	r = one * (1.0 - step / (64.0 * nsteps)), err = 0.0;
+
+		for(int i=0; i<ncoeffs; i++) {
+			double	dc, ds;
+
+			dc = llround(r * c[i]) - r * c[i];
+			ds = llround(r * s[i]) - r * s[i];
+			err += dc*dc + ds*ds;
+		}
+
+		// Normalize by the radius, so that we compare relative errors
+		err /= r*r;
+		if ((best_err < 0)||(err < best_err)) {
+			best_err = err;
+			best_r = r;
+		}
+	}
+
+	delete[] c;
+	delete[] s;
+	return best_r;
+}
+
 void	gen_coeffs(FILE *cmem, int stage, int cbits,
-			int nwide, int offset, bool inv) {
+			int nwide, int offset, bool inv, bool opt_coef) {
 	//
 	// For an FFT stage of 2^n elements, we need 2^(n-1) butterfly
 	// coefficients, sometimes called twiddle factors.  Stage captures the
@@ -126,6 +233,12 @@ void	gen_coeffs(FILE *cmem, int stage, int cbits,
 	// assert(stage % nwide == 0);
 	// printf("GEN-COEFFS(): stage =%4d, bits =%2d, nwide = %d, offset = %d, nverse = %d\n", stage, cbits, nwide, offset, inv);
 	int	ncoeffs = stage/nwide/2;
+	double	radius = (double)(1ll<<(cbits-2));
+
+	// Both halves of a two-sample-per-clock stage must share one gain,
+	// so the radius is always chosen from the stage as a whole
+	if (opt_coef)
+		radius = coef_radius(stage, cbits, inv);
 	for(int i=0; i<ncoeffs; i++) {
 		int k = nwide*i+offset;
 		double	W = ((inv)?1:-1)*2.0*M_PI*k/(double)(stage);
@@ -133,8 +246,8 @@ void	gen_coeffs(FILE *cmem, int stage, int cbits,
 		long long ic, is, vl;
 
 		c = cos(W); s = sin(W);
-		ic = (long long)llround((1ll<<(cbits-2)) * c);
-		is = (long long)llround((1ll<<(cbits-2)) * s);
+		ic = (long long)llround(radius * c);
+		is = (long long)llround(radius * s);
 		vl = (ic & (~(-1ll << (cbits))));
 		vl <<= (cbits);
 		vl |= (is & (~(-1ll << (cbits))));
@@ -187,11 +300,70 @@ FILE	*gen_coeff_open(const char *fname) {
 }
 
 void	gen_coeff_file(const char *coredir, const char *fname,
-			int stage, int cbits, int nwide, int offset, bool inv) {
+			int stage, int cbits, int nwide, int offset, bool inv,
+			bool opt_coef) {
 	std::string	fstr;
 	FILE	*cmem;
 
 	fstr= gen_coeff_fname(coredir, stage, nwide, offset, inv);
 	cmem = gen_coeff_open(fstr.c_str());
-	gen_coeffs(cmem, stage,  cbits, nwide, offset, inv);
+	gen_coeffs(cmem, stage,  cbits, nwide, offset, inv, opt_coef);
+}
+
+//
+// Returns a Verilog expression for the bin number of the sample at position
+// pos, or, for two samples per clock, of lane lane (0 for left, 1 for right)
+// of pair pos.  A negative lane indicates one sample per clock.  When the
+// FFT output is in bit reversed order, this is the bit reversal of its
+// position.
+//
+std::string	gen_bin_expr(const char *pos, int lgpos, int lane,
+		bool unordered) {
+	char	buf[32];
+	std::string	result;
+
+	if (!unordered) {
+		if (lane < 0)
+			return std::string(pos);
+		sprintf(buf, "{ %s, 1'b%d }", pos, lane);
+		return std::string(buf);
+	}
+
+	result = "{ ";
+	if (lane >= 0) {
+		sprintf(buf, "1'b%d", lane);
+		result += buf;
+	}
+	for(int k=0; k<lgpos; k++) {
+		if ((k > 0)||(lane >= 0))
+			result += ", ";
+		sprintf(buf, "%s[%d]", pos, k);
+		result += buf;
+	}
+	result += " }";
+	return result;
+}
+
+//
+// rnd_module
+//
+// Returns the name of the rounding module a stage should instantiate.  With
+// rndsel, every instance picks its own rounder through rndselect, and *parm
+// is set to the parameter it passes rndselect after its widths.  Otherwise
+// *parm is left empty.
+//
+const char	*rnd_module(ROUND_T rounding, bool rndsel, const char **parm) {
+	if (parm)
+		*parm = (rndsel) ? ",RNDMODE" : "";
+
+	if (rndsel)
+		return "rndselect";
+	else if (rounding == RND_TRUNCATE)
+		return "truncate";
+	else if (rounding == RND_FROMZERO)
+		return "roundfromzero";
+	else if (rounding == RND_HALFUP)
+		return "roundhalfup";
+	else
+		return "convround";
 }
@@ -38,18 +38,26 @@
 #ifndef	FFTLIB_H
 #define	FFTLIB_H
 
+#include "rounding.h"
+
 #define	USE_OLD_MULTIPLY	false
 
 extern	int	lgval(int vl);
 extern	int	nextlg(int vl);
 extern	int	bflydelay(int nbits, int xtra);
 extern	int	lgdelay(int nbits, int xtra);
+extern	void	coef_bits(int lgsize, const int *dflt, int *cbits);
 extern	void	gen_coeffs(FILE *cmem, int stage, int cbits,
-			int nwide, int offset, bool inv);
+			int nwide, int offset, bool inv, bool opt_coef=false);
 extern	std::string	gen_coeff_fname(const char *coredir,
 			int stage, int nwide, int offset, bool inv);
 extern	FILE	*gen_coeff_open(const char *fname);
 extern	void	gen_coeff_file(const char *coredir, const char *fname,
-			int stage, int cbits, int nwide, int offset, bool inv);
+			int stage, int cbits, int nwide, int offset, bool inv,
+			bool opt_coef=false);
+extern	std::string	gen_bin_expr(const char *pos, int lgpos, int lane,
+			bool unordered);
+extern	const char	*rnd_module(ROUND_T rounding, bool rndsel=false,
+			const char **parm=NULL);
 
 #endif	// FFTLIB_H
@@ -0,0 +1,1302 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	fftmodel.cpp
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Generates fftmodel.h and fftmodel.cpp (ifftmodel.* for an
+//		inverse), a C++ model of the fftmain.v built beside them,
+//	intended to be bit exact.  fftgen records each stage it writes into
+//	fftmain.v--its widths, shift, rounding method, and twiddle factor
+//	file--and the model walks the same stages in the same order, so that
+//	every sample of every stage should match the Verilog.  This has yet to
+//	be checked against a Verilated core.
+//
+//	The model doesn't care about clocks.  It takes one frame at a time,
+//	and holds it by position within the frame, which is also the order in
+//	which each single sample per clock stage produces its outputs.  Many
+//	frames may also be run at once, interleaved, in which case the stage
+//	kernels are vectorized across the frames with AVX2 or AVX-512.
+//	A pool of worker threads, each with a model of its own, may then
+//	share out large batches of frames.
+//
+//	A third, header only, model (fftmodel_t.h) specializes a template
+//	on the core's widths, with every stage's parameters as template
+//	arguments and its twiddle factors compiled in, for programs that
+//	can't read the cmem_*.hex files at run time.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+#define _CRT_SECURE_NO_WARNINGS   //  ms vs 2012 doesn't like fopen
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _MSC_VER //  added for ms vs compatibility
+
+#include <io.h>
+#include <direct.h>
+#define _USE_MATH_DEFINES
+#else
+// And for G++/Linux environment
+
+#include <unistd.h>	// Defines the R_OK/W_OK/etc. macros
+#include <sys/stat.h>
+#endif
+
+#include <string.h>
+#include <string>
+#include <math.h>
+#include <ctype.h>
+#include <assert.h>
+
+#include "defaults.h"
+#include "legal.h"
+#include "rounding.h"
+
+#include "fftmodel.h"
+
+static	const char	*mdl_kind_name(MDLSTAGE_T kind) {
+	switch(kind) {
+	case MDL_QTRSTAGE:	return "QTRSTAGE";
+	case MDL_LASTSTAGE:	return "LASTSTAGE";
+	default:		return "BUTTERFLY";
+	}
+}
+
+//
+// Record one stage of fftmain, as it is written
+//
+void	mdl_stage(MDLSTAGE &s, MDLSTAGE_T kind, int size, int iw, int cw,
+		int ow, int shift, ROUND_T rnd, const std::string &cmem,
+		int cstride) {
+	s.kind  = kind;
+	s.size  = size;
+	s.iw    = iw;
+	s.cw    = cw;
+	s.ow    = ow;
+	s.shift = shift;
+	s.rnd   = rnd;
+	s.cmem  = cmem;
+	s.ocmem = "";
+	s.cstride = cstride;
+}
+
+static	void	build_fftmodel_h(const char *fname, const char *name,
+			int lgsize, int iw, int ow, bool inverse,
+			bool bitreverse, bool pairs, int nkeep, int nstages,
+			const MDLSTAGE *stage) {
+	FILE	*fp = fopen(fname, "w");
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return;
+	}
+
+	std::string	NAME(name);
+	for(unsigned k=0; k<NAME.length(); k++)
+		NAME[k] = toupper(NAME[k]);
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\t%s.h\n"
+"//\n"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:\tA C++ model of the %d point %sfftmain.v built alongside\n"
+"//		it, intended to be bit exact.  Each stage is modeled with the\n"
+"//	same widths, shifts, rounding, and twiddle factors as the Verilog, so\n"
+"//	every output of every stage should match the core\'s bit for bit,\n"
+"//	though this has yet to be checked against the Verilog.  The twiddle\n"
+"//	factors are read from the core\'s own cmem_*.hex files, found in the\n"
+"//	directory given to the constructor.\n"
+"//\n"
+"//	Samples are given and returned as separate real and imaginary\n"
+"//	arrays of SIZE values each.  Inputs are taken as IWIDTH bit two\'s\n"
+"//	complement values, and outputs are sign extended from OWIDTH bits.\n"
+"//	The outputs are in the order the core produces them: natural order,\n"
+"//	bit reversed order if it was built without its bit reversal stage\n"
+"//	(-s), or bins k and N-k in turn if it was built for two real\n"
+"//	channels (-u).  Front and back ends wrapped around fftmain are not\n"
+"//	modeled.\n"
+"//\n"
+"//	%s_POOL spreads batches of frames across a pool of worker threads,\n"
+"//	each with its own model and its own working buffers.  Programs using\n"
+"//	it need to be built with -pthread.\n"
+"//\n%s"
+"//\n", name, prjname, 1<<lgsize, (inverse)?"i":"",
+		NAME.c_str(), creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n");
+
+	fprintf(fp,
+"#ifndef\t%s_H\n"
+"#define\t%s_H\n"
+"\n"
+"#include <stdint.h>\n"
+"#include <thread>\n"
+"#include <mutex>\n"
+"#include <condition_variable>\n"
+"\n"
+"class\t%s {\n"
+"public:\n"
+	"\tstatic\tconst\tint\tLGSIZE = %d, SIZE = (1<<LGSIZE),\n"
+			"\t\t\t\tIWIDTH = %d, OWIDTH = %d, NSTAGES = %d;\n"
+	"\t// Only the first NKEEP inputs of each frame are used, the rest\n"
+	"\t// are taken to be zero\n"
+	"\tstatic\tconst\tint\tNKEEP = %d;\n"
+	"\tstatic\tconst\tbool\tINVERSE = %s, BITREVERSE = %s;\n"
+	"\t// Bins k and N-k are produced in turn, as for dualreal.v\n"
+	"\tstatic\tconst\tbool\tPAIRS = %s;\n"
+"\n"
+	"\t// Rounding methods, numbered as RNDMODE within rndselect.v\n"
+	"\ttypedef\tenum {\n"
+		"\t\tTRUNCATE, FROMZERO, HALFUP, CONVERGENT\n"
+	"\t} RND_T;\n"
+"\n"
+	"\ttypedef\tenum {\n"
+		"\t\tBUTTERFLY, QTRSTAGE, LASTSTAGE\n"
+	"\t} STAGE_T;\n"
+"\n"
+	"\t// Each stage, from the first (largest) to laststage.v.  A butterfly\n"
+	"\t// stage uses entry n*cstride of cmem as the twiddle factor for\n"
+	"\t// position n within its span, or entry n/2 of ocmem for odd n\n"
+	"\t// if given.\n"
+	"\ttypedef\tstruct {\n"
+		"\t\tSTAGE_T\t\tkind;\n"
+		"\t\tint\t\tsize, iw, cw, ow, shift;\n"
+		"\t\tRND_T\t\trnd;\n"
+		"\t\tconst char\t*cmem, *ocmem;\n"
+		"\t\tint\t\tcstride;\n"
+	"\t} STAGE;\n"
+	"\tstatic\tconst\tSTAGE\tstages[NSTAGES];\n"
+"\n"
+"private:\n"
+	"\tint64_t\t*m_coef_r[NSTAGES], *m_coef_i[NSTAGES];\n"
+	"\tint64_t\t*m_tap_r[NSTAGES], *m_tap_i[NSTAGES];\n"
+	"\tint64_t\t*m_bat_mem, *m_bat_r, *m_bat_i;\n"
+	"\tint\tm_nbat;\n"
+	"\tbool\tm_loaded;\n"
+"\n"
+	"\tbool\tload(int k, const char *cmemdir);\n"
+	"\tvoid\tstage(int k, int nf, int64_t *v_r, int64_t *v_i);\n"
+	"\tstatic\tvoid\tbfly_rows(const STAGE &s, int64_t c_r, int64_t c_i,\n"
+			"\t\t\tint nf, int64_t *a_r, int64_t *a_i,\n"
+			"\t\t\tint64_t *b_r, int64_t *b_i);\n"
+	"\tstatic\tvoid\tsumdif_rows(const STAGE &s, int rot, int nf,\n"
+			"\t\t\tint64_t *a_r, int64_t *a_i,\n"
+			"\t\t\tint64_t *b_r, int64_t *b_i);\n"
+"\n"
+"public:\n"
+	"\t%s(const char *cmemdir = \".\");\n"
+	"\t~%s(void);\n"
+"\n"
+	"\t// True if every twiddle factor file was found and read\n"
+	"\tbool\tloaded(void) const { return m_loaded; }\n"
+"\n"
+	"\t// Transform one frame\n"
+	"\tvoid\tapply(const int64_t *in_r, const int64_t *in_i,\n"
+			"\t\t\tint64_t *out_r, int64_t *out_i);\n"
+"\n"
+	"\t// Transform nframes frames at once, vectorized across the frames\n"
+	"\t// when built for AVX-512 or AVX2.  The frames are interleaved, so\n"
+	"\t// sample n of frame f is at [n*nframes+f], both in and out.  The\n"
+	"\t// results are those of apply(), but the taps are not kept.\n"
+	"\tvoid\tapply_batch(int nframes, const int64_t *in_r,\n"
+			"\t\t\tconst int64_t *in_i, int64_t *out_r, int64_t *out_i);\n"
+"\n"
+	"\t// As apply_batch(), but with the frames one after another, so that\n"
+	"\t// sample n of frame f is at [f*SIZE+n], both in and out.\n"
+	"\tvoid\tapply_frames(int nframes, const int64_t *in_r,\n"
+			"\t\t\tconst int64_t *in_i, int64_t *out_r, int64_t *out_i);\n"
+"\n"
+	"\t// Allocate the batch buffers for up to nframes frames now, rather\n"
+	"\t// than on the first batch that needs them\n"
+	"\tvoid\treserve(int nframes);\n"
+"\n"
+	"\t// The outputs of stage k of the last frame, by position within the\n"
+	"\t// frame.  This is also the order a single sample per clock stage\n"
+	"\t// produces them in.\n"
+	"\tconst\tint64_t\t*tap_r(int k) const { return m_tap_r[k]; }\n"
+	"\tconst\tint64_t\t*tap_i(int k) const { return m_tap_i[k]; }\n"
+"\n"
+	"\t// The arithmetic of the core\'s rounders, truncate.v through\n"
+	"\t// convround.v\n"
+	"\tstatic\tint64_t\tsext(int64_t v, int bits);\n"
+	"\tstatic\tint64_t\tround(RND_T rnd, int iwid, int owid, int shift,\n"
+			"\t\t\t\tint64_t v);\n"
+	"\tstatic\tunsigned\tbitrev(int nbits, unsigned v);\n"
+	"\t// Where output k of a frame is found, among the last stage\'s\n"
+	"\t// outputs\n"
+	"\tstatic\tunsigned\toutpos(unsigned k);\n"
+"};\n"
+"\n"
+"class\t%s_POOL {\n"
+	"\tint\t\tm_nthreads, m_chunk;\n"
+	"\t%s\t**m_model;\n"
+	"\tstd::thread\t*m_thread;\n"
+"\n"
+	"\tstd::mutex\tm_lock;\n"
+	"\tstd::condition_variable\tm_start, m_done;\n"
+	"\tunsigned\tm_job;\n"
+	"\tint\t\tm_busy;\n"
+	"\tbool\t\tm_quit;\n"
+"\n"
+	"\t// The batch being worked on\n"
+	"\tint\t\tm_nframes;\n"
+	"\tconst\tint64_t\t*m_in_r, *m_in_i;\n"
+	"\tint64_t\t\t*m_out_r, *m_out_i;\n"
+"\n"
+	"\tvoid\tworker(int id);\n"
+"\n"
+"public:\n"
+	"\t// nthreads of zero uses one thread per core.  Each thread works\n"
+	"\t// through its share of a batch chunk frames at a time, in buffers\n"
+	"\t// allocated here, so no batch allocates memory.\n"
+	"\t%s_POOL(int nthreads = 0, const char *cmemdir = \".\",\n"
+			"\t\t\tint chunk = 64);\n"
+	"\t~%s_POOL(void);\n"
+"\n"
+	"\tint\tthreads(void) const { return m_nthreads; }\n"
+	"\tbool\tloaded(void) const;\n"
+"\n"
+	"\t// Transform nframes frames, laid out as for %s::apply_frames(),\n"
+	"\t// returning once all of them are done\n"
+	"\tvoid\tapply(int nframes, const int64_t *in_r, const int64_t *in_i,\n"
+			"\t\t\tint64_t *out_r, int64_t *out_i);\n"
+"};\n"
+"\n"
+"//\n"
+"// %s_TAPS(TAP) expands to TAP(k, size) for each stage k.  Within\n"
+"// %sfftmain.v, the outputs of that stage are w_d<size> (w_e<size> and\n"
+"// w_o<size> at two samples per clock), and its sync is w_s<size>.\n"
+"//\n"
+"#define\t%s_TAPS(TAP)",
+		NAME.c_str(), NAME.c_str(), NAME.c_str(),
+		lgsize, iw, ow, nstages, nkeep,
+		(inverse)?"true":"false", (bitreverse)?"true":"false",
+		(pairs)?"true":"false",
+		NAME.c_str(), NAME.c_str(),
+		NAME.c_str(), NAME.c_str(), NAME.c_str(), NAME.c_str(),
+		NAME.c_str(), NAME.c_str(), (inverse)?"i":"", NAME.c_str());
+	for(int k=0; k<nstages; k++)
+		fprintf(fp, "\t\\\n\tTAP(%d, %d)", k, stage[k].size);
+	fprintf(fp, "\n\n#endif\t// %s_H\n", NAME.c_str());
+
+	fclose(fp);
+}
+
+static	void	build_fftmodel_cpp(const char *fname, const char *name,
+			int lgsize, bool inverse, int nstages,
+			const MDLSTAGE *stage) {
+	FILE	*fp = fopen(fname, "w");
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return;
+	}
+
+	std::string	NAME(name);
+	for(unsigned k=0; k<NAME.length(); k++)
+		NAME[k] = toupper(NAME[k]);
+	const char	*N = NAME.c_str();
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\t%s.cpp\n"
+"//\n"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:\tThe stages of the %d point %sfftmain.v, and the arithmetic\n"
+"//		of each, for the model declared in %s.h.\n"
+"//\n%s"
+"//\n", name, prjname, 1<<lgsize, (inverse)?"i":"", name, creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n");
+
+	fprintf(fp,
+"#include <stdio.h>\n"
+"#include <stdlib.h>\n"
+"#include <string.h>\n"
+"#include <string>\n"
+"\n"
+"#include \"%s.h\"\n"
+"\n"
+"const\t%s::STAGE\t%s::stages[%s::NSTAGES] = {\n"
+"\t// kind,\tsize,\tiw, cw, ow, shift,\trounding,\tcoefficients\n",
+		name, N, N, N);
+	for(int k=0; k<nstages; k++) {
+		const MDLSTAGE	&s = stage[k];
+		const char	*rnd;
+
+		switch(s.rnd) {
+		case RND_TRUNCATE:	rnd = "TRUNCATE";	break;
+		case RND_FROMZERO:	rnd = "FROMZERO";	break;
+		case RND_HALFUP:	rnd = "HALFUP";		break;
+		default:		rnd = "CONVERGENT";	break;
+		}
+
+		fprintf(fp, "\t{ %s,\t%d,\t%d, %d, %d, %d,\t%s,\t",
+			mdl_kind_name(s.kind), s.size, s.iw, s.cw, s.ow,
+			s.shift, rnd);
+		if (s.kind != MDL_BUTTERFLY)
+			fprintf(fp, "NULL, NULL, 0");
+		else if (s.ocmem.length() > 0)
+			fprintf(fp, "\"%s\", \"%s\", 1",
+				s.cmem.c_str(), s.ocmem.c_str());
+		else
+			fprintf(fp, "\"%s\", NULL, %d",
+				s.cmem.c_str(), s.cstride);
+		fprintf(fp, " }%s\n", (k+1 < nstages) ? ",":"");
+	}
+	fprintf(fp, "};\n\n");
+
+	fprintf(fp,
+"int64_t\t%s::sext(int64_t v, int bits) {\n"
+	"\tuint64_t\tm;\n"
+"\n"
+	"\tif (bits >= 64)\n"
+		"\t\treturn v;\n"
+	"\tm = (1ull << bits) - 1;\n"
+	"\tif (v & (1ull << (bits-1)))\n"
+		"\t\treturn (int64_t)((uint64_t)v | ~m);\n"
+	"\treturn (int64_t)((uint64_t)v & m);\n"
+"}\n"
+"\n"
+"//\n"
+"// Drop the top SHIFT bits of an IWID bit value, and round away all but the\n"
+"// OWID bits that remain, as the rounders of the core do.  As in the\n"
+"// Verilog, IWID == OWID passes the value through, shift or not, for all\n"
+"// but truncation and rounding half up.\n"
+"//\n"
+"int64_t\t%s::round(RND_T rnd, int iwid, int owid, int shift,\n"
+		"\t\tint64_t v) {\n"
+	"\tint\td = iwid - shift - owid;\n"
+	"\tint64_t\ttruncated;\n"
+	"\tbool\tfirst_lost_bit, other_lost_bits;\n"
+"\n"
+	"\tv = sext(v, iwid);\n"
+	"\tif ((iwid == owid)&&(rnd != TRUNCATE)&&(rnd != HALFUP))\n"
+		"\t\treturn v;\n"
+	"\tif (d <= 0)\n"
+		"\t\treturn sext(v * (1ll << (-d)), owid);\n"
+"\n"
+	"\ttruncated = v >> d;\n"
+	"\tfirst_lost_bit  = (v >> (d-1)) & 1;\n"
+	"\tother_lost_bits = (d > 1) && ((v & ((1ll << (d-1))-1)) != 0);\n"
+"\n"
+	"\tswitch(rnd) {\n"
+	"\tcase TRUNCATE:\n"
+		"\t\tbreak;\n"
+	"\tcase HALFUP:\n"
+		"\t\tif (first_lost_bit)\n"
+			"\t\t\ttruncated++;\n"
+		"\t\tbreak;\n"
+	"\tcase FROMZERO:\n"
+		"\t\tif ((first_lost_bit)&&((other_lost_bits)||(v >= 0)))\n"
+			"\t\t\ttruncated++;\n"
+		"\t\tbreak;\n"
+	"\tdefault:\n"
+		"\t\tif ((first_lost_bit)&&((other_lost_bits)||(truncated & 1)))\n"
+			"\t\t\ttruncated++;\n"
+		"\t\tbreak;\n"
+	"\t}\n"
+"\n"
+	"\treturn sext(truncated, owid);\n"
+"}\n"
+"\n"
+"unsigned\t%s::bitrev(int nbits, unsigned v) {\n"
+	"\tunsigned\tr = 0;\n"
+"\n"
+	"\tfor(int k=0; k<nbits; k++) {\n"
+		"\t\tr = (r << 1) | (v & 1);\n"
+		"\t\tv >>= 1;\n"
+	"\t} return r;\n"
+"}\n"
+"\n"
+"unsigned\t%s::outpos(unsigned k) {\n"
+	"\tif (PAIRS)\n"
+		"\t\tk = (k & 1) ? (k+1)/2 : (SIZE - k/2) %% SIZE;\n"
+	"\treturn (BITREVERSE) ? bitrev(LGSIZE, k) : k;\n"
+"}\n"
+"\n", N, N, N, N);
+
+	fprintf(fp,
+"//\n"
+"// Read the twiddle factors of stage k into one entry per position within\n"
+"// its span.  Each line of a cmem_*.hex file holds the real part of one\n"
+"// factor above its imaginary part, cw bits each.\n"
+"//\n"
+"bool\t%s::load(int k, const char *cmemdir) {\n"
+	"\tconst\tSTAGE\t&s = stages[k];\n"
+	"\tint\tspan = s.size/2, nfiles = (s.ocmem) ? 2:1;\n"
+"\n"
+	"\tfor(int f=0; f<nfiles; f++) {\n"
+		"\t\tstd::string\tfname = std::string(cmemdir) + \"/\"\n"
+			"\t\t\t+ ((f == 0) ? s.cmem : s.ocmem);\n"
+		"\t\tFILE\t*fp = fopen(fname.c_str(), \"r\");\n"
+		"\t\tunsigned long long\tvl;\n"
+		"\t\tint\tn = 0;\n"
+"\n"
+		"\t\tif (NULL == fp) {\n"
+			"\t\t\tfprintf(stderr, \"Could not open \\\'%%s\\\' for reading\\n\",\n"
+				"\t\t\t\tfname.c_str());\n"
+			"\t\t\tperror(\"O/S Err was:\");\n"
+			"\t\t\treturn false;\n"
+		"\t\t}\n"
+"\n"
+		"\t\t// Entry e of the file belongs to position p, if any\n"
+		"\t\tfor(int e=0; (n < span)&&(1 == fscanf(fp, \"%%llx\", &vl)); e++) {\n"
+			"\t\t\tint\tp;\n"
+"\n"
+			"\t\t\tif (nfiles > 1)\n"
+				"\t\t\t\tp = 2*e+f;\n"
+			"\t\t\telse if (e %% s.cstride != 0)\n"
+				"\t\t\t\tcontinue;\n"
+			"\t\t\telse\n"
+				"\t\t\t\tp = e / s.cstride;\n"
+			"\t\t\tif (p >= span)\n"
+				"\t\t\t\tbreak;\n"
+			"\t\t\tm_coef_r[k][p] = sext((int64_t)(vl >> s.cw), s.cw);\n"
+			"\t\t\tm_coef_i[k][p] = sext((int64_t)vl, s.cw);\n"
+			"\t\t\tn++;\n"
+		"\t\t} fclose(fp);\n"
+"\n"
+		"\t\tif (n < span / nfiles) {\n"
+			"\t\t\tfprintf(stderr, \"%%s holds too few coefficients\\n\",\n"
+				"\t\t\t\tfname.c_str());\n"
+			"\t\t\treturn false;\n"
+		"\t\t}\n"
+	"\t}\n"
+"\n"
+	"\treturn true;\n"
+"}\n"
+"\n"
+"%s::%s(const char *cmemdir) {\n"
+	"\tm_loaded = true;\n"
+	"\tm_bat_mem = m_bat_r = m_bat_i = NULL;\n"
+	"\tm_nbat = 0;\n"
+	"\tfor(int k=0; k<NSTAGES; k++) {\n"
+		"\t\tm_tap_r[k] = new int64_t[SIZE];\n"
+		"\t\tm_tap_i[k] = new int64_t[SIZE];\n"
+		"\t\tm_coef_r[k] = m_coef_i[k] = NULL;\n"
+		"\t\tif (stages[k].kind != BUTTERFLY)\n"
+			"\t\t\tcontinue;\n"
+		"\t\tm_coef_r[k] = new int64_t[stages[k].size/2];\n"
+		"\t\tm_coef_i[k] = new int64_t[stages[k].size/2];\n"
+		"\t\tif (!load(k, cmemdir))\n"
+			"\t\t\tm_loaded = false;\n"
+	"\t}\n"
+"}\n"
+"\n"
+"%s::~%s(void) {\n"
+	"\tdelete[] m_bat_mem;\n"
+	"\tfor(int k=0; k<NSTAGES; k++) {\n"
+		"\t\tdelete[] m_tap_r[k];\n"
+		"\t\tdelete[] m_tap_i[k];\n"
+		"\t\tdelete[] m_coef_r[k];\n"
+		"\t\tdelete[] m_coef_i[k];\n"
+	"\t}\n"
+"}\n"
+"\n",
+		N, N, N, N, N);
+
+	fprintf(fp,
+"//\n"
+"// The stage kernels work on rows of nf values, one value per frame, so that\n"
+"// many frames may be processed at once.  When compiled for AVX-512 or AVX2\n"
+"// (-mavx512f or -mavx2), each row is processed a vector of frames at a\n"
+"// time.  Frames left over, and every frame of a build without these, go\n"
+"// through the scalar loops below, which are the definition of the model\'s\n"
+"// arithmetic.  The vector loops must match them bit for bit.\n"
+"//\n"
+"// The vector multiply is a signed 32x32 bit multiply, so a butterfly whose\n"
+"// coefficients or differences are wider than 32 bits stays scalar.  The\n"
+"// rounders shift logically rather than arithmetically, since AVX2 has no\n"
+"// 64-bit arithmetic shift.  This changes only the bits above OWID, which are\n"
+"// replaced by the sign extension anyway.\n"
+"//\n"
+"#if defined(__AVX512F__)\n"
+"#include <immintrin.h>\n"
+"typedef\t__m512i\tVEC;\n"
+"#define\tVLANES\t\t8\n"
+"#define\tVLOAD(P)\t_mm512_loadu_si512((const void *)(P))\n"
+"#define\tVSTORE(P,V)\t_mm512_storeu_si512((void *)(P), V)\n"
+"#define\tVSET1(X)\t_mm512_set1_epi64(X)\n"
+"#define\tVADD(A,B)\t_mm512_add_epi64(A,B)\n"
+"#define\tVSUB(A,B)\t_mm512_sub_epi64(A,B)\n"
+"#define\tVAND(A,B)\t_mm512_and_si512(A,B)\n"
+"#define\tVOR(A,B)\t_mm512_or_si512(A,B)\n"
+"#define\tVXOR(A,B)\t_mm512_xor_si512(A,B)\n"
+"// The zero masked multiply and shifts keep some versions of GCC from\n"
+"// warning of uninitialized values within the unmasked ones\n"
+"#define\tVMUL(A,B)\t_mm512_maskz_mul_epi32(0xff, A, B)\n"
+"#define\tVSRL(A,N)\t_mm512_maskz_srl_epi64(0xff, A, _mm_cvtsi32_si128(N))\n"
+"#define\tVSLL(A,N)\t_mm512_maskz_sll_epi64(0xff, A, _mm_cvtsi32_si128(N))\n"
+"#elif defined(__AVX2__)\n"
+"#include <immintrin.h>\n"
+"typedef\t__m256i\tVEC;\n"
+"#define\tVLANES\t\t4\n"
+"#define\tVLOAD(P)\t_mm256_loadu_si256((const __m256i *)(P))\n"
+"#define\tVSTORE(P,V)\t_mm256_storeu_si256((__m256i *)(P), V)\n"
+"#define\tVSET1(X)\t_mm256_set1_epi64x(X)\n"
+"#define\tVADD(A,B)\t_mm256_add_epi64(A,B)\n"
+"#define\tVSUB(A,B)\t_mm256_sub_epi64(A,B)\n"
+"#define\tVAND(A,B)\t_mm256_and_si256(A,B)\n"
+"#define\tVOR(A,B)\t_mm256_or_si256(A,B)\n"
+"#define\tVXOR(A,B)\t_mm256_xor_si256(A,B)\n"
+"#define\tVMUL(A,B)\t_mm256_mul_epi32(A,B)\n"
+"#define\tVSRL(A,N)\t_mm256_srl_epi64(A, _mm_cvtsi32_si128(N))\n"
+"#define\tVSLL(A,N)\t_mm256_sll_epi64(A, _mm_cvtsi32_si128(N))\n"
+"#endif\n"
+"\n"
+"#ifdef\tVLANES\n"
+"static inline VEC\tvsext(VEC v, int bits) {\n"
+	"\tconst\tVEC\tm = VSET1((int64_t)((1ull << bits)-1)),\n"
+			"\t\t\ts = VSET1((int64_t)(1ull << (bits-1)));\n"
+"\n"
+	"\treturn VSUB(VXOR(VAND(v, m), s), s);\n"
+"}\n"
+"\n"
+"static inline VEC\tvround(%s::RND_T rnd, int iwid, int owid, int shift,\n"
+		"\t\tVEC v) {\n"
+	"\tconst\tVEC\tone = VSET1(1);\n"
+	"\tint\td = iwid - shift - owid;\n"
+	"\tVEC\ttruncated, first_lost_bit, other_lost_bits, lost_mask, inc;\n"
+"\n"
+	"\tif ((iwid == owid)&&(rnd != %s::TRUNCATE)&&(rnd != %s::HALFUP))\n"
+		"\t\treturn vsext(v, owid);\n"
+	"\tif (d <= 0)\n"
+		"\t\treturn vsext(VSLL(v, -d), owid);\n"
+"\n"
+	"\ttruncated = VSRL(v, d);\n"
+	"\tfirst_lost_bit = VAND(VSRL(v, d-1), one);\n"
+	"\t// Adding 2^(d-1)-1 to the bits below the first lost bit carries\n"
+	"\t// into it if any of them are set\n"
+	"\tlost_mask = VSET1((1ll << (d-1))-1);\n"
+	"\tother_lost_bits = VAND(VSRL(VADD(VAND(v, lost_mask), lost_mask), d-1),\n"
+				"\t\t\t\tone);\n"
+"\n"
+	"\tswitch(rnd) {\n"
+	"\tcase %s::TRUNCATE:\n"
+		"\t\tinc = VSET1(0);\n"
+		"\t\tbreak;\n"
+	"\tcase %s::HALFUP:\n"
+		"\t\tinc = first_lost_bit;\n"
+		"\t\tbreak;\n"
+	"\tcase %s::FROMZERO:\n"
+		"\t\tinc = VAND(first_lost_bit, VOR(other_lost_bits,\n"
+				"\t\t\t\tVXOR(VSRL(v, 63), one)));\n"
+		"\t\tbreak;\n"
+	"\tdefault:\n"
+		"\t\tinc = VAND(first_lost_bit, VOR(other_lost_bits,\n"
+				"\t\t\t\tVAND(truncated, one)));\n"
+		"\t\tbreak;\n"
+	"\t}\n"
+"\n"
+	"\treturn vsext(VADD(truncated, inc), owid);\n"
+"}\n"
+"#endif\n"
+"\n", N, N, N, N, N, N);
+
+	fprintf(fp,
+"//\n"
+"// A butterfly stage (butterfly.v or hwbfly.v) scales the sum by the\n"
+"// 2^(cw-2) gain of its coefficients, and multiplies the difference by the\n"
+"// twiddle factor, rounding both from cw+iw+3 bits.\n"
+"//\n"
+"void\t%s::bfly_rows(const STAGE &s, int64_t c_r, int64_t c_i, int nf,\n"
+		"\t\tint64_t *a_r, int64_t *a_i, int64_t *b_r, int64_t *b_i) {\n"
+	"\tconst\tint\tw = s.cw+s.iw+3;\n"
+	"\tint\tf = 0;\n"
+"\n"
+"#ifdef\tVLANES\n"
+	"\tif ((s.cw <= 32)&&(s.iw+1 <= 32)) {\n"
+		"\t\tconst\tVEC\tv_cr = VSET1(c_r), v_ci = VSET1(c_i);\n"
+"\n"
+		"\t\tfor(; f+VLANES <= nf; f += VLANES) {\n"
+			"\t\t\tVEC\tl_r = VLOAD(a_r+f), l_i = VLOAD(a_i+f),\n"
+				"\t\t\t\tr_r = VLOAD(b_r+f), r_i = VLOAD(b_i+f);\n"
+			"\t\t\tVEC\tsum_r = VADD(l_r, r_r), sum_i = VADD(l_i, r_i),\n"
+				"\t\t\t\tdif_r = VSUB(l_r, r_r), dif_i = VSUB(l_i, r_i);\n"
+"\n"
+			"\t\t\tVSTORE(a_r+f, vround(s.rnd, w, s.ow, s.shift+4,\n"
+					"\t\t\t\t\tVSLL(sum_r, s.cw-2)));\n"
+			"\t\t\tVSTORE(a_i+f, vround(s.rnd, w, s.ow, s.shift+4,\n"
+					"\t\t\t\t\tVSLL(sum_i, s.cw-2)));\n"
+			"\t\t\tVSTORE(b_r+f, vround(s.rnd, w, s.ow, s.shift+4,\n"
+					"\t\t\t\t\tVSUB(VMUL(v_cr, dif_r), VMUL(v_ci, dif_i))));\n"
+			"\t\t\tVSTORE(b_i+f, vround(s.rnd, w, s.ow, s.shift+4,\n"
+					"\t\t\t\t\tVADD(VMUL(v_cr, dif_i), VMUL(v_ci, dif_r))));\n"
+		"\t\t}\n"
+	"\t}\n"
+"#endif\n"
+"\n"
+	"\tfor(; f<nf; f++) {\n"
+		"\t\tconst\tint64_t\tgain = 1ll << (s.cw-2);\n"
+		"\t\tint64_t\tsum_r, sum_i, dif_r, dif_i;\n"
+"\n"
+		"\t\tsum_r = a_r[f] + b_r[f];\n"
+		"\t\tsum_i = a_i[f] + b_i[f];\n"
+		"\t\tdif_r = a_r[f] - b_r[f];\n"
+		"\t\tdif_i = a_i[f] - b_i[f];\n"
+"\n"
+		"\t\ta_r[f] = round(s.rnd, w, s.ow, s.shift+4, sum_r * gain);\n"
+		"\t\ta_i[f] = round(s.rnd, w, s.ow, s.shift+4, sum_i * gain);\n"
+		"\t\tb_r[f] = round(s.rnd, w, s.ow, s.shift+4,\n"
+				"\t\t\t\tc_r * dif_r - c_i * dif_i);\n"
+		"\t\tb_i[f] = round(s.rnd, w, s.ow, s.shift+4,\n"
+				"\t\t\t\tc_r * dif_i + c_i * dif_r);\n"
+	"\t}\n"
+"}\n"
+"\n"
+"//\n"
+"// The qtrstage and laststage round their sums and differences from iw+1\n"
+"// bits.  The qtrstage then multiplies its odd differences by -j (rot > 0),\n"
+"// or by j for an inverse (rot < 0).\n"
+"//\n"
+"void\t%s::sumdif_rows(const STAGE &s, int rot, int nf,\n"
+		"\t\tint64_t *a_r, int64_t *a_i, int64_t *b_r, int64_t *b_i) {\n"
+	"\tconst\tint\tw = s.iw+1;\n"
+	"\tint\tf = 0;\n"
+"\n"
+"#ifdef\tVLANES\n"
+	"\tfor(; f+VLANES <= nf; f += VLANES) {\n"
+		"\t\tVEC\tl_r = VLOAD(a_r+f), l_i = VLOAD(a_i+f),\n"
+			"\t\t\tr_r = VLOAD(b_r+f), r_i = VLOAD(b_i+f);\n"
+		"\t\tVEC\tdif_r, dif_i;\n"
+"\n"
+		"\t\tVSTORE(a_r+f, vround(s.rnd, w, s.ow, s.shift, VADD(l_r, r_r)));\n"
+		"\t\tVSTORE(a_i+f, vround(s.rnd, w, s.ow, s.shift, VADD(l_i, r_i)));\n"
+		"\t\tdif_r = vround(s.rnd, w, s.ow, s.shift, VSUB(l_r, r_r));\n"
+		"\t\tdif_i = vround(s.rnd, w, s.ow, s.shift, VSUB(l_i, r_i));\n"
+		"\t\tif (rot == 0) {\n"
+			"\t\t\tVSTORE(b_r+f, dif_r);\n"
+			"\t\t\tVSTORE(b_i+f, dif_i);\n"
+		"\t\t} else if (rot > 0) {\n"
+			"\t\t\tVSTORE(b_r+f, dif_i);\n"
+			"\t\t\tVSTORE(b_i+f, vsext(VSUB(VSET1(0), dif_r), s.ow));\n"
+		"\t\t} else {\n"
+			"\t\t\tVSTORE(b_r+f, vsext(VSUB(VSET1(0), dif_i), s.ow));\n"
+			"\t\t\tVSTORE(b_i+f, dif_r);\n"
+		"\t\t}\n"
+	"\t}\n"
+"#endif\n"
+"\n"
+	"\tfor(; f<nf; f++) {\n"
+		"\t\tint64_t\tdif_r, dif_i;\n"
+"\n"
+		"\t\tdif_r = round(s.rnd, w, s.ow, s.shift, a_r[f] - b_r[f]);\n"
+		"\t\tdif_i = round(s.rnd, w, s.ow, s.shift, a_i[f] - b_i[f]);\n"
+		"\t\ta_r[f] = round(s.rnd, w, s.ow, s.shift, a_r[f] + b_r[f]);\n"
+		"\t\ta_i[f] = round(s.rnd, w, s.ow, s.shift, a_i[f] + b_i[f]);\n"
+		"\t\tif (rot == 0) {\n"
+			"\t\t\tb_r[f] = dif_r;\n"
+			"\t\t\tb_i[f] = dif_i;\n"
+		"\t\t} else if (rot > 0) {\n"
+			"\t\t\tb_r[f] = dif_i;\n"
+			"\t\t\tb_i[f] = sext(-dif_r, s.ow);\n"
+		"\t\t} else {\n"
+			"\t\t\tb_r[f] = sext(-dif_i, s.ow);\n"
+			"\t\t\tb_i[f] = dif_r;\n"
+		"\t\t}\n"
+	"\t}\n"
+"}\n"
+"\n"
+"//\n"
+"// Stage k pairs position n of each block of size values with position\n"
+"// n+size/2, in place, for each of nf frames.  Position p of frame f is at\n"
+"// v[p*nf+f].\n"
+"//\n"
+"void\t%s::stage(int k, int nf, int64_t *v_r, int64_t *v_i) {\n"
+	"\tconst\tSTAGE\t&s = stages[k];\n"
+	"\tconst\tint\tspan = s.size/2;\n"
+"\n"
+	"\tfor(int base=0; base<SIZE; base += s.size) {\n"
+		"\t\tfor(int n=0; n<span; n++) {\n"
+			"\t\t\tconst int\ta = (base+n)*nf, b = (base+n+span)*nf;\n"
+"\n"
+			"\t\t\tif (s.kind == BUTTERFLY)\n"
+				"\t\t\t\tbfly_rows(s, m_coef_r[k][n], m_coef_i[k][n], nf,\n"
+					"\t\t\t\t\tv_r+a, v_i+a, v_r+b, v_i+b);\n"
+			"\t\t\telse\n"
+				"\t\t\t\tsumdif_rows(s, (n&1) ? ((INVERSE) ? -1:1) : 0,\n"
+					"\t\t\t\t\tnf, v_r+a, v_i+a, v_r+b, v_i+b);\n"
+		"\t\t}\n"
+	"\t}\n"
+"}\n"
+"\n"
+"void\t%s::apply(const int64_t *in_r, const int64_t *in_i,\n"
+		"\t\tint64_t *out_r, int64_t *out_i) {\n"
+	"\tfor(int k=0; k<SIZE; k++) {\n"
+		"\t\tm_tap_r[0][k] = (k < NKEEP) ? sext(in_r[k], IWIDTH) : 0;\n"
+		"\t\tm_tap_i[0][k] = (k < NKEEP) ? sext(in_i[k], IWIDTH) : 0;\n"
+	"\t}\n"
+"\n"
+	"\tfor(int k=0; k<NSTAGES; k++) {\n"
+		"\t\tif (k > 0) {\n"
+			"\t\t\tmemcpy(m_tap_r[k], m_tap_r[k-1], SIZE * sizeof(int64_t));\n"
+			"\t\t\tmemcpy(m_tap_i[k], m_tap_i[k-1], SIZE * sizeof(int64_t));\n"
+		"\t\t} stage(k, 1, m_tap_r[k], m_tap_i[k]);\n"
+	"\t}\n"
+"\n"
+	"\t// The stages leave the frame in bit reversed order\n"
+	"\tfor(int k=0; k<SIZE; k++) {\n"
+		"\t\tunsigned\tp = outpos(k);\n"
+"\n"
+		"\t\tout_r[k] = m_tap_r[NSTAGES-1][p];\n"
+		"\t\tout_i[k] = m_tap_i[NSTAGES-1][p];\n"
+	"\t}\n"
+"}\n"
+"\n"
+"//\n"
+"// Both batch buffers come from one allocation, each starting on a 64 byte\n"
+"// cache line\n"
+"//\n"
+"void\t%s::reserve(int nframes) {\n"
+	"\tsize_t\tlen;\n"
+"\n"
+	"\tif (nframes <= m_nbat)\n"
+		"\t\treturn;\n"
+	"\tdelete[] m_bat_mem;\n"
+	"\tm_nbat = nframes;\n"
+	"\tlen = ((size_t)SIZE * m_nbat + 7) & ~(size_t)7;\n"
+	"\tm_bat_mem = new int64_t[2 * len + 8];\n"
+	"\tm_bat_r = (int64_t *)(((uintptr_t)m_bat_mem + 63) & ~(uintptr_t)63);\n"
+	"\tm_bat_i = m_bat_r + len;\n"
+"}\n"
+"\n"
+"void\t%s::apply_batch(int nframes, const int64_t *in_r, const int64_t *in_i,\n"
+		"\t\tint64_t *out_r, int64_t *out_i) {\n"
+	"\treserve(nframes);\n"
+"\n"
+	"\tfor(int k=0; k<SIZE * nframes; k++) {\n"
+		"\t\tbool\tkeep = (k < NKEEP * nframes);\n"
+"\n"
+		"\t\tm_bat_r[k] = (keep) ? sext(in_r[k], IWIDTH) : 0;\n"
+		"\t\tm_bat_i[k] = (keep) ? sext(in_i[k], IWIDTH) : 0;\n"
+	"\t}\n"
+"\n"
+	"\tfor(int k=0; k<NSTAGES; k++)\n"
+		"\t\tstage(k, nframes, m_bat_r, m_bat_i);\n"
+"\n"
+	"\tfor(int k=0; k<SIZE; k++) {\n"
+		"\t\tunsigned\tp = outpos(k);\n"
+"\n"
+		"\t\tmemcpy(&out_r[k * nframes], &m_bat_r[p * nframes],\n"
+			"\t\t\tnframes * sizeof(int64_t));\n"
+		"\t\tmemcpy(&out_i[k * nframes], &m_bat_i[p * nframes],\n"
+			"\t\t\tnframes * sizeof(int64_t));\n"
+	"\t}\n"
+"}\n"
+"\n"
+"void\t%s::apply_frames(int nframes, const int64_t *in_r, const int64_t *in_i,\n"
+		"\t\tint64_t *out_r, int64_t *out_i) {\n"
+	"\treserve(nframes);\n"
+"\n"
+	"\tfor(int k=0; k<SIZE; k++) {\n"
+		"\t\tint64_t\t*r = &m_bat_r[k * nframes], *i = &m_bat_i[k * nframes];\n"
+"\n"
+		"\t\tfor(int f=0; f<nframes; f++) {\n"
+			"\t\t\tr[f] = (k < NKEEP) ? sext(in_r[f*SIZE+k], IWIDTH) : 0;\n"
+			"\t\t\ti[f] = (k < NKEEP) ? sext(in_i[f*SIZE+k], IWIDTH) : 0;\n"
+		"\t\t}\n"
+	"\t}\n"
+"\n"
+	"\tfor(int k=0; k<NSTAGES; k++)\n"
+		"\t\tstage(k, nframes, m_bat_r, m_bat_i);\n"
+"\n"
+	"\tfor(int k=0; k<SIZE; k++) {\n"
+		"\t\tunsigned\tp = outpos(k);\n"
+		"\t\tconst\tint64_t\t*r = &m_bat_r[p * nframes],\n"
+				"\t\t\t*i = &m_bat_i[p * nframes];\n"
+"\n"
+		"\t\tfor(int f=0; f<nframes; f++) {\n"
+			"\t\t\tout_r[f*SIZE+k] = r[f];\n"
+			"\t\t\tout_i[f*SIZE+k] = i[f];\n"
+		"\t\t}\n"
+	"\t}\n"
+"}\n", N, N, N, N, N, N, N);
+
+	fprintf(fp,
+"\n"
+"//\n"
+"// The pool\'s workers wait for a new job number, each takes its own\n"
+"// contiguous share of the frames, and the last one done wakes apply().\n"
+"// Each worker has its own model, so nothing they write is shared.\n"
+"//\n"
+"%s_POOL::%s_POOL(int nthreads, const char *cmemdir, int chunk) {\n"
+	"\tif (nthreads <= 0)\n"
+		"\t\tnthreads = std::thread::hardware_concurrency();\n"
+	"\tif (nthreads <= 0)\n"
+		"\t\tnthreads = 1;\n"
+	"\tm_nthreads = nthreads;\n"
+	"\tm_chunk = (chunk > 0) ? chunk : 1;\n"
+	"\tm_job  = 0;\n"
+	"\tm_busy = 0;\n"
+	"\tm_quit = false;\n"
+	"\tm_nframes = 0;\n"
+	"\tm_in_r = m_in_i = NULL;\n"
+	"\tm_out_r = m_out_i = NULL;\n"
+"\n"
+	"\tm_model = new %s *[m_nthreads];\n"
+	"\tfor(int k=0; k<m_nthreads; k++) {\n"
+		"\t\tm_model[k] = new %s(cmemdir);\n"
+		"\t\tm_model[k]->reserve(m_chunk);\n"
+	"\t}\n"
+"\n"
+	"\tm_thread = new std::thread[m_nthreads];\n"
+	"\tfor(int k=0; k<m_nthreads; k++)\n"
+		"\t\tm_thread[k] = std::thread(&%s_POOL::worker, this, k);\n"
+"}\n"
+"\n"
+"%s_POOL::~%s_POOL(void) {\n"
+	"\t{\n"
+		"\t\tstd::lock_guard<std::mutex>\tlock(m_lock);\n"
+		"\t\tm_quit = true;\n"
+	"\t} m_start.notify_all();\n"
+"\n"
+	"\tfor(int k=0; k<m_nthreads; k++) {\n"
+		"\t\tm_thread[k].join();\n"
+		"\t\tdelete m_model[k];\n"
+	"\t}\n"
+	"\tdelete[] m_thread;\n"
+	"\tdelete[] m_model;\n"
+"}\n"
+"\n"
+"bool\t%s_POOL::loaded(void) const {\n"
+	"\tfor(int k=0; k<m_nthreads; k++)\n"
+		"\t\tif (!m_model[k]->loaded())\n"
+			"\t\t\treturn false;\n"
+	"\treturn true;\n"
+"}\n"
+"\n"
+"void\t%s_POOL::worker(int id) {\n"
+	"\t%s\t*mdl = m_model[id];\n"
+	"\tunsigned\tjob = 0;\n"
+"\n"
+	"\twhile(true) {\n"
+		"\t\tint\tfirst, last;\n"
+"\n"
+		"\t\t{\n"
+			"\t\t\tstd::unique_lock<std::mutex>\tlock(m_lock);\n"
+			"\t\t\twhile((!m_quit)&&(m_job == job))\n"
+				"\t\t\t\tm_start.wait(lock);\n"
+			"\t\t\tif (m_quit)\n"
+				"\t\t\t\treturn;\n"
+			"\t\t\tjob = m_job;\n"
+		"\t\t}\n"
+"\n"
+		"\t\tfirst = (int)((int64_t)m_nframes * id / m_nthreads);\n"
+		"\t\tlast  = (int)((int64_t)m_nframes * (id+1) / m_nthreads);\n"
+		"\t\tfor(int f=first; f<last; f += m_chunk) {\n"
+			"\t\t\tint\t\tnf = (last-f < m_chunk) ? last-f : m_chunk;\n"
+			"\t\t\tsize_t\t\tat = (size_t)f * %s::SIZE;\n"
+"\n"
+			"\t\t\tmdl->apply_frames(nf, m_in_r+at, m_in_i+at,\n"
+				"\t\t\t\tm_out_r+at, m_out_i+at);\n"
+		"\t\t}\n"
+"\n"
+		"\t\t{\n"
+			"\t\t\tstd::lock_guard<std::mutex>\tlock(m_lock);\n"
+			"\t\t\tif (--m_busy == 0)\n"
+				"\t\t\t\tm_done.notify_one();\n"
+		"\t\t}\n"
+	"\t}\n"
+"}\n"
+"\n"
+"void\t%s_POOL::apply(int nframes, const int64_t *in_r, const int64_t *in_i,\n"
+		"\t\tint64_t *out_r, int64_t *out_i) {\n"
+	"\tstd::unique_lock<std::mutex>\tlock(m_lock);\n"
+"\n"
+	"\tm_nframes = nframes;\n"
+	"\tm_in_r  = in_r;\n"
+	"\tm_in_i  = in_i;\n"
+	"\tm_out_r = out_r;\n"
+	"\tm_out_i = out_i;\n"
+	"\tm_busy  = m_nthreads;\n"
+	"\tm_job++;\n"
+	"\tm_start.notify_all();\n"
+"\n"
+	"\twhile(m_busy > 0)\n"
+		"\t\tm_done.wait(lock);\n"
+"}\n", N, N, N, N, N, N, N, N, N, N, N, N);
+
+	fclose(fp);
+}
+
+//
+// Read the twiddle factors of a butterfly stage back from the cmem_*.hex
+// files written for it, one per position within its span, as the run time
+// model's load() does
+//
+static	bool	mdl_coefs(const char *coredir, const MDLSTAGE &s,
+			long long *c_r, long long *c_i) {
+	int	span = s.size/2, nfiles = (s.ocmem.length() > 0) ? 2:1;
+
+	for(int f=0; f<nfiles; f++) {
+		std::string	fname = std::string(coredir) + "/"
+				+ ((f == 0) ? s.cmem : s.ocmem);
+		FILE	*fp = fopen(fname.c_str(), "r");
+		unsigned long long	vl;
+		int	n = 0;
+
+		if (NULL == fp) {
+			fprintf(stderr, "Could not open \'%s\' for reading\n",
+				fname.c_str());
+			perror("O/S Err was:");
+			return false;
+		}
+
+		for(int e=0; (n < span)&&(1 == fscanf(fp, "%llx", &vl)); e++) {
+			unsigned long long	m = (1ull << s.cw) - 1,
+						sgn = 1ull << (s.cw-1);
+			int	p;
+
+			if (nfiles > 1)
+				p = 2*e+f;
+			else if (e % s.cstride != 0)
+				continue;
+			else
+				p = e / s.cstride;
+			if (p >= span)
+				break;
+			c_r[p] = (long long)((((vl >> s.cw) & m) ^ sgn) - sgn);
+			c_i[p] = (long long)(((vl & m) ^ sgn) - sgn);
+			n++;
+		} fclose(fp);
+
+		if (n < span / nfiles) {
+			fprintf(stderr, "%s holds too few coefficients\n",
+				fname.c_str());
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static	void	mdl_table(FILE *fp, const char *name, int len,
+			const long long *v) {
+	fprintf(fp, "\t\t\t%s[%d] = {", name, len);
+	for(int k=0; k<len; k++)
+		fprintf(fp, "%s%lld%s", (k%8 == 0) ? "\n\t\t\t\t":" ", v[k],
+			(k+1 < len) ? ",":"");
+	fprintf(fp, " }");
+}
+
+static	void	build_fftmodel_t(const char *fname, const char *coredir,
+			const char *name, int lgsize, int iw, int ow,
+			bool inverse, bool bitreverse, bool pairs, int nkeep,
+			int nstages, const MDLSTAGE *stage) {
+	FILE	*fp = fopen(fname, "w");
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return;
+	}
+
+	std::string	NAME(name);
+	for(unsigned k=0; k<NAME.length(); k++)
+		NAME[k] = toupper(NAME[k]);
+	const char	*N = NAME.c_str(), *P = (inverse) ? "I":"";
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\t%s_t.h\n"
+"//\n"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:\tA header only C++ model of the %d point %sfftmain.v\n"
+"//		built alongside it, intended to be bit exact.  This is the\n"
+"//	model of %s.h, save that it is specialized at compile time: the\n"
+"//	template below is defined only for the widths this core was built\n"
+"//	with, each stage is a call with its size, widths, shift, and rounding\n"
+"//	as template arguments, and the twiddle factors are compiled in.  No\n"
+"//	files are read at run time, and nothing is allocated.\n"
+"//\n"
+"//	Use it with the header written by fftgen -a, as in\n"
+"//\n"
+"//		%s_T<%sFFT_LGWIDTH, %sFFT_IWIDTH, %sFFT_OWIDTH>\tfft;\n"
+"//\n"
+"//	so that a core rebuilt with other widths fails to compile, rather\n"
+"//	than give other results.  Samples are given and returned as for\n"
+"//	%s.h, and C++11 or later is required.\n"
+"//\n%s"
+"//\n", name, prjname, 1<<lgsize, (inverse)?"i":"", name, N, P, P, P,
+		name, creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n");
+
+	fprintf(fp,
+"#ifndef\t%s_T_%d_%d_%d_H\n"
+"#define\t%s_T_%d_%d_%d_H\n"
+"\n"
+"#include <stdint.h>\n"
+"\n"
+"#ifndef\t%s_T_DECLARED\n"
+"#define\t%s_T_DECLARED\n"
+"// Defined only for the widths of cores that have been built\n"
+"template<int LGWIDTH, int IWIDTH, int OWIDTH>\tclass\t%s_T;\n"
+"#endif\n"
+"\n"
+"template<>\tclass\t%s_T<%d, %d, %d> {\n"
+"public:\n"
+	"\tstatic\tconst\tint\tLGSIZE = %d, SIZE = (1<<LGSIZE),\n"
+			"\t\t\t\tIWIDTH = %d, OWIDTH = %d, NSTAGES = %d;\n"
+	"\t// Only the first NKEEP inputs of each frame are used, the rest\n"
+	"\t// are taken to be zero\n"
+	"\tstatic\tconst\tint\tNKEEP = %d;\n"
+	"\tstatic\tconst\tbool\tINVERSE = %s, BITREVERSE = %s;\n"
+	"\t// Bins k and N-k are produced in turn, as for dualreal.v\n"
+	"\tstatic\tconst\tbool\tPAIRS = %s;\n"
+"\n"
+	"\ttypedef\tenum {\n"
+		"\t\tTRUNCATE, FROMZERO, HALFUP, CONVERGENT\n"
+	"\t} RND_T;\n"
+"\n"
+"private:\n"
+	"\tint64_t\tm_r[SIZE], m_i[SIZE];\n"
+"\n"
+"public:\n"
+	"\t// The arithmetic of the core\'s rounders, as in %s.cpp, but with\n"
+	"\t// the widths known at compile time\n"
+	"\ttemplate<int BITS>\n"
+	"\tstatic\tinline\tint64_t\tsext(int64_t v) {\n"
+		"\t\tconst\tuint64_t\tm = (2ull << (BITS-1)) - 1,\n"
+				"\t\t\t\ts = 1ull << (BITS-1);\n"
+"\n"
+		"\t\treturn (int64_t)((((uint64_t)v & m) ^ s) - s);\n"
+	"\t}\n"
+"\n"
+	"\ttemplate<RND_T RND, int IWID, int OWID, int SHIFT>\n"
+	"\tstatic\tinline\tint64_t\tround(int64_t v) {\n"
+		"\t\t// D bits are rounded away, or Z = -D zeros appended.  L is\n"
+		"\t\t// D, kept positive so the shifts below are always defined.\n"
+		"\t\tconst\tint\tD = IWID - SHIFT - OWID, L = (D > 0) ? D : 1,\n"
+				"\t\t\t\tZ = (D < 0) ? -D : 0;\n"
+		"\t\tint64_t\ttruncated;\n"
+		"\t\tbool\tfirst_lost_bit, other_lost_bits;\n"
+"\n"
+		"\t\tv = sext<IWID>(v);\n"
+		"\t\tif ((IWID == OWID)&&(RND != TRUNCATE)&&(RND != HALFUP))\n"
+			"\t\t\treturn v;\n"
+		"\t\tif (D <= 0)\n"
+			"\t\t\treturn sext<OWID>(v * (1ll << Z));\n"
+"\n"
+		"\t\ttruncated = v >> L;\n"
+		"\t\tfirst_lost_bit  = (v >> (L-1)) & 1;\n"
+		"\t\tother_lost_bits = (L > 1) && ((v & ((1ll << (L-1))-1)) != 0);\n"
+"\n"
+		"\t\tswitch(RND) {\n"
+		"\t\tcase TRUNCATE:\n"
+			"\t\t\tbreak;\n"
+		"\t\tcase HALFUP:\n"
+			"\t\t\tif (first_lost_bit)\n"
+				"\t\t\t\ttruncated++;\n"
+			"\t\t\tbreak;\n"
+		"\t\tcase FROMZERO:\n"
+			"\t\t\tif ((first_lost_bit)&&((other_lost_bits)||(v >= 0)))\n"
+				"\t\t\t\ttruncated++;\n"
+			"\t\t\tbreak;\n"
+		"\t\tdefault:\n"
+			"\t\t\tif ((first_lost_bit)&&((other_lost_bits)||(truncated & 1)))\n"
+				"\t\t\t\ttruncated++;\n"
+			"\t\t\tbreak;\n"
+		"\t\t}\n"
+"\n"
+		"\t\treturn sext<OWID>(truncated);\n"
+	"\t}\n"
+"\n"
+"private:\n"
+	"\t// A butterfly stage of SZ points, as butterfly.v or hwbfly.v\n"
+	"\ttemplate<int SZ, int IW, int CW, int OW, int SHIFT, RND_T RND>\n"
+	"\tstatic\tinline\tvoid\tbfly(const int64_t *c_r, const int64_t *c_i,\n"
+			"\t\t\t\tint64_t *v_r, int64_t *v_i) {\n"
+		"\t\tconst\tint\tW = CW+IW+3;\n"
+		"\t\tconst\tint64_t\tgain = 1ll << (CW-2);\n"
+"\n"
+		"\t\tfor(int base=0; base<SIZE; base += SZ)\n"
+		"\t\tfor(int n=0; n<SZ/2; n++) {\n"
+			"\t\t\tconst\tint\ta = base+n, b = base+n+SZ/2;\n"
+			"\t\t\tint64_t\tsum_r, sum_i, dif_r, dif_i;\n"
+"\n"
+			"\t\t\tsum_r = v_r[a] + v_r[b];\n"
+			"\t\t\tsum_i = v_i[a] + v_i[b];\n"
+			"\t\t\tdif_r = v_r[a] - v_r[b];\n"
+			"\t\t\tdif_i = v_i[a] - v_i[b];\n"
+"\n"
+			"\t\t\tv_r[a] = round<RND, W, OW, SHIFT+4>(sum_r * gain);\n"
+			"\t\t\tv_i[a] = round<RND, W, OW, SHIFT+4>(sum_i * gain);\n"
+			"\t\t\tv_r[b] = round<RND, W, OW, SHIFT+4>(\n"
+					"\t\t\t\tc_r[n] * dif_r - c_i[n] * dif_i);\n"
+			"\t\t\tv_i[b] = round<RND, W, OW, SHIFT+4>(\n"
+					"\t\t\t\tc_r[n] * dif_i + c_i[n] * dif_r);\n"
+		"\t\t}\n"
+	"\t}\n"
+"\n"
+	"\t// A qtrstage (ROT != 0) or laststage (ROT == 0) of SZ points.  The\n"
+	"\t// qtrstage multiplies its odd differences by -j (ROT > 0), or by\n"
+	"\t// j for an inverse (ROT < 0).\n"
+	"\ttemplate<int SZ, int IW, int OW, int SHIFT, RND_T RND, int ROT>\n"
+	"\tstatic\tinline\tvoid\tsumdif(int64_t *v_r, int64_t *v_i) {\n"
+		"\t\tconst\tint\tW = IW+1;\n"
+"\n"
+		"\t\tfor(int base=0; base<SIZE; base += SZ)\n"
+		"\t\tfor(int n=0; n<SZ/2; n++) {\n"
+			"\t\t\tconst\tint\ta = base+n, b = base+n+SZ/2;\n"
+			"\t\t\tint64_t\tdif_r, dif_i;\n"
+"\n"
+			"\t\t\tdif_r = round<RND, W, OW, SHIFT>(v_r[a] - v_r[b]);\n"
+			"\t\t\tdif_i = round<RND, W, OW, SHIFT>(v_i[a] - v_i[b]);\n"
+			"\t\t\tv_r[a] = round<RND, W, OW, SHIFT>(v_r[a] + v_r[b]);\n"
+			"\t\t\tv_i[a] = round<RND, W, OW, SHIFT>(v_i[a] + v_i[b]);\n"
+			"\t\t\tif ((ROT == 0)||((n&1) == 0)) {\n"
+				"\t\t\t\tv_r[b] = dif_r;\n"
+				"\t\t\t\tv_i[b] = dif_i;\n"
+			"\t\t\t} else if (ROT > 0) {\n"
+				"\t\t\t\tv_r[b] = dif_i;\n"
+				"\t\t\t\tv_i[b] = sext<OW>(-dif_r);\n"
+			"\t\t\t} else {\n"
+				"\t\t\t\tv_r[b] = sext<OW>(-dif_i);\n"
+				"\t\t\t\tv_i[b] = dif_r;\n"
+			"\t\t\t}\n"
+		"\t\t}\n"
+	"\t}\n"
+"\n"
+"public:\n"
+	"\t// Transform one frame\n"
+	"\tvoid\tapply(const int64_t *in_r, const int64_t *in_i,\n"
+			"\t\t\tint64_t *out_r, int64_t *out_i) {\n"
+		"\t\tfor(int k=0; k<SIZE; k++) {\n"
+			"\t\t\tm_r[k] = (k < NKEEP) ? sext<IWIDTH>(in_r[k]) : 0;\n"
+			"\t\t\tm_i[k] = (k < NKEEP) ? sext<IWIDTH>(in_i[k]) : 0;\n"
+		"\t\t}\n"
+"\n",
+		N, lgsize, iw, ow, N, lgsize, iw, ow,
+		N, N, N,
+		N, lgsize, iw, ow,
+		lgsize, iw, ow, nstages, nkeep,
+		(inverse)?"true":"false", (bitreverse)?"true":"false",
+		(pairs)?"true":"false", name);
+
+	for(int k=0; k<nstages; k++) {
+		const MDLSTAGE	&s = stage[k];
+		const char	*rnd;
+
+		switch(s.rnd) {
+		case RND_TRUNCATE:	rnd = "TRUNCATE";	break;
+		case RND_FROMZERO:	rnd = "FROMZERO";	break;
+		case RND_HALFUP:	rnd = "HALFUP";		break;
+		default:		rnd = "CONVERGENT";	break;
+		}
+
+		if (s.kind == MDL_BUTTERFLY) {
+			int		span = s.size/2;
+			long long	*c_r = new long long[span],
+					*c_i = new long long[span];
+
+			if (!mdl_coefs(coredir, s, c_r, c_i)) {
+				fprintf(stderr, "ERR: %s is incomplete\n", fname);
+				for(int p=0; p<span; p++)
+					c_r[p] = c_i[p] = 0;
+			}
+
+			fprintf(fp, "\t\t{\n"
+				"\t\t\t// Stage %d, from %s\n"
+				"\t\t\tstatic\tconstexpr\tint64_t\n", k,
+				s.cmem.c_str());
+			mdl_table(fp, "c_r", span, c_r);
+			fprintf(fp, ",\n");
+			mdl_table(fp, "c_i", span, c_i);
+			fprintf(fp, ";\n\n"
+				"\t\t\tbfly<%d, %d, %d, %d, %d, %s>(c_r, c_i, m_r, m_i);\n"
+				"\t\t}\n", s.size, s.iw, s.cw, s.ow, s.shift,
+				rnd);
+
+			delete[] c_r;
+			delete[] c_i;
+		} else
+			fprintf(fp, "\t\t// Stage %d, the %s\n"
+				"\t\tsumdif<%d, %d, %d, %d, %s, %d>(m_r, m_i);\n",
+				k, (s.kind == MDL_QTRSTAGE)
+					? "qtrstage" : "laststage",
+				s.size, s.iw, s.ow, s.shift, rnd,
+				(s.kind != MDL_QTRSTAGE) ? 0 : (inverse) ? -1:1);
+	}
+
+	fprintf(fp,
+"\n"
+		"\t\t// The stages leave the frame in bit reversed order\n"
+		"\t\tfor(int k=0; k<SIZE; k++) {\n"
+			"\t\t\tunsigned\tb = k, p;\n"
+"\n"
+			"\t\t\t// Bins k and N-k in turn, as for dualreal.v\n"
+			"\t\t\tif (PAIRS)\n"
+				"\t\t\t\tb = (k & 1) ? (k+1)/2 : (SIZE - k/2) %% SIZE;\n"
+			"\t\t\tp = b;\n"
+			"\t\t\tif (BITREVERSE) {\n"
+				"\t\t\t\tp = 0;\n"
+				"\t\t\t\tfor(int j=0; j<LGSIZE; j++)\n"
+					"\t\t\t\t\tp |= ((b >> j) & 1) << (LGSIZE-1-j);\n"
+			"\t\t\t}\n"
+"\n"
+			"\t\t\tout_r[k] = m_r[p];\n"
+			"\t\t\tout_i[k] = m_i[p];\n"
+		"\t\t}\n"
+	"\t}\n"
+"};\n"
+"\n"
+"#endif\t// %s_T_%d_%d_%d_H\n", N, lgsize, iw, ow);
+
+	fclose(fp);
+}
+
+void	build_fftmodel(const char *coredir, int lgsize, int iw, int ow,
+		bool inverse, bool bitreverse, bool pairs, int nkeep,
+		int nstages, const MDLSTAGE *stage) {
+	std::string	name, fname;
+
+	name = (inverse) ? "ifftmodel" : "fftmodel";
+
+	fname = std::string(coredir) + "/" + name + ".h";
+	build_fftmodel_h(fname.c_str(), name.c_str(), lgsize, iw, ow, inverse,
+		bitreverse, pairs, nkeep, nstages, stage);
+
+	fname = std::string(coredir) + "/" + name + ".cpp";
+	build_fftmodel_cpp(fname.c_str(), name.c_str(), lgsize, inverse,
+		nstages, stage);
+
+	fname = std::string(coredir) + "/" + name + "_t.h";
+	build_fftmodel_t(fname.c_str(), coredir, name.c_str(), lgsize, iw, ow,
+		inverse, bitreverse, pairs, nkeep, nstages, stage);
+}
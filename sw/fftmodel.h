@@ -0,0 +1,69 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	fftmodel.h
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Generates a C++ model of the fftmain.v just built, intended to
+//		be bit exact, from a description of each of its stages recorded
+//	as the Verilog was written.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+#ifndef	FFTMODEL_H
+#define	FFTMODEL_H
+
+#include "rounding.h"
+
+typedef	enum {
+	MDL_BUTTERFLY, MDL_QTRSTAGE, MDL_LASTSTAGE
+} MDLSTAGE_T;
+
+//
+// One stage of fftmain, as the model needs to know it.  A butterfly
+// stage's twiddle factors are entry n*cstride of cmem, for position n within
+// its span.  When a two sample per clock stage keeps its even and odd
+// coefficients in separate files, ocmem names the odd one.
+//
+typedef	struct	{
+	MDLSTAGE_T	kind;
+	int		size, iw, cw, ow, shift;
+	ROUND_T		rnd;
+	std::string	cmem, ocmem;
+	int		cstride;
+} MDLSTAGE;
+
+extern	void	mdl_stage(MDLSTAGE &s, MDLSTAGE_T kind, int size, int iw,
+			int cw, int ow, int shift, ROUND_T rnd,
+			const std::string &cmem = "", int cstride = 1);
+extern	void	build_fftmodel(const char *coredir, int lgsize, int iw,
+			int ow, bool inverse, bool bitreverse, bool pairs,
+			int nkeep, int nstages, const MDLSTAGE *stage);
+
+#endif	// FFTMODEL_H
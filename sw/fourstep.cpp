@@ -0,0 +1,542 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	fourstep.cpp
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Generates fourstep.v, a four-step (Bailey) FFT of N = M*M
+//		points built from two M point fftmain pipelines.  Writing
+//	n = M n1 + n2 and k = k1 + M k2,
+//
+//	X[k1 + M k2] = SUM_n2 W_M^{n2 k2} W_N^{n2 k1} SUM_n1 x[M n1 + n2] W_M^{n1 k1}
+//
+//	so that the first pipeline transforms the columns of x, the result
+//	is rotated by W_N^{n2 k1}, and the second pipeline transforms the
+//	rows.  The two transposes between these steps go through an external
+//	memory, rather than the delay lines of a single N point pipeline.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+#define _CRT_SECURE_NO_WARNINGS   //  ms vs 2012 doesn't like fopen
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _MSC_VER //  added for ms vs compatibility
+
+#include <io.h>
+#include <direct.h>
+#define _USE_MATH_DEFINES
+#else
+// And for G++/Linux environment
+
+#include <unistd.h>	// Defines the R_OK/W_OK/etc. macros
+#include <sys/stat.h>
+#endif
+
+#include <string.h>
+#include <string>
+#include <math.h>
+#include <ctype.h>
+#include <assert.h>
+
+#include "defaults.h"
+#include "legal.h"
+#include "fftlib.h"
+
+#include "fourstep.h"
+
+std::string	gen_fourstep_fname(const char *coredir, const char *tbl,
+			int lgsize, bool inv) {
+	std::string	result;
+	char	*memfile;
+
+	memfile = new char[strlen(coredir)+strlen(tbl)+64];
+	if (coredir[0] == '\0')
+		sprintf(memfile, "%stw%s_%d.hex",
+			(inv)?"i":"", tbl, 1<<lgsize);
+	else
+		sprintf(memfile, "%s/%stw%s_%d.hex",
+			coredir, (inv)?"i":"", tbl, 1<<lgsize);
+	result = std::string(memfile);
+	delete[] memfile;
+	return result;
+}
+
+//
+// The inter-step twiddle, W_N^e for e = n2 k1 < N, is the product of two
+// smaller tables, W_M^{e/M} from the "hi" table and W_N^{e%M} from the
+// "lo" table.  Each has M entries.
+//
+static	void	gen_twiddle_table(const char *fname, int npts, int nentries,
+			int cbits, bool inv) {
+	FILE	*fp = fopen(fname, "w");
+	double	radius = (double)(1ll<<(cbits-2));
+
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return;
+	}
+
+	for(int k=0; k<nentries; k++) {
+		double	W = ((inv)?1:-1)*2.0*M_PI*k/(double)npts;
+		long long ic, is, vl;
+
+		ic = (long long)llround(radius * cos(W));
+		is = (long long)llround(radius * sin(W));
+		vl = (ic & (~(-1ll << (cbits))));
+		vl <<= (cbits);
+		vl |= (is & (~(-1ll << (cbits))));
+		fprintf(fp, "%0*llx\n", ((cbits*2+3)/4), vl);
+	}
+
+	fclose(fp);
+}
+
+void	gen_fourstep_twiddles(const char *coredir, int lgsize, int cbits,
+		bool inv) {
+	std::string	fname;
+	int		lghalf = lgsize/2;
+
+	assert(2*cbits < 64);
+
+	fname = gen_fourstep_fname(coredir, "hi", lgsize, inv);
+	gen_twiddle_table(fname.c_str(), 1<<lghalf, 1<<lghalf, cbits, inv);
+	fname = gen_fourstep_fname(coredir, "lo", lgsize, inv);
+	gen_twiddle_table(fname.c_str(), 1<<lgsize, 1<<lghalf, cbits, inv);
+}
+
+void	build_fourstep(const char *fname, int lgsize, int iw, int ow, int cw,
+		bool inv, ROUND_T rounding, const bool async_reset) {
+	FILE	*fp = fopen(fname, "w");
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return;
+	}
+
+	std::string	resetw("i_reset"), always_reset;
+	if (async_reset) {
+		resetw = std::string("i_areset_n");
+		always_reset = std::string("\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	} else
+		always_reset = std::string("\talways @(posedge i_clk)\n\tif (i_reset)\n");
+
+	const	char	*rnd_string = rnd_module(rounding);
+
+	assert((lgsize & 1)==0);
+	assert(ow >= iw);
+
+	std::string	hifile = gen_fourstep_fname("", "hi", lgsize, inv),
+			lofile = gen_fourstep_fname("", "lo", lgsize, inv);
+	const char	*fftname = (inv) ? "ifftmain" : "fftmain";
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\tfourstep.v\n"
+"//\n"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:\tA %d point four-step FFT, built from two %d point %s\n"
+"//		pipelines.  With n = M n1 + n2 and k = k1 + M k2, M = %d,\n"
+"//\n"
+"//	X[k1 + M k2] = SUM_n2 W_M^{n2 k2} W_N^{n2 k1} SUM_n1 x[M n1 + n2] W_M^{n1 k1}\n"
+"//\n"
+"//	Each incoming frame is written to external memory channel A in order,\n"
+"//	while the last frame is read back by columns into the first %s.\n"
+"//	Its outputs are rotated by W_N^{n2 k1}, and written to channel B\n"
+"//	transposed, while the last such frame is read back in order into the\n"
+"//	second %s.\n"
+"//\n"
+"//	The result, X[k1 + M k2], is produced with k1 in the outer loop and\n"
+"//	k2 in the inner loop, so that o_sync marks X[0] and each o_ce\n"
+"//	thereafter steps k2 before k1.  A natural order output requires one\n"
+"//	more transpose, should it be needed.\n"
+"//\n"
+"// Memory:\tEach channel holds two frames of N words of 2*IW bits, one\n"
+"//		being written while the other is read, for (2N) words\n"
+"//	in all.  Writes are accepted on every o_m?_we.  Reads are requested\n"
+"//	by o_m?_re, and must be returned, in order, with i_m?_rvalid.  The\n"
+"//	read latency may be anything, but a read must return any data written\n"
+"//	before it was requested.  extmem.v models this for simulation.\n"
+"//\n"
+"//	Linear addresses are written to channel A and read from channel B,\n"
+"//	so these may be grouped into bursts.  The other side of each\n"
+"//	transpose steps by M words per request.\n"
+"//\n"
+"//	To keep the twiddle tables small, both pipelines use the input width,\n"
+"//	IW.  The first pipeline's outputs are scaled back to this width by\n"
+"//	the twiddle multiply, dropping the %d bits it grew by.\n"
+"//\n"
+"//	As with fftmain, everything moves with i_ce.  Outputs will only\n"
+"//	be produced as further frames are provided.\n"
+"//\n%s"
+"//\n", prjname, 1<<lgsize, 1<<(lgsize/2), fftname, 1<<(lgsize/2),
+		fftname, fftname, ow-iw, creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+
+	fprintf(fp,
+"module\tfourstep(i_clk, %s, i_ce, i_sample,\n"
+		"\t\to_ma_we, o_ma_waddr, o_ma_wdata,\n"
+		"\t\to_ma_re, o_ma_raddr, i_ma_rvalid, i_ma_rdata,\n"
+		"\t\to_mb_we, o_mb_waddr, o_mb_wdata,\n"
+		"\t\to_mb_re, o_mb_raddr, i_mb_rvalid, i_mb_rdata,\n"
+		"\t\to_ce, o_result, o_sync);\n"
+	"\tlocalparam\tIW=%d, OW=%d, CW=%d, LGHALF=%d, LGSIZE=2*LGHALF;\n"
+	"\tlocalparam\tTWHIFILE=\"%s\", TWLOFILE=\"%s\";\n"
+	"\t//\n"
+	"\tinput\twire\t\t\ti_clk, %s, i_ce;\n"
+	"\tinput\twire\t[(2*IW-1):0]\ti_sample;\n"
+	"\t// External memory, channel A: the input transpose\n"
+	"\toutput\treg\t\t\to_ma_we, o_ma_re;\n"
+	"\toutput\treg\t[LGSIZE:0]\to_ma_waddr, o_ma_raddr;\n"
+	"\toutput\treg\t[(2*IW-1):0]\to_ma_wdata;\n"
+	"\tinput\twire\t\t\ti_ma_rvalid;\n"
+	"\tinput\twire\t[(2*IW-1):0]\ti_ma_rdata;\n"
+	"\t// External memory, channel B: the inter-step transpose\n"
+	"\toutput\treg\t\t\to_mb_we, o_mb_re;\n"
+	"\toutput\treg\t[LGSIZE:0]\to_mb_waddr, o_mb_raddr;\n"
+	"\toutput\treg\t[(2*IW-1):0]\to_mb_wdata;\n"
+	"\tinput\twire\t\t\ti_mb_rvalid;\n"
+	"\tinput\twire\t[(2*IW-1):0]\ti_mb_rdata;\n"
+	"\t//\n"
+	"\toutput\twire\t\t\to_ce;\n"
+	"\toutput\twire\t[(2*OW-1):0]\to_result;\n"
+	"\toutput\twire\t\t\to_sync;\n"
+"\n",
+		resetw.c_str(), iw, ow, cw, lgsize/2,
+		hifile.c_str(), lofile.c_str(), resetw.c_str());
+
+	// Step one: the input transpose
+	fprintf(fp,
+	"\t////////////////////////////////////////////////////////////////\n"
+	"\t//\n"
+	"\t// Step one: write each frame in order, while reading the last by\n"
+	"\t// columns\n"
+	"\t//\n"
+	"\treg\t[LGSIZE:0]\tacnt;\n"
+	"\treg\t\t\tarunning;\n"
+"\n"
+	"\tinitial\tacnt = 0;\n"
+	"%s"
+	"\t\tacnt <= 0;\n"
+	"\telse if (i_ce)\n"
+	"\t\tacnt <= acnt + 1'b1;\n"
+"\n"
+	"\tinitial\tarunning = 1'b0;\n"
+	"%s"
+	"\t\tarunning <= 1'b0;\n"
+	"\telse if ((i_ce)&&(&acnt[(LGSIZE-1):0]))\n"
+	"\t\tarunning <= 1'b1;\n"
+"\n"
+	"\tinitial\t{ o_ma_we, o_ma_re } = 2'b00;\n"
+	"%s"
+	"\t\t{ o_ma_we, o_ma_re } <= 2'b00;\n"
+	"\telse\n"
+	"\t\t{ o_ma_we, o_ma_re } <= { i_ce, (i_ce)&&(arunning) };\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+	"\t\to_ma_waddr <= acnt;\n"
+	"\t\to_ma_wdata <= i_sample;\n"
+	"\t\t// Read x[M n1 + n2], with n2 in the upper half of acnt\n"
+	"\t\to_ma_raddr <= { !acnt[LGSIZE], acnt[(LGHALF-1):0],\n"
+	"\t\t\t\t\tacnt[(LGSIZE-1):LGHALF] };\n"
+	"\tend\n"
+"\n"
+	"\t//\n"
+	"\t// Step two: an M point FFT of each column\n"
+	"\t//\n"
+	"\twire\t[(2*OW-1):0]\tw_r1;\n"
+	"\twire\t\t\tw_s1;\n"
+"\n"
+	"\t%s\tfftone(i_clk, %s, i_ma_rvalid, i_ma_rdata, w_r1, w_s1);\n"
+"\n",
+		always_reset.c_str(), always_reset.c_str(),
+		always_reset.c_str(), fftname, resetw.c_str());
+
+	// Step three: the twiddle
+	fprintf(fp,
+	"\t////////////////////////////////////////////////////////////////\n"
+	"\t//\n"
+	"\t// Step three: rotate bin k1 of column n2 by W_N^{n2 k1}.  This\n"
+	"\t// moves with the first FFT, capturing its outputs on each i_ce.\n"
+	"\t//\n"
+	"\treg	[(2*CW-1):0]	twhi	[0:((1<<LGHALF)-1)];\n"
+	"\treg	[(2*CW-1):0]	twlo	[0:((1<<LGHALF)-1)];\n"
+"\n"
+	"\tinitial\t$readmemh(TWHIFILE, twhi);\n"
+	"\tinitial\t$readmemh(TWLOFILE, twlo);\n"
+"\n"
+	"\twire\t\t\tce1;\n"
+	"\treg\t\t\tstarted1, r_ce1;\n"
+	"\treg\t[(LGSIZE-1):0]\ttcnt, tw_e;\n"
+	"\treg\t[7:0]\t\ttvalid;\n"
+	"\treg\t[(2*OW-1):0]\ty0, y1, y2, y3, y4;\n"
+	"\treg\t[(2*CW-1):0]\tta, tb;\n"
+	"\twire\tsigned\t[(CW-1):0]\tta_r, ta_i, tb_r, tb_i, tw_r, tw_i;\n"
+	"\treg\tsigned\t[(2*CW-1):0]\tp_rr, p_ii, p_ri, p_ir;\n"
+	"\treg\tsigned\t[(2*CW):0]\tpw_r, pw_i;\n"
+	"\twire\tsigned\t[(OW-1):0]\ty_r, y_i;\n"
+	"\treg\tsigned\t[(OW+CW-1):0]\tq_rr, q_ii, q_ri, q_ir;\n"
+	"\treg\tsigned\t[(OW+CW):0]\tqz_r, qz_i;\n"
+	"\twire\tsigned\t[(IW-1):0]\tz_r, z_i;\n"
+	"\twire\t\t\tb_wr;\n"
+"\n"
+	"\tassign\tce1 = i_ma_rvalid;\n"
+"\n"
+	"\tinitial\tstarted1 = 1'b0;\n"
+	"%s"
+	"\t\tstarted1 <= 1'b0;\n"
+	"\telse if ((ce1)&&(w_s1))\n"
+	"\t\tstarted1 <= 1'b1;\n"
+"\n"
+	"\t// tcnt holds { n2, k1 } of the FFT output being captured\n"
+	"\tinitial\ttcnt = 0;\n"
+	"\tinitial\ttvalid = 0;\n"
+	"%s"
+	"\tbegin\n"
+	"\t\ttcnt <= 0;\n"
+	"\t\ttvalid <= 0;\n"
+	"\tend else if (ce1)\n"
+	"\tbegin\n"
+	"\t\tif ((started1)||(w_s1))\n"
+	"\t\t\ttcnt <= tcnt + 1'b1;\n"
+	"\t\ttvalid <= { tvalid[6:0], (started1)||(w_s1) };\n"
+	"\tend\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (ce1)\n"
+	"\tbegin\n"
+	"\t\t// The exponent, n2 * k1, is always less than N\n"
+	"\t\ty0   <= w_r1;\n"
+	"\t\ttw_e <= tcnt[(LGSIZE-1):LGHALF] * tcnt[(LGHALF-1):0];\n"
+"\n"
+	"\t\tta <= twhi[tw_e[(LGSIZE-1):LGHALF]];\n"
+	"\t\ttb <= twlo[tw_e[(LGHALF-1):0]];\n"
+	"\t\ty1 <= y0;\n"
+"\n"
+	"\t\tp_rr <= ta_r * tb_r;\n"
+	"\t\tp_ii <= ta_i * tb_i;\n"
+	"\t\tp_ri <= ta_r * tb_i;\n"
+	"\t\tp_ir <= ta_i * tb_r;\n"
+	"\t\ty2 <= y1;\n"
+"\n"
+	"\t\tpw_r <= p_rr - p_ii;\n"
+	"\t\tpw_i <= p_ri + p_ir;\n"
+	"\t\ty3 <= y2;\n"
+"\n"
+	"\t\t// (The twiddle rounders act here)\n"
+	"\t\ty4 <= y3;\n"
+"\n"
+	"\t\tq_rr <= y_r * tw_r;\n"
+	"\t\tq_ii <= y_i * tw_i;\n"
+	"\t\tq_ri <= y_r * tw_i;\n"
+	"\t\tq_ir <= y_i * tw_r;\n"
+"\n"
+	"\t\tqz_r <= q_rr - q_ii;\n"
+	"\t\tqz_i <= q_ri + q_ir;\n"
+	"\tend\n"
+"\n"
+	"\tassign\tta_r = ta[(2*CW-1):CW];\n"
+	"\tassign\tta_i = ta[(CW-1):0];\n"
+	"\tassign\ttb_r = tb[(2*CW-1):CW];\n"
+	"\tassign\ttb_i = tb[(CW-1):0];\n"
+	"\tassign\ty_r  = y4[(2*OW-1):OW];\n"
+	"\tassign\ty_i  = y4[(OW-1):0];\n"
+"\n"
+	"\t// Both tables carry a gain of 2^(CW-2), as does their product\n"
+	"\t%s #(2*CW+1,CW,3) rnd_twr(i_clk, ce1, pw_r, tw_r);\n"
+	"\t%s #(2*CW+1,CW,3) rnd_twi(i_clk, ce1, pw_i, tw_i);\n"
+"\n"
+	"\t// Remove the twiddle's gain, and return to IW bits\n"
+	"\t%s #(OW+CW+1,IW,3) rnd_zr(i_clk, ce1, qz_r, z_r);\n"
+	"\t%s #(OW+CW+1,IW,3) rnd_zi(i_clk, ce1, qz_i, z_i);\n"
+"\n"
+	"\t// A new z follows every i_ce of the first FFT\n"
+	"\tinitial\tr_ce1 = 1'b0;\n"
+	"%s"
+	"\t\tr_ce1 <= 1'b0;\n"
+	"\telse\n"
+	"\t\tr_ce1 <= ce1;\n"
+"\n"
+	"\tassign\tb_wr = (r_ce1)&&(tvalid[7]);\n"
+"\n",
+		always_reset.c_str(), always_reset.c_str(),
+		rnd_string, rnd_string, rnd_string, rnd_string,
+		always_reset.c_str());
+
+	// Step four: the inter-step transpose, and the second FFT
+	fprintf(fp,
+	"\t////////////////////////////////////////////////////////////////\n"
+	"\t//\n"
+	"\t// Step four: write the rotated outputs transposed, while reading the\n"
+	"\t// last such frame in order\n"
+	"\t//\n"
+	"\treg\t[LGSIZE:0]\tbcnt;\n"
+	"\treg\t\t\tbrunning;\n"
+"\n"
+	"\tinitial\tbcnt = 0;\n"
+	"%s"
+	"\t\tbcnt <= 0;\n"
+	"\telse if (b_wr)\n"
+	"\t\tbcnt <= bcnt + 1'b1;\n"
+"\n"
+	"\tinitial\tbrunning = 1'b0;\n"
+	"%s"
+	"\t\tbrunning <= 1'b0;\n"
+	"\telse if ((b_wr)&&(&bcnt[(LGSIZE-1):0]))\n"
+	"\t\tbrunning <= 1'b1;\n"
+"\n"
+	"\tinitial\t{ o_mb_we, o_mb_re } = 2'b00;\n"
+	"%s"
+	"\t\t{ o_mb_we, o_mb_re } <= 2'b00;\n"
+	"\telse\n"
+	"\t\t{ o_mb_we, o_mb_re } <= { b_wr, (b_wr)&&(brunning) };\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (b_wr)\n"
+	"\tbegin\n"
+	"\t\t// Write to { k1, n2 }, with n2 in the upper half of bcnt\n"
+	"\t\to_mb_waddr <= { bcnt[LGSIZE], bcnt[(LGHALF-1):0],\n"
+	"\t\t\t\t\tbcnt[(LGSIZE-1):LGHALF] };\n"
+	"\t\to_mb_wdata <= { z_r, z_i };\n"
+	"\t\to_mb_raddr <= { !bcnt[LGSIZE], bcnt[(LGSIZE-1):0] };\n"
+	"\tend\n"
+"\n"
+	"\t//\n"
+	"\t// An M point FFT of each row\n"
+	"\t//\n"
+	"\twire\t[(2*OW-1):0]\tw_r2;\n"
+	"\twire\t\t\tw_s2;\n"
+	"\treg\t\t\tr_ce2, started2;\n"
+	"\treg\t[(LGHALF-1):0]\tkcnt;\n"
+"\n"
+	"\t%s\tffttwo(i_clk, %s, i_mb_rvalid, i_mb_rdata, w_r2, w_s2);\n"
+"\n"
+	"\tinitial\t{ r_ce2, started2 } = 2'b00;\n"
+	"\tinitial\tkcnt = 0;\n"
+	"%s"
+	"\tbegin\n"
+	"\t\t{ r_ce2, started2 } <= 2'b00;\n"
+	"\t\tkcnt <= 0;\n"
+	"\tend else begin\n"
+	"\t\tr_ce2 <= i_mb_rvalid;\n"
+	"\t\tif ((r_ce2)&&(w_s2))\n"
+	"\t\tbegin\n"
+	"\t\t\tstarted2 <= 1'b1;\n"
+	"\t\t\tkcnt <= kcnt + 1'b1;\n"
+	"\t\tend\n"
+	"\tend\n"
+"\n"
+	"\t// o_result changes on the clock following each i_ce of the second\n"
+	"\t// FFT.  kcnt counts its frames, one per k1.\n"
+	"\tassign\to_ce     = (r_ce2)&&((started2)||(w_s2));\n"
+	"\tassign\to_result = w_r2;\n"
+	"\tassign\to_sync   = (r_ce2)&&(w_s2)&&(kcnt == 0);\n"
+"\n"
+"endmodule\n",
+		always_reset.c_str(), always_reset.c_str(),
+		always_reset.c_str(), fftname, resetw.c_str(),
+		always_reset.c_str());
+
+	fclose(fp);
+}
+
+void	build_extmem(const char *fname) {
+	FILE	*fp = fopen(fname, "w");
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return;
+	}
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\textmem.v\n"
+"//\n"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:\tA behavioral model of one channel of the external memory\n"
+"//		used by fourstep.v, for simulation only.  Writes take place\n"
+"//	on every i_we.  Each i_re returns the word at i_raddr, LATENCY clocks\n"
+"//	later, with o_rvalid set.  Reads see any write made before them.\n"
+"//\n%s"
+"//\n", prjname, creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+
+	fprintf(fp,
+"module\textmem(i_clk, i_we, i_waddr, i_wdata, i_re, i_raddr,\n"
+		"\t\to_rvalid, o_rdata);\n"
+	"\tparameter\tAW=11, DW=32, LATENCY=4;\n"
+	"\t//\n"
+	"\tinput\twire\t\t\ti_clk;\n"
+	"\tinput\twire\t\t\ti_we;\n"
+	"\tinput\twire\t[(AW-1):0]\ti_waddr;\n"
+	"\tinput\twire\t[(DW-1):0]\ti_wdata;\n"
+	"\tinput\twire\t\t\ti_re;\n"
+	"\tinput\twire\t[(AW-1):0]\ti_raddr;\n"
+	"\toutput\twire\t\t\to_rvalid;\n"
+	"\toutput\twire\t[(DW-1):0]\to_rdata;\n"
+"\n"
+	"\treg\t[(DW-1):0]\tmem\t[0:((1<<AW)-1)];\n"
+	"\treg\t[(DW-1):0]\tpdata\t[0:(LATENCY-1)];\n"
+	"\treg\t[(LATENCY-1):0]\tpvalid;\n"
+	"\tinteger\t\t\tk;\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_we)\n"
+	"\t\tmem[i_waddr] <= i_wdata;\n"
+"\n"
+	"\tinitial\tpvalid = 0;\n"
+	"\talways @(posedge i_clk)\n"
+	"\tbegin\n"
+	"\t\tpvalid[LATENCY-1] <= i_re;\n"
+	"\t\tpdata[LATENCY-1] <= ((i_we)&&(i_waddr == i_raddr))\n"
+	"\t\t\t\t? i_wdata : mem[i_raddr];\n"
+	"\t\tfor(k=0; k<LATENCY-1; k=k+1)\n"
+	"\t\tbegin\n"
+	"\t\t\tpvalid[k] <= pvalid[k+1];\n"
+	"\t\t\tpdata[k]  <= pdata[k+1];\n"
+	"\t\tend\n"
+	"\tend\n"
+"\n"
+	"\tassign\to_rvalid = pvalid[0];\n"
+	"\tassign\to_rdata  = pdata[0];\n"
+"\n"
+"endmodule\n");
+
+	fclose(fp);
+}
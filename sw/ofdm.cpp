@@ -0,0 +1,274 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	ofdm.cpp
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Generates ofdmmod.v, an inverse FFT whose bit reversal also
+//		inserts each symbol's cyclic prefix, and ofdmdemod.v, a
+//	forward FFT fed only the samples following each prefix.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+#define _CRT_SECURE_NO_WARNINGS   //  ms vs 2012 doesn't like fopen
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _MSC_VER //  added for ms vs compatibility
+
+#include <io.h>
+#include <direct.h>
+#define _USE_MATH_DEFINES
+#else
+// And for G++/Linux environment
+
+#include <unistd.h>	// Defines the R_OK/W_OK/etc. macros
+#include <sys/stat.h>
+#endif
+
+#include <string.h>
+#include <string>
+#include <math.h>
+#include <ctype.h>
+#include <assert.h>
+
+#include "defaults.h"
+#include "legal.h"
+#include "fftlib.h"
+
+#include "ofdm.h"
+
+void	build_ofdmmod(const char *fname, int lgsize, int cplen,
+		int iw, int ow, const bool async_reset) {
+	FILE	*fp = fopen(fname, "w");
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return;
+	}
+
+	std::string	resetw("i_reset"), always_reset;
+	if (async_reset) {
+		resetw = std::string("i_areset_n");
+		always_reset = std::string("\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	} else
+		always_reset = std::string("\talways @(posedge i_clk)\n\tif (i_reset)\n");
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\tofdmmod.v\n"
+"//\n"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:\tAn OFDM modulator, producing symbols of %d samples, each led\n"
+"//		by a %d sample cyclic prefix.  The subcarriers of each symbol\n"
+"//	are accepted in natural order, one per i_ce while o_ready is set, by\n"
+"//	an inverse FFT built without its bit reversal stage.  cpinsert then\n"
+"//	reorders the FFT\'s output and inserts the prefix from the same\n"
+"//	memory, producing one sample on every i_ce.\n"
+"//\n"
+"//	o_ready is set for the first N of every N+CPLEN i_ce\'s.  o_sync is\n"
+"//	true with the first sample of each prefix.\n"
+"//\n%s"
+"//\n", prjname, 1<<lgsize, cplen, creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+
+	fprintf(fp,
+"module\tofdmmod(i_clk, %s, i_ce, i_sample, o_ready, o_result, o_sync);\n"
+	"\tlocalparam\tIW=%d, OW=%d, LGSIZE=%d, CPLEN=%d;\n"
+	"\tlocalparam\t[LGSIZE:0]\tSYMLEN = (1<<LGSIZE) + CPLEN;\n"
+	"\t//\n"
+	"\tinput\twire\t\t\ti_clk, %s, i_ce;\n"
+	"\tinput\twire\t[(2*IW-1):0]\ti_sample;\n"
+	"\toutput\twire\t\t\to_ready;\n"
+	"\toutput\twire\t[(2*OW-1):0]\to_result;\n"
+	"\toutput\twire\t\t\to_sync;\n"
+"\n"
+	"\t//\n"
+	"\t// Only run the FFT on N of every N+CPLEN i_ce\'s\n"
+	"\t//\n"
+	"\treg\t[LGSIZE:0]\tsymcnt;\n"
+	"\twire\t\t\tw_fftce;\n"
+"\n"
+	"\tinitial\tsymcnt = 0;\n"
+	"%s"
+	"\t\tsymcnt <= 0;\n"
+	"\telse if (i_ce)\n"
+	"\t\tsymcnt <= (symcnt == SYMLEN-1) ? 0 : symcnt + 1'b1;\n"
+"\n"
+	"\tassign\to_ready = (symcnt < (1<<LGSIZE));\n"
+	"\tassign\tw_fftce = (i_ce)&&(o_ready);\n"
+"\n"
+	"\twire\t[(2*OW-1):0]\tw_result;\n"
+	"\twire\t\t\tw_sync;\n"
+"\n"
+	"\tifftmain\tifft(i_clk, %s, w_fftce, i_sample, w_result, w_sync);\n"
+"\n"
+	"\t//\n"
+	"\t// Return to natural order, and insert the prefix\n"
+	"\t//\n"
+	"\tcpinsert #(LGSIZE, OW, CPLEN)\n"
+	"\t\tcp(i_clk, %s, i_ce, w_fftce, w_sync, w_result,\n"
+	"\t\t\to_result, o_sync);\n"
+"\n"
+"endmodule\n",
+		resetw.c_str(), iw, ow, lgsize, cplen, resetw.c_str(),
+		always_reset.c_str(), resetw.c_str(), resetw.c_str());
+
+	fclose(fp);
+}
+
+void	build_ofdmdemod(const char *fname, int lgsize, int cplen,
+		int iw, int ow, const bool async_reset) {
+	FILE	*fp = fopen(fname, "w");
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return;
+	}
+
+	std::string	resetw("i_reset"), always_reset;
+	if (async_reset) {
+		resetw = std::string("i_areset_n");
+		always_reset = std::string("\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	} else
+		always_reset = std::string("\talways @(posedge i_clk)\n\tif (i_reset)\n");
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\tofdmdemod.v\n"
+"//\n"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:\tAn OFDM demodulator, for symbols of %d samples, each led\n"
+"//		by a %d sample cyclic prefix.  Samples arrive one per i_ce,\n"
+"//	with i_sync set on the first sample of a prefix, as found by the\n"
+"//	receiver\'s symbol timing recovery.  The prefix is dropped, and only\n"
+"//	the N samples following it are given to the FFT.\n"
+"//\n"
+"//	i_sync need only be given once, although it may be given with every\n"
+"//	symbol.  Should it arrive anywhere but where the next prefix was\n"
+"//	expected, the FFT is reset to align with it, and any symbols still\n"
+"//	within the FFT are abandoned.\n"
+"//\n"
+"//	The subcarriers of each symbol are produced in natural order, on\n"
+"//	N of every N+CPLEN i_ce\'s, with o_valid set.  o_sync is true with\n"
+"//	subcarrier zero.\n"
+"//\n%s"
+"//\n", prjname, 1<<lgsize, cplen, creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+
+	fprintf(fp,
+"module\tofdmdemod(i_clk, %s, i_ce, i_sync, i_sample,\n"
+		"\t\to_result, o_sync, o_valid);\n"
+	"\tlocalparam\tIW=%d, OW=%d, LGSIZE=%d, CPLEN=%d;\n"
+	"\tlocalparam\t[LGSIZE:0]\tSYMLEN = (1<<LGSIZE) + CPLEN;\n"
+	"\t//\n"
+	"\tinput\twire\t\t\ti_clk, %s, i_ce, i_sync;\n"
+	"\tinput\twire\t[(2*IW-1):0]\ti_sample;\n"
+	"\toutput\twire\t[(2*OW-1):0]\to_result;\n"
+	"\toutput\twire\t\t\to_sync, o_valid;\n"
+"\n"
+	"\t//\n"
+	"\t// Symbol timing\n"
+	"\t//\n"
+	"\treg\t[LGSIZE:0]\tsymcnt;\n"
+	"\treg\t\t\tsym_started, r_realign;\n"
+	"\twire\t[LGSIZE:0]\tw_pos;\n"
+	"\twire\t\t\tw_fftce, w_fftreset;\n"
+"\n"
+	"\tinitial\t{ sym_started, symcnt } = 0;\n"
+	"%s"
+	"\t\t{ sym_started, symcnt } <= 0;\n"
+	"\telse if (i_ce)\n"
+	"\tbegin\n"
+	"\t\tif (i_sync)\n"
+	"\t\t\tsym_started <= 1'b1;\n"
+	"\t\tsymcnt <= (w_pos == SYMLEN-1) ? 0 : w_pos + 1'b1;\n"
+	"\tend\n"
+"\n"
+	"\t// The position of this sample within its symbol\n"
+	"\tassign\tw_pos = (i_sync) ? 0 : symcnt;\n"
+"\n"
+	"\t// Drop the prefix\n"
+	"\tassign\tw_fftce = (i_ce)&&((sym_started)||(i_sync))\n"
+	"\t\t\t\t&&(w_pos >= CPLEN);\n"
+"\n"
+	"\t// Restart the FFT if the symbol timing moves.  The prefix is\n"
+	"\t// at least two samples long, so this completes before the FFT\n"
+	"\t// is given the first sample of the new symbol.\n"
+	"\tinitial\tr_realign = 1'b0;\n"
+	"%s"
+	"\t\tr_realign <= 1'b0;\n"
+	"\telse\n"
+	"\t\tr_realign <= (i_ce)&&(i_sync)&&(sym_started)&&(symcnt != 0);\n"
+"\n",
+		resetw.c_str(), iw, ow, lgsize, cplen, resetw.c_str(),
+		always_reset.c_str(), always_reset.c_str());
+
+	if (async_reset)
+		fprintf(fp,
+	"\tassign\tw_fftreset = (i_areset_n)&&(!r_realign);\n");
+	else
+		fprintf(fp,
+	"\tassign\tw_fftreset = (i_reset)||(r_realign);\n");
+
+	fprintf(fp,
+"\n"
+	"\twire\t\t\tw_sync;\n"
+	"\treg\t\t\tr_step, out_started;\n"
+"\n"
+	"\tfftmain\tfft(i_clk, w_fftreset, w_fftce, i_sample, o_result, w_sync);\n"
+"\n"
+	"\t// The FFT\'s outputs change only when it is stepped, and are\n"
+	"\t// junk until its first o_sync\n"
+	"\tinitial\t{ r_step, out_started } = 2\'b00;\n"
+	"%s"
+	"\t\t{ r_step, out_started } <= 2\'b00;\n"
+	"\telse if (r_realign)\n"
+	"\t\t{ r_step, out_started } <= 2\'b00;\n"
+	"\telse if (i_ce)\n"
+	"\tbegin\n"
+	"\t\tr_step <= w_fftce;\n"
+	"\t\tif ((r_step)&&(w_sync))\n"
+	"\t\t\tout_started <= 1\'b1;\n"
+	"\tend\n"
+"\n"
+	"\tassign\to_valid = (r_step)&&((out_started)||(w_sync));\n"
+	"\tassign\to_sync  = (r_step)&&(w_sync);\n"
+"\n"
+"endmodule\n", always_reset.c_str());
+
+	fclose(fp);
+}
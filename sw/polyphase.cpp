@@ -0,0 +1,573 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	polyphase.cpp
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Generates a polyphase filter bank (PFB) front end for a single
+//		sample per clock FFT.  A plain window, such as windowfn.v,
+//	spans a single FFT length, and so its bins leak into each other.  The
+//	PFB instead spans several FFT lengths with a longer prototype low-pass
+//	filter, folding these products back down to one FFT length, so each
+//	FFT bin becomes a channel with a much flatter passband and a far
+//	steeper roll off.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+#define _CRT_SECURE_NO_WARNINGS   //  ms vs 2012 doesn't like fopen
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _MSC_VER //  added for ms vs compatibility
+
+#include <io.h>
+#include <direct.h>
+#define _USE_MATH_DEFINES
+#else
+// And for G++/Linux environment
+
+#include <unistd.h>	// Defines the R_OK/W_OK/etc. macros
+#include <sys/stat.h>
+#endif
+
+#include <string.h>
+#include <string>
+#include <math.h>
+#include <ctype.h>
+#include <assert.h>
+
+#include "defaults.h"
+#include "legal.h"
+#include "fftlib.h"
+#include "polyphase.h"
+
+std::string	gen_pfb_fname(const char *coredir, int fftsize, int ntaps) {
+	char	*memfile;
+	std::string	result;
+
+	memfile = new char[strlen(coredir)+strlen("/polyphase_x.hex")+32];
+	if (coredir[0] == '\0')
+		sprintf(memfile, "polyphase_%dx%d.hex", fftsize, ntaps);
+	else
+		sprintf(memfile, "%s/polyphase_%dx%d.hex", coredir,
+			fftsize, ntaps);
+	result = std::string(memfile);
+	delete[] memfile;
+	return result;
+}
+
+//
+// The prototype filter is a windowed sinc, h[k], of length ntaps * N, whose
+// cutoff is at the edge of each FFT bin.  Line n of the tap file holds the
+// ntaps coefficients applied to the samples found at position n within
+// each of the ntaps most recent FFT lengths,
+//
+//	{ h[n], h[N+n], ..., h[(ntaps-1)*N+n] }
+//
+// with h[n], the tap for the oldest sample, in the most significant bits.
+// The taps are scaled so that the largest sum of the absolute values of
+// any one line is just under unity.  The sum of all of the products for
+// any one output can then never overflow IW+TW bits.
+//
+void	gen_pfb_taps(const char *fname, WINDOW_T window,
+			int lgsize, int ntaps, int tbits) {
+	FILE	*fp;
+	int	fftsize = (1<<lgsize), nh = ntaps * fftsize;
+	long long	maxv = (1ll<<(tbits-1))-1;
+	double	*h, mxsum = 0.0, scale;
+	char	*line;
+	int	ndigits = (ntaps * tbits + 3)/4;
+
+	h = new double[nh];
+	for(int k=0; k<nh; k++) {
+		double	x = (k + 0.5 - nh/2) / (double)fftsize;
+
+		h[k] = window_value(window, k, nh, true);
+		if (x != 0.0)
+			h[k] *= sin(M_PI * x) / (M_PI * x);
+	}
+
+	for(int n=0; n<fftsize; n++) {
+		double	sum = 0.0;
+
+		for(int p=0; p<ntaps; p++)
+			sum += fabs(h[p*fftsize+n]);
+		if (sum > mxsum)
+			mxsum = sum;
+	}
+	scale = maxv / mxsum;
+
+	fp = fopen(fname, "w");
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open PFB tap file \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		exit(EXIT_FAILURE);
+	}
+
+	// Each line is too wide for a long long, so we build it up one hex
+	// digit at a time, starting with the least significant
+	line = new char[ndigits+1];
+	line[ndigits] = '\0';
+	for(int n=0; n<fftsize; n++) {
+		int	digit = ndigits-1, nbits = 0;
+		unsigned long long	acc = 0;
+
+		for(int p=ntaps-1; p>=0; p--) {
+			long long	tap;
+
+			tap = llround(scale * h[p*fftsize+n]);
+			acc |= (tap & (~(-1ll << tbits))) << nbits;
+			nbits += tbits;
+			while(nbits >= 4) {
+				line[digit--] = "0123456789abcdef"[acc & 0x0f];
+				acc >>= 4;
+				nbits -= 4;
+			}
+		}
+		if (nbits > 0)
+			line[digit--] = "0123456789abcdef"[acc & 0x0f];
+		assert(digit == -1);
+		fprintf(fp, "%s\n", line);
+	}
+
+	fclose(fp);
+	delete[] line;
+	delete[] h;
+}
+
+void	build_polyphase(const char *fname, int lgsize, int ntaps, int ovsamp,
+		int iw, int ow, int tw, const bool async_reset) {
+	FILE	*fp = fopen(fname, "w");
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return;
+	}
+
+	std::string	resetw("i_reset"), always_reset;
+	if (async_reset) {
+		resetw = std::string("i_areset_n");
+		always_reset = std::string("\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	} else
+		always_reset = std::string("\talways @(posedge i_clk)\n\tif (i_reset)\n");
+
+	int	lgtaps;
+	char	lastbank[32];
+	const	char	*slot = (ovsamp > 1) ? "(i_ce)||(i_alt_ce)" : "i_ce";
+
+	assert(ntaps >= 2);
+	assert((ovsamp == 1)||(ovsamp == 2));
+	for(lgtaps=1; (1<<lgtaps) < ntaps; lgtaps++)
+		;
+	sprintf(lastbank, "%d'd%d", lgtaps, ntaps-1);
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\tpolyphase.v\n"
+"//\n"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:\tA %d tap per branch polyphase filter bank front end, producing\n"
+"//		%s frames for a %d point FFT taking one sample per\n"
+"//	clock.  Each output is the sum of %d products: the taps of a windowed\n"
+"//	sinc prototype filter, spanning %d FFT lengths, times the samples\n"
+"//	found at the same position within each of the last %d FFT lengths.\n"
+"//	Since the FFT of this sum is the output of a bank of channel filters,\n"
+"//	this greatly reduces the leakage between FFT bins when compared to\n"
+"//	windowing alone.\n"
+"//\n"
+"//	The incoming data is kept in %d memories, one per FFT length, so all\n"
+"//	%d samples can be read at once.  Since the memory holding the newest\n"
+"//	samples rotates, the data read from these memories is rotated to\n"
+"//	line up with the taps before the multiplies.\n"
+"//\n",
+		prjname, ntaps,
+		(ovsamp > 1) ? "2x oversampled (50% overlapped)"
+				: "critically sampled",
+		1<<lgsize, ntaps, ntaps, ntaps, ntaps, ntaps);
+
+	if (ovsamp > 1)
+		fprintf(fp,
+"//	Like windowfn.v, a new frame begins every N/2 samples, so this\n"
+"//	produces two outputs for every input.  The second output is produced\n"
+"//	on i_alt_ce, which must be true once between any two i_ce's.\n"
+"//	Consecutive frames start N/2 samples apart, so the odd bins of every\n"
+"//	other frame will be negated with respect to a continuous channel.\n"
+"//\n");
+
+	fprintf(fp,
+"// Ports:\n"
+"//	i_ce		True when i_sample is valid\n"
+"//	i_sample	The incoming complex sample, real part in the MSBs\n");
+	if (ovsamp > 1)
+		fprintf(fp,
+"//	i_alt_ce	True when an output should be produced without\n"
+"//			any new input\n");
+	fprintf(fp,
+"//\n"
+"//	o_ce		True when o_sample is valid\n"
+"//	o_sample	The filtered sample, ready for the FFT\n"
+"//	o_frame		True on the first sample of any frame.  Following a\n"
+"//			reset, o_ce will remain false until the first frame\n"
+"//		is complete, and then rise together with o_frame.  o_ce may\n"
+"//		therefore drive the FFT's i_ce directly.\n"
+"//\n%s"
+"//\n", creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+
+	fprintf(fp,
+"module\tpolyphase(i_clk, %s, i_ce, i_sample,%s\n"
+	"\t\to_frame, o_ce, o_sample);\n"
+	"\tparameter\t\tIW=%d, OW=%d, TW=%d, LGNFFT = %d;\n"
+	"\tparameter\t\tINITIAL_COEFFS = \"polyphase_%dx%d.hex\";\n"
+	"\t//\n"
+	"\tlocalparam\tAW=IW+TW;\n"
+	"\t//\n"
+	"\tinput\twire\t\t\ti_clk, %s;\n"
+	"\t//\n"
+	"\tinput\twire\t\t\ti_ce;\n"
+	"\tinput\twire\t[(2*IW-1):0]\ti_sample;\n",
+		resetw.c_str(), (ovsamp > 1) ? " i_alt_ce," : "",
+		iw, ow, tw, lgsize, 1<<lgsize, ntaps, resetw.c_str());
+	if (ovsamp > 1)
+		fprintf(fp, "\tinput\twire\t\t\ti_alt_ce;\n");
+	fprintf(fp,
+	"\t//\n"
+	"\toutput\treg\t\t\to_frame, o_ce;\n"
+	"\toutput\treg\t[(2*OW-1):0]\to_sample;\n"
+"\n"
+	"\t// The taps for position n within the frame, for all %d branches\n"
+	"\treg	[(%d*TW-1):0]	cmem	[0:(1<<LGNFFT)-1];\n"
+	"\t// The last %d FFT lengths of incoming data, one per memory\n",
+		ntaps, ntaps, ntaps);
+	for(int b=0; b<ntaps; b++)
+		fprintf(fp,
+	"\treg	[(2*IW-1):0]	dmem%d	[0:(1<<LGNFFT)-1];\n", b);
+	fprintf(fp,
+"\n"
+	"\treg		[LGNFFT-1:0]	wridx, rdidx;\n"
+	"\treg		[%d:0]		wrbank, rdbank, d_bank;\n",
+		lgtaps-1);
+	if (ovsamp > 1)
+		fprintf(fp,
+	"\treg		[LGNFFT-1:0]	tidx;\n");
+	fprintf(fp,
+	"\treg				start_frame, running;\n"
+	"\treg				a_ce, d_ce, m_ce, p_ce, s_ce;\n"
+	"\treg				a_frame, d_frame, m_frame, p_frame,\n"
+	"\t\t\t\t\ts_frame;\n"
+	"\treg		[(%d*TW-1):0]	d_taps, m_taps;\n"
+	"\treg	signed	[AW-1:0]	sum_r, sum_i;\n",
+		ntaps);
+	for(int b=0; b<ntaps; b++)
+		fprintf(fp,
+	"\treg		[(2*IW-1):0]	bdata%d, qdata%d;\n", b, b);
+	for(int b=0; b<ntaps; b++)
+		fprintf(fp,
+	"\treg	signed	[AW-1:0]	prod_r%d, prod_i%d;\n", b, b);
+	fprintf(fp,
+"\n"
+	"\tinitial $readmemh(INITIAL_COEFFS, cmem);\n"
+"\n"
+	"\t//\n"
+	"\t// Record the incoming data.  Each memory holds one FFT length of\n"
+	"\t// data, with wrbank selecting the memory for the current FFT length.\n"
+	"\t//\n"
+	"\tinitial\twridx  = 0;\n"
+	"\tinitial\twrbank = 0;\n"
+	"%s"
+	"\tbegin\n"
+	"\t\twridx  <= 0;\n"
+	"\t\twrbank <= 0;\n"
+	"\tend else if (i_ce)\n"
+	"\tbegin\n"
+	"\t\twridx <= wridx + 1'b1;\n"
+	"\t\tif (&wridx)\n"
+	"\t\t\twrbank <= (wrbank == %s) ? 0 : (wrbank + 1'b1);\n"
+	"\tend\n\n",
+		always_reset.c_str(), lastbank);
+	for(int b=0; b<ntaps; b++)
+		fprintf(fp,
+	"\talways @(posedge i_clk)\n"
+	"\tif ((i_ce)&&(wrbank == %d'd%d))\n"
+	"\t\tdmem%d[wridx] <= i_sample;\n\n", lgtaps, b, b);
+
+	if (ovsamp > 1) {
+		fprintf(fp,
+	"\t//\n"
+	"\t// A new frame begins every N/2 samples.  Since two outputs are\n"
+	"\t// produced per input, the frame starting at sample s begins on the\n"
+	"\t// i_ce that writes sample s+N/2, and output 2k is read as sample\n"
+	"\t// s+N/2+k is written.  The data each output needs has then always\n"
+	"\t// been written, and no data is overwritten until it is no longer\n"
+	"\t// needed.  No frame is complete, however, until %d FFT lengths\n"
+	"\t// have been received.\n"
+	"\t//\n"
+	"\talways @(*)\n"
+	"\t\tstart_frame = (wridx[LGNFFT-2:0] == 0);\n"
+"\n"
+	"\tinitial\trunning = 1'b0;\n"
+	"%s"
+	"\t\trunning <= 1'b0;\n"
+	"\telse if ((i_ce)&&(start_frame)&&(wrbank == %s)&&(wridx[LGNFFT-1]))\n"
+	"\t\trunning <= 1'b1;\n"
+"\n"
+	"\tinitial\trdidx  = 0;\n"
+	"\tinitial\trdbank = 0;\n"
+	"\tinitial\ttidx   = 0;\n"
+	"%s"
+	"\tbegin\n"
+	"\t\trdidx  <= 0;\n"
+	"\t\trdbank <= 0;\n"
+	"\t\ttidx   <= 0;\n"
+	"\tend else if ((i_ce)&&(start_frame))\n"
+	"\tbegin\n"
+	"\t\t// Back up by N/2 samples, to the start of the frame\n"
+	"\t\trdidx  <= { !wridx[LGNFFT-1], wridx[LGNFFT-2:0] };\n"
+	"\t\tif (wridx[LGNFFT-1])\n"
+	"\t\t\trdbank <= wrbank;\n"
+	"\t\telse\n"
+	"\t\t\trdbank <= (wrbank == 0) ? %s : (wrbank - 1'b1);\n"
+	"\t\ttidx   <= 0;\n"
+	"\tend else if (%s)\n"
+	"\tbegin\n"
+	"\t\trdidx <= rdidx + 1'b1;\n"
+	"\t\tif (&rdidx)\n"
+	"\t\t\trdbank <= (rdbank == %s) ? 0 : (rdbank + 1'b1);\n"
+	"\t\ttidx  <= tidx + 1'b1;\n"
+	"\tend\n\n",
+		ntaps, always_reset.c_str(), lastbank,
+		always_reset.c_str(), lastbank, slot, lastbank);
+
+		fprintf(fp,
+	"\t//\n"
+	"\t// Following any valid read address, ...\n"
+	"\t//	a_ce: The address is valid\n"
+	"\t//	d_ce: The data and taps, read from memory, are valid\n"
+	"\t//	m_ce: The data has been rotated to line up with the taps\n"
+	"\t//	p_ce: The products of data and taps are valid\n"
+	"\t//	s_ce: The sum of these products is valid\n"
+	"\t//\n"
+	"\tinitial	{ s_ce, p_ce, m_ce, d_ce, a_ce } = 5'h0;\n"
+	"\tinitial	{ s_frame, p_frame, m_frame, d_frame, a_frame } = 5'h0;\n"
+	"%s"
+	"\tbegin\n"
+	"\t\t{ s_ce, p_ce, m_ce, d_ce, a_ce } <= 5'h0;\n"
+	"\t\t{ s_frame, p_frame, m_frame, d_frame, a_frame } <= 5'h0;\n"
+	"\tend else begin\n"
+	"\t\ta_ce <= (%s)&&((running)||((i_ce)&&(start_frame)\n"
+	"\t\t\t\t&&(wrbank == %s)&&(wridx[LGNFFT-1])));\n"
+	"\t\ta_frame <= (i_ce)&&(start_frame)&&((running)\n"
+	"\t\t\t\t||((wrbank == %s)&&(wridx[LGNFFT-1])));\n",
+		always_reset.c_str(), slot, lastbank, lastbank);
+	} else {
+		fprintf(fp,
+	"\t//\n"
+	"\t// Frames start every N samples, and each output uses the sample\n"
+	"\t// just written, so the read address simply follows the write\n"
+	"\t// address.  No frame is complete, however, until %d FFT lengths\n"
+	"\t// have been received.\n"
+	"\t//\n"
+	"\talways @(*)\n"
+	"\t\tstart_frame = (wridx == 0);\n"
+"\n"
+	"\tinitial\trunning = 1'b0;\n"
+	"%s"
+	"\t\trunning <= 1'b0;\n"
+	"\telse if ((i_ce)&&(start_frame)&&(wrbank == %s))\n"
+	"\t\trunning <= 1'b1;\n"
+"\n"
+	"\tinitial\trdidx  = 0;\n"
+	"\tinitial\trdbank = 0;\n"
+	"%s"
+	"\tbegin\n"
+	"\t\trdidx  <= 0;\n"
+	"\t\trdbank <= 0;\n"
+	"\tend else if (i_ce)\n"
+	"\tbegin\n"
+	"\t\trdidx  <= wridx;\n"
+	"\t\trdbank <= wrbank;\n"
+	"\tend\n\n",
+		ntaps, always_reset.c_str(), lastbank,
+		always_reset.c_str());
+
+		fprintf(fp,
+	"\t//\n"
+	"\t// Following any valid read address, ...\n"
+	"\t//	a_ce: The address is valid\n"
+	"\t//	d_ce: The data and taps, read from memory, are valid\n"
+	"\t//	m_ce: The data has been rotated to line up with the taps\n"
+	"\t//	p_ce: The products of data and taps are valid\n"
+	"\t//	s_ce: The sum of these products is valid\n"
+	"\t//\n"
+	"\tinitial	{ s_ce, p_ce, m_ce, d_ce, a_ce } = 5'h0;\n"
+	"\tinitial	{ s_frame, p_frame, m_frame, d_frame, a_frame } = 5'h0;\n"
+	"%s"
+	"\tbegin\n"
+	"\t\t{ s_ce, p_ce, m_ce, d_ce, a_ce } <= 5'h0;\n"
+	"\t\t{ s_frame, p_frame, m_frame, d_frame, a_frame } <= 5'h0;\n"
+	"\tend else begin\n"
+	"\t\ta_ce <= (i_ce)&&((running)\n"
+	"\t\t\t\t||((start_frame)&&(wrbank == %s)));\n"
+	"\t\ta_frame <= (i_ce)&&(start_frame)\n"
+	"\t\t\t\t&&((running)||(wrbank == %s));\n",
+		always_reset.c_str(), lastbank, lastbank);
+	}
+
+	fprintf(fp,
+	"\t\t{ s_ce, p_ce, m_ce, d_ce } <= { p_ce, m_ce, d_ce, a_ce };\n"
+	"\t\t{ s_frame, p_frame, m_frame, d_frame }\n"
+	"\t\t\t\t<= { p_frame, m_frame, d_frame, a_frame };\n"
+	"\tend\n\n");
+
+	fprintf(fp,
+	"\t// Read the data from every memory, together with the taps.  As\n"
+	"\t// with windowfn.v, these are block RAM reads, so nothing else is\n"
+	"\t// done here.\n"
+	"\talways @(posedge i_clk)\n"
+	"\tbegin\n");
+	for(int b=0; b<ntaps; b++)
+		fprintf(fp,
+	"\t\tbdata%d <= dmem%d[rdidx];\n", b, b);
+	fprintf(fp,
+	"\t\td_taps  <= cmem[%s];\n"
+	"\t\td_bank  <= rdbank;\n"
+	"\tend\n\n",
+		(ovsamp > 1) ? "tidx" : "rdidx");
+
+	fprintf(fp,
+	"\t// Rotate the data, so that qdata0 holds the newest sample and\n"
+	"\t// qdata%d the oldest, to match the order of the taps\n",
+		ntaps-1);
+	for(int q=0; q<ntaps; q++) {
+		fprintf(fp,
+	"\talways @(posedge i_clk)\n"
+	"\tcase(d_bank)\n");
+		for(int b=0; b<ntaps; b++)
+			fprintf(fp,
+	"\t%d'd%d:\tqdata%d <= bdata%d;\n",
+				lgtaps, b, q, (b + ntaps - q) % ntaps);
+		if ((1<<lgtaps) != ntaps)
+			fprintf(fp,
+	"\tdefault:\tqdata%d <= 0;\n", q);
+		fprintf(fp,
+	"\tendcase\n\n");
+	}
+	fprintf(fp,
+	"\talways @(posedge i_clk)\n"
+	"\t\tm_taps <= d_taps;\n\n");
+
+	fprintf(fp,
+	"\t// Our %d multiplies\n"
+	"\talways @(posedge i_clk)\n"
+	"\tbegin\n", 2*ntaps);
+	for(int q=0; q<ntaps; q++) {
+		fprintf(fp,
+	"\t\tprod_r%d <= $signed(qdata%d[(2*IW-1):IW])\n"
+	"\t\t\t\t* $signed(m_taps[%d*TW +: TW]);\n"
+	"\t\tprod_i%d <= $signed(qdata%d[(IW-1):0])\n"
+	"\t\t\t\t* $signed(m_taps[%d*TW +: TW]);\n",
+			q, q, q, q, q, q);
+	}
+	fprintf(fp,
+	"\tend\n\n");
+
+	fprintf(fp,
+	"\t// Since the taps are scaled so that no one output can exceed unity\n"
+	"\t// gain, this sum will fit within AW bits\n"
+	"\talways @(posedge i_clk)\n"
+	"\tbegin\n"
+	"\t\tsum_r <= prod_r0");
+	for(int q=1; q<ntaps; q++)
+		fprintf(fp, " + prod_r%d", q);
+	fprintf(fp, ";\n"
+	"\t\tsum_i <= prod_i0");
+	for(int q=1; q<ntaps; q++)
+		fprintf(fp, " + prod_i%d", q);
+	fprintf(fp, ";\n"
+	"\tend\n\n");
+
+	fprintf(fp,
+	"\tinitial	o_ce    = 1'b0;\n"
+	"\tinitial	o_frame = 1'b0;\n"
+	"%s"
+	"\tbegin\n"
+	"\t\to_ce    <= 1'b0;\n"
+	"\t\to_frame <= 1'b0;\n"
+	"\tend else begin\n"
+	"\t\to_ce    <= s_ce;\n"
+	"\t\to_frame <= s_frame;\n"
+	"\tend\n\n", always_reset.c_str());
+
+	fprintf(fp,
+	"\tgenerate if (OW == AW)\n"
+	"\tbegin : BIT_ADJUSTMENT_NONE\n"
+"\n"
+	"\t\talways @(posedge i_clk)\n"
+	"\t\tif (s_ce)\n"
+	"\t\t\to_sample <= { sum_r, sum_i };\n"
+"\n"
+	"\tend else if (OW < AW)\n"
+	"\tbegin : BIT_ADJUSTMENT_ROUNDING\n"
+	"\t\twire	[AW-1:0]	rnd_r, rnd_i;\n"
+"\n"
+	"\t\tassign	rnd_r = sum_r + { {(OW){1'b0}}, sum_r[AW-OW],\n"
+	"\t\t\t\t{(AW-OW-1){!sum_r[AW-OW]}} };\n"
+	"\t\tassign	rnd_i = sum_i + { {(OW){1'b0}}, sum_i[AW-OW],\n"
+	"\t\t\t\t{(AW-OW-1){!sum_i[AW-OW]}} };\n"
+"\n"
+	"\t\talways @(posedge i_clk)\n"
+	"\t\tif (s_ce)\n"
+	"\t\t\to_sample <= { rnd_r[(AW-1):(AW-OW)],\n"
+	"\t\t\t\t\trnd_i[(AW-1):(AW-OW)] };\n"
+"\n"
+	"\t\t// Make Verilator happy\n"
+	"\t\t// verilator lint_off UNUSED\n"
+	"\t\twire	[2*(AW-OW)-1:0]	unused_rounding_bits;\n"
+	"\t\tassign	unused_rounding_bits = { rnd_r[AW-OW-1:0],\n"
+	"\t\t\t\t\trnd_i[AW-OW-1:0] };\n"
+	"\t\t// verilator lint_on  UNUSED\n"
+"\n"
+	"\tend else // if (OW > AW)\n"
+	"\tbegin : BIT_ADJUSTMENT_EXTENDING\n"
+"\n"
+	"\t\talways @(posedge i_clk)\n"
+	"\t\tif (s_ce)\n"
+	"\t\t\to_sample <= { sum_r, {(OW-AW){1'b0}},\n"
+	"\t\t\t\t\tsum_i, {(OW-AW){1'b0}} };\n"
+"\n"
+	"\tend endgenerate\n"
+"\n"
+"endmodule\n");
+
+	fclose(fp);
+}
@@ -0,0 +1,54 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	polyphase.h
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Generates the prototype filter taps, and the Verilog, for a
+//		polyphase filter bank front end to a single sample per clock
+//	FFT.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+#ifndef	POLYPHASE_H
+#define	POLYPHASE_H
+
+#include "windowfn.h"
+
+extern	std::string	gen_pfb_fname(const char *coredir, int fftsize,
+			int ntaps);
+extern	void	gen_pfb_taps(const char *fname, WINDOW_T window,
+			int lgsize, int ntaps, int tbits);
+extern	void	build_polyphase(const char *fname,
+			int lgsize, int ntaps, int ovsamp,
+			int iw, int ow, int tw,
+			const bool async_reset = false);
+
+#endif	// POLYPHASE_H
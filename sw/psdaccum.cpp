@@ -0,0 +1,501 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	psdaccum.cpp
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Generates psdaccum.v, a back end for the FFT that computes the
+//		power, |X|^2, in each output bin and integrates it across a
+//	given number of frames, as for a Welch power spectral density estimate.
+//	Since the bins are accumulated in the order the FFT produces them, this
+//	works as well on the FFT's bit reversed output (-s) as on its natural
+//	ordered output.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+#define _CRT_SECURE_NO_WARNINGS   //  ms vs 2012 doesn't like fopen
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _MSC_VER //  added for ms vs compatibility
+
+#include <io.h>
+#include <direct.h>
+#define _USE_MATH_DEFINES
+#else
+// And for G++/Linux environment
+
+#include <unistd.h>	// Defines the R_OK/W_OK/etc. macros
+#include <sys/stat.h>
+#endif
+
+#include <string.h>
+#include <string>
+#include <math.h>
+#include <ctype.h>
+#include <assert.h>
+
+#include "defaults.h"
+#include "legal.h"
+#include "fftlib.h"
+#include "psdaccum.h"
+
+//
+// The width of the accumulated power.  |X|^2 can be as large as 2^(2iw-1),
+// and so needs 2*iw bits, to which we add enough bits to sum navg frames.
+//
+int	psd_width(int iw, int navg) {
+	int	lgnavg;
+
+	for(lgnavg=0; (1<<lgnavg) < navg; lgnavg++)
+		;
+	return 2*iw + lgnavg;
+}
+
+void	build_psdaccum(const char *fname, int lgsize, int iw, int navg, int ow,
+		bool single_clock, bool unordered, const bool async_reset) {
+	FILE	*fp = fopen(fname, "w");
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return;
+	}
+
+	std::string	resetw("i_reset"), always_reset;
+	if (async_reset) {
+		resetw = std::string("i_areset_n");
+		always_reset = std::string("\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	} else
+		always_reset = std::string("\talways @(posedge i_clk)\n\tif (i_reset)\n");
+
+	int	lgnavg, lgpos, nlanes;
+	const char *const	lsfx[2] = { "_l", "_r" };
+	const char *const	linput[2] = { "i_left", "i_right" };
+	// With one frame per integration, there's nothing to integrate: the
+	// power in each bin passes straight through
+	const bool	integrate = (navg > 1);
+	const char	*ocond = (integrate) ? "(b_ce)&&(b_last)" : "b_ce";
+
+	for(lgnavg=0; (1<<lgnavg) < navg; lgnavg++)
+		;
+	nlanes = (single_clock) ? 1 : 2;
+	lgpos = (single_clock) ? lgsize : (lgsize-1);
+	assert(lgpos >= 1);
+	assert(navg >= 1);
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\tpsdaccum.v\n"
+"//\n"
+"// Project:\t%s\n"
+"//\n", prjname);
+	if (integrate)
+		fprintf(fp,
+"// Purpose:\tIntegrates the power, |X|^2, in each bin of a %d point FFT\n"
+"//		across %d frames.  Connect the FFT's outputs, together with\n"
+"//	its o_sync and its i_ce, to this module.  Every %d frames, as the last\n"
+"//	of these frames passes through, the integrated power of each bin is\n"
+"//	produced together with that bin's number.\n"
+"//\n"
+"//	The running sums are kept in a memory indexed by the bin's position\n"
+"//	within the frame, so no frame buffer is required, and the FFT's\n"
+"//	outputs may be used in the order they are produced.  %s\n"
+"//\n"
+"//	The first frame begins with the first o_sync from the FFT.  Each\n"
+"//	integration is then %d frames long, starting with that frame.\n"
+"//\n",
+			1<<lgsize, navg, navg,
+			(unordered) ? "Here, those\n"
+"//	are in bit reversed order, and the bin numbers produced account for\n"
+"//	this."
+				: "Here, those\n"
+"//	are in their natural order.",
+			navg);
+	else
+		fprintf(fp,
+"// Purpose:\tProduces the power, |X|^2, in each bin of a %d point FFT.\n"
+"//		Connect the FFT's outputs, together with its o_sync and its\n"
+"//	i_ce, to this module.  Since only one frame is integrated, no memory\n"
+"//	is needed: the power of each bin is produced, together with that\n"
+"//	bin's number, as soon as it is found.  The FFT's outputs may be used\n"
+"//	in the order they are produced.  %s\n"
+"//\n"
+"//	The first frame begins with the first o_sync from the FFT.\n"
+"//\n",
+			1<<lgsize,
+			(unordered) ? "Here, those are in bit\n"
+"//	reversed order, and the bin numbers produced account for this."
+				: "Here, those are in their\n"
+"//	natural order.");
+	fprintf(fp,
+"// Ports:\n"
+"//	i_ce		The FFT's clock enable.  A sample is accepted on every\n"
+"//			i_ce, once the first i_sync has been seen.\n");
+	if (single_clock)
+		fprintf(fp,
+"//	i_sample	The FFT's o_result, real part in the MSBs\n");
+	else
+		fprintf(fp,
+"//	i_left, i_right	The FFT's o_left and o_right\n");
+	fprintf(fp,
+"//	i_sync		The FFT's o_sync, true on the first sample of a frame\n"
+"//\n"
+"//	o_ce		True when an integrated power is valid\n"
+"//	o_sync		True with the first power of each integration\n");
+	if (single_clock)
+		fprintf(fp,
+"//	o_bin		The number of the bin whose power is in o_power\n"
+"//	o_power		The (unsigned) power integrated in bin o_bin.  If OW\n"
+"//			is less than AW, the full width of the sum, this is\n"
+"//		its top OW bits.\n");
+	else
+		fprintf(fp,
+"//	o_lbin, o_rbin	The numbers of the bins whose power is in o_lpower\n"
+"//			and o_rpower\n"
+"//	o_lpower, o_rpower The (unsigned) power integrated in the two\n"
+"//			bins.  If OW is less than AW, the full width of\n"
+"//		the sum, these are its top OW bits.\n");
+	fprintf(fp,
+"//\n%s"
+"//\n", creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+
+	if (single_clock)
+		fprintf(fp,
+"module\tpsdaccum(i_clk, %s, i_ce, i_sample, i_sync,\n"
+	"\t\to_ce, o_sync, o_bin, o_power);\n",
+			resetw.c_str());
+	else
+		fprintf(fp,
+"module\tpsdaccum(i_clk, %s, i_ce, i_left, i_right, i_sync,\n"
+	"\t\to_ce, o_sync, o_lbin, o_lpower, o_rbin, o_rpower);\n",
+			resetw.c_str());
+	fprintf(fp,
+	"\tlocalparam\tIW=%d, LGSIZE=%d, NAVG=%d, LGNAVG=%d;\n"
+	"\tlocalparam\tAW=2*IW+LGNAVG;\n"
+	"\tparameter\tOW=%d;\n"
+	"\t//\n"
+	"\tinput\twire\t\t\ti_clk, %s;\n"
+	"\t//\n"
+	"\tinput\twire\t\t\ti_ce;\n",
+		iw, lgsize, navg, lgnavg, ow, resetw.c_str());
+	if (single_clock)
+		fprintf(fp,
+	"\tinput\twire\t[(2*IW-1):0]\ti_sample;\n");
+	else
+		fprintf(fp,
+	"\tinput\twire\t[(2*IW-1):0]\ti_left, i_right;\n");
+	fprintf(fp,
+	"\tinput\twire\t\t\ti_sync;\n"
+	"\t//\n"
+	"\toutput\treg\t\t\to_ce, o_sync;\n");
+	if (single_clock)
+		fprintf(fp,
+	"\toutput\treg\t[(LGSIZE-1):0]\to_bin;\n"
+	"\toutput\treg\t[(OW-1):0]\to_power;\n");
+	else
+		fprintf(fp,
+	"\toutput\treg\t[(LGSIZE-1):0]\to_lbin, o_rbin;\n"
+	"\toutput\treg\t[(OW-1):0]\to_lpower, o_rpower;\n");
+
+	fprintf(fp,
+"\n"
+	"\treg				running;\n"
+	"\treg		[%d:0]		pos, a_pos, b_pos;\n",
+		lgpos-1);
+	if (integrate)
+		fprintf(fp,
+	"\treg		[%d:0]		fcount;\n"
+	"\treg		[%d:0]		nxt_fcount;\n"
+	"\treg				a_ce, a_first, a_last,\n"
+	"\t\t\t\t\tb_ce, b_first, b_last;\n",
+			lgnavg-1, lgnavg-1);
+	else
+		fprintf(fp,
+	"\treg				a_ce, b_ce;\n");
+	for(int l=0; l<nlanes; l++) {
+		const char *sfx = (single_clock) ? "" : lsfx[l];
+		fprintf(fp,
+	"\treg	signed	[(2*IW-1):0]	sq_r%s, sq_i%s;\n"
+	"\treg		[(2*IW-1):0]	power%s;\n",
+			sfx, sfx, sfx);
+		if (integrate)
+			fprintf(fp,
+	"\treg		[(AW-1):0]	rdata%s;\n", sfx);
+		fprintf(fp,
+	"\twire		[(AW-1):0]	acc%s;\n", sfx);
+		if (integrate)
+			fprintf(fp,
+	"\treg		[(AW-1):0]	pmem%s	[0:((1<<%d)-1)];\n",
+				sfx, lgpos);
+	}
+
+	fprintf(fp,
+"\n"
+	"\t//\n"
+	"\t// Nothing is valid until the first frame begins\n"
+	"\t//\n"
+	"\tinitial\trunning = 1'b0;\n"
+	"%s"
+	"\t\trunning <= 1'b0;\n"
+	"\telse if ((i_ce)&&(i_sync))\n"
+	"\t\trunning <= 1'b1;\n"
+"\n", always_reset.c_str());
+
+	if (integrate)
+		fprintf(fp,
+	"\t//\n"
+	"\t// Count frames within each integration.  The first frame of an\n"
+	"\t// integration overwrites the sums left from the last, and the last\n"
+	"\t// frame produces our outputs.\n"
+	"\t//\n"
+	"\talways @(*)\n"
+	"\tif (!i_sync)\n"
+	"\t\tnxt_fcount = fcount;\n"
+	"\telse if ((!running)||(fcount == %d'd%d))\n"
+	"\t\tnxt_fcount = 0;\n"
+	"\telse\n"
+	"\t\tnxt_fcount = fcount + 1'b1;\n"
+"\n"
+	"\tinitial\tfcount = 0;\n"
+	"%s"
+	"\t\tfcount <= 0;\n"
+	"\telse if (i_ce)\n"
+	"\t\tfcount <= nxt_fcount;\n"
+"\n", lgnavg, navg-1, always_reset.c_str());
+
+	fprintf(fp,
+	"\t// pos is the position of the next sample within the frame\n"
+	"\tinitial\tpos = 0;\n"
+	"%s"
+	"\t\tpos <= 0;\n"
+	"\telse if (i_ce)\n"
+	"\t\tpos <= (i_sync) ? 1 : (pos + 1'b1);\n"
+"\n", always_reset.c_str());
+
+	fprintf(fp,
+	"\t//\n"
+	"\t// Following any valid sample, ...\n"
+	"\t//	a_ce: Each component has been squared\n"
+	"\t//	b_ce: The power is valid%s\n"
+	"\t//\n"
+	"\tinitial	{ b_ce, a_ce } = 2'b00;\n"
+	"%s"
+	"\t\t{ b_ce, a_ce } <= 2'b00;\n"
+	"\telse\n"
+	"\t\t{ b_ce, a_ce } <= { a_ce, (i_ce)&&((running)||(i_sync)) };\n"
+"\n",
+		(integrate) ? ", as is the prior sum from memory" : "",
+		always_reset.c_str());
+	if (integrate)
+		fprintf(fp,
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+	"\t\ta_pos   <= (i_sync) ? 0 : pos;\n"
+	"\t\ta_first <= (nxt_fcount == 0);\n"
+	"\t\ta_last  <= (nxt_fcount == %d'd%d);\n"
+	"\tend\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tbegin\n"
+	"\t\tb_pos   <= a_pos;\n"
+	"\t\tb_first <= a_first;\n"
+	"\t\tb_last  <= a_last;\n"
+	"\tend\n"
+"\n", lgnavg, navg-1);
+	else
+		fprintf(fp,
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\t\ta_pos <= (i_sync) ? 0 : pos;\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\t\tb_pos <= a_pos;\n"
+"\n");
+
+	for(int l=0; l<nlanes; l++) {
+		const char *sfx = (single_clock) ? "" : lsfx[l],
+			*in = (single_clock) ? "i_sample" : linput[l];
+
+		std::string	extpower = std::string("power") + sfx;
+		if (lgnavg > 0)
+			extpower = "{ {(LGNAVG){1'b0}}, " + extpower + " }";
+
+		if (!single_clock)
+			fprintf(fp,
+	"\t//\n"
+	"\t// The %s lane\n"
+	"\t//\n", (l == 0) ? "left" : "right");
+		fprintf(fp,
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+	"\t\tsq_r%s <= $signed(%s[(2*IW-1):IW])\n"
+	"\t\t\t\t* $signed(%s[(2*IW-1):IW]);\n"
+	"\t\tsq_i%s <= $signed(%s[(IW-1):0])\n"
+	"\t\t\t\t* $signed(%s[(IW-1):0]);\n"
+	"\tend\n"
+"\n"
+	"\t// Both squares are positive, and no more than 2^(2*IW-2), so\n"
+	"\t// their sum will fit in 2*IW bits\n",
+			sfx, in, in, sfx, in, in);
+		if (!integrate) {
+			fprintf(fp,
+	"\talways @(posedge i_clk)\n"
+	"\t\tpower%s <= sq_r%s + sq_i%s;\n"
+"\n"
+	"\tassign\tacc%s = power%s;\n"
+"\n",
+				sfx, sfx, sfx, sfx, sfx);
+			continue;
+		}
+
+		fprintf(fp,
+	"\talways @(posedge i_clk)\n"
+	"\tbegin\n"
+	"\t\tpower%s <= sq_r%s + sq_i%s;\n"
+	"\t\trdata%s <= pmem%s[a_pos];\n"
+	"\tend\n"
+"\n"
+	"\tassign\tacc%s = ((b_first) ? 0 : rdata%s)\n"
+	"\t\t\t+ %s;\n"
+"\n"
+	"\t// A bin is only read again a full frame after it is written\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (b_ce)\n"
+	"\t\tpmem%s[b_pos] <= acc%s;\n"
+"\n",
+			sfx, sfx, sfx, sfx, sfx,
+			sfx, sfx, extpower.c_str(), sfx, sfx);
+	}
+
+	fprintf(fp,
+	"\t//\n"
+	"\t// Produce our outputs during the last frame of each integration\n"
+	"\t//\n"
+	"\tinitial\to_ce   = 1'b0;\n"
+	"\tinitial\to_sync = 1'b0;\n"
+	"%s"
+	"\tbegin\n"
+	"\t\to_ce   <= 1'b0;\n"
+	"\t\to_sync <= 1'b0;\n"
+	"\tend else begin\n"
+	"\t\to_ce   <= %s;\n"
+	"\t\to_sync <= %s&&(b_pos == 0);\n"
+	"\tend\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (%s)\n",
+		always_reset.c_str(), ocond,
+		(integrate) ? ocond : "(b_ce)", ocond);
+	if (single_clock)
+		fprintf(fp, "\t\to_bin <= %s;\n",
+			gen_bin_expr("b_pos", lgpos, -1, unordered).c_str());
+	else
+		fprintf(fp,
+	"\tbegin\n"
+	"\t\to_lbin <= %s;\n"
+	"\t\to_rbin <= %s;\n"
+	"\tend\n",
+			gen_bin_expr("b_pos", lgpos, 0, unordered).c_str(),
+			gen_bin_expr("b_pos", lgpos, 1, unordered).c_str());
+
+	fprintf(fp,
+"\n"
+	"\tgenerate if (OW == AW)\n"
+	"\tbegin : BIT_ADJUSTMENT_NONE\n"
+"\n"
+	"\t\talways @(posedge i_clk)\n"
+	"\t\tif (%s)\n", ocond);
+	if (single_clock)
+		fprintf(fp,
+	"\t\t\to_power <= acc;\n");
+	else
+		fprintf(fp,
+	"\t\tbegin\n"
+	"\t\t\to_lpower <= acc_l;\n"
+	"\t\t\to_rpower <= acc_r;\n"
+	"\t\tend\n");
+	fprintf(fp,
+"\n"
+	"\tend else if (OW < AW)\n"
+	"\tbegin : BIT_ADJUSTMENT_DROP\n"
+"\n"
+	"\t\talways @(posedge i_clk)\n"
+	"\t\tif (%s)\n", ocond);
+	if (single_clock)
+		fprintf(fp,
+	"\t\t\to_power <= acc[(AW-1):(AW-OW)];\n"
+"\n"
+	"\t\t// Make Verilator happy\n"
+	"\t\t// verilator lint_off UNUSED\n"
+	"\t\twire	[(AW-OW-1):0]	unused_bits;\n"
+	"\t\tassign	unused_bits = acc[(AW-OW-1):0];\n"
+	"\t\t// verilator lint_on  UNUSED\n");
+	else
+		fprintf(fp,
+	"\t\tbegin\n"
+	"\t\t\to_lpower <= acc_l[(AW-1):(AW-OW)];\n"
+	"\t\t\to_rpower <= acc_r[(AW-1):(AW-OW)];\n"
+	"\t\tend\n"
+"\n"
+	"\t\t// Make Verilator happy\n"
+	"\t\t// verilator lint_off UNUSED\n"
+	"\t\twire	[2*(AW-OW)-1:0]	unused_bits;\n"
+	"\t\tassign	unused_bits = { acc_l[(AW-OW-1):0],\n"
+	"\t\t\t\t\tacc_r[(AW-OW-1):0] };\n"
+	"\t\t// verilator lint_on  UNUSED\n");
+	fprintf(fp,
+"\n"
+	"\tend else // if (OW > AW)\n"
+	"\tbegin : BIT_ADJUSTMENT_EXTENDING\n"
+"\n"
+	"\t\talways @(posedge i_clk)\n"
+	"\t\tif (%s)\n", ocond);
+	if (single_clock)
+		fprintf(fp,
+	"\t\t\to_power <= { {(OW-AW){1'b0}}, acc };\n");
+	else
+		fprintf(fp,
+	"\t\tbegin\n"
+	"\t\t\to_lpower <= { {(OW-AW){1'b0}}, acc_l };\n"
+	"\t\t\to_rpower <= { {(OW-AW){1'b0}}, acc_r };\n"
+	"\t\tend\n");
+	fprintf(fp,
+"\n"
+	"\tend endgenerate\n"
+"\n"
+"endmodule\n");
+
+	fclose(fp);
+}
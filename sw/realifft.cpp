@@ -0,0 +1,364 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	realifft.cpp
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Generates an inverse FFT producing N real outputs from the
+//		N/2+1 unique bins of a Hermitian symmetric spectrum.  The
+//	spectrum is first merged into N/2 complex values, whose N/2 point
+//	complex inverse FFT then holds the even outputs in its real parts and
+//	the odd outputs in its imaginary parts.  This requires half of the
+//	memory, and produces twice the real samples per clock, of an N point
+//	complex inverse FFT.
+//
+//	Writing the real outputs as x[2m] + j x[2m+1], and using
+//	X[k+N/2] = conj(X[N/2-k]),
+//
+//	x[2m]+jx[2m+1] = SUM_k Z[k] e^{j 2pi k m/(N/2)}, k = 0 ... N/2-1,
+//
+//	Z[k] = (X[k]+conj(X[N/2-k])) + j(X[k]-conj(X[N/2-k])) e^{j 2pi k/N}
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+#define _CRT_SECURE_NO_WARNINGS   //  ms vs 2012 doesn't like fopen
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _MSC_VER //  added for ms vs compatibility
+
+#include <io.h>
+#include <direct.h>
+#define _USE_MATH_DEFINES
+#else
+// And for G++/Linux environment
+
+#include <unistd.h>	// Defines the R_OK/W_OK/etc. macros
+#include <sys/stat.h>
+#endif
+
+#include <string.h>
+#include <string>
+#include <math.h>
+#include <ctype.h>
+#include <assert.h>
+
+#include "defaults.h"
+#include "legal.h"
+#include "fftlib.h"
+
+#include "realifft.h"
+
+void	build_hermitian(const char *fname, int lgsize, int iw, int cw,
+		ROUND_T rounding, const bool async_reset) {
+	FILE	*fp = fopen(fname, "w");
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return;
+	}
+
+	std::string	resetw("i_reset"), always_reset;
+	if (async_reset) {
+		resetw = std::string("i_areset_n");
+		always_reset = std::string("\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	} else
+		always_reset = std::string("\talways @(posedge i_clk)\n\tif (i_reset)\n");
+
+	const	char	*rnd_string = rnd_module(rounding);
+
+	assert(lgsize >= 3);
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\thermitian.v\n"
+"//\n"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:\tMerges the N/2+1 unique bins of a Hermitian symmetric %d point\n"
+"//		spectrum into the N/2 complex values whose N/2 point inverse\n"
+"//	FFT holds the %d real outputs.  Writing these outputs as x[2m]+jx[2m+1],\n"
+"//\n"
+"//	Z[k] = (X[k]+conj(X[N/2-k])) + j(X[k]-conj(X[N/2-k])) e^{j 2pi k/N}\n"
+"//\n"
+"//	for k = 0 ... N/2-1.  Since X[0] and X[N/2] are both real, bin N/2\n"
+"//	is expected in the imaginary part of bin 0, so that each frame is\n"
+"//	N/2 samples long.  Bins are expected in their natural order, one per\n"
+"//	i_ce, with the first sample following a reset starting a frame.\n"
+"//\n"
+"//	Each frame is kept in memory, so that X[k] and X[N/2-k] may be read\n"
+"//	together, while the next frame is written.  The outputs are Z[k]/2,\n"
+"//	so that they fit within one more bit than the inputs.\n"
+"//\n"
+"//	Like the FFT stages, everything here moves on i_ce.  o_sync is true\n"
+"//	with Z[0], and never before the first frame has been received.\n"
+"//\n%s"
+"//\n", prjname, 1<<lgsize, 1<<lgsize, creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+
+	fprintf(fp,
+"module\thermitian(i_clk, %s, i_ce, i_sample, o_sample, o_sync);\n"
+	"\tparameter\tIW=%d, CW=%d, LGSIZE=%d;\n"
+	"\tparameter\tCOEFFILE=\"icmem_%d.hex\";\n"
+	"\tlocalparam\tOW=IW+1, VW=IW+CW+3;\n"
+	"\t//\n"
+	"\tinput\twire\t\t\ti_clk, %s, i_ce;\n"
+	"\tinput\twire\t[(2*IW-1):0]\ti_sample;\n"
+	"\toutput\twire\t[(2*OW-1):0]\to_sample;\n"
+	"\toutput\treg\t\t\to_sync;\n"
+"\n"
+	"\t// Two frames, of N/2 bins each, and the twiddles e^{j 2pi k/N}\n"
+	"\treg	[(2*IW-1):0]	fmem	[0:((1<<LGSIZE)-1)];\n"
+	"\treg	[(2*CW-1):0]	cmem	[0:((1<<(LGSIZE-1))-1)];\n"
+"\n"
+	"\treg	[(LGSIZE-1):0]	wraddr;\n"
+	"\twire	[(LGSIZE-2):0]	kidx, nkidx;\n"
+	"\treg			running;\n"
+	"\treg	[(2*IW-1):0]	ra, rb;\n"
+	"\treg	[(2*CW-1):0]	rtw, s_tw;\n"
+	"\treg			r_zero, r_sync, s_sync, p_sync, x_sync, v_sync;\n"
+	"\twire	signed	[(IW-1):0]	a_r, a_i, b_r, b_i;\n"
+	"\treg	signed	[IW:0]		s_r, s_i, d_r, d_i, p_sr, p_si,\n"
+	"\t\t\t\t\tx_sr, x_si;\n"
+	"\twire	signed	[(CW-1):0]	tw_r, tw_i;\n"
+	"\treg	signed	[(IW+CW):0]	p_rr, p_ii, p_ri, p_ir;\n"
+	"\treg	signed	[(IW+CW+1):0]	x_r, x_i;\n"
+	"\treg	signed	[(VW-1):0]	v_r, v_i;\n"
+	"\twire	signed	[(OW-1):0]	z_r, z_i;\n"
+"\n"
+	"\tinitial\t$readmemh(COEFFILE, cmem);\n"
+"\n"
+	"\t//\n"
+	"\t// Write each incoming frame into memory\n"
+	"\t//\n"
+	"\tinitial\twraddr = 0;\n"
+	"%s"
+	"\t\twraddr <= 0;\n"
+	"\telse if (i_ce)\n"
+	"\t\twraddr <= wraddr + 1'b1;\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\t\tfmem[wraddr] <= i_sample;\n"
+"\n"
+	"\tinitial\trunning = 1'b0;\n"
+	"%s"
+	"\t\trunning <= 1'b0;\n"
+	"\telse if ((i_ce)&&(&wraddr[(LGSIZE-2):0]))\n"
+	"\t\trunning <= 1'b1;\n"
+"\n"
+	"\t//\n"
+	"\t// While each frame is written, read X[k] and X[N/2-k] from the\n"
+	"\t// last one\n"
+	"\t//\n"
+	"\tassign\tkidx  = wraddr[(LGSIZE-2):0];\n"
+	"\tassign\tnkidx = -kidx;\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+	"\t\tra  <= fmem[{ !wraddr[LGSIZE-1], kidx  }];\n"
+	"\t\trb  <= fmem[{ !wraddr[LGSIZE-1], nkidx }];\n"
+	"\t\trtw <= cmem[kidx];\n"
+	"\t\tr_zero <= (kidx == 0);\n"
+	"\tend\n"
+"\n"
+	"\tinitial\tr_sync = 1'b0;\n"
+	"%s"
+	"\t\tr_sync <= 1'b0;\n"
+	"\telse if (i_ce)\n"
+	"\t\tr_sync <= (running)&&(kidx == 0);\n"
+"\n"
+	"\tassign\ta_r = ra[(2*IW-1):IW];\n"
+	"\tassign\ta_i = ra[(IW-1):0];\n"
+	"\tassign\tb_r = rb[(2*IW-1):IW];\n"
+	"\tassign\tb_i = rb[(IW-1):0];\n"
+"\n"
+	"\t//\n"
+	"\t// Sum and difference of X[k] and conj(X[N/2-k])\n"
+	"\t//\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+	"\t\tif (r_zero)\n"
+	"\t\tbegin\n"
+	"\t\t\t// X[0] and X[N/2] are both real, and share a word\n"
+	"\t\t\ts_r <= a_r + a_i;\n"
+	"\t\t\ts_i <= 0;\n"
+	"\t\t\td_r <= a_r - a_i;\n"
+	"\t\t\td_i <= 0;\n"
+	"\t\tend else begin\n"
+	"\t\t\ts_r <= a_r + b_r;\n"
+	"\t\t\ts_i <= a_i - b_i;\n"
+	"\t\t\td_r <= a_r - b_r;\n"
+	"\t\t\td_i <= a_i + b_i;\n"
+	"\t\tend\n"
+	"\t\ts_tw <= rtw;\n"
+	"\tend\n"
+"\n"
+	"\tassign\ttw_r = s_tw[(2*CW-1):CW];\n"
+	"\tassign\ttw_i = s_tw[(CW-1):0];\n"
+"\n"
+	"\t//\n"
+	"\t// Rotate the difference by the twiddle factor\n"
+	"\t//\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+	"\t\tp_rr <= d_r * tw_r;\n"
+	"\t\tp_ii <= d_i * tw_i;\n"
+	"\t\tp_ri <= d_r * tw_i;\n"
+	"\t\tp_ir <= d_i * tw_r;\n"
+	"\t\t{ p_sr, p_si } <= { s_r, s_i };\n"
+	"\tend\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+	"\t\tx_r <= p_rr - p_ii;\n"
+	"\t\tx_i <= p_ri + p_ir;\n"
+	"\t\t{ x_sr, x_si } <= { p_sr, p_si };\n"
+	"\tend\n"
+"\n"
+	"\t//\n"
+	"\t// Z = sum + j * (rotated difference), where the twiddles carry a\n"
+	"\t// gain of 2^(CW-2)\n"
+	"\t//\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+	"\t\tv_r <= $signed({ x_sr, {(CW-2){1'b0}} }) - x_i;\n"
+	"\t\tv_i <= $signed({ x_si, {(CW-2){1'b0}} }) + x_r;\n"
+	"\tend\n"
+"\n"
+	"\t// Dropping CW-1 bits leaves Z/2.  The top three bits are only\n"
+	"\t// there to keep the arithmetic above from overflowing.\n"
+	"\t%s #(VW,OW,3) rnd_r(i_clk, i_ce, v_r, z_r);\n"
+	"\t%s #(VW,OW,3) rnd_i(i_clk, i_ce, v_i, z_i);\n"
+"\n"
+	"\tinitial\t{ s_sync, p_sync, x_sync, v_sync, o_sync } = 5'h0;\n"
+	"%s"
+	"\t\t{ s_sync, p_sync, x_sync, v_sync, o_sync } <= 5'h0;\n"
+	"\telse if (i_ce)\n"
+	"\t\t{ s_sync, p_sync, x_sync, v_sync, o_sync }\n"
+	"\t\t\t<= { r_sync, s_sync, p_sync, x_sync, v_sync };\n"
+"\n"
+	"\tassign\to_sample = { z_r, z_i };\n"
+"\n"
+"endmodule\n",
+		resetw.c_str(), iw, cw, lgsize, 1<<lgsize, resetw.c_str(),
+		always_reset.c_str(), always_reset.c_str(),
+		always_reset.c_str(), rnd_string, rnd_string,
+		always_reset.c_str());
+
+	fclose(fp);
+}
+
+void	build_realifft(const char *fname, int lgsize, int iw, int ow,
+		const bool async_reset) {
+	FILE	*fp = fopen(fname, "w");
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return;
+	}
+
+	std::string	resetw("i_reset"), always_reset;
+	if (async_reset) {
+		resetw = std::string("i_areset_n");
+		always_reset = std::string("\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	} else
+		always_reset = std::string("\talways @(posedge i_clk)\n\tif (i_reset)\n");
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\trealifft.v\n"
+"//\n"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:\tA %d point inverse FFT, producing real outputs from a\n"
+"//		Hermitian symmetric spectrum.  The spectrum is merged into\n"
+"//	%d complex values by hermitian.v, whose %d point complex inverse FFT\n"
+"//	then produces two real outputs per clock.\n"
+"//\n"
+"// Ports:\n"
+"//	i_ce		True when i_sample is valid.  The first i_ce following\n"
+"//			a reset begins the first frame.\n"
+"//	i_sample	Bins 0 through N/2-1 of the spectrum, in natural order,\n"
+"//			real part in the MSBs.  Since bins 0 and N/2 are both\n"
+"//		real, the real part of bin N/2 is placed in the imaginary part\n"
+"//		of bin 0.\n"
+"//	o_even, o_odd	Two consecutive real outputs, x[2m] and x[2m+1].\n"
+"//			These are half of the inverse DFT of the spectrum.\n"
+"//	o_sync		True with the first pair of outputs of each frame\n"
+"//\n%s"
+"//\n", prjname, 1<<lgsize, 1<<(lgsize-1), 1<<(lgsize-1), creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+
+	fprintf(fp,
+"module\trealifft(i_clk, %s, i_ce, i_sample, o_even, o_odd, o_sync);\n"
+	"\tlocalparam\tIW=%d, OW=%d;\n"
+	"\t//\n"
+	"\tinput\twire\t\t\ti_clk, %s, i_ce;\n"
+	"\tinput\twire\t[(2*IW-1):0]\ti_sample;\n"
+	"\toutput\twire\t[(OW-1):0]\to_even, o_odd;\n"
+	"\toutput\twire\t\t\to_sync;\n"
+"\n"
+	"\twire\t[(2*IW+1):0]\tw_merged;\n"
+	"\twire\t\t\tw_msync, w_ce;\n"
+	"\treg\t\t\tstarted;\n"
+	"\twire\t[(2*OW-1):0]\tw_result;\n"
+"\n"
+	"\thermitian\tmerge(i_clk, %s, i_ce, i_sample, w_merged, w_msync);\n"
+"\n"
+	"\t// Hold the inverse FFT until the first merged frame begins\n"
+	"\tinitial\tstarted = 1'b0;\n"
+	"%s"
+	"\t\tstarted <= 1'b0;\n"
+	"\telse if ((i_ce)&&(w_msync))\n"
+	"\t\tstarted <= 1'b1;\n"
+"\n"
+	"\tassign\tw_ce = (i_ce)&&((started)||(w_msync));\n"
+"\n"
+	"\tifftmain\tifft(i_clk, %s, w_ce, w_merged, w_result, o_sync);\n"
+"\n"
+	"\tassign\to_even = w_result[(2*OW-1):OW];\n"
+	"\tassign\to_odd  = w_result[(OW-1):0];\n"
+"\n"
+"endmodule\n",
+		resetw.c_str(), iw, ow, resetw.c_str(), resetw.c_str(),
+		always_reset.c_str(), resetw.c_str());
+
+	fclose(fp);
+}
@@ -54,7 +54,6 @@
 
 
 void	build_truncator(const char *fname) {
-	printf("TRUNCATING!\n");
 	FILE	*fp = fopen(fname, "w");
 	if (NULL == fp) {
 		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
@@ -405,3 +404,82 @@ SLASHLINE
 "endmodule\n");
 }
 
+
+void	build_rndselect(const char *fname, unsigned rndmask) {
+	FILE	*fp = fopen(fname, "w");
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return;
+	}
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename: 	rndselect.v\n"
+"//\n"
+"// Project:	%s\n"
+"//\n"
+"// Purpose:	When different stages of the FFT are built with different\n"
+"//		rounding methods, this module sits in place of the rounder\n"
+"//	within each butterfly, quarter stage, and last stage.  The RNDMODE\n"
+"//	parameter then selects, at elaboration time, which of the rounders\n"
+"//	that were generated for this core is actually used.  There is no\n"
+"//	logic cost to this selection: only the chosen rounder is built.\n"
+"//\n"
+"//	RNDMODE\t0: truncate\n"
+"//\t\t1: roundfromzero\n"
+"//\t\t2: roundhalfup\n"
+"//\t\t3: convround\n"
+"//\n"
+"//	Only those rounders used somewhere within the core are available.\n"
+"//	Any other RNDMODE falls back to the last rounder listed below.\n"
+"//\n"
+"//\n%s"
+"//\n",
+		prjname, creator);
+
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+	fprintf(fp,
+"module	rndselect(i_clk, i_ce, i_val, o_val);\n"
+"\tparameter\tIWID=16, OWID=8, SHIFT=0;\n"
+"\tparameter\t[1:0]\tRNDMODE=%d;\n"
+"\tinput\twire\t\t\t\ti_clk, i_ce;\n"
+"\tinput\twire\tsigned\t[(IWID-1):0]\ti_val;\n"
+"\toutput\twire\tsigned\t[(OWID-1):0]\to_val;\n"
+"\n"
+"\tgenerate ", (int)RND_CONVERGENT);
+
+	static	const	char	*rnd_names[4] = {
+		"truncate", "roundfromzero", "roundhalfup", "convround" };
+	static	const	char	*rnd_labels[4] = {
+		"TRUNCATE", "ROUNDFROMZERO", "ROUNDHALFUP", "CONVROUND" };
+	int	last = -1;
+
+	for(int k=0; k<4; k++)
+		if (rndmask & (1u<<k))
+			last = k;
+	assert(last >= 0);
+
+	for(int k=0; k<4; k++) {
+		if (0 == (rndmask & (1u<<k)))
+			continue;
+		if (k == last)
+			fprintf(fp, "begin : %s\n", rnd_labels[k]);
+		else
+			fprintf(fp, "if (RNDMODE == %d)\n\tbegin : %s\n",
+				k, rnd_labels[k]);
+		fprintf(fp,
+"\t\t%s #(IWID,OWID,SHIFT) rnd(i_clk, i_ce, i_val, o_val);\n", rnd_names[k]);
+		if (k == last)
+			fprintf(fp, "\tend endgenerate\n");
+		else
+			fprintf(fp, "\tend else ");
+	}
+
+	fprintf(fp,
+"\n"
+"endmodule\n");
+	fclose(fp);
+}
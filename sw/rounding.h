@@ -48,5 +48,6 @@ extern	void	build_truncator(const char *fname);
 extern	void	build_roundhalfup(const char *fname);
 extern	void	build_roundfromzero(const char *fname);
 extern	void	build_convround(const char *fname);
+extern	void	build_rndselect(const char *fname, unsigned rndmask);
 
 #endif
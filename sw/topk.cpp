@@ -0,0 +1,422 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	topk.cpp
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Generates topk.v, a back end for the FFT that finds the K bins
+//		of greatest power within each frame.  Only these K bins, with
+//	their powers and bin numbers, are produced, once per frame, rather
+//	than every bin of the FFT.
+//
+//
+//	steeper roll off.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+#define _CRT_SECURE_NO_WARNINGS   //  ms vs 2012 doesn't like fopen
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _MSC_VER //  added for ms vs compatibility
+
+#include <io.h>
+#include <direct.h>
+#define _USE_MATH_DEFINES
+#else
+// And for G++/Linux environment
+
+#include <unistd.h>	// Defines the R_OK/W_OK/etc. macros
+#include <sys/stat.h>
+#endif
+
+#include <string.h>
+#include <string>
+#include <math.h>
+#include <ctype.h>
+#include <assert.h>
+
+#include "defaults.h"
+#include "legal.h"
+#include "fftlib.h"
+#include "topk.h"
+
+void	build_topk(const char *fname, int lgsize, int iw, int k,
+		bool single_clock, bool unordered, const bool async_reset) {
+	FILE	*fp = fopen(fname, "w");
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return;
+	}
+
+	std::string	resetw("i_reset"), always_reset;
+	if (async_reset) {
+		resetw = std::string("i_areset_n");
+		always_reset = std::string("\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	} else
+		always_reset = std::string("\talways @(posedge i_clk)\n\tif (i_reset)\n");
+
+	int	lgpos, lgk, nlanes;
+	const char *const	lsfx[2] = { "_l", "_r" };
+	const char *const	linput[2] = { "i_left", "i_right" };
+
+	nlanes = (single_clock) ? 1 : 2;
+	lgpos = (single_clock) ? lgsize : (lgsize-1);
+	for(lgk=0; (1<<lgk) <= k; lgk++)
+		;
+	assert(lgpos >= 1);
+	assert((k >= 1)&&(k <= (1<<lgpos)));
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\ttopk.v\n"
+"//\n"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:\tFinds the %d bins of greatest power, |X|^2, within each frame\n"
+"//		of a %d point FFT.  Connect the FFT's outputs, together with\n"
+"//	its o_sync and its i_ce, to this module.  Once the last bin of a frame\n"
+"//	has passed, these %d bins are produced on %d consecutive clocks, in\n"
+"//	order of decreasing power, each with its bin number.\n"
+"//\n"
+"//	The bins are kept in a list sorted by power.  Each new bin is\n"
+"//	compared against every entry in the list at once, and then inserted\n"
+"//	in place, pushing the weaker entries down and the weakest out.\n",
+		prjname, k, 1<<lgsize, k, k);
+	if (!single_clock)
+		fprintf(fp,
+"//	Since two bins arrive per clock, the left and right bins are kept\n"
+"//	in separate lists, which are then merged as they are produced.\n");
+	fprintf(fp,
+"//	%s\n"
+"//\n"
+"// Ports:\n"
+"//	i_ce		The FFT's clock enable.  A sample is accepted on every\n"
+"//			i_ce, once the first i_sync has been seen.\n",
+		(unordered) ? "The FFT's output is expected in bit reversed\n"
+"//	order, and the bin numbers produced account for this."
+			: "The FFT's output is expected in its natural order.");
+	if (single_clock)
+		fprintf(fp,
+"//	i_sample	The FFT's o_result, real part in the MSBs\n");
+	else
+		fprintf(fp,
+"//	i_left, i_right	The FFT's o_left and o_right\n");
+	fprintf(fp,
+"//	i_sync		The FFT's o_sync, true on the first sample of a frame\n"
+"//\n"
+"//	o_ce		True when o_bin and o_power are valid\n"
+"//	o_sync		True with the strongest bin of each frame\n"
+"//	o_bin		The number of a bin\n"
+"//	o_power		The (unsigned) power in that bin\n"
+"//\n%s"
+"//\n", creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+
+	if (single_clock)
+		fprintf(fp,
+"module\ttopk(i_clk, %s, i_ce, i_sample, i_sync,\n",
+			resetw.c_str());
+	else
+		fprintf(fp,
+"module\ttopk(i_clk, %s, i_ce, i_left, i_right, i_sync,\n",
+			resetw.c_str());
+	fprintf(fp,
+	"\t\to_ce, o_sync, o_bin, o_power);\n"
+	"\tlocalparam\tIW=%d, LGSIZE=%d, K=%d;\n"
+	"\tlocalparam\tPW=2*IW;\n"
+	"\t//\n"
+	"\tinput\twire\t\t\ti_clk, %s;\n"
+	"\t//\n"
+	"\tinput\twire\t\t\ti_ce;\n",
+		iw, lgsize, k, resetw.c_str());
+	if (single_clock)
+		fprintf(fp,
+	"\tinput\twire\t[(2*IW-1):0]\ti_sample;\n");
+	else
+		fprintf(fp,
+	"\tinput\twire\t[(2*IW-1):0]\ti_left, i_right;\n");
+	fprintf(fp,
+	"\tinput\twire\t\t\ti_sync;\n"
+	"\t//\n"
+	"\toutput\treg\t\t\to_ce, o_sync;\n"
+	"\toutput\treg\t[(LGSIZE-1):0]\to_bin;\n"
+	"\toutput\treg\t[(PW-1):0]\to_power;\n"
+"\n"
+	"\treg				running, flush;\n"
+	"\treg		[%d:0]		pos, a_pos, b_pos;\n"
+	"\treg				a_ce, a_first, a_last,\n"
+	"\t\t\t\t\tb_ce, b_first, b_last;\n"
+	"\treg		[%d:0]		ocount;\n",
+		lgpos-1, lgk-1);
+	for(int l=0; l<nlanes; l++) {
+		const char *sfx = (single_clock) ? "" : lsfx[l];
+		fprintf(fp,
+	"\treg	signed	[(2*IW-1):0]	sq_r%s, sq_i%s;\n"
+	"\treg		[(PW-1):0]	power%s;\n"
+	"\t// The sorted list, strongest first\n"
+	"\treg		[(PW-1):0]	mag%s	[0:(K-1)];\n"
+	"\treg		[%d:0]		idx%s	[0:(K-1)];\n"
+	"\treg		[(K-1):0]	vld%s;\n"
+	"\twire		[(K-1):0]	gt%s;\n"
+	"\t// The list from the last frame, as it is produced\n"
+	"\treg		[(PW-1):0]	omag%s	[0:(K-1)];\n"
+	"\treg		[%d:0]		oidx%s	[0:(K-1)];\n",
+			sfx, sfx, sfx, sfx, lgpos-1, sfx, sfx, sfx,
+			sfx, lgpos-1, sfx);
+	}
+	if (!single_clock)
+		fprintf(fp,
+	"\twire				sel_l;\n");
+	fprintf(fp,
+	"\tgenvar\t\t\t\tk;\n");
+
+	fprintf(fp,
+"\n"
+	"\t//\n"
+	"\t// Nothing is valid until the first frame begins\n"
+	"\t//\n"
+	"\tinitial\trunning = 1'b0;\n"
+	"%s"
+	"\t\trunning <= 1'b0;\n"
+	"\telse if ((i_ce)&&(i_sync))\n"
+	"\t\trunning <= 1'b1;\n"
+"\n"
+	"\t// pos is the position of the next sample within the frame\n"
+	"\tinitial\tpos = 0;\n"
+	"%s"
+	"\t\tpos <= 0;\n"
+	"\telse if (i_ce)\n"
+	"\t\tpos <= (i_sync) ? 1 : (pos + 1'b1);\n"
+"\n"
+	"\t//\n"
+	"\t// Following any valid sample, ...\n"
+	"\t//	a_ce: Each component has been squared\n"
+	"\t//	b_ce: The power is valid, and may be inserted into the list\n"
+	"\t//\n"
+	"\tinitial	{ b_ce, a_ce } = 2'b00;\n"
+	"%s"
+	"\t\t{ b_ce, a_ce } <= 2'b00;\n"
+	"\telse\n"
+	"\t\t{ b_ce, a_ce } <= { a_ce, (i_ce)&&((running)||(i_sync)) };\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+	"\t\ta_pos   <= (i_sync) ? 0 : pos;\n"
+	"\t\ta_first <= i_sync;\n"
+	"\t\ta_last  <= (!i_sync)&&(&pos);\n"
+	"\tend\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tbegin\n"
+	"\t\tb_pos   <= a_pos;\n"
+	"\t\tb_first <= a_first;\n"
+	"\t\tb_last  <= a_last;\n"
+	"\tend\n"
+"\n",
+		always_reset.c_str(), always_reset.c_str(),
+		always_reset.c_str());
+
+	for(int l=0; l<nlanes; l++) {
+		const char *sfx = (single_clock) ? "" : lsfx[l],
+			*in = (single_clock) ? "i_sample" : linput[l];
+
+		if (!single_clock)
+			fprintf(fp,
+	"\t//\n"
+	"\t// The %s lane\n"
+	"\t//\n", (l == 0) ? "left" : "right");
+		fprintf(fp,
+	"\talways @(posedge i_clk)\n"
+	"\tif (i_ce)\n"
+	"\tbegin\n"
+	"\t\tsq_r%s <= $signed(%s[(2*IW-1):IW])\n"
+	"\t\t\t\t* $signed(%s[(2*IW-1):IW]);\n"
+	"\t\tsq_i%s <= $signed(%s[(IW-1):0])\n"
+	"\t\t\t\t* $signed(%s[(IW-1):0]);\n"
+	"\tend\n"
+"\n"
+	"\t// Both squares are positive, and no more than 2^(2*IW-2), so\n"
+	"\t// their sum will fit in 2*IW bits\n"
+	"\talways @(posedge i_clk)\n"
+	"\t\tpower%s <= sq_r%s + sq_i%s;\n"
+"\n",
+			sfx, in, in, sfx, in, in, sfx, sfx, sfx);
+
+		fprintf(fp,
+	"\t// The list is sorted, so once the new power is greater than one\n"
+	"\t// entry, it will be greater than every entry following.  The\n"
+	"\t// first bin of a frame starts a new list.\n"
+	"\tinitial\tvld%s = 0;\n"
+	"%s"
+	"\t\tvld%s <= 0;\n"
+	"\telse if (b_ce)\n"
+	"\t\tvld%s <= (b_first) ? 1 : %s;\n"
+"\n"
+	"\tgenerate for(k=0; k<K; k=k+1)\n"
+	"\tbegin : SORT%s\n"
+	"\t\tassign\tgt%s[k] = (!vld%s[k])||(power%s > mag%s[k]);\n"
+"\n"
+	"\t\tif (k == 0)\n"
+	"\t\tbegin : HEAD\n"
+	"\t\t\talways @(posedge i_clk)\n"
+	"\t\t\tif ((b_ce)&&((b_first)||(gt%s[0])))\n"
+	"\t\t\tbegin\n"
+	"\t\t\t\tmag%s[0] <= power%s;\n"
+	"\t\t\t\tidx%s[0] <= b_pos;\n"
+	"\t\t\tend\n"
+	"\t\tend else begin : TAIL\n"
+	"\t\t\talways @(posedge i_clk)\n"
+	"\t\t\tif ((b_ce)&&(!b_first)&&(gt%s[k]))\n"
+	"\t\t\tbegin\n"
+	"\t\t\t\tif (gt%s[k-1])\n"
+	"\t\t\t\tbegin\n"
+	"\t\t\t\t\tmag%s[k] <= mag%s[k-1];\n"
+	"\t\t\t\t\tidx%s[k] <= idx%s[k-1];\n"
+	"\t\t\t\tend else begin\n"
+	"\t\t\t\t\tmag%s[k] <= power%s;\n"
+	"\t\t\t\t\tidx%s[k] <= b_pos;\n"
+	"\t\t\t\tend\n"
+	"\t\t\tend\n"
+	"\t\tend\n"
+"\n"
+	"\t\t// Copy the list at the end of each frame, and then shift it\n"
+	"\t\t// out, one entry at a time\n"
+	"\t\tif (k < K-1)\n"
+	"\t\tbegin : SHIFT\n"
+	"\t\t\talways @(posedge i_clk)\n"
+	"\t\t\tif (flush)\n"
+	"\t\t\tbegin\n"
+	"\t\t\t\tomag%s[k] <= mag%s[k];\n"
+	"\t\t\t\toidx%s[k] <= idx%s[k];\n"
+	"\t\t\tend else if (%s)\n"
+	"\t\t\tbegin\n"
+	"\t\t\t\tomag%s[k] <= omag%s[k+1];\n"
+	"\t\t\t\toidx%s[k] <= oidx%s[k+1];\n"
+	"\t\t\tend\n"
+	"\t\tend else begin : LAST\n"
+	"\t\t\talways @(posedge i_clk)\n"
+	"\t\t\tif (flush)\n"
+	"\t\t\tbegin\n"
+	"\t\t\t\tomag%s[k] <= mag%s[k];\n"
+	"\t\t\t\toidx%s[k] <= idx%s[k];\n"
+	"\t\t\tend\n"
+	"\t\tend\n"
+	"\tend endgenerate\n"
+"\n",
+			sfx, always_reset.c_str(), sfx, sfx,
+			(k > 1) ? (std::string("{ vld") + sfx + "[(K-2):0], 1'b1 }").c_str() : "1",
+			(single_clock) ? "" : ((l == 0) ? "_L" : "_R"),
+			sfx, sfx, sfx, sfx,
+			sfx, sfx, sfx, sfx,
+			sfx, sfx, sfx, sfx, sfx, sfx, sfx, sfx, sfx,
+			sfx, sfx, sfx, sfx,
+			(single_clock) ? "ocount != 0"
+				: ((l == 0) ? "(ocount != 0)&&(sel_l)"
+					: "(ocount != 0)&&(!sel_l)"),
+			sfx, sfx, sfx, sfx,
+			sfx, sfx, sfx, sfx);
+	}
+
+	fprintf(fp,
+	"\t//\n"
+	"\t// Produce the list from each frame, once its last bin has been\n"
+	"\t// inserted.  Each list takes K clocks to produce, while the next\n"
+	"\t// list cannot be ready for at least a frame.\n"
+	"\t//\n"
+	"\tinitial\tflush = 1'b0;\n"
+	"%s"
+	"\t\tflush <= 1'b0;\n"
+	"\telse\n"
+	"\t\tflush <= (b_ce)&&(b_last);\n"
+"\n"
+	"\tinitial\tocount = 0;\n"
+	"%s"
+	"\t\tocount <= 0;\n"
+	"\telse if (flush)\n"
+	"\t\tocount <= K;\n"
+	"\telse if (ocount != 0)\n"
+	"\t\tocount <= ocount - 1'b1;\n"
+"\n",
+		always_reset.c_str(), always_reset.c_str());
+
+	if (!single_clock)
+		fprintf(fp,
+	"\t// Merge the two lists.  Neither list can run dry, since each\n"
+	"\t// holds all K entries.\n"
+	"\tassign\tsel_l = (omag_l[0] >= omag_r[0]);\n"
+"\n");
+
+	fprintf(fp,
+	"\tinitial\to_ce   = 1'b0;\n"
+	"\tinitial\to_sync = 1'b0;\n"
+	"%s"
+	"\tbegin\n"
+	"\t\to_ce   <= 1'b0;\n"
+	"\t\to_sync <= 1'b0;\n"
+	"\tend else begin\n"
+	"\t\to_ce   <= (ocount != 0);\n"
+	"\t\to_sync <= (ocount == K);\n"
+	"\tend\n"
+"\n"
+	"\talways @(posedge i_clk)\n",
+		always_reset.c_str());
+	if (single_clock)
+		fprintf(fp,
+	"\tif (ocount != 0)\n"
+	"\tbegin\n"
+	"\t\to_power <= omag[0];\n"
+	"\t\to_bin   <= %s;\n"
+	"\tend\n",
+			gen_bin_expr("oidx[0]", lgpos, -1, unordered).c_str());
+	else
+		fprintf(fp,
+	"\tif ((ocount != 0)&&(sel_l))\n"
+	"\tbegin\n"
+	"\t\to_power <= omag_l[0];\n"
+	"\t\to_bin   <= %s;\n"
+	"\tend else if (ocount != 0)\n"
+	"\tbegin\n"
+	"\t\to_power <= omag_r[0];\n"
+	"\t\to_bin   <= %s;\n"
+	"\tend\n",
+			gen_bin_expr("oidx_l[0]", lgpos, 0, unordered).c_str(),
+			gen_bin_expr("oidx_r[0]", lgpos, 1, unordered).c_str());
+
+	fprintf(fp,
+"\n"
+"endmodule\n");
+
+	fclose(fp);
+}
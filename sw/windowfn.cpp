@@ -0,0 +1,401 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	windowfn.cpp
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Generates the taps for a window function, and (for FFTs taking
+//		two samples per clock) the Verilog to apply them.  The
+//	single sample per clock window function, rtl/windowfn.v, can use
+//	these same taps when its OPT_FIXED_TAPS parameter is set.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+#define _CRT_SECURE_NO_WARNINGS   //  ms vs 2012 doesn't like fopen
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _MSC_VER //  added for ms vs compatibility
+
+#include <io.h>
+#include <direct.h>
+#define _USE_MATH_DEFINES
+#define	strcasecmp	_stricmp
+#else
+// And for G++/Linux environment
+
+#include <unistd.h>	// Defines the R_OK/W_OK/etc. macros
+#include <sys/stat.h>
+#endif
+
+#include <string.h>
+#include <string>
+#include <math.h>
+#include <ctype.h>
+#include <assert.h>
+
+#include "defaults.h"
+#include "legal.h"
+#include "fftlib.h"
+#include "windowfn.h"
+
+bool	parse_window(const char *str, WINDOW_T &window) {
+	if ((strcasecmp(str, "rect")==0)||(strcasecmp(str, "none")==0))
+		window = WIN_RECT;
+	else if ((strcasecmp(str, "hann")==0)||(strcasecmp(str, "hanning")==0))
+		window = WIN_HANN;
+	else if (strcasecmp(str, "hamming")==0)
+		window = WIN_HAMMING;
+	else if (strcasecmp(str, "blackman")==0)
+		window = WIN_BLACKMAN;
+	else
+		return false;
+	return true;
+}
+
+const char *window_name(WINDOW_T window) {
+	switch(window) {
+	case WIN_RECT:		return "rectangular";
+	case WIN_HANN:		return "Hann";
+	case WIN_HAMMING:	return "Hamming";
+	case WIN_BLACKMAN:	return "Blackman";
+	default:		return "no";
+	}
+}
+
+std::string	gen_window_fname(const char *coredir, int fftsize) {
+	char	*memfile;
+	std::string	result;
+
+	memfile = new char[strlen(coredir)+strlen("/window_.hex")+16];
+	if (coredir[0] == '\0')
+		sprintf(memfile, "window_%d.hex", fftsize);
+	else
+		sprintf(memfile, "%s/window_%d.hex", coredir, fftsize);
+	result = std::string(memfile);
+	delete[] memfile;
+	return result;
+}
+
+//
+// Evaluates tap k of an n point periodic window.  With offset, the window
+// is evaluated half a sample later, so that w[k] = w[n-1-k].  This symmetry
+// allows the two sample per clock window to keep only half of its taps.
+// The Hann window keeps its property that two copies, offset by N/2, sum to
+// a constant, so 50% overlapped frames still give every sample the same
+// total weight.
+//
+double	window_value(WINDOW_T window, int k, int n, bool offset) {
+	double	x = 2.0 * M_PI * (k + ((offset) ? 0.5 : 0.0)) / (double)n;
+
+	switch(window) {
+	case WIN_HANN:		return 0.5 - 0.5 * cos(x);
+	case WIN_HAMMING:	return 0.54 - 0.46 * cos(x);
+	case WIN_BLACKMAN:	return 0.42 - 0.5 * cos(x) + 0.08 * cos(2.0*x);
+	default:		return 1.0;
+	}
+}
+
+void	gen_window_taps(const char *fname, WINDOW_T window,
+			int lgsize, int tbits, bool half) {
+	FILE	*fp;
+	int	ntaps = (1<<lgsize);
+	long long	maxv = (1ll<<(tbits-1))-1;
+
+	fp = fopen(fname, "w");
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open window file \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		exit(EXIT_FAILURE);
+	}
+
+	if (half)
+		ntaps /= 2;
+	for(int k=0; k<ntaps; k++) {
+		long long	tap;
+
+		tap = llround(maxv * window_value(window, k, 1<<lgsize, half));
+		fprintf(fp, "%0*llx\n", (tbits+3)/4,
+			tap & (~(-1ll << tbits)));
+	}
+
+	fclose(fp);
+}
+
+void	build_dblwindow(const char *fname, int lgsize, int iw, int ow, int tw,
+		const bool async_reset) {
+	FILE	*fp = fopen(fname, "w");
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return;
+	}
+
+	std::string	resetw("i_reset"), always_reset;
+	if (async_reset) {
+		resetw = std::string("i_areset_n");
+		always_reset = std::string("\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	} else
+		always_reset = std::string("\talways @(posedge i_clk)\n\tif (i_reset)\n");
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\tdblwindowfn.v\n"
+"//\n"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:\tApply a window function to incoming real data, producing\n"
+"//		frames with 50%% overlap for an FFT taking two samples per\n"
+"//	clock.  Since every sample is used in two frames, one sample in per\n"
+"//	i_ce produces one pair of windowed samples out, o_left and o_right,\n"
+"//	each o_ce.  Hence, with i_ce true on every clock, this will keep up\n"
+"//	with a -2 FFT running at full rate.\n"
+"//\n"
+"//	The incoming samples are split between an even and an odd memory, so\n"
+"//	that both samples of a pair may be read on the same clock.  Since\n"
+"//	the window is symmetric, only the first half of its taps are kept,\n"
+"//	and both multiplies read them from this one table.\n"
+"//\n"
+"//	For this module, the window size is the FFT length.\n"
+"//\n"
+"// Ports:\n"
+"//	i_ce		True when i_sample is valid\n"
+"//	i_sample	The incoming (real) sample data\n"
+"//\n"
+"//	o_ce		True when the core has a valid output pair\n"
+"//	o_left, o_right	The even and odd windowed samples of this pair\n"
+"//	o_frame		True on the first pair of any frame.  Following a\n"
+"//			reset, o_ce will remain false until the first frame\n"
+"//		is complete, and then rise together with o_frame.  o_ce may\n"
+"//		therefore drive the FFT's i_ce directly.\n"
+"//\n%s"
+"//\n", prjname, creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+
+	fprintf(fp,
+"module\tdblwindowfn(i_clk, %s, i_ce, i_sample,\n"
+	"\t\to_frame, o_ce, o_left, o_right);\n"
+	"\tparameter\t\tIW=%d, OW=%d, TW=%d, LGNFFT = %d;\n"
+	"\tparameter\t\tINITIAL_COEFFS = \"window_%d.hex\";\n"
+	"\t//\n"
+	"\tlocalparam\tAW=IW+TW;\n"
+	"\t//\n"
+	"\tinput\twire\t\t\ti_clk, %s;\n"
+	"\t//\n"
+	"\tinput\twire\t\t\ti_ce;\n"
+	"\tinput\twire\t[(IW-1):0]\ti_sample;\n"
+	"\t//\n"
+	"\toutput\treg\t\t\to_frame, o_ce;\n"
+	"\toutput\treg\t[(OW-1):0]\to_left, o_right;\n"
+"\n"
+	"\t// The first half of the window, w[k] = w[N-1-k]\n"
+	"\treg	[(TW-1):0]	cmem	[0:(1<<(LGNFFT-1))-1];\n"
+	"\t// The last N samples, split into even and odd halves\n"
+	"\treg	[(IW-1):0]	emem	[0:(1<<(LGNFFT-1))-1];\n"
+	"\treg	[(IW-1):0]	omem	[0:(1<<(LGNFFT-1))-1];\n"
+"\n"
+	"\treg		[LGNFFT-1:0]	wridx;\n"
+	"\treg		[LGNFFT-2:0]	rdidx, pairidx;\n"
+	"\twire		[LGNFFT-2:0]	ecidx, ocidx;\n"
+	"\treg				start_frame, running;\n"
+	"\treg				a_ce, d_ce, p_ce;\n"
+	"\treg				a_frame, d_frame, p_frame;\n"
+	"\treg	signed	[IW-1:0]	edata, odata;\n"
+	"\treg	signed	[TW-1:0]	etap, otap;\n"
+	"\treg	signed	[AW-1:0]	eproduct, oproduct;\n"
+"\n"
+	"\tinitial $readmemh(INITIAL_COEFFS, cmem);\n"
+"\n",
+		resetw.c_str(), iw, ow, tw, lgsize, 1<<lgsize,
+		resetw.c_str());
+
+	fprintf(fp,
+	"\t//\n"
+	"\t// Record the incoming data into the even and odd memories\n"
+	"\t//\n"
+	"\tinitial\twridx = 0;\n%s"
+		"\t\twridx <= 0;\n"
+	"\telse if (i_ce)\n"
+		"\t\twridx <= wridx + 1'b1;\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif ((i_ce)&&(!wridx[0]))\n"
+		"\t\temem[wridx[LGNFFT-1:1]] <= i_sample;\n"
+"\n"
+	"\talways @(posedge i_clk)\n"
+	"\tif ((i_ce)&&(wridx[0]))\n"
+		"\t\tomem[wridx[LGNFFT-1:1]] <= i_sample;\n"
+"\n", always_reset.c_str());
+
+	fprintf(fp,
+	"\t//\n"
+	"\t// A new frame begins every N/2 samples.  We start reading it on the\n"
+	"\t// i_ce that writes its next to last sample, so that the first pair\n"
+	"\t// is read on the following clock.  Each pair is then read before\n"
+	"\t// it can be overwritten, and after both of its samples have been\n"
+	"\t// written.  No frame is complete, however, until N samples have\n"
+	"\t// been received.\n"
+	"\t//\n"
+	"\talways @(*)\n"
+		"\t\tstart_frame = (&wridx[LGNFFT-2:1])&&(!wridx[0]);\n"
+"\n"
+	"\tinitial\trunning = 1'b0;\n%s"
+		"\t\trunning <= 1'b0;\n"
+	"\telse if ((i_ce)&&(start_frame)&&(wridx[LGNFFT-1]))\n"
+		"\t\trunning <= 1'b1;\n"
+"\n"
+	"\tinitial\trdidx   = 0;\n"
+	"\tinitial\tpairidx = 0;\n%s"
+	"\tbegin\n"
+		"\t\trdidx   <= 0;\n"
+		"\t\tpairidx <= 0;\n"
+	"\tend else if (i_ce)\n"
+	"\tbegin\n"
+		"\t\tif (start_frame)\n"
+		"\t\tbegin\n"
+			"\t\t\t// The frame began N-2 samples ago, or equivalently\n"
+			"\t\t\t// two samples ahead in our memory\n"
+			"\t\t\trdidx   <= wridx[LGNFFT-1:1] + 1'b1;\n"
+			"\t\t\tpairidx <= 0;\n"
+		"\t\tend else begin\n"
+			"\t\t\trdidx   <= rdidx + 1'b1;\n"
+			"\t\t\tpairidx <= pairidx + 1'b1;\n"
+		"\t\tend\n"
+	"\tend\n"
+"\n"
+	"\t// The taps for pair n are w[2n] and w[2n+1].  In the second half of\n"
+	"\t// the frame, these are found at N-1-2n and N-2-2n instead.\n"
+	"\tassign\tecidx = { pairidx[LGNFFT-3:0], 1'b0 }\n"
+		"\t\t\t^ {(LGNFFT-1){pairidx[LGNFFT-2]}};\n"
+	"\tassign\tocidx = { pairidx[LGNFFT-3:0], 1'b1 }\n"
+		"\t\t\t^ {(LGNFFT-1){pairidx[LGNFFT-2]}};\n"
+"\n", always_reset.c_str(), always_reset.c_str());
+
+	fprintf(fp,
+	"\t//\n"
+	"\t// Following any valid read address, ...\n"
+	"\t//	a_ce: The address is valid\n"
+	"\t//	d_ce: The data and taps, read from memory, are valid\n"
+	"\t//	p_ce: The products of data and taps are valid\n"
+	"\t//\n"
+	"\tinitial\t{ p_ce, d_ce, a_ce } = 3'h0;\n"
+	"\tinitial\t{ p_frame, d_frame, a_frame } = 3'h0;\n%s"
+	"\tbegin\n"
+		"\t\t{ p_ce, d_ce, a_ce } <= 3'h0;\n"
+		"\t\t{ p_frame, d_frame, a_frame } <= 3'h0;\n"
+	"\tend else begin\n"
+		"\t\ta_ce <= (i_ce)&&((running)\n"
+			"\t\t\t\t||((start_frame)&&(wridx[LGNFFT-1])));\n"
+		"\t\ta_frame <= (i_ce)&&(start_frame)\n"
+			"\t\t\t\t&&((running)||(wridx[LGNFFT-1]));\n"
+		"\t\t{ p_ce, d_ce } <= { d_ce, a_ce };\n"
+		"\t\t{ p_frame, d_frame } <= { d_frame, a_frame };\n"
+	"\tend\n"
+"\n"
+	"\t// Read both samples and both taps.  As with windowfn.v, these are\n"
+	"\t// block RAM reads, so nothing else is done here.\n"
+	"\talways @(posedge i_clk)\n"
+	"\tbegin\n"
+		"\t\tedata <= emem[rdidx];\n"
+		"\t\todata <= omem[rdidx];\n"
+		"\t\tetap  <= cmem[ecidx];\n"
+		"\t\totap  <= cmem[ocidx];\n"
+	"\tend\n"
+"\n"
+	"\t// Our two multiplies\n"
+	"\talways @(posedge i_clk)\n"
+	"\tbegin\n"
+		"\t\teproduct <= edata * etap;\n"
+		"\t\toproduct <= odata * otap;\n"
+	"\tend\n"
+"\n", always_reset.c_str());
+
+	fprintf(fp,
+	"\tinitial\to_ce    = 1'b0;\n"
+	"\tinitial\to_frame = 1'b0;\n%s"
+	"\tbegin\n"
+		"\t\to_ce    <= 1'b0;\n"
+		"\t\to_frame <= 1'b0;\n"
+	"\tend else begin\n"
+		"\t\to_ce    <= p_ce;\n"
+		"\t\to_frame <= p_frame;\n"
+	"\tend\n"
+"\n"
+	"\tgenerate if (OW == AW)\n"
+	"\tbegin : BIT_ADJUSTMENT_NONE\n"
+"\n"
+		"\t\talways @(posedge i_clk)\n"
+		"\t\tif (p_ce)\n"
+		"\t\tbegin\n"
+			"\t\t\to_left  <= eproduct;\n"
+			"\t\t\to_right <= oproduct;\n"
+		"\t\tend\n"
+"\n"
+	"\tend else if (OW < AW)\n"
+	"\tbegin : BIT_ADJUSTMENT_ROUNDING\n"
+		"\t\twire	[AW-1:0]	erounded, orounded;\n"
+"\n"
+		"\t\tassign	erounded = eproduct + { {(OW){1'b0}}, eproduct[AW-OW],\n"
+				"\t\t\t\t{(AW-OW-1){!eproduct[AW-OW]}} };\n"
+		"\t\tassign	orounded = oproduct + { {(OW){1'b0}}, oproduct[AW-OW],\n"
+				"\t\t\t\t{(AW-OW-1){!oproduct[AW-OW]}} };\n"
+"\n"
+		"\t\talways @(posedge i_clk)\n"
+		"\t\tif (p_ce)\n"
+		"\t\tbegin\n"
+			"\t\t\to_left  <= erounded[(AW-1):(AW-OW)];\n"
+			"\t\t\to_right <= orounded[(AW-1):(AW-OW)];\n"
+		"\t\tend\n"
+"\n"
+		"\t\t// Make Verilator happy\n"
+		"\t\t// verilator lint_off UNUSED\n"
+		"\t\twire	[2*(AW-OW)-1:0]	unused_rounding_bits;\n"
+		"\t\tassign	unused_rounding_bits = { erounded[AW-OW-1:0],\n"
+				"\t\t\t\t\torounded[AW-OW-1:0] };\n"
+		"\t\t// verilator lint_on  UNUSED\n"
+"\n"
+	"\tend else // if (OW > AW)\n"
+	"\tbegin : BIT_ADJUSTMENT_EXTENDING\n"
+"\n"
+		"\t\talways @(posedge i_clk)\n"
+		"\t\tif (p_ce)\n"
+		"\t\tbegin\n"
+			"\t\t\to_left  <= { eproduct, {(OW-AW){1'b0}} };\n"
+			"\t\t\to_right <= { oproduct, {(OW-AW){1'b0}} };\n"
+		"\t\tend\n"
+"\n"
+	"\tend endgenerate\n"
+"\n"
+"endmodule\n", always_reset.c_str());
+
+	fclose(fp);
+}
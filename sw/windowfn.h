@@ -0,0 +1,57 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	windowfn.h
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Generates window function taps, and the two sample per clock
+//		window function that applies them ahead of a -2 FFT.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+#ifndef	WINDOWFN_H
+#define	WINDOWFN_H
+
+typedef	enum {
+	WIN_NONE=0, WIN_RECT, WIN_HANN, WIN_HAMMING, WIN_BLACKMAN
+} WINDOW_T;
+
+extern	bool	parse_window(const char *str, WINDOW_T &window);
+extern	const char *window_name(WINDOW_T window);
+extern	double	window_value(WINDOW_T window, int k, int n,
+			bool offset=false);
+extern	std::string	gen_window_fname(const char *coredir, int fftsize);
+extern	void	gen_window_taps(const char *fname, WINDOW_T window,
+			int lgsize, int tbits, bool half);
+extern	void	build_dblwindow(const char *fname,
+			int lgsize, int iw, int ow, int tw,
+			const bool async_reset = false);
+
+#endif	// WINDOWFN_H
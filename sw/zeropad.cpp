@@ -0,0 +1,147 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	zeropad.cpp
+//
+// Project:	A General Purpose Pipelined FFT Implementation
+//
+// Purpose:	Generates zeropad.v, which feeds an FFT pruned for zero padded
+//		frames (-z) with the zeros of each frame itself, so that only
+//	the nonzero samples need be given to it.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2015-2018, Gisselquist Technology, LLC
+//
+// This program is free software (firmware): you can redistribute it and/or
+// modify it under the terms of  the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTIBILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  (It's in the $(ROOT)/doc directory.  Run make with no
+// target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+//
+// License:	GPL, v3, as defined and found on www.gnu.org,
+//		http://www.gnu.org/licenses/gpl.html
+//
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+#define _CRT_SECURE_NO_WARNINGS   //  ms vs 2012 doesn't like fopen
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _MSC_VER //  added for ms vs compatibility
+
+#include <io.h>
+#include <direct.h>
+#define _USE_MATH_DEFINES
+#else
+// And for G++/Linux environment
+
+#include <unistd.h>	// Defines the R_OK/W_OK/etc. macros
+#include <sys/stat.h>
+#endif
+
+#include <string.h>
+#include <string>
+#include <math.h>
+#include <ctype.h>
+#include <assert.h>
+
+#include "defaults.h"
+#include "legal.h"
+#include "fftlib.h"
+
+#include "zeropad.h"
+
+void	build_zeropad(const char *fname, int lgsize, int nonzero,
+		int iw, int ow, const bool inverse, const bool async_reset) {
+	FILE	*fp = fopen(fname, "w");
+	if (NULL == fp) {
+		fprintf(stderr, "Could not open \'%s\' for writing\n", fname);
+		perror("O/S Err was:");
+		return;
+	}
+
+	std::string	resetw("i_reset"), always_reset;
+	if (async_reset) {
+		resetw = std::string("i_areset_n");
+		always_reset = std::string("\talways @(posedge i_clk, negedge i_areset_n)\n\tif (!i_areset_n)\n");
+	} else
+		always_reset = std::string("\talways @(posedge i_clk)\n\tif (i_reset)\n");
+
+	fprintf(fp,
+SLASHLINE
+"//\n"
+"// Filename:\tzeropad.v\n"
+"//\n"
+"// Project:\t%s\n"
+"//\n"
+"// Purpose:\tFeeds a %d point FFT, pruned for frames where only the first\n"
+"//		%d samples may be nonzero, with only those samples.  They are\n"
+"//	accepted one per i_ce while o_ready is set.  Once the last of them\n"
+"//	is in, o_ready falls, and a frame counter gives the FFT the remaining\n"
+"//	%d zeros itself, one on every clock, before raising o_ready again\n"
+"//	for the next frame.\n"
+"//\n"
+"//	When samples arrive less often than once a clock, a frame thus takes\n"
+"//	%d sample times plus %d clocks, rather than %d sample times.\n"
+"//\n"
+"//	The FFT runs on o_ce, and o_result and o_sync are to be read on\n"
+"//	every clock with o_ce set, just as the FFT\'s outputs are read on\n"
+"//	every i_ce.  o_sync is true with bin zero.\n"
+"//\n%s"
+"//\n", prjname, 1<<lgsize, nonzero, (1<<lgsize)-nonzero,
+		nonzero, (1<<lgsize)-nonzero, 1<<lgsize, creator);
+	fprintf(fp, "%s", cpyleft);
+	fprintf(fp, "//\n//\n`default_nettype\tnone\n//\n");
+
+	fprintf(fp,
+"module\tzeropad(i_clk, %s, i_ce, i_sample, o_ready,\n"
+		"\t\to_ce, o_result, o_sync);\n"
+	"\tlocalparam\tIW=%d, OW=%d, LGSIZE=%d;\n"
+	"\tlocalparam\t[LGSIZE-1:0]\tNKEEP = %d;\n"
+	"\t//\n"
+	"\tinput\twire\t\t\ti_clk, %s, i_ce;\n"
+	"\tinput\twire\t[(2*IW-1):0]\ti_sample;\n"
+	"\toutput\twire\t\t\to_ready, o_ce;\n"
+	"\toutput\twire\t[(2*OW-1):0]\to_result;\n"
+	"\toutput\twire\t\t\to_sync;\n"
+"\n"
+	"\t//\n"
+	"\t// Count the FFT\'s samples, and fill in the zeros past NKEEP\n"
+	"\t//\n"
+	"\treg\t[(LGSIZE-1):0]\tfcount;\n"
+	"\twire\t\t\tw_fill;\n"
+	"\twire\t[(2*IW-1):0]\tw_sample;\n"
+"\n"
+	"\tassign\tw_fill  = (fcount >= NKEEP);\n"
+	"\tassign\to_ready = !w_fill;\n"
+	"\tassign\to_ce    = (w_fill)||(i_ce);\n"
+	"\tassign\tw_sample= (w_fill) ? 0 : i_sample;\n"
+"\n"
+	"\tinitial\tfcount = 0;\n"
+	"%s"
+	"\t\tfcount <= 0;\n"
+	"\telse if (o_ce)\n"
+	"\t\tfcount <= fcount + 1\'b1;\n"
+"\n"
+	"\t%sfftmain\tfft(i_clk, %s, o_ce, w_sample, o_result, o_sync);\n"
+"\n"
+"endmodule\n",
+		resetw.c_str(), iw, ow, lgsize, nonzero, resetw.c_str(),
+		always_reset.c_str(), (inverse) ? "i" : "", resetw.c_str());
+
+	fclose(fp);
+}